@@ -106,6 +106,8 @@ const (
 	IndexOptDense      = 1 << 5
 	IndexOptAppendable = 1 << 4
 	IndexOptSparse     = 1 << 3
+	IndexOptBitmap     = 1 << 2
+	IndexOptColumn     = 1 << 1
 
 	StorageOptEnabled               = 1
 	StorageOptDropOnFileFormatError = 1 << 1
@@ -126,4 +128,5 @@ const (
 	ErrNetwork          = 12
 	ErrNotFound         = 13
 	ErrStateInvalidated = 14
+	ErrOutdatedWAL      = 15
 )
@@ -16,6 +16,8 @@ type IndexDef struct {
 	IsArray     bool        `json:"is_array"`
 	IsDense     bool        `json:"is_dense"`
 	IsSparse    bool        `json:"is_sparse"`
+	IsBitmap    bool        `json:"is_bitmap"`
+	IsColumn    bool        `json:"is_column"`
 	CollateMode string      `json:"collate_mode"`
 	SortOrder   string      `json:"sort_order_letters"`
 	Config      interface{} `json:"config"`
@@ -16,10 +16,20 @@ Error Reindexer::Insert(const string& nsName, Item& item, Completion cmpl) { ret
 Error Reindexer::Update(const string& nsName, Item& item, Completion cmpl) { return impl_->Update(nsName, item, cmpl); }
 Error Reindexer::Upsert(const string& nsName, Item& item, Completion cmpl) { return impl_->Upsert(nsName, item, cmpl); }
 Error Reindexer::Delete(const string& nsName, Item& item, Completion cmpl) { return impl_->Delete(nsName, item, cmpl); }
+Error Reindexer::Insert(const string& nsName, vector<Item>& items, Completion cmpl) { return impl_->Insert(nsName, items, cmpl); }
+Error Reindexer::Update(const string& nsName, vector<Item>& items, Completion cmpl) { return impl_->Update(nsName, items, cmpl); }
+Error Reindexer::Upsert(const string& nsName, vector<Item>& items, Completion cmpl) { return impl_->Upsert(nsName, items, cmpl); }
+Error Reindexer::Delete(const string& nsName, vector<Item>& items, Completion cmpl) { return impl_->Delete(nsName, items, cmpl); }
 Item Reindexer::NewItem(const string& nsName) { return impl_->NewItem(nsName); }
 Error Reindexer::GetMeta(const string& nsName, const string& key, string& data) { return impl_->GetMeta(nsName, key, data); }
 Error Reindexer::PutMeta(const string& nsName, const string& key, const string_view& data) { return impl_->PutMeta(nsName, key, data); }
 Error Reindexer::EnumMeta(const string& nsName, vector<string>& keys) { return impl_->EnumMeta(nsName, keys); }
+Error Reindexer::GetWAL(const string& nsName, int64_t lastLSN, int limit, WALChunk& chunk) {
+	return impl_->GetWAL(nsName, lastLSN, limit, chunk);
+}
+Error Reindexer::GetSnapshot(const string& nsName, int64_t lsn, int64_t fromID, int maxSize, SnapshotChunk& chunk) {
+	return impl_->GetSnapshot(nsName, lsn, fromID, maxSize, chunk);
+}
 Error Reindexer::Delete(const Query& q, QueryResults& result) { return impl_->Delete(q, result); }
 Error Reindexer::Select(const string_view& query, QueryResults& result, Completion cmpl) { return impl_->Select(query, result, cmpl); }
 Error Reindexer::Select(const Query& q, QueryResults& result, Completion cmpl) { return impl_->Select(q, result, cmpl); }
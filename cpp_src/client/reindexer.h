@@ -5,6 +5,8 @@
 #include "client/reindexerconfig.h"
 #include "core/namespacedef.h"
 #include "core/query/query.h"
+#include "replicator/snapshot.h"
+#include "replicator/walrecord.h"
 
 namespace reindexer {
 namespace client {
@@ -89,6 +91,26 @@ public:
 	/// @param item - Item, obtained by call to NewItem of the same namespace
 	/// @param cmpl - Optional async completion routine. If nullptr function will work syncronius
 	Error Delete(const string &nsName, Item &item, Completion cmpl = nullptr);
+	/// Insert batch of Items to namespace. Items are sent by single request, and are applied by single transaction
+	/// @param nsName - Name of namespace
+	/// @param items - Items, obtained by call to NewItem of the same namespace. Must be kept alive until async completion
+	/// @param cmpl - Optional async completion routine. If nullptr function will work syncronius
+	Error Insert(const string &nsName, vector<Item> &items, Completion cmpl = nullptr);
+	/// Update batch of Items in namespace. Items are sent by single request, and are applied by single transaction
+	/// @param nsName - Name of namespace
+	/// @param items - Items, obtained by call to NewItem of the same namespace. Must be kept alive until async completion
+	/// @param cmpl - Optional async completion routine. If nullptr function will work syncronius
+	Error Update(const string &nsName, vector<Item> &items, Completion cmpl = nullptr);
+	/// Update or Insert batch of Items in namespace. Items are sent by single request, and are applied by single transaction
+	/// @param nsName - Name of namespace
+	/// @param items - Items, obtained by call to NewItem of the same namespace. Must be kept alive until async completion
+	/// @param cmpl - Optional async completion routine. If nullptr function will work syncronius
+	Error Upsert(const string &nsName, vector<Item> &items, Completion cmpl = nullptr);
+	/// Delete batch of Items from namespace. Items are sent by single request, and are applied by single transaction
+	/// @param nsName - Name of namespace
+	/// @param items - Items, obtained by call to NewItem of the same namespace. Must be kept alive until async completion
+	/// @param cmpl - Optional async completion routine. If nullptr function will work syncronius
+	Error Delete(const string &nsName, vector<Item> &items, Completion cmpl = nullptr);
 	/// Delete all items froms namespace, which matches provided Query
 	/// @param query - Query with conditions
 	/// @param result - QueryResults with IDs of deleted items
@@ -124,6 +146,20 @@ public:
 	/// @param nsName - Name of namespace
 	/// @param keys - std::vector filled with meta keys
 	Error EnumMeta(const string &nsName, vector<string> &keys);
+	/// Get changes of namespace from its write-ahead log
+	/// @param nsName - Name of namespace
+	/// @param lastLSN - LSN of the last change, which is already known. -1 to get all kept changes
+	/// @param limit - maximum amount of records in chunk. 0 - get only LSN of the last change of namespace
+	/// @param chunk - output chunk of WAL. Returns errOutdatedWAL, if WAL does not keep changes after lastLSN
+	Error GetWAL(const string &nsName, int64_t lastLSN, int limit, WALChunk &chunk);
+	/// Get chunk of snapshot of namespace. Snapshot keeps items, which were not changed after LSN of snapshot,
+	/// so the rest of changes is got from WAL after LSN of snapshot
+	/// @param nsName - Name of namespace
+	/// @param lsn - LSN of snapshot, as returned by the first chunk. -1 to get the first chunk of new snapshot
+	/// @param fromID - row, which chunk starts from, as returned by nextID of previous chunk
+	/// @param maxSize - approximate maximum size of items of chunk in bytes
+	/// @param chunk - output chunk of snapshot
+	Error GetSnapshot(const string &nsName, int64_t lsn, int64_t fromID, int maxSize, SnapshotChunk &chunk);
 
 	typedef QueryResults QueryResultsT;
 	typedef Item ItemT;
@@ -5,6 +5,8 @@ namespace client {
 
 struct ReindexerConfig {
 	int ConnPoolSize = 4;
+	// Max count of not answered requests per connection. New requests wait for answers of previous ones
+	int RequestsWindow = 256;
 };
 
 }  // namespace client
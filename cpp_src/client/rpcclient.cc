@@ -59,7 +59,8 @@ void RPCClient::run() {
 	});
 	stop_.start();
 	for (int i = 0; i < config_.ConnPoolSize; i++) {
-		connections_.push_back(std::unique_ptr<cproto::ClientConnection>(new cproto::ClientConnection(loop_, &uri_)));
+		connections_.push_back(
+			std::unique_ptr<cproto::ClientConnection>(new cproto::ClientConnection(loop_, &uri_, config_.RequestsWindow)));
 	}
 
 	if (curConnIdx_ == -1) curConnIdx_ = 0;
@@ -93,6 +94,32 @@ Error RPCClient::Insert(const string& ns, Item& item, Completion cmpl) { return
 Error RPCClient::Update(const string& ns, Item& item, Completion cmpl) { return modifyItem(ns, item, ModeUpdate, cmpl); }
 Error RPCClient::Upsert(const string& ns, Item& item, Completion cmpl) { return modifyItem(ns, item, ModeUpsert, cmpl); }
 Error RPCClient::Delete(const string& ns, Item& item, Completion cmpl) { return modifyItem(ns, item, ModeDelete, cmpl); }
+Error RPCClient::Insert(const string& ns, vector<Item>& items, Completion cmpl) { return modifyItems(ns, items, ModeInsert, cmpl); }
+Error RPCClient::Update(const string& ns, vector<Item>& items, Completion cmpl) { return modifyItems(ns, items, ModeUpdate, cmpl); }
+Error RPCClient::Upsert(const string& ns, vector<Item>& items, Completion cmpl) { return modifyItems(ns, items, ModeUpsert, cmpl); }
+Error RPCClient::Delete(const string& ns, vector<Item>& items, Completion cmpl) { return modifyItems(ns, items, ModeDelete, cmpl); }
+
+static void packPrecepts(ItemImpl* impl, WrSerializer& ser) {
+	if (impl->GetPrecepts().size()) {
+		ser.PutVarUint(impl->GetPrecepts().size());
+		for (auto& p : impl->GetPrecepts()) {
+			ser.PutVString(p);
+		}
+	}
+}
+
+// All the items are sent by single request
+void RPCClient::packItems(vector<Item>& items, WrSerializer& ser) {
+	ser.PutVarUint(items.size());
+	WrSerializer pser;
+	for (auto& item : items) {
+		ser.PutVString(item.GetCJSON());
+		ser.PutVarUint(unsigned(item.GetStateToken()));
+		pser.Reset();
+		packPrecepts(item.impl_.get(), pser);
+		ser.PutVString(pser.Slice());
+	}
+}
 
 Error RPCClient::modifyItem(const string& ns, Item& item, int mode, Completion cmpl) {
 	if (cmpl) {
@@ -100,12 +127,7 @@ Error RPCClient::modifyItem(const string& ns, Item& item, int mode, Completion c
 	}
 
 	WrSerializer ser;
-	if (item.impl_->GetPrecepts().size()) {
-		ser.PutVarUint(item.impl_->GetPrecepts().size());
-		for (auto& p : item.impl_->GetPrecepts()) {
-			ser.PutVString(p);
-		}
-	}
+	packPrecepts(item.impl_.get(), ser);
 
 	for (int tryCount = 0;; tryCount++) {
 		auto conn = getConn();
@@ -134,12 +156,7 @@ Error RPCClient::modifyItem(const string& ns, Item& item, int mode, Completion c
 
 Error RPCClient::modifyItemAsync(const string& ns, Item* item, int mode, Completion clientCompl) {
 	WrSerializer ser;
-	if (item->impl_->GetPrecepts().size()) {
-		ser.PutVarUint(item->impl_->GetPrecepts().size());
-		for (auto& p : item->impl_->GetPrecepts()) {
-			ser.PutVString(p);
-		}
-	}
+	packPrecepts(item->impl_.get(), ser);
 
 	getConn()->Call(
 		[this, ns, mode, item, clientCompl](const net::cproto::RPCAnswer& ret) -> void {
@@ -172,6 +189,76 @@ Error RPCClient::modifyItemAsync(const string& ns, Item* item, int mode, Complet
 	return errOK;
 }
 
+Error RPCClient::modifyItems(const string& ns, vector<Item>& items, int mode, Completion cmpl) {
+	if (cmpl) {
+		return modifyItemsAsync(ns, &items, mode, cmpl);
+	}
+
+	for (int tryCount = 0;; tryCount++) {
+		WrSerializer ser;
+		packItems(items, ser);
+		auto conn = getConn();
+		auto ret = conn->Call(cproto::kCmdModifyItems, ns, int(FormatCJson), ser.Slice(), mode);
+		if (!ret.Status().ok()) {
+			if (ret.Status().code() != errStateInvalidated || tryCount > 2) return ret.Status();
+			QueryResults qr;
+			Select(Query(ns).Limit(0), qr);
+			Error err = rebuildItems(ns, items);
+			if (!err.ok()) return err;
+			continue;
+		}
+		try {
+			auto args = ret.GetArgs(2);
+			NSArray nsArray{getNamespace(ns)};
+			return QueryResults(conn, nsArray, p_string(args[0]), int(args[1])).Status();
+		} catch (const Error& err) {
+			return err;
+		}
+	}
+}
+
+Error RPCClient::modifyItemsAsync(const string& ns, vector<Item>* items, int mode, Completion clientCompl) {
+	WrSerializer ser;
+	packItems(*items, ser);
+
+	getConn()->Call(
+		[this, ns, mode, items, clientCompl](const net::cproto::RPCAnswer& ret) -> void {
+			if (!ret.Status().ok()) {
+				if (ret.Status().code() != errStateInvalidated) return clientCompl(ret.Status());
+				// State invalidated - make select to update state
+				QueryResults* qr = new QueryResults;
+				Select(Query(ns).Limit(0), *qr, [=](const Error& ret) {
+					delete qr;
+					if (!ret.ok()) return clientCompl(ret);
+					Error err = rebuildItems(ns, *items);
+					if (!err.ok()) return clientCompl(err);
+					modifyItemsAsync(ns, items, mode, clientCompl);
+				});
+			} else
+				try {
+					auto args = ret.GetArgs(2);
+					NSArray nsArray{getNamespace(ns)};
+					clientCompl(QueryResults(getConn(), nsArray, p_string(args[0]), int(args[1])).Status());
+				} catch (const Error& err) {
+					clientCompl(err);
+				}
+		},
+		cproto::kCmdModifyItems, ns, int(FormatCJson), ser.Slice(), mode);
+	return errOK;
+}
+
+Error RPCClient::rebuildItems(const string& ns, vector<Item>& items) {
+	auto pNs = getNamespace(ns);
+	for (auto& item : items) {
+		auto newImpl = new ItemImpl(pNs->payloadType_, pNs->tagsMatcher_);
+		Error err = newImpl->FromJSON(item.impl_->GetJSON());
+		newImpl->SetPrecepts(item.impl_->GetPrecepts());
+		item.impl_.reset(newImpl);
+		if (!err.ok()) return err;
+	}
+	return errOK;
+}
+
 Item RPCClient::NewItem(const string& nsName) {
 	try {
 		auto ns = getNamespace(nsName);
@@ -214,6 +301,26 @@ Error RPCClient::EnumMeta(const string& ns, vector<string>& keys) {
 	}
 }
 
+Error RPCClient::GetWAL(const string& ns, int64_t lastLSN, int limit, WALChunk& chunk) {
+	try {
+		auto ret = getConn()->Call(cproto::kCmdGetWAL, ns, lastLSN, limit);
+		if (!ret.Status().ok()) return ret.Status();
+		return chunk.Unpack(string_view(ret.GetArgs(1)[0]));
+	} catch (const Error& err) {
+		return err;
+	}
+}
+
+Error RPCClient::GetSnapshot(const string& ns, int64_t lsn, int64_t fromID, int maxSize, SnapshotChunk& chunk) {
+	try {
+		auto ret = getConn()->Call(cproto::kCmdGetSnapshot, ns, lsn, fromID, maxSize);
+		if (!ret.Status().ok()) return ret.Status();
+		return chunk.Unpack(string_view(ret.GetArgs(1)[0]));
+	} catch (const Error& err) {
+		return err;
+	}
+}
+
 Error RPCClient::Delete(const Query& query, QueryResults& result) {
 	WrSerializer ser;
 	query.Serialize(ser);
@@ -16,10 +16,15 @@
 #include "estl/fast_hash_map.h"
 #include "estl/shared_mutex.h"
 #include "net/cproto/clientconnection.h"
+#include "replicator/snapshot.h"
+#include "replicator/walrecord.h"
 #include "tools/errors.h"
 #include "urlparser/urlparser.h"
 
 namespace reindexer {
+
+class WrSerializer;
+
 namespace client {
 
 using std::string;
@@ -47,6 +52,10 @@ public:
 	Error Update(const string &_namespace, client::Item &item, Completion completion = nullptr);
 	Error Upsert(const string &_namespace, client::Item &item, Completion completion = nullptr);
 	Error Delete(const string &_namespace, client::Item &item, Completion completion = nullptr);
+	Error Insert(const string &_namespace, vector<client::Item> &items, Completion completion = nullptr);
+	Error Update(const string &_namespace, vector<client::Item> &items, Completion completion = nullptr);
+	Error Upsert(const string &_namespace, vector<client::Item> &items, Completion completion = nullptr);
+	Error Delete(const string &_namespace, vector<client::Item> &items, Completion completion = nullptr);
 	Error Delete(const Query &query, QueryResults &result);
 	Error Select(const string_view &query, QueryResults &result, Completion clientCompl = nullptr);
 	Error Select(const Query &query, QueryResults &result, Completion clientCompl = nullptr);
@@ -55,10 +64,17 @@ public:
 	Error GetMeta(const string &_namespace, const string &key, string &data);
 	Error PutMeta(const string &_namespace, const string &key, const string_view &data);
 	Error EnumMeta(const string &_namespace, vector<string> &keys);
+	Error GetWAL(const string &_namespace, int64_t lastLSN, int limit, WALChunk &chunk);
+	Error GetSnapshot(const string &_namespace, int64_t lsn, int64_t fromID, int maxSize, SnapshotChunk &chunk);
 
 private:
 	Error modifyItem(const string &_namespace, Item &item, int mode, Completion);
 	Error modifyItemAsync(const string &_namespace, Item *item, int mode, Completion);
+	Error modifyItems(const string &_namespace, vector<Item> &items, int mode, Completion);
+	Error modifyItemsAsync(const string &_namespace, vector<Item> *items, int mode, Completion);
+	// Rebuild items with actual state of namespace
+	Error rebuildItems(const string &_namespace, vector<Item> &items);
+	static void packItems(vector<Item> &items, WrSerializer &ser);
 	Namespace::Ptr getNamespace(const string &nsName);
 	void run();
 
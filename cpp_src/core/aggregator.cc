@@ -23,10 +23,11 @@ Aggregator::Aggregator(AggType aggType, const string &name) : aggType_(aggType),
 	}
 }
 
-void Aggregator::Bind(PayloadType type, int fieldIdx, const TagsPath &fieldPath) {
+void Aggregator::Bind(PayloadType type, int fieldIdx, const TagsPath &fieldPath, const void *column) {
 	payloadType_ = type;
 	if (fieldIdx >= 0) {
 		fieldType_ = &type->Field(fieldIdx);
+		if (!fieldType_->IsArray()) column_ = column;
 	} else {
 		fieldPath_ = fieldPath;
 	}
@@ -56,7 +57,22 @@ AggregationResult Aggregator::GetResult() const {
 	return ret;
 }
 
-void Aggregator::Aggregate(const PayloadValue &data) {
+void Aggregator::Aggregate(const PayloadValue &data, IdType rowId) {
+	if (column_) {
+		switch (fieldType_->Type()) {
+			case KeyValueBool:
+				return aggregate(Variant(static_cast<const bool *>(column_)[rowId]));
+			case KeyValueInt:
+				return aggregate(Variant(static_cast<const int *>(column_)[rowId]));
+			case KeyValueInt64:
+				return aggregate(Variant(static_cast<const int64_t *>(column_)[rowId]));
+			case KeyValueDouble:
+				return aggregate(Variant(static_cast<const double *>(column_)[rowId]));
+			default:
+				break;
+		}
+	}
+
 	if (!fieldType_) {
 		ConstPayload pl(payloadType_, data);
 		VariantArray va;
@@ -78,6 +94,26 @@ void Aggregator::Aggregate(const PayloadValue &data) {
 	}
 }
 
+void Aggregator::Merge(const Aggregator &other) {
+	assert(aggType_ == other.aggType_);
+	switch (aggType_) {
+		case AggSum:
+		case AggAvg:
+			result_ += other.result_;
+			hitCount_ += other.hitCount_;
+			break;
+		case AggMin:
+			result_ = std::min(other.result_, result_);
+			break;
+		case AggMax:
+			result_ = std::max(other.result_, result_);
+			break;
+		case AggFacet:
+			for (auto &it : *other.facets_) (*facets_)[it.first] += it.second;
+			break;
+	};
+}
+
 void Aggregator::aggregate(const Variant &v) {
 	switch (aggType_) {
 		case AggSum:
@@ -17,8 +17,10 @@ public:
 	Aggregator(const Aggregator &) = delete;
 	Aggregator &operator=(const Aggregator &) = delete;
 
-	void Aggregate(const PayloadValue &lhs);
-	void Bind(PayloadType type, int fieldIdx, const TagsPath &fieldPath);
+	void Aggregate(const PayloadValue &lhs, IdType rowId);
+	// Merge result of other aggregator of the same type, which aggregated other rows
+	void Merge(const Aggregator &other);
+	void Bind(PayloadType type, int fieldIdx, const TagsPath &fieldPath, const void *column = nullptr);
 	AggregationResult GetResult() const;
 
 protected:
@@ -27,6 +29,8 @@ protected:
 	PayloadType payloadType_;
 	// Field type for indexed field
 	const PayloadFieldType *fieldType_ = nullptr;
+	// Column of index for indexed scalar field, values are read from it instead of payload
+	const void *column_ = nullptr;
 
 	// Json path to field, for non indexed field
 	TagsPath fieldPath_;
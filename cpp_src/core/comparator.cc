@@ -1,4 +1,5 @@
 #include "core/comparator.h"
+#include <algorithm>
 #include "cjson/baseencoder.h"
 #include "core/payload/payloadiface.h"
 #include "query/querywhere.h"
@@ -84,6 +85,15 @@ void Comparator::BindEqualPosition(const TagsPath &tagsPath, const VariantArray
 	equalPositionMode = true;
 }
 
+void Comparator::BindDictionary(const h_vector<key_string, 2> &strings) {
+	assert(type_ == KeyValueString && (cond_ == CondEq || cond_ == CondSet) && !strings.empty());
+	dictStrings_ = strings;
+	dictCodes_.clear();
+	for (auto &str : dictStrings_) dictCodes_.push_back(p_string(str).raw());
+	std::sort(dictCodes_.begin(), dictCodes_.end());
+	dictCodes_.erase(std::unique(dictCodes_.begin(), dictCodes_.end()), dictCodes_.end());
+}
+
 bool Comparator::Compare(const PayloadValue &data, int rowId) {
 	if (fields_.getTagsPathsLength() > 0) {
 		VariantArray rhs;
@@ -141,4 +151,99 @@ bool Comparator::Compare(const PayloadValue &data, int rowId) {
 	return false;
 }
 
+void Comparator::CompareBatch(const vector<PayloadValue> &items, IdType from, int count, uint8_t *result) {
+	assert(from >= 0 && size_t(from + count) <= items.size());
+	if (isBatchable()) {
+		switch (type_) {
+			case KeyValueBool:
+				return compareBatch(cmpBool, items, from, count, result);
+			case KeyValueInt:
+				return compareBatch(cmpInt, items, from, count, result);
+			case KeyValueInt64:
+				return compareBatch(cmpInt64, items, from, count, result);
+			case KeyValueDouble:
+				return compareBatch(cmpDouble, items, from, count, result);
+			default:
+				break;
+		}
+	}
+	for (int i = 0; i < count; i++) {
+		const PayloadValue &pv = items[from + i];
+		if (!pv.IsFree() && Compare(pv, from + i)) result[i] = 1;
+	}
+}
+
+bool Comparator::isBatchable() const {
+	if (fields_.getTagsPathsLength() > 0 || isArray_ || dist_) return false;
+	switch (type_) {
+		case KeyValueBool:
+		case KeyValueInt:
+		case KeyValueInt64:
+		case KeyValueDouble:
+			break;
+		default:
+			return false;
+	}
+	switch (cond_) {
+		case CondEq:
+		case CondLt:
+		case CondLe:
+		case CondGt:
+		case CondGe:
+		case CondRange:
+			return true;
+		default:
+			return false;
+	}
+}
+
+template <typename T>
+void Comparator::compareBatch(const ComparatorImpl<T> &impl, const vector<PayloadValue> &items, IdType from, int count, uint8_t *result) {
+	constexpr int kChunkSize = 256;
+	T values[kChunkSize];
+	uint8_t valid[kChunkSize];
+	const T rhs = impl.values_[0];
+	const T rhs2 = cond_ == CondRange ? impl.values_[1] : rhs;
+	const T *column = reinterpret_cast<const T *>(rawData_);
+
+	for (int chunk = 0; chunk < count; chunk += kChunkSize) {
+		int n = std::min(kChunkSize, count - chunk);
+		// Gather values of field to contiguous array, so compare loops below are vectorized by compiler.
+		// Values are taken from column of index, if it's available, instead of decoding each payload
+		for (int i = 0; i < n; i++) {
+			IdType rowId = from + chunk + i;
+			const PayloadValue &pv = items[rowId];
+			valid[i] = !pv.IsFree();
+			if (!valid[i]) {
+				values[i] = T();
+			} else {
+				values[i] = column ? column[rowId] : *reinterpret_cast<const T *>(pv.Ptr() + offset_);
+			}
+		}
+		uint8_t *res = result + chunk;
+		switch (cond_) {
+			case CondEq:
+				for (int i = 0; i < n; i++) res[i] |= valid[i] & uint8_t(values[i] == rhs);
+				break;
+			case CondLt:
+				for (int i = 0; i < n; i++) res[i] |= valid[i] & uint8_t(values[i] < rhs);
+				break;
+			case CondLe:
+				for (int i = 0; i < n; i++) res[i] |= valid[i] & uint8_t(values[i] <= rhs);
+				break;
+			case CondGt:
+				for (int i = 0; i < n; i++) res[i] |= valid[i] & uint8_t(values[i] > rhs);
+				break;
+			case CondGe:
+				for (int i = 0; i < n; i++) res[i] |= valid[i] & uint8_t(values[i] >= rhs);
+				break;
+			case CondRange:
+				for (int i = 0; i < n; i++) res[i] |= valid[i] & uint8_t(values[i] >= rhs) & uint8_t(values[i] <= rhs2);
+				break;
+			default:
+				abort();
+		}
+	}
+}
+
 }  // namespace reindexer
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include "comparatorimpl.h"
 #include "compositearraycomparator.h"
 #include "estl/fast_hash_set.h"
@@ -15,9 +16,20 @@ public:
 	~Comparator();
 
 	bool Compare(const PayloadValue &lhs, int rowId);
+	/// Compares batch of sequential rows. Values of scalar int, int64, double and bool fields are gathered from column of index
+	/// or from payloads to contiguous array and compared by branchless loop, other conditions are compared row by row.
+	/// @param items - items of namespace
+	/// @param from - rowId of 1-st row of batch
+	/// @param count - amount of rows in batch
+	/// @param result - array of count elements. Elements of matched rows are set to 1, other elements are not changed.
+	void CompareBatch(const vector<PayloadValue> &items, IdType from, int count, uint8_t *result);
 	void Bind(PayloadType type, int field);
 	void BindEqualPosition(int field, const VariantArray &val, CondType cond);
 	void BindEqualPosition(const TagsPath &tagsPath, const VariantArray &val, CondType cond);
+	/// Binds strings of index dictionary, which match CondEq or CondSet condition. All values of field must be interned
+	/// by the same dictionary, so they are compared by pointers to dictionary strings instead of string contents.
+	/// @param strings - matched strings of dictionary.
+	void BindDictionary(const h_vector<key_string, 2> &strings);
 
 protected:
 	bool compare(const Variant &kr) {
@@ -56,6 +68,7 @@ protected:
 			case KeyValueDouble:
 				return cmpDouble.Compare(cond_, *static_cast<double *>(ptr));
 			case KeyValueString:
+				if (!dictStrings_.empty()) return isDictionaryString(*static_cast<p_string *>(ptr));
 				return cmpString.Compare(cond_, *static_cast<p_string *>(ptr), collateOpts_);
 			case KeyValueComposite:
 				return cmpComposite.Compare(cond_, *static_cast<PayloadValue *>(ptr), collateOpts_);
@@ -67,7 +80,14 @@ protected:
 	inline
 	bool is_unique(const Variant& v) { return dist_ ? dist_->emplace(v).second : true; }
 
+	bool isDictionaryString(p_string str) const {
+		if (dictCodes_.size() == 1) return str.raw() == dictCodes_[0];
+		return std::binary_search(dictCodes_.begin(), dictCodes_.end(), str.raw());
+	}
 	void setValues(const VariantArray &values);
+	bool isBatchable() const;
+	template <typename T>
+	void compareBatch(const ComparatorImpl<T> &impl, const vector<PayloadValue> &items, IdType from, int count, uint8_t *result);
 
 	ComparatorImpl<bool> cmpBool;
 	ComparatorImpl<int> cmpInt;
@@ -89,6 +109,9 @@ protected:
 	CompositeArrayComparator cmpEqualPosition;
 	shared_ptr<fast_hash_set<Variant>> dist_;
 	bool equalPositionMode = false;
+	// Matched strings of index dictionary, which are kept alive, while their pointers are compared, and sorted raw values of their p_string
+	h_vector<key_string, 2> dictStrings_;
+	h_vector<uint64_t, 2> dictCodes_;
 };
 
 }  // namespace reindexer
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "core/storage/storagetype.h"
+#include "core/type_consts.h"
+
+namespace reindexer {
+
+/// Options of connection to database in embeded mode
+struct ConnectOpts {
+	ConnectOpts &WithStorageType(datastorage::StorageType type) {
+		storageType = type;
+		return *this;
+	}
+	ConnectOpts &WithStorageTunables(const StorageOpts &opts) {
+		storageTunables = opts;
+		return *this;
+	}
+
+	/// Engine of storage of new database. Existing database is opened by the engine, which is written to its placeholder file
+	datastorage::StorageType storageType = datastorage::StorageType::LevelDB;
+	/// Tunables of storage engine: compression, block cache and write buffer sizes, etc.
+	/// They are applied to namespaces, which do not set their own tunables in StorageOpts.
+	/// Block cache of this size is shared by all the namespaces of database. Namespace, which sets its own block cache size, has own cache
+	StorageOpts storageTunables;
+};
+
+}  // namespace reindexer
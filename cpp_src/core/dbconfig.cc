@@ -1,6 +1,7 @@
 #include "dbconfig.h"
 #include <limits.h>
 #include "gason/gason.h"
+#include "replicator/waltracker.h"
 #include "tools/jsontools.h"
 #include "tools/stringstools.h"
 
@@ -23,6 +24,52 @@ Error DBProfilingConfig::FromJSON(JsonValue &jvalue) {
 	return errOK;
 }
 
+Error DBOptimizationConfig::FromJSON(JsonValue &jvalue) {
+	try {
+		if (jvalue.getTag() == JSON_NULL) return errOK;
+		if (jvalue.getTag() != JSON_OBJECT) return Error(errParseJson, "Expected object in 'optimization' key");
+
+		for (auto elem : jvalue) {
+			parseJsonField("timeout_ms", timeoutMs, elem, 0, INT_MAX);
+			parseJsonField("parallel_select_threads", parallelSelectThreads, elem, 0, 1024);
+			parseJsonField("parallel_select_threshold", parallelSelectThreshold, elem, 0, INT_MAX);
+		}
+	} catch (const Error &err) {
+		return err;
+	}
+	return errOK;
+}
+
+Error DBNamespacesConfig::FromJSON(JsonValue &jvalue) {
+	try {
+		if (jvalue.getTag() == JSON_NULL) return errOK;
+		if (jvalue.getTag() != JSON_ARRAY) return Error(errParseJson, "Expected array in 'namespaces' key");
+
+		for (auto elem : jvalue) {
+			auto &subv = elem->value;
+			if (subv.getTag() != JSON_OBJECT) {
+				return Error(errParseJson, "Expected object in 'namespaces' array element");
+			}
+
+			string name, sortedIdsMode = "copy";
+			size_t nsWALSize = kDefaultWALSize;
+			for (auto subelem : subv) {
+				parseJsonField("namespace", name, subelem);
+				parseJsonField("sorted_ids_mode", sortedIdsMode, subelem);
+				parseJsonField("wal_size", nsWALSize, subelem, 0, INT_MAX);
+			}
+			if (sortedIdsMode != "copy" && sortedIdsMode != "on_demand") {
+				return Error(errParams, "Unknown sorted_ids_mode '%s' of namespace '%s'", sortedIdsMode.c_str(), name.c_str());
+			}
+			onDemandSortedIds.insert({name, sortedIdsMode == "on_demand"});
+			walSize.insert({name, nsWALSize});
+		}
+	} catch (const Error &err) {
+		return err;
+	}
+	return errOK;
+}
+
 Error DBLoggingConfig::FromJSON(JsonValue &jvalue) {
 	try {
 		if (jvalue.getTag() == JSON_NULL) return errOK;
@@ -16,6 +16,24 @@ struct DBProfilingConfig {
 	bool memStats = false;
 };
 
+struct DBOptimizationConfig {
+	Error FromJSON(JsonValue &v);
+	// Quiet period after last update of namespace, before background commit of its indexes. 0 - disabled
+	int timeoutMs = 0;
+	// Maximum amount of threads, which execute select loop of single query, including thread of query. 0 or 1 - disabled
+	int parallelSelectThreads = 0;
+	// Minimum amount of expected iterations of select loop to execute it by several threads
+	int parallelSelectThreshold = 100000;
+};
+
+struct DBNamespacesConfig {
+	Error FromJSON(JsonValue &v);
+	// Sorted idsets are built on demand by ranks of rows in sort orders, instead of keeping sorted copies in each idset
+	std::unordered_map<std::string, bool> onDemandSortedIds;
+	// Maximum amount of records in write-ahead log of namespace
+	std::unordered_map<std::string, size_t> walSize;
+};
+
 struct DBLoggingConfig {
 	Error FromJSON(JsonValue &v);
 	std::unordered_map<std::string, int> logQueries;
@@ -73,6 +73,7 @@ public:
 	void Commit(const CommitContext &ctx);
 	bool IsCommited() const { return true; }
 	bool IsEmpty() const { return empty(); }
+	size_t Size() const { return size(); }
 	size_t BTreeSize() const { return 0; }
 	string Dump();
 };
@@ -156,6 +157,8 @@ public:
 	void Commit(const CommitContext &ctx);
 	bool IsCommited() const { return !usingBtree_; }
 	bool IsEmpty() const { return empty() && (!set_ || set_->empty()); }
+	// Amount of ids, including not commited ones
+	size_t Size() const { return usingBtree_ ? set_->size() : size(); }
 	size_t BTreeSize() const { return set_ ? sizeof(*set_.get()) + set_->size() * sizeof(int) : 0; }
 
 protected:
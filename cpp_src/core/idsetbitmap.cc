@@ -0,0 +1,257 @@
+#include "core/idsetbitmap.h"
+#include <algorithm>
+#include <iterator>
+
+namespace reindexer {
+
+static inline int popCount(uint64_t v) {
+	v = v - ((v >> 1) & 0x5555555555555555ULL);
+	v = (v & 0x3333333333333333ULL) + ((v >> 2) & 0x3333333333333333ULL);
+	v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return int((v * 0x0101010101010101ULL) >> 56);
+}
+
+bool IdSetBitmap::Container::contains(uint16_t v) const {
+	if (isBitmap()) return bits[v >> 6] & (uint64_t(1) << (v & 63));
+	return std::binary_search(array.begin(), array.end(), v);
+}
+
+void IdSetBitmap::Container::add(uint16_t v) {
+	if (isBitmap()) {
+		uint64_t &word = bits[v >> 6];
+		uint64_t mask = uint64_t(1) << (v & 63);
+		if (!(word & mask)) {
+			word |= mask;
+			card++;
+		}
+		return;
+	}
+	if (array.empty() || array.back() < v) {
+		array.push_back(v);
+	} else {
+		auto it = std::lower_bound(array.begin(), array.end(), v);
+		if (*it == v) return;
+		array.insert(it, v);
+	}
+	if (++card > kMaxArraySize) toBitmap();
+}
+
+void IdSetBitmap::Container::toBitmap() {
+	if (isBitmap()) return;
+	bits.assign(kBitmapWords, 0);
+	for (uint16_t v : array) bits[v >> 6] |= uint64_t(1) << (v & 63);
+	array.clear();
+	array.shrink_to_fit();
+}
+
+void IdSetBitmap::Container::normalize() {
+	if (isBitmap() && card <= kMaxArraySize) {
+		array.reserve(card);
+		forEach([this](uint16_t v) { array.push_back(v); });
+		bits.clear();
+		bits.shrink_to_fit();
+	} else if (!isBitmap() && card > kMaxArraySize) {
+		toBitmap();
+	}
+}
+
+template <typename F>
+void IdSetBitmap::Container::forEach(F f) const {
+	if (!isBitmap()) {
+		for (uint16_t v : array) f(v);
+		return;
+	}
+	for (int i = 0; i < kBitmapWords; i++) {
+		for (uint64_t word = bits[i]; word; word &= word - 1) {
+			// Index of lowest set bit
+			int bit = popCount((word & (~word + 1)) - 1);
+			f(uint16_t((i << 6) + bit));
+		}
+	}
+}
+
+IdSetBitmap::Container &IdSetBitmap::container(uint16_t key) {
+	if (containers_.empty() || containers_.back().key < key) {
+		containers_.emplace_back();
+		containers_.back().key = key;
+		return containers_.back();
+	}
+	auto it = std::lower_bound(containers_.begin(), containers_.end(), key, [](const Container &c, uint16_t k) { return c.key < k; });
+	if (it == containers_.end() || it->key != key) {
+		it = containers_.emplace(it);
+		it->key = key;
+	}
+	return *it;
+}
+
+void IdSetBitmap::Add(IdType id) {
+	assert(id >= 0);
+	container(uint32_t(id) >> 16).add(uint32_t(id) & 0xFFFF);
+}
+
+void IdSetBitmap::Add(IdSetRef ids) {
+	Container *cur = nullptr;
+	for (IdType id : ids) {
+		assert(id >= 0);
+		uint16_t key = uint32_t(id) >> 16;
+		if (!cur || cur->key != key) {
+			cur = &container(key);
+			// Container of ascending ids will have at least this amount of elements
+			if (!cur->isBitmap() && ids.size() > size_t(kMaxArraySize)) cur->toBitmap();
+		}
+		cur->add(uint32_t(id) & 0xFFFF);
+	}
+	for (auto &c : containers_) c.normalize();
+}
+
+bool IdSetBitmap::Contains(IdType id) const {
+	if (id < 0) return false;
+	uint16_t key = uint32_t(id) >> 16;
+	auto it = std::lower_bound(containers_.begin(), containers_.end(), key, [](const Container &c, uint16_t k) { return c.key < k; });
+	return it != containers_.end() && it->key == key && it->contains(uint32_t(id) & 0xFFFF);
+}
+
+IdSetBitmap::Container IdSetBitmap::andContainers(const Container &lhs, const Container &rhs) {
+	Container res;
+	res.key = lhs.key;
+	if (lhs.isBitmap() && rhs.isBitmap()) {
+		res.bits.resize(kBitmapWords);
+		for (int i = 0; i < kBitmapWords; i++) {
+			res.bits[i] = lhs.bits[i] & rhs.bits[i];
+			res.card += popCount(res.bits[i]);
+		}
+		res.normalize();
+	} else if (!lhs.isBitmap() && !rhs.isBitmap()) {
+		std::set_intersection(lhs.array.begin(), lhs.array.end(), rhs.array.begin(), rhs.array.end(), std::back_inserter(res.array));
+		res.card = res.array.size();
+	} else {
+		const Container &arr = lhs.isBitmap() ? rhs : lhs;
+		const Container &bmp = lhs.isBitmap() ? lhs : rhs;
+		for (uint16_t v : arr.array) {
+			if (bmp.contains(v)) res.array.push_back(v);
+		}
+		res.card = res.array.size();
+	}
+	return res;
+}
+
+IdSetBitmap::Container IdSetBitmap::orContainers(const Container &lhs, const Container &rhs) {
+	Container res;
+	res.key = lhs.key;
+	if (!lhs.isBitmap() && !rhs.isBitmap() && lhs.card + rhs.card <= kMaxArraySize) {
+		std::set_union(lhs.array.begin(), lhs.array.end(), rhs.array.begin(), rhs.array.end(), std::back_inserter(res.array));
+		res.card = res.array.size();
+		return res;
+	}
+	res.bits.assign(kBitmapWords, 0);
+	for (const Container *c : {&lhs, &rhs}) {
+		if (c->isBitmap()) {
+			for (int i = 0; i < kBitmapWords; i++) res.bits[i] |= c->bits[i];
+		} else {
+			for (uint16_t v : c->array) res.bits[v >> 6] |= uint64_t(1) << (v & 63);
+		}
+	}
+	for (int i = 0; i < kBitmapWords; i++) res.card += popCount(res.bits[i]);
+	res.normalize();
+	return res;
+}
+
+IdSetBitmap::Container IdSetBitmap::andNotContainers(const Container &lhs, const Container &rhs) {
+	Container res;
+	res.key = lhs.key;
+	if (!lhs.isBitmap()) {
+		if (rhs.isBitmap()) {
+			for (uint16_t v : lhs.array) {
+				if (!rhs.contains(v)) res.array.push_back(v);
+			}
+		} else {
+			std::set_difference(lhs.array.begin(), lhs.array.end(), rhs.array.begin(), rhs.array.end(), std::back_inserter(res.array));
+		}
+		res.card = res.array.size();
+		return res;
+	}
+	res.bits = lhs.bits;
+	if (rhs.isBitmap()) {
+		for (int i = 0; i < kBitmapWords; i++) res.bits[i] &= ~rhs.bits[i];
+	} else {
+		for (uint16_t v : rhs.array) res.bits[v >> 6] &= ~(uint64_t(1) << (v & 63));
+	}
+	for (int i = 0; i < kBitmapWords; i++) res.card += popCount(res.bits[i]);
+	res.normalize();
+	return res;
+}
+
+void IdSetBitmap::And(const IdSetBitmap &other) {
+	vector<Container> res;
+	auto lit = containers_.begin();
+	auto rit = other.containers_.begin();
+	while (lit != containers_.end() && rit != other.containers_.end()) {
+		if (lit->key < rit->key) {
+			++lit;
+		} else if (rit->key < lit->key) {
+			++rit;
+		} else {
+			Container c = andContainers(*lit, *rit);
+			if (c.card) res.push_back(std::move(c));
+			++lit, ++rit;
+		}
+	}
+	containers_.swap(res);
+}
+
+void IdSetBitmap::Or(const IdSetBitmap &other) {
+	vector<Container> res;
+	res.reserve(std::max(containers_.size(), other.containers_.size()));
+	auto lit = containers_.begin();
+	auto rit = other.containers_.begin();
+	while (lit != containers_.end() || rit != other.containers_.end()) {
+		if (rit == other.containers_.end() || (lit != containers_.end() && lit->key < rit->key)) {
+			res.push_back(std::move(*lit++));
+		} else if (lit == containers_.end() || rit->key < lit->key) {
+			res.push_back(*rit++);
+		} else {
+			res.push_back(orContainers(*lit, *rit));
+			++lit, ++rit;
+		}
+	}
+	containers_.swap(res);
+}
+
+void IdSetBitmap::AndNot(const IdSetBitmap &other) {
+	vector<Container> res;
+	auto rit = other.containers_.begin();
+	for (auto &c : containers_) {
+		while (rit != other.containers_.end() && rit->key < c.key) ++rit;
+		if (rit == other.containers_.end() || rit->key != c.key) {
+			res.push_back(std::move(c));
+		} else {
+			Container r = andNotContainers(c, *rit);
+			if (r.card) res.push_back(std::move(r));
+		}
+	}
+	containers_.swap(res);
+}
+
+size_t IdSetBitmap::Size() const {
+	size_t ret = 0;
+	for (auto &c : containers_) ret += c.card;
+	return ret;
+}
+
+size_t IdSetBitmap::HeapSize() const {
+	size_t ret = containers_.capacity() * sizeof(Container);
+	for (auto &c : containers_) ret += c.array.capacity() * sizeof(uint16_t) + c.bits.capacity() * sizeof(uint64_t);
+	return ret;
+}
+
+IdSet::Ptr IdSetBitmap::ToIdSet() const {
+	auto ids = std::make_shared<IdSet>();
+	ids->reserve(Size());
+	for (auto &c : containers_) {
+		IdType high = IdType(c.key) << 16;
+		c.forEach([&ids, high](uint16_t v) { ids->Add(high | v, IdSet::Unordered); });
+	}
+	return ids;
+}
+
+}  // namespace reindexer
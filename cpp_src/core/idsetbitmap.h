@@ -0,0 +1,72 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "core/idset.h"
+
+namespace reindexer {
+
+using std::vector;
+
+/// Compressed bitmap set of ids (roaring bitmap). Ids are splitted by high 16 bits to containers.
+/// Container stores low 16 bits of ids as sorted array, while it has not more than kMaxArraySize elements,
+/// or as bitmap of 65536 bits otherwise. Set operations are done container by container.
+class IdSetBitmap {
+public:
+	typedef shared_ptr<const IdSetBitmap> Ptr;
+
+	/// Adds id to set. Adding ids in ascending order is the fastest.
+	/// @param id - id to add.
+	void Add(IdType id);
+	/// Adds sorted ids to set.
+	/// @param ids - ids in ascending order.
+	void Add(IdSetRef ids);
+	/// Checks if id is in set.
+	/// @param id - id to check.
+	bool Contains(IdType id) const;
+	/// Intersects set with other set.
+	void And(const IdSetBitmap &other);
+	/// Unites set with other set.
+	void Or(const IdSetBitmap &other);
+	/// Removes ids of other set from set.
+	void AndNot(const IdSetBitmap &other);
+	/// @return amount of ids in set.
+	size_t Size() const;
+	/// @return true if set is empty.
+	bool IsEmpty() const { return containers_.empty(); }
+	/// @return memory consumption of set.
+	size_t HeapSize() const;
+	/// Makes sorted IdSet from ids of set.
+	IdSet::Ptr ToIdSet() const;
+
+protected:
+	static constexpr int kMaxArraySize = 4096;
+	static constexpr int kBitmapWords = 65536 / 64;
+
+	struct Container {
+		bool isBitmap() const { return !bits.empty(); }
+		bool contains(uint16_t v) const;
+		void add(uint16_t v);
+		// Converts container to array or to bitmap, depending on cardinality
+		void normalize();
+		void toBitmap();
+		template <typename F>
+		void forEach(F f) const;
+
+		uint16_t key = 0;
+		int card = 0;
+		vector<uint16_t> array;
+		vector<uint64_t> bits;
+	};
+
+	static Container andContainers(const Container &lhs, const Container &rhs);
+	static Container orContainers(const Container &lhs, const Container &rhs);
+	static Container andNotContainers(const Container &lhs, const Container &rhs);
+
+	Container &container(uint16_t key);
+
+	// Containers, ordered by key. Empty containers are not stored
+	vector<Container> containers_;
+};
+
+}  // namespace reindexer
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core/idset.h"
+#include "core/idsetbitmap.h"
 #include "core/keyvalue/variant.h"
 #include "core/lrucache.h"
 
@@ -27,9 +28,15 @@ struct IdSetCacheKey {
 struct IdSetCacheVal {
 	IdSetCacheVal() : ids(nullptr) {}
 	IdSetCacheVal(const IdSet::Ptr &i) : ids(i) {}
-	size_t Size() const { return ids ? sizeof(*ids.get()) + ids->heap_size() : 0; }
+	IdSetCacheVal(const IdSetBitmap::Ptr &b) : bitmap(b) {}
+	size_t Size() const {
+		return (ids ? sizeof(*ids.get()) + ids->heap_size() : 0) + (bitmap ? sizeof(*bitmap.get()) + bitmap->HeapSize() : 0);
+	}
+	bool IsEmpty() const { return !ids && !bitmap; }
 
 	IdSet::Ptr ids;
+	// Compressed bitmap of ids. Is kept instead of ids for indexes with bitmap option
+	IdSetBitmap::Ptr bitmap;
 };
 
 struct equal_idset_cache_key {
@@ -22,6 +22,7 @@ Index::Index(const Index& obj)
 	: type_(obj.type_),
 	  name_(obj.name_),
 	  sortOrders_(obj.sortOrders_),
+	  sortRanks_(obj.sortRanks_),
 	  sortId_(obj.sortId_),
 	  opts_(obj.opts_),
 	  payloadType_(obj.payloadType_),
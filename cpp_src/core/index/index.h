@@ -11,6 +11,7 @@
 #include "core/perfstatcounter.h"
 #include "core/selectfunc/ctx/basefunctionctx.h"
 #include "core/selectkeyresult.h"
+#include "estl/fast_hash_map.h"
 
 namespace reindexer {
 
@@ -26,6 +27,8 @@ public:
 	};
 	using KeyEntry = reindexer::KeyEntry<IdSet>;
 	using KeyEntryPlain = reindexer::KeyEntry<IdSetPlain>;
+	/// Relocated payloads of items by their old data
+	using RelocatedPayloads = fast_hash_map<const uint8_t*, PayloadValue>;
 
 	Index(const IndexDef& idef, const PayloadType payloadType, const FieldsSet& fields);
 	Index(const Index&);
@@ -38,6 +41,11 @@ public:
 
 	virtual SelectKeyResults SelectKey(const VariantArray& keys, CondType condition, SortType stype, ResultType res_type,
 									   BaseFunctionCtx::Ptr ctx) = 0;
+	/// Estimates amount of rows, matched to condition, by statistics of index, without selecting idsets
+	/// @param keys - keys of condition, converted to SelectKeyType.
+	/// @param condition - condition.
+	/// @return estimated amount of rows, or -1 if index can't estimate it
+	virtual int64_t EstimateRows(const VariantArray& /*keys*/, CondType /*condition*/) { return -1; }
 	virtual bool Commit(const CommitContext& ctx) = 0;
 	virtual void MakeSortOrders(UpdateSortedContext&) {}
 
@@ -45,6 +53,14 @@ public:
 	virtual size_t Size() const { return 0; }
 	virtual Index* Clone() = 0;
 	virtual bool IsOrdered() const { return false; }
+	/// Rebuilds statistics of keys distribution for query planner. It is called by idle optimizer
+	virtual void RebuildStatistics() {}
+	/// Replaces keys, which share payloads with items, by relocated payloads. It is called by compaction of payloads
+	virtual void RelocatePayloads(const RelocatedPayloads& /*relocated*/) {}
+	/// Column of index - values of scalar field, indexed by rowId. Column is kept for int, int64, double and bool '-' indexes,
+	/// and for such hash and tree indexes with column option. Array, sparse and dense indexes do not keep column.
+	/// @return pointer to 1-st element of column, or nullptr if index does not keep column
+	virtual const void* ColumnData() const { return nullptr; }
 	virtual IndexMemStat GetMemStat() = 0;
 	void UpdatePayloadType(const PayloadType payloadType) { payloadType_ = payloadType; }
 
@@ -56,6 +72,10 @@ public:
 	const string& Name() const { return name_; }
 	IndexType Type() const { return type_; }
 	const vector<IdType>& SortOrders() const { return sortOrders_; }
+	/// Positions of rows in sort orders of index. Kept only, when idsets do not keep copies of ids, sorted by this index
+	/// @return position in SortOrders() for each rowId, or empty vector
+	const vector<SortType>& SortRanks() const { return sortRanks_; }
+	void SetSortRanks(vector<SortType>&& ranks) { sortRanks_ = std::move(ranks); }
 	const IndexOpts& Opts() const { return opts_; }
 	virtual void SetOpts(const IndexOpts& opts) { opts_ = opts; }
 	void SetFields(const FieldsSet& fields) { fields_ = fields; }
@@ -81,6 +101,8 @@ protected:
 	string name_;
 	// Vector or ids, sorted by this index. Available only for ordered indexes
 	vector<IdType> sortOrders_;
+	// Position of each rowId in sortOrders_. Used instead of sorted copies of idsets, if namespace builds them on demand
+	vector<SortType> sortRanks_;
 
 	SortType sortId_ = 0;
 	// Index options
@@ -1,12 +1,18 @@
 
 #include "indexordered.h"
+#include <algorithm>
+#include <iterator>
 #include "tools/errors.h"
 #include "tools/logger.h"
 
 namespace reindexer {
 
+// Amount of buckets in histogram of keys distribution
+static const int64_t kHistogramBuckets = 100;
+
 template <typename T>
 Variant IndexOrdered<T>::Upsert(const Variant &key, IdType id) {
+	if (this->opts_.IsColumn()) this->upsertColumn(key, id);
 	if (key.Type() == KeyValueNull) {
 		this->empty_ids_.Unsorted().Add(id, IdSet::Auto);
 		// Return invalid ref
@@ -18,7 +24,11 @@ Variant IndexOrdered<T>::Upsert(const Variant &key, IdType id) {
 
 	if (keyIt == this->idx_map.end() || !found)
 		keyIt = this->idx_map.insert(keyIt, {static_cast<typename T::key_type>(key), typename T::mapped_type()});
+	size_t rows = keyIt->second.Unsorted().Size();
 	keyIt->second.Unsorted().Add(id, this->opts_.IsPK() ? IdSet::Ordered : IdSet::Auto);
+	rows = keyIt->second.Unsorted().Size() - rows;
+	this->keyedRows_ += rows;
+	if (rows && !histBounds_.empty()) updateHistogram(keyIt->first, rows);
 	this->markUpdated(&*keyIt);
 
 	if (this->KeyType() == KeyValueString && this->opts_.GetCollateMode() != CollateNone) {
@@ -28,6 +38,23 @@ Variant IndexOrdered<T>::Upsert(const Variant &key, IdType id) {
 	return Variant(keyIt->first);
 }
 
+template <typename T>
+void IndexOrdered<T>::Delete(const Variant &key, IdType id) {
+	if (key.Type() == KeyValueNull || histBounds_.empty()) return IndexUnordered<T>::Delete(key, id);
+
+	bool found = false;
+	auto keyIt = lower_bound(key, found);
+	if (!found) return;
+	// Key could be erased from map by delete, so bucket is found before
+	auto boundIt = std::lower_bound(histBounds_.begin(), histBounds_.end(), keyIt->first, this->idx_map.key_comp());
+	int64_t rows = this->keyedRows_;
+	IndexUnordered<T>::Delete(key, id);
+	rows -= this->keyedRows_;
+	if (boundIt == histBounds_.end()) --boundIt;
+	histRows_[boundIt - histBounds_.begin()] -= rows;
+	histChangedRows_ += rows;
+}
+
 // special implementation for string: avoid allocation string for *_map::lower_bound
 // !!!! Not thread safe. Do not use this in Select
 template <typename T>
@@ -36,7 +63,7 @@ typename T::iterator IndexOrdered<T>::lower_bound(const Variant &key, bool &foun
 	p_string skey = static_cast<p_string>(key);
 	this->tmpKeyVal_->assign(skey.data(), skey.length());
 	auto it = this->idx_map.lower_bound(this->tmpKeyVal_);
-	found = (it != this->idx_map.end() && this->tmpKeyVal_ == it->first);
+	found = (it != this->idx_map.end() && !this->idx_map.key_comp()(this->tmpKeyVal_, it->first));
 	return it;
 }
 
@@ -48,9 +75,22 @@ typename T::iterator IndexOrdered<T>::lower_bound(const Variant &key, bool &foun
 	return it;
 }
 
+static bool isRangeCondition(CondType condition) {
+	return condition == CondLt || condition == CondLe || condition == CondGt || condition == CondGe || condition == CondRange;
+}
+
 template <typename T>
 SelectKeyResults IndexOrdered<T>::SelectKey(const VariantArray &keys, CondType condition, SortType sortId, Index::ResultType res_type,
 											BaseFunctionCtx::Ptr ctx) {
+	// Idsets do not keep ids, sorted by this index: select rowIds and convert them to positions in sort orders.
+	// Range of keys is selected as range of sort orders below
+	if (sortId && sortId == this->sortId_ && !this->sortRanks_.empty() && res_type != Index::ForceComparator &&
+		(res_type == Index::ForceIdset || !isRangeCondition(condition))) {
+		SelectKeyResults results = SelectKey(keys, condition, 0, res_type, ctx);
+		for (auto &res : results) res.MapToSortRanks(this->sortRanks_);
+		return results;
+	}
+
 	++this->rawQueriesCount_;
 
 	if (res_type == Index::ForceComparator) return IndexStore<typename T::key_type>::SelectKey(keys, condition, sortId, res_type, ctx);
@@ -105,13 +145,21 @@ SelectKeyResults IndexOrdered<T>::SelectKey(const VariantArray &keys, CondType c
 		return SelectKeyResults(res);
 
 	if (this->sortId_ == sortId && sortId && res_type != Index::ForceIdset) {
-		assert(startIt->second.Sorted(this->sortId_).size());
-		IdType idFirst = startIt->second.Sorted(this->sortId_).front();
-
 		auto backIt = endIt;
 		backIt--;
-		assert(backIt->second.Sorted(this->sortId_).size());
-		IdType idLast = backIt->second.Sorted(this->sortId_).back();
+		IdType idFirst, idLast;
+		if (this->sortRanks_.empty()) {
+			assert(startIt->second.Sorted(this->sortId_).size());
+			idFirst = startIt->second.Sorted(this->sortId_).front();
+			assert(backIt->second.Sorted(this->sortId_).size());
+			idLast = backIt->second.Sorted(this->sortId_).back();
+		} else {
+			assert(startIt->second.Unsorted().size() && backIt->second.Unsorted().size());
+			idFirst = INT_MAX;
+			idLast = INT_MIN;
+			for (auto id : startIt->second.Unsorted()) idFirst = std::min(idFirst, IdType(this->sortRanks_[id]));
+			for (auto id : backIt->second.Unsorted()) idLast = std::max(idLast, IdType(this->sortRanks_[id]));
+		}
 		// sort by this index. Just give part of sorted ids;
 		res.push_back(SingleSelectKeyResult(idFirst, idLast + 1));
 	} else {
@@ -146,6 +194,100 @@ SelectKeyResults IndexOrdered<T>::SelectKey(const VariantArray &keys, CondType c
 	return SelectKeyResults(res);
 }
 
+template <typename T>
+int64_t IndexOrdered<T>::EstimateRows(const VariantArray &keys, CondType condition) {
+	switch (condition) {
+		case CondLt:
+		case CondLe:
+		case CondGt:
+		case CondGe:
+		case CondRange:
+			break;
+		default:
+			return IndexUnordered<T>::EstimateRows(keys, condition);
+	}
+	if (this->idx_map.empty()) return 0;
+	if (histRows_.empty() || keys.empty()) return -1;
+
+	int64_t total = this->keyedRows_;
+	switch (condition) {
+		case CondLt:
+			return estimateRowsBefore(keys[0], false);
+		case CondLe:
+			return estimateRowsBefore(keys[0], true);
+		case CondGt:
+			return total - estimateRowsBefore(keys[0], true);
+		case CondGe:
+			return total - estimateRowsBefore(keys[0], false);
+		default:
+			if (keys.size() != 2) return -1;
+			return std::max(estimateRowsBefore(keys[1], true) - estimateRowsBefore(keys[0], false), int64_t(0));
+	}
+}
+
+template <typename T>
+int64_t IndexOrdered<T>::estimateRowsBefore(const Variant &key, bool inclusive) {
+	auto comp = this->idx_map.key_comp();
+	auto k = static_cast<typename T::key_type>(key);
+	auto boundIt = std::lower_bound(histBounds_.begin(), histBounds_.end(), k, comp);
+	if (boundIt == histBounds_.end()) return this->keyedRows_;
+
+	size_t bucket = boundIt - histBounds_.begin();
+	int64_t before = 0;
+	for (size_t i = 0; i < bucket; ++i) before += histRows_[i];
+	if (comp(k, *boundIt)) {
+		// Key is inside of bucket: assume half of bucket
+		return before + histRows_[bucket] / 2;
+	}
+	if (inclusive) return before + histRows_[bucket];
+	// Key is upper bound of bucket: exclude rows of key itself
+	auto keyIt = this->idx_map.find(k);
+	return before + histRows_[bucket] - (keyIt != this->idx_map.end() ? int64_t(keyIt->second.Unsorted().Size()) : 0);
+}
+
+template <typename T>
+bool IndexOrdered<T>::Commit(const CommitContext &ctx) {
+	if (!IndexUnordered<T>::Commit(ctx)) return false;
+	// Bounds of buckets are rebalanced, when rows were changed as many times, as there were rows in histogram,
+	// so cost of rebuild is amortized by writes
+	if (histBounds_.empty() || histChangedRows_ > histBuiltRows_) buildHistogram();
+	return true;
+}
+
+template <typename T>
+void IndexOrdered<T>::RebuildStatistics() {
+	if (histChangedRows_) buildHistogram();
+}
+
+template <typename T>
+void IndexOrdered<T>::updateHistogram(const typename T::key_type &key, int64_t rows) {
+	auto boundIt = std::lower_bound(histBounds_.begin(), histBounds_.end(), key, this->idx_map.key_comp());
+	// Key is greater, than keys of histogram: extend the last bucket
+	if (boundIt == histBounds_.end()) *(--boundIt) = key;
+	histRows_[boundIt - histBounds_.begin()] += rows;
+	histChangedRows_ += rows;
+}
+
+template <typename T>
+void IndexOrdered<T>::buildHistogram() {
+	histBounds_.clear();
+	histRows_.clear();
+	histBuiltRows_ = histChangedRows_ = 0;
+	// Keys of composite indexes hold payloads of items, so histogram is not kept for them
+	if (isComposite(this->type_)) return;
+
+	int64_t step = std::max(this->keyedRows_ / kHistogramBuckets, int64_t(1)), rows = 0;
+	for (auto keyIt = this->idx_map.begin(); keyIt != this->idx_map.end(); ++keyIt) {
+		rows += keyIt->second.Unsorted().Size();
+		if (rows >= step || std::next(keyIt) == this->idx_map.end()) {
+			histBounds_.push_back(keyIt->first);
+			histRows_.push_back(rows);
+			histBuiltRows_ += rows;
+			rows = 0;
+		}
+	}
+}
+
 template <typename T>
 void IndexOrdered<T>::MakeSortOrders(UpdateSortedContext &ctx) {
 	logPrintf(LogTrace, "IndexOrdered::MakeSortOrders (%s)", this->name_.c_str());
@@ -12,16 +12,34 @@ public:
 
 	SelectKeyResults SelectKey(const VariantArray &keys, CondType condition, SortType stype, Index::ResultType res_type,
 							   BaseFunctionCtx::Ptr ctx) override;
+	int64_t EstimateRows(const VariantArray &keys, CondType condition) override;
+	bool Commit(const CommitContext &ctx) override;
 	Variant Upsert(const Variant &key, IdType id) override;
+	void Delete(const Variant &key, IdType id) override;
 	void MakeSortOrders(UpdateSortedContext &ctx) override;
 	Index *Clone() override;
 	bool IsOrdered() const override;
+	void RebuildStatistics() override;
 
 protected:
 	template <typename U = T, typename std::enable_if<is_string_map_key<U>::value>::type * = nullptr>
 	typename T::iterator lower_bound(const Variant &key, bool &found);
 	template <typename U = T, typename std::enable_if<!is_string_map_key<U>::value>::type * = nullptr>
 	typename T::iterator lower_bound(const Variant &key, bool &found);
+
+	void buildHistogram();
+	// Adds amount of rows to bucket of key
+	void updateHistogram(const typename T::key_type &key, int64_t rows);
+	// Estimated amount of rows with keys less than key, or not greater than key, if inclusive
+	int64_t estimateRowsBefore(const Variant &key, bool inclusive);
+
+	// Equi-depth histogram of keys distribution: upper bounds of buckets and amount of rows in bucket.
+	// Rows of buckets are updated with each upsert and delete, and bounds are rebalanced by idle optimizer,
+	// or on commit, when amount of changed rows exceeds amount of rows, which histogram was built from
+	vector<typename T::key_type> histBounds_;
+	vector<int64_t> histRows_;
+	int64_t histBuiltRows_ = 0;
+	int64_t histChangedRows_ = 0;
 };
 
 Index *IndexOrdered_New(const IndexDef &idef, const PayloadType payloadType, const FieldsSet &fields);
@@ -48,13 +48,23 @@ Variant IndexStore<PayloadValue>::Upsert(const Variant &key, IdType /*id*/) {
 
 template <typename T>
 Variant IndexStore<T>::Upsert(const Variant &key, IdType id) {
-	if (!opts_.IsArray() && !opts_.IsDense()) {
-		idx_data.resize(std::max(id + 1, int(idx_data.size())));
-		idx_data[id] = static_cast<T>(key);
-	}
+	upsertColumn(key, id);
 	return Variant(key);
 }
 
+template <>
+void IndexStore<key_string>::upsertColumn(const Variant & /*key*/, IdType /*id*/) {}
+
+template <>
+void IndexStore<PayloadValue>::upsertColumn(const Variant & /*key*/, IdType /*id*/) {}
+
+template <typename T>
+void IndexStore<T>::upsertColumn(const Variant &key, IdType id) {
+	if (opts_.IsArray() || opts_.IsDense() || opts_.IsSparse()) return;
+	if (int(idx_data.size()) <= id) idx_data.resize(id + 1);
+	idx_data[id] = key.Type() == KeyValueNull ? T() : static_cast<T>(key);
+}
+
 template <typename T>
 bool IndexStore<T>::Commit(const CommitContext &ctx) {
 	if ((ctx.phases() & CommitContext::MakeIdsets) && allowedToCommit(ctx.phases())) {
@@ -73,10 +83,59 @@ bool IndexStore<T>::Commit(const CommitContext &ctx) {
 	return false;
 }
 
+// Max size of dictionary, which is scanned to find strings, matched by condition with collation
+static const size_t kMaxDictionaryScan = 1024;
+
+// Strings of dense '-' field are interned by str_map of index, which is dictionary of field values,
+// so equality of payload value to matched dictionary string is checked by compare of pointers
+template <>
+bool IndexStore<key_string>::selectByDictionary(const VariantArray &keys, CondType condition, ResultType res_type,
+												SelectKeyResult &res) {
+	// Hash and tree indexes use this class only for comparators, but don't fill its dictionary
+	if (type_ != IndexStrStore || opts_.IsSparse() || (condition != CondEq && condition != CondSet) || keys.empty()) return false;
+	for (auto &key : keys) {
+		// Empty string is equal to null value, which is not interned
+		if (key.Type() != KeyValueString || !static_cast<p_string>(key).length()) return false;
+	}
+
+	h_vector<key_string, 2> strings;
+	if (opts_.collateOpts_.mode == CollateNone) {
+		for (auto &key : keys) {
+			auto keyIt = str_map.find(static_cast<key_string>(key));
+			if (keyIt != str_map.end() && keyIt->second) strings.push_back(keyIt->first);
+		}
+	} else {
+		if (str_map.size() > kMaxDictionaryScan) return false;
+		for (auto &it : str_map) {
+			if (!it.second) continue;
+			for (auto &key : keys) {
+				if (!collateCompare(string_view(*it.first), string_view(static_cast<p_string>(key)), opts_.collateOpts_)) {
+					strings.push_back(it.first);
+					break;
+				}
+			}
+		}
+	}
+
+	// Result without ids and comparators is empty
+	if (strings.empty()) return true;
+	res.comparators_.push_back(Comparator(condition, KeyType(), keys, opts_.IsArray(), res_type == Index::ForceIdset, payloadType_, fields_,
+										  nullptr, opts_.collateOpts_));
+	res.comparators_.back().BindDictionary(strings);
+	return true;
+}
+
+template <typename T>
+bool IndexStore<T>::selectByDictionary(const VariantArray & /*keys*/, CondType /*condition*/, ResultType /*res_type*/,
+									   SelectKeyResult & /*res*/) {
+	return false;
+}
+
 template <typename T>
 SelectKeyResults IndexStore<T>::SelectKey(const VariantArray &keys, CondType condition, SortType /*sortId*/, ResultType res_type,
 										  BaseFunctionCtx::Ptr /*ctx*/) {
 	SelectKeyResult res;
+	if (selectByDictionary(keys, condition, res_type, res)) return SelectKeyResults(res);
 	res.comparators_.push_back(Comparator(condition, KeyType(), keys, opts_.IsArray(), res_type == Index::ForceIdset, payloadType_, fields_,
 										  idx_data.size() ? idx_data.data() : nullptr, opts_.collateOpts_));
 	return SelectKeyResults(res);
@@ -116,6 +175,11 @@ Index *IndexStore_New(const IndexDef &idef, const PayloadType payloadType, const
 	}
 }
 
+template class IndexStore<bool>;
+template class IndexStore<int>;
+template class IndexStore<int64_t>;
+template class IndexStore<double>;
+template class IndexStore<key_string>;
 template class IndexStore<PayloadValue>;
 
 }  // namespace reindexer
@@ -23,6 +23,7 @@ public:
 	void UpdateSortedIds(const UpdateSortedContext & /*ctx*/) override {}
 	Index *Clone() override;
 	IndexMemStat GetMemStat() override;
+	const void *ColumnData() const override { return idx_data.size() ? idx_data.data() : nullptr; }
 
 	IdSetRef Find(const Variant & /*key*/) override {
 		throw Error(errLogic, "IndexStore::Find of '%s' is not implemented. Do not use '-' index as pk!", this->name_.c_str());
@@ -30,12 +31,24 @@ public:
 
 protected:
 	unordered_str_map<int>::iterator find(const Variant &key);
+	// Puts value of scalar field to column
+	void upsertColumn(const Variant &key, IdType id);
+	// Selects CondEq and CondSet by strings of dictionary. Returns false, if condition can't be checked by dictionary
+	bool selectByDictionary(const VariantArray &keys, CondType condition, ResultType res_type, SelectKeyResult &res);
+
 	unordered_str_map<int> str_map;
 	h_vector<T> idx_data;
 
 	key_string tmpKeyVal_ = make_key_string();
 };
 
+template <>
+void IndexStore<key_string>::upsertColumn(const Variant &key, IdType id);
+template <>
+void IndexStore<PayloadValue>::upsertColumn(const Variant &key, IdType id);
+template <>
+bool IndexStore<key_string>::selectByDictionary(const VariantArray &keys, CondType condition, ResultType res_type, SelectKeyResult &res);
+
 Index *IndexStore_New(const IndexDef &idef, const PayloadType payloadType, const FieldsSet &fields_);
 
 }  // namespace reindexer
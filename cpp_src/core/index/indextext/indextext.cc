@@ -116,7 +116,7 @@ SelectKeyResults IndexText<T>::SelectKey(const VariantArray &keys, CondType cond
 	dsl.parse(keys[0].As<string>());
 	auto mergedIds = Select(ftctx, dsl);
 	if (mergedIds) {
-		if (need_put && mergedIds->size()) cache_ft_->Put(*cache_ft.key, FtIdSetCacheVal{mergedIds, ftctx->GetData()});
+		if (need_put && mergedIds->size()) cache_ft_->Put(IdSetCacheKey{keys, condition, 0}, FtIdSetCacheVal{mergedIds, ftctx->GetData()});
 
 		res.push_back(SingleSelectKeyResult(mergedIds));
 	}
@@ -5,8 +5,12 @@
 #include "tools/logger.h"
 namespace reindexer {
 
+// Maximum amount of keys of condition, which rows are estimated by lookup of keys
+static const size_t kMaxEstimatedKeys = 100;
+
 template <typename T>
 Variant IndexUnordered<T>::Upsert(const Variant &key, IdType id) {
+	if (this->opts_.IsColumn()) this->upsertColumn(key, id);
 	if (key.Type() == KeyValueNull) {
 		this->empty_ids_.Unsorted().Add(id, IdSet::Auto);
 		// Return invalid ref
@@ -17,7 +21,9 @@ Variant IndexUnordered<T>::Upsert(const Variant &key, IdType id) {
 	if (keyIt == this->idx_map.end()) {
 		keyIt = this->idx_map.insert({static_cast<typename T::key_type>(key), typename T::mapped_type()}).first;
 	}
+	size_t rows = keyIt->second.Unsorted().Size();
 	keyIt->second.Unsorted().Add(id, this->opts_.IsPK() ? IdSet::Ordered : IdSet::Auto);
+	keyedRows_ += keyIt->second.Unsorted().Size() - rows;
 	markUpdated(&*keyIt);
 
 	if (this->KeyType() == KeyValueString && this->opts_.GetCollateMode() != CollateNone) {
@@ -40,7 +46,7 @@ void IndexUnordered<T>::Delete(const Variant &key, IdType id) {
 	if (keyIt == idx_map.end()) return;
 
 	delcnt = keyIt->second.Unsorted().Erase(id);
-	(void)delcnt;
+	keyedRows_ -= delcnt;
 	// TODO: we have to implement removal of composite indexes (doesn't work right now)
 	assertf(this->opts_.IsArray() || this->Opts().IsSparse() || delcnt, "Delete unexists id from index '%s' id=%d,key=%s",
 			this->name_.c_str(), id, Variant(key).As<string>().c_str());
@@ -88,9 +94,21 @@ void IndexUnordered<T>::tryIdsetCache(const VariantArray &keys, CondType conditi
 
 	auto cached = cache_->Get(IdSetCacheKey{keys, condition, sortId});
 	if (cached.key) {
-		if (!cached.val.ids) {
+		if (cached.val.IsEmpty()) {
 			selector(res);
-			cache_->Put(*cached.key, res.mergeIdsets());
+			auto ids = res.mergeIdsets();
+			if (this->opts_.IsBitmap()) {
+				// Only compressed bitmap is kept in cache. Merged ids are used by this select only
+				auto bitmap = std::make_shared<IdSetBitmap>();
+				bitmap->Add(IdSetRef(ids->data(), ids->size()));
+				res.bitmap_ = bitmap;
+				cache_->Put(IdSetCacheKey{keys, condition, sortId}, IdSetCacheVal(res.bitmap_));
+			} else {
+				cache_->Put(IdSetCacheKey{keys, condition, sortId}, IdSetCacheVal(ids));
+			}
+		} else if (cached.val.bitmap) {
+			res.push_back(SingleSelectKeyResult(cached.val.bitmap->ToIdSet()));
+			res.bitmap_ = cached.val.bitmap;
 		} else {
 			res.push_back(SingleSelectKeyResult(cached.val.ids));
 		}
@@ -197,6 +215,30 @@ void IndexUnordered<T>::DumpKeys() {
 	}
 }
 
+template <typename T>
+int64_t IndexUnordered<T>::EstimateRows(const VariantArray &keys, CondType condition) {
+	switch (condition) {
+		case CondEq:
+		case CondSet: {
+			// Lookup of each key of large set costs as much as select, so average rows per key is used
+			if (keys.size() > kMaxEstimatedKeys) {
+				if (idx_map.empty()) return 0;
+				return std::min(keyedRows_, int64_t(keys.size()) * keyedRows_ / int64_t(idx_map.size()));
+			}
+			int64_t rows = 0;
+			for (auto &key : keys) {
+				auto keyIt = this->find(key);
+				if (keyIt != this->idx_map.end()) rows += keyIt->second.Unsorted().Size();
+			}
+			return rows;
+		}
+		case CondEmpty:
+			return this->empty_ids_.Unsorted().Size();
+		default:
+			return -1;
+	}
+}
+
 template <typename T>
 bool IndexUnordered<T>::Commit(const CommitContext &ctx) {
 	if ((ctx.phases() & CommitContext::MakeIdsets) && this->allowedToCommit(ctx.phases())) {
@@ -233,6 +275,7 @@ void IndexUnordered<T>::UpdateSortedIds(const UpdateSortedContext &ctx) {
 	}
 
 	this->empty_ids_.UpdateSortedIds(ctx);
+	sortedIdxCount_ = ctx.getSortedIdxCount();
 }
 
 template <typename T>
@@ -251,12 +294,16 @@ template <typename T>
 IndexMemStat IndexUnordered<T>::GetMemStat() {
 	IndexMemStat ret = IndexStore<typename T::key_type>::GetMemStat();
 	ret.uniqKeysCount = idx_map.size();
-	ret.sortOrdersSize = this->sortOrders_.capacity();
+	ret.sortOrdersSize = this->sortOrders_.capacity() * sizeof(IdType) + this->sortRanks_.capacity() * sizeof(SortType);
 	if (cache_) ret.idsetCache = cache_->GetMemStat();
 	getMemStat(ret);
 	for (auto &it : idx_map) {
-		ret.idsetPlainSize += sizeof(it.second) + it.second.ids_.heap_size();
-		ret.idsetBTreeSize += it.second.ids_.BTreeSize();
+		// Sorted copies of ids follow ids in idset. The rest of its capacity is counted as plain idset
+		auto &ids = it.second.ids_;
+		size_t sortedSize = ids.heap_size() ? std::min(ids.capacity() - ids.size(), ids.size() * sortedIdxCount_) * sizeof(IdType) : 0;
+		ret.idsetPlainSize += sizeof(it.second) + ids.heap_size() - sortedSize;
+		ret.sortOrdersSize += sortedSize;
+		ret.idsetBTreeSize += ids.BTreeSize();
 	}
 	return ret;
 }
@@ -273,6 +320,29 @@ template <typename T>
 template <typename U, typename std::enable_if<!is_string_map_key<U>::value && !is_string_unord_map_key<T>::value>::type *>
 void IndexUnordered<T>::getMemStat(IndexMemStat & /*ret*/) const {}
 
+template <typename T>
+void IndexUnordered<T>::RelocatePayloads(const Index::RelocatedPayloads &relocated) {
+	relocatePayloads(relocated);
+}
+
+template <typename T>
+template <typename U, typename std::enable_if<is_payload_map_key<U>::value || is_payload_unord_map_key<T>::value>::type *>
+void IndexUnordered<T>::relocatePayloads(const Index::RelocatedPayloads &relocated) {
+	if (relocated.empty()) return;
+	vector<PayloadValue> keys;
+	for (auto &it : idx_map) {
+		if (relocated.find(it.first.Ptr()) != relocated.end()) keys.push_back(it.first);
+	}
+	// Relocated payload has the same value, so key entry is inserted again to the same position of map
+	for (auto &key : keys) {
+		auto it = idx_map.find(key);
+		assert(it != idx_map.end());
+		auto entry = std::move(it->second);
+		idx_map.erase(it);
+		idx_map[relocated.find(key.Ptr())->second] = std::move(entry);
+	}
+}
+
 template <typename KeyEntryT>
 static Index *IndexUnordered_New(const IndexDef &idef, const PayloadType payloadType, const FieldsSet &fields) {
 	switch (idef.Type()) {
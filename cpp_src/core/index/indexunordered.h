@@ -52,12 +52,14 @@ public:
 	void DumpKeys() override;
 	SelectKeyResults SelectKey(const VariantArray &keys, CondType condition, SortType stype, Index::ResultType res_type,
 							   BaseFunctionCtx::Ptr ctx) override;
+	int64_t EstimateRows(const VariantArray &keys, CondType condition) override;
 	bool Commit(const CommitContext &ctx) override;
 	void UpdateSortedIds(const UpdateSortedContext &) override;
 	Index *Clone() override;
 	IndexMemStat GetMemStat() override;
 	size_t Size() const override final { return idx_map.size(); }
 	IdSetRef Find(const Variant &key) override final;
+	void RelocatePayloads(const Index::RelocatedPayloads &relocated) override;
 
 protected:
 	void markUpdated(typename T::value_type *key);
@@ -69,6 +71,12 @@ protected:
 	template <typename U = T, typename std::enable_if<!is_string_map_key<U>::value && !is_string_unord_map_key<T>::value>::type * = nullptr>
 	typename T::iterator find(const Variant &key);
 
+	template <typename U = T, typename std::enable_if<is_payload_map_key<U>::value || is_payload_unord_map_key<T>::value>::type * = nullptr>
+	void relocatePayloads(const Index::RelocatedPayloads &relocated);
+	template <typename U = T,
+			  typename std::enable_if<!is_payload_map_key<U>::value && !is_payload_unord_map_key<T>::value>::type * = nullptr>
+	void relocatePayloads(const Index::RelocatedPayloads &) {}
+
 	template <typename U = T, typename std::enable_if<is_string_map_key<U>::value || is_string_unord_map_key<T>::value>::type * = nullptr>
 	void getMemStat(IndexMemStat &) const;
 	template <typename U = T, typename std::enable_if<!is_string_map_key<U>::value && !is_string_unord_map_key<T>::value>::type * = nullptr>
@@ -80,6 +88,10 @@ protected:
 	shared_ptr<IdSetCache> cache_ = std::make_shared<IdSetCache>();
 	// Empty ids
 	Index::KeyEntry empty_ids_;
+	// Amount of ids of all the keys. With amount of keys it gives average rows per key for query planner
+	int64_t keyedRows_ = 0;
+	// Amount of sorted copies of ids, which were built in idsets by the last UpdateSortedIds
+	int sortedIdxCount_ = 0;
 	// Tracker of updates
 	UpdateTracker<T> tracker_;
 };
@@ -115,7 +115,7 @@ Error IndexDef::FromJSON(JsonValue &jvalue) {
 		if (jvalue.getTag() != JSON_OBJECT) throw Error(errParseJson, "Expected json object in 'indexes' key");
 
 		CollateMode collateValue = CollateNone;
-		bool isPk = false, isArray = false, isDense = false, isSparse = false;
+		bool isPk = false, isArray = false, isDense = false, isSparse = false, isBitmap = false, isColumn = false;
 		string jsonPath;
 		string collateStr;
 		string sortOrderLetters;
@@ -129,6 +129,8 @@ Error IndexDef::FromJSON(JsonValue &jvalue) {
 			parseJsonField("is_array", isArray, elem);
 			parseJsonField("is_dense", isDense, elem);
 			parseJsonField("is_sparse", isSparse, elem);
+			parseJsonField("is_bitmap", isBitmap, elem);
+			parseJsonField("is_column", isColumn, elem);
 			parseJsonField("collate_mode", collateStr, elem);
 			parseJsonField("sort_order_letters", sortOrderLetters, elem);
 			parseJsonField("json_path", jsonPath, elem);
@@ -151,7 +153,7 @@ Error IndexDef::FromJSON(JsonValue &jvalue) {
 					  "indexDef.json_path is used. It has been deprecated and will be removed in future releases. Use json_paths instead");
 		}
 
-		opts_.PK(isPk).Array(isArray).Dense(isDense).Sparse(isSparse);
+		opts_.PK(isPk).Array(isArray).Dense(isDense).Sparse(isSparse).Bitmap(isBitmap).Column(isColumn);
 		opts_.config = config;
 
 		if (!collateStr.empty()) {
@@ -185,6 +187,8 @@ void IndexDef::GetJSON(WrSerializer &ser, bool describeCompat) const {
 		.Put("is_array", opts_.IsArray())
 		.Put("is_dense", opts_.IsDense())
 		.Put("is_sparse", opts_.IsSparse())
+		.Put("is_bitmap", opts_.IsBitmap())
+		.Put("is_column", opts_.IsColumn())
 		.Put("collate_mode", getCollateMode())
 		.Put("sort_order_letters", opts_.collateOpts_.sortOrderTable.GetSortOrderCharacters())
 		.Raw("config", opts_.hasConfig() ? opts_.config.c_str() : "{}");
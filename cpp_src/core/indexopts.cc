@@ -17,6 +17,8 @@ bool IndexOpts::IsPK() const { return options & kIndexOptPK; }
 bool IndexOpts::IsArray() const { return options & kIndexOptArray; }
 bool IndexOpts::IsDense() const { return options & kIndexOptDense; }
 bool IndexOpts::IsSparse() const { return options & kIndexOptSparse; }
+bool IndexOpts::IsBitmap() const { return options & kIndexOptBitmap; }
+bool IndexOpts::IsColumn() const { return options & kIndexOptColumn; }
 bool IndexOpts::hasConfig() const { return !config.empty(); }
 CollateMode IndexOpts::GetCollateMode() const { return static_cast<CollateMode>(collateOpts_.mode); }
 
@@ -40,6 +42,16 @@ IndexOpts& IndexOpts::Sparse(bool value) {
 	return *this;
 }
 
+IndexOpts& IndexOpts::Bitmap(bool value) {
+	options = value ? options | kIndexOptBitmap : options & ~(kIndexOptBitmap);
+	return *this;
+}
+
+IndexOpts& IndexOpts::Column(bool value) {
+	options = value ? options | kIndexOptColumn : options & ~(kIndexOptColumn);
+	return *this;
+}
+
 IndexOpts& IndexOpts::SetCollateMode(CollateMode mode) {
 	collateOpts_.mode = mode;
 	return *this;
@@ -3,6 +3,7 @@
 #include "core/idset.h"
 #include "core/keyvalue/variant.h"
 #include "core/lrucache.h"
+#include "core/nsselecter/joinhashtable.h"
 #include "core/nsselecter/nsselecter.h"
 #include "core/query/query.h"
 #include "tools/serializer.h"
@@ -25,6 +26,15 @@ struct JoinCacheKey {
 		buf_.reserve(buf_.size() + ser.Len());
 		buf_.insert(buf_.end(), ser.Buf(), ser.Buf() + ser.Len());
 	}
+	// Key of hash table of joined query: its conditions and fields of joined namespace, which are joined by
+	void SetHashTableData(const Query &q) {
+		WrSerializer ser;
+		q.Serialize(ser, (SkipJoinQueries | SkipMergeQueries));
+		ser.PutVString("hash_table");
+		for (auto &je : q.joinEntries_) ser.PutVString(je.joinIndex_);
+		buf_.reserve(buf_.size() + ser.Len());
+		buf_.insert(buf_.end(), ser.Buf(), ser.Buf() + ser.Len());
+	}
 	JoinCacheKey(SortType sortId, const Query &q) { SetData(sortId, q); }
 	JoinCacheKey(const JoinCacheKey &other) { buf_ = other.buf_; }
 	size_t Size() const { return sizeof(JoinCacheKey) + buf_.size(); }
@@ -46,11 +56,15 @@ struct hash_join_cache_key {
 
 struct JoinCacheVal {
 	JoinCacheVal() {}
-	size_t Size() const { return ids_ ? sizeof(*ids_.get()) + ids_->heap_size() : 0; }
+	size_t Size() const { return (ids_ ? sizeof(*ids_.get()) + ids_->heap_size() : 0) + (hashTable ? hashTable->HeapSize() : 0); }
 	IdSet::Ptr ids_;
 	bool matchedAtLeastOnce = false;
 	bool inited = false;
 	SelectCtx::PreResult::Ptr preResult;
+	// Hash table of rows of joined namespace. It refers to rows, so it is not valid after any update of namespace
+	JoinHashTable::Ptr hashTable;
+	// Indexes of joined namespace, which were used by joined query
+	FieldsSet indexes;
 };
 typedef LRUCache<JoinCacheKey, JoinCacheVal, hash_join_cache_key, equal_join_cache_key> MainLruCache;
 
@@ -113,6 +113,8 @@ struct p_string {
 
 	int type() const { return (v & tagMask) >> tagShift; }
 	string toString() const { return string(data(), length()); }
+	// Tagged pointer. Strings, interned by the same dictionary, are equal only if their raw values are equal
+	uint64_t raw() const { return v; }
 
 protected:
 	const void *ptr() const { return v ? reinterpret_cast<const void *>(v & ~tagMask) : ""; }
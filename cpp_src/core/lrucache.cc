@@ -9,96 +9,130 @@
 
 namespace reindexer {
 
-const size_t kElemSizeOverhead = 256;
-
 template <typename K, typename V, typename hash, typename equal>
 typename LRUCache<K, V, hash, equal>::Iterator LRUCache<K, V, hash, equal>::Get(const K &key) {
 	if (cacheSizeLimit_ == 0) return Iterator();
 
-	std::lock_guard<mutex> lk(lock_);
-
-	auto it = items_.find(key);
+	Shard &shard = getShard(key);
+	{
+		shared_lock<shared_timed_mutex> lk(shard.lock);
+		auto it = shard.items.find(key);
+		if (it != shard.items.end()) return hit(*it);
+	}
 
-	if (it == items_.end()) {
-		it = items_.emplace(key, Entry{}).first;
-		totalCacheSize_ += kElemSizeOverhead + sizeof(Entry) + key.Size();
-		it->second.lruPos = lru_.insert(lru_.end(), &it->first);
-		eraseLRU();
-	} else if (std::next(it->second.lruPos) != lru_.end()) {
-		lru_.splice(lru_.end(), lru_, it->second.lruPos, std::next(it->second.lruPos));
-		it->second.lruPos = std::prev(lru_.end());
+	std::lock_guard<shared_timed_mutex> lk(shard.lock);
+	auto it = shard.items.find(key);
+	if (it == shard.items.end()) {
+		size_t size = kElemSizeOverhead + sizeof(Entry) + key.Size();
+		evict(shard, size);
+		it = shard.items.emplace(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple()).first;
+		it->second.clockPos = shard.clock.insert(shard.hand, &it->first);
+		totalSize_ += size;
+		++itemsCount_;
 	}
-	if (++it->second.hitCount < hitCountToCache_) {
+	return hit(*it);
+}
+
+template <typename K, typename V, typename hash, typename equal>
+typename LRUCache<K, V, hash, equal>::Iterator LRUCache<K, V, hash, equal>::hit(typename Map::value_type &item) {
+	auto &entry = item.second;
+	entry.referenced.store(true, std::memory_order_relaxed);
+	int hitCountToCache = hitCountToCache_.load(std::memory_order_relaxed);
+	if (entry.hitCount.load(std::memory_order_relaxed) < hitCountToCache &&
+		entry.hitCount.fetch_add(1, std::memory_order_relaxed) + 1 < hitCountToCache) {
 		return Iterator();
 	}
-	++getCount_;
+	getCount_.fetch_add(1, std::memory_order_relaxed);
 
 	// logPrintf(LogInfo, "Cache::Get (cond=%d,sortId=%d,keys=%d), total in cache items=%d,size=%d", key.cond, key.sort,
 	// 		  (int)key.keys.size(), items_.size(), totalCacheSize_);
-	return Iterator(&it->first, it->second.val);
+	return Iterator(&item.first, entry.val);
 }
 
 template <typename K, typename V, typename hash, typename equal>
 void LRUCache<K, V, hash, equal>::Put(const K &key, const V &v) {
 	if (cacheSizeLimit_ == 0) return;
 
-	std::lock_guard<mutex> lk(lock_);
-	auto it = items_.find(key);
-	if (it == items_.end()) return;
+	Shard &shard = getShard(key);
+	std::lock_guard<shared_timed_mutex> lk(shard.lock);
+	auto it = shard.items.find(key);
+	if (it == shard.items.end()) return;
 
-	totalCacheSize_ += v.Size() - it->second.val.Size();
+	totalSize_ += v.Size() - it->second.val.Size();
 	it->second.val = v;
+	it->second.referenced.store(true, std::memory_order_relaxed);
 
 	// logPrintf(LogInfo, "IdSetCache::Put () add %d,left %d,fwdCnt=%d,sz=%d", endIt - begIt, left, it->second.fwdCount,
 	// 		  it->second.ids->size());
 	++putCount_;
 
-	eraseLRU();
+	evict(shard, 0);
 }
 
 template <typename K, typename V, typename hash, typename equal>
-void LRUCache<K, V, hash, equal>::eraseLRU() {
-	typename LRUList::iterator it = lru_.begin();
-
-	while (totalCacheSize_ > cacheSizeLimit_) {
-		assert(it != lru_.end());
-		auto mIt = items_.find(**it);
-		assert(mIt != items_.end());
-		totalCacheSize_ = totalCacheSize_ - (sizeof(Entry) + kElemSizeOverhead + mIt->first.Size() + mIt->second.val.Size());
-		items_.erase(mIt);
-		it = lru_.erase(it);
-		++eraseCount_;
+void LRUCache<K, V, hash, equal>::evict(Shard &shard, size_t extraSize) {
+	evictShard(shard, extraSize);
+	for (auto &other : shards_) {
+		if (totalSize_ + extraSize <= cacheSizeLimit_) break;
+		if (&other == &shard || !other.lock.try_lock()) continue;
+		evictShard(other, extraSize);
+		other.lock.unlock();
 	}
 
-	if (eraseCount_ && putCount_ * 16 > getCount_) {
-		logPrintf(LogWarning, "IdSetCache::eraseLRU () cache invalidates too fast eraseCount=%d,putCount=%d,getCount=%d", eraseCount_,
-				  putCount_, eraseCount_);
-		eraseCount_ = 0;
-		hitCountToCache_ *= 2;
+	// Counters are shared by all the shards: limit is raised only by the thread, which has reset count of erased entries
+	int eraseCount = eraseCount_.load(std::memory_order_relaxed);
+	if (eraseCount && putCount_ * 16 > getCount_ && eraseCount_.compare_exchange_strong(eraseCount, 0)) {
+		logPrintf(LogWarning, "LRUCache::evict () cache invalidates too fast eraseCount=%d,putCount=%d,getCount=%d", eraseCount,
+				  int(putCount_), int(getCount_));
+		int hitCount = hitCountToCache_.load(std::memory_order_relaxed);
+		while (!hitCountToCache_.compare_exchange_weak(hitCount, hitCount * 2)) {
+		}
 		putCount_ = 0;
 		getCount_ = 0;
 	}
 }
+
+template <typename K, typename V, typename hash, typename equal>
+void LRUCache<K, V, hash, equal>::evictShard(Shard &shard, size_t extraSize) {
+	while (totalSize_ + extraSize > cacheSizeLimit_ && !shard.clock.empty()) {
+		if (shard.hand == shard.clock.end()) shard.hand = shard.clock.begin();
+		auto it = shard.items.find(**shard.hand);
+		assert(it != shard.items.end());
+		// Entry was requested after last pass: give it second chance
+		if (it->second.referenced.exchange(false, std::memory_order_relaxed)) {
+			++shard.hand;
+			continue;
+		}
+		erase(shard, it);
+	}
+}
+
 template <typename K, typename V, typename hash, typename equal>
 void LRUCache<K, V, hash, equal>::Invalidate() {
-	std::lock_guard<mutex> lk(lock_);
+	for (auto &shard : shards_) {
+		std::lock_guard<shared_timed_mutex> lk(shard.lock);
+		for (auto it = shard.items.begin(); it != shard.items.end(); ++it) {
+			totalSize_ -= sizeof(Entry) + kElemSizeOverhead + it->first.Size() + it->second.val.Size();
+		}
+		eraseCount_ += shard.items.size();
+		itemsCount_ -= shard.items.size();
+		shard.items.clear();
+		shard.clock.clear();
+		shard.hand = shard.clock.end();
+	}
+}
 
-	eraseCount_ += items_.size();
-	items_.clear();
-	lru_.clear();
-	totalCacheSize_ = 0;
+template <typename K, typename V, typename hash, typename equal>
+bool LRUCache<K, V, hash, equal>::Empty() const {
+	return itemsCount_.load(std::memory_order_relaxed) == 0;
 }
 
 template <typename K, typename V, typename hash, typename equal>
 LRUCacheMemStat LRUCache<K, V, hash, equal>::GetMemStat() {
-	std::lock_guard<mutex> lk(lock_);
 	LRUCacheMemStat ret;
-	ret.totalSize = totalCacheSize_;
-	ret.itemsCount = items_.size();
+	ret.totalSize = totalSize_;
+	ret.itemsCount = itemsCount_;
 	ret.emptyCount = 0;
-	// for (auto &item : items_) {
-	// 	if (item.second.val.Empty()) ret.emptyCount++;
-	// }
 
 	ret.hitCountLimit = hitCountToCache_;
 
@@ -107,6 +141,7 @@ LRUCacheMemStat LRUCache<K, V, hash, equal>::GetMemStat() {
 template class LRUCache<IdSetCacheKey, IdSetCacheVal, hash_idset_cache_key, equal_idset_cache_key>;
 template class LRUCache<IdSetCacheKey, FtIdSetCacheVal, hash_idset_cache_key, equal_idset_cache_key>;
 template class LRUCache<QueryCacheKey, QueryCacheVal, HashQueryCacheKey, EqQueryCacheKey>;
+template class LRUCache<QueryCacheKey, QueryResultsCacheVal, HashQueryCacheKey, EqQueryCacheKey>;
 template class LRUCache<JoinCacheKey, JoinCacheVal, hash_join_cache_key, equal_join_cache_key>;
 
 }  // namespace reindexer
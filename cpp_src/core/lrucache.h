@@ -1,9 +1,12 @@
 #pragma once
 
 #include <estl/fast_hash_set.h>
+#include <array>
+#include <atomic>
 #include <list>
 #include <mutex>
 #include <unordered_map>
+#include "estl/shared_mutex.h"
 #include "namespacestat.h"
 
 namespace reindexer {
@@ -13,14 +16,23 @@ using std::unordered_map;
 
 const size_t kDefaultCacheSizeLimit = 1024 * 1024 * 128;
 const int kDefaultHitCountToCache = 2;
+const size_t kElemSizeOverhead = 256;
+// Amount of independent parts of cache. Each shard has own lock
+const int kCacheShardsCount = 16;
 
+// Cache is divided into shards by hash of key. Get of existing entry takes only shared lock of shard,
+// so concurrent readers do not block each other. Entries are evicted by CLOCK (second chance) algorithm:
+// Get only sets atomic reference bit of entry, instead of moving it to the head of LRU list.
+// Size limit is shared by all the shards, so single entry may take up to the whole cache
 template <typename K, typename V, typename hash, typename equal>
 class LRUCache {
 public:
 	LRUCache(size_t sizeLimit = kDefaultCacheSizeLimit, int hitCount = kDefaultHitCountToCache)
-		: totalCacheSize_(0), cacheSizeLimit_(sizeLimit), hitCountToCache_(hitCount) {}
+		: cacheSizeLimit_(sizeLimit), hitCountToCache_(hitCount) {}
 	struct Iterator {
 		Iterator(const K *k = nullptr, const V &v = V()) : key(k), val(v) {}
+		// Key of entry in cache, or nullptr, if value is not cached yet. Entry may be evicted by concurrent request,
+		// so key should be used only as flag: Put value by own key of caller
 		const K *key;
 		V val;
 	};
@@ -31,28 +43,75 @@ public:
 
 	LRUCacheMemStat GetMemStat();
 
-	bool Empty() const { return items_.empty(); }
+	bool Empty() const;
 	void Invalidate();
+	// Invalidate only entries, which values are matched by filter
+	template <typename F>
+	void Invalidate(F filter) {
+		for (auto &shard : shards_) {
+			std::lock_guard<shared_timed_mutex> lk(shard.lock);
+			for (auto it = shard.items.begin(); it != shard.items.end();) {
+				if (filter(it->second.val)) {
+					it = erase(shard, it);
+				} else {
+					++it;
+				}
+			}
+		}
+	}
 
 protected:
-	void eraseLRU();
-
-	typedef list<const K *> LRUList;
+	typedef list<const K *> ClockList;
 
 	struct Entry {
 		V val;
-		typename LRUList::iterator lruPos;
-		int hitCount = 0;
+		typename ClockList::iterator clockPos;
+		// Value of entry is returned only after hitCountToCache_ requests
+		std::atomic<int> hitCount{0};
+		// Entry was requested after last pass of clock hand
+		std::atomic<bool> referenced{false};
+	};
+	typedef unordered_map<K, Entry, hash, equal> Map;
+
+	struct Shard {
+		Shard() : hand(clock.end()) {}
+		Map items;
+		// Ring of entries, which is passed by clock hand. New entries are inserted just behind the hand
+		ClockList clock;
+		typename ClockList::iterator hand;
+		mutable shared_timed_mutex lock;
 	};
 
-	unordered_map<K, Entry, hash, equal> items_;
-	LRUList lru_;
-	mutex lock_;
-	size_t totalCacheSize_;
+	Shard &getShard(const K &k) {
+		size_t h = hash()(k);
+		return shards_[(h ^ (h >> 16)) % kCacheShardsCount];
+	}
+	Iterator hit(typename Map::value_type &item);
+	// Evict entries, until extraSize bytes are fit to cache limit. Entries of locked shard are evicted first,
+	// then entries of other shards, which are not locked by concurrent requests
+	void evict(Shard &shard, size_t extraSize);
+	void evictShard(Shard &shard, size_t extraSize);
+	typename Map::iterator erase(Shard &shard, typename Map::iterator it) {
+		totalSize_ -= sizeof(Entry) + kElemSizeOverhead + it->first.Size() + it->second.val.Size();
+		--itemsCount_;
+		if (shard.hand == it->second.clockPos) {
+			shard.hand = shard.clock.erase(it->second.clockPos);
+		} else {
+			shard.clock.erase(it->second.clockPos);
+		}
+		++eraseCount_;
+		return shard.items.erase(it);
+	}
+
+	std::array<Shard, kCacheShardsCount> shards_;
 	size_t cacheSizeLimit_;
-	int hitCountToCache_;
+	// Hit count limit of all the shards. It is raised by compare-exchange, when entries are evicted too fast
+	std::atomic<int> hitCountToCache_;
+	// Size and amount of entries of all the shards
+	std::atomic<size_t> totalSize_{0};
+	std::atomic<int> itemsCount_{0};
 
-	int getCount_ = 0, putCount_ = 0, eraseCount_ = 0;
+	std::atomic<int> getCount_{0}, putCount_{0}, eraseCount_{0};
 };
 
 }  // namespace reindexer
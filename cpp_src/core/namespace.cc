@@ -1,11 +1,17 @@
 #include "core/namespace.h"
 #include <algorithm>
+#include <cerrno>
 #include <chrono>
+#include <cstring>
 #include <ctime>
 #include <memory>
 #include <string>
 #include <thread>
+#include "core/cjson/baseencoder.h"
+#include "core/cjson/cjsonbuilder.h"
+#include "core/cjson/jsonbuilder.h"
 #include "core/index/index.h"
+#include "core/nsloader.h"
 #include "core/nsselecter/nsselecter.h"
 #include "itemimpl.h"
 #include "storage/storagefactory.h"
@@ -14,6 +20,8 @@
 #include "tools/logger.h"
 #include "tools/stringstools.h"
 #include "tools/timetools.h"
+#include "tools/workerpool.h"
+#include "transaction.h"
 
 using std::chrono::duration_cast;
 using std::chrono::high_resolution_clock;
@@ -55,16 +63,20 @@ Namespace::Namespace(const Namespace &src)
 	  storage_(src.storage_),
 	  updates_(src.updates_),
 	  unflushedCount_(0),
-	  sortOrdersBuilt_(false),
 	  sortedQueriesCount_(0),
 	  meta_(src.meta_),
 	  dbpath_(src.dbpath_),
 	  queryCache_(src.queryCache_),
+	  resultsCache_(make_shared<QueryResultsCache>()),
+	  payloadAllocator_(src.payloadAllocator_),
+	  payloadsCompacted_(src.payloadsCompacted_),
 	  joinCache_(src.joinCache_),
 	  cacheMode_(src.cacheMode_),
 	  enablePerfCounters_(src.enablePerfCounters_.load()),
 	  queriesLogLevel_(src.queriesLogLevel_),
-	  lsnCounter_(src.lsnCounter_) {
+	  onDemandSortedIds_(src.onDemandSortedIds_),
+	  lsnCounter_(src.lsnCounter_),
+	  wal_(src.wal_) {
 	for (auto &idxIt : src.indexes_) indexes_.push_back(unique_ptr<Index>(idxIt->Clone()));
 	logPrintf(LogTrace, "Namespace::Namespace (clone %s)", name_.c_str());
 }
@@ -75,15 +87,19 @@ Namespace::Namespace(const string &name, CacheMode cacheMode)
 	  payloadType_(name),
 	  tagsMatcher_(payloadType_),
 	  unflushedCount_(0),
-	  sortOrdersBuilt_(false),
 	  sortedQueriesCount_(0),
 	  queryCache_(make_shared<QueryCache>()),
+	  resultsCache_(make_shared<QueryResultsCache>()),
+	  payloadAllocator_(new PayloadAllocator(payloadType_.TotalSize())),
 	  joinCache_(make_shared<JoinCache>()),
 	  cacheMode_(cacheMode),
 	  needPutCacheMode_(true),
 	  enablePerfCounters_(false),
 	  queriesLogLevel_(LogNone),
-	  lsnCounter_(0) {
+	  onDemandSortedIds_(false),
+	  lsnCounter_(0),
+	  // Changes of system namespaces are not replicated
+	  wal_(name.size() && name[0] == '#' ? 0 : kDefaultWALSize) {
 	logPrintf(LogTrace, "Namespace::Namespace (%s)", name_.c_str());
 	items_.reserve(10000);
 
@@ -120,6 +136,9 @@ void Namespace::updateItems(PayloadType oldPlType, const FieldsSet &changedField
 	logPrintf(LogTrace, "Namespace::updateItems(%s) delta=%d", name_.c_str(), deltaFields);
 
 	assert(oldPlType->NumFields() + deltaFields == payloadType_->NumFields());
+	// Items are copied with new payload type to heap, and are moved to slabs of new allocator by compaction
+	payloadAllocator_ = new PayloadAllocator(payloadType_.TotalSize());
+	payloadsCompacted_ = false;
 
 	int compositeStartIdx = 0;
 	if (deltaFields >= 0) {
@@ -183,6 +202,7 @@ void Namespace::updateItems(PayloadType oldPlType, const FieldsSet &changedField
 			indexes_[fieldIdx]->Upsert(Variant(plNew), rowId);
 		}
 
+		plNew.SetLSN(plCurr.GetLSN());
 		plCurr = std::move(plNew);
 	}
 	markUpdated();
@@ -196,6 +216,10 @@ void Namespace::AddIndex(const IndexDef &indexDef) {
 
 	addIndex(indexDef);
 	saveIndexesToStorage();
+
+	WrSerializer ser;
+	indexDef.GetJSON(ser);
+	addWALRecord(kWALOpModifyIndex, ModeInsert, ser.Slice().ToString());
 }
 
 void Namespace::UpdateIndex(const IndexDef &indexDef) {
@@ -203,6 +227,10 @@ void Namespace::UpdateIndex(const IndexDef &indexDef) {
 
 	updateIndex(indexDef);
 	saveIndexesToStorage();
+
+	WrSerializer ser;
+	indexDef.GetJSON(ser);
+	addWALRecord(kWALOpModifyIndex, ModeUpdate, ser.Slice().ToString());
 }
 
 void Namespace::DropIndex(const string &index) {
@@ -210,6 +238,7 @@ void Namespace::DropIndex(const string &index) {
 
 	dropIndex(index);
 	saveIndexesToStorage();
+	addWALRecord(kWALOpDropIndex, 0, string(index));
 }
 
 void Namespace::dropIndex(const string &index) {
@@ -266,6 +295,9 @@ void Namespace::dropIndex(const string &index) {
 
 	indexes_.erase(indexes_.begin() + fieldIdx);
 	indexesNames_.erase(itIdxName);
+	invalidateSortOrders(nullptr);
+	// Numbers of indexes are shifted, so indexes of cached queries are not valid anymore
+	invalidateQueryCache();
 }
 
 void Namespace::addIndex(const IndexDef &indexDef) {
@@ -409,6 +441,8 @@ void Namespace::AddCompositeIndex(const IndexDef &indexDef) {
 
 void Namespace::insertIndex(Index *newIndex, int idxNo, const string &realName) {
 	indexes_.insert(indexes_.begin() + idxNo, unique_ptr<Index>(newIndex));
+	// Sort ids of ordered indexes are shifted
+	invalidateSortOrders(nullptr);
 
 	for (auto &n : indexesNames_) {
 		if (n.second >= idxNo) {
@@ -445,13 +479,82 @@ void Namespace::Update(Item &item, bool store) { modifyItem(item, store, ModeUpd
 void Namespace::Upsert(Item &item, bool store) { modifyItem(item, store, ModeUpsert); }
 
 void Namespace::Delete(Item &item) {
-	ItemImpl *ritem = item.impl_;
-	string jsonSliceBuf;
+	PerfStatCalculatorMT calc(updatePerfCounter_, enablePerfCounters_);
+	WLock lock(mtx_);
+	calc.LockHit();
+
+	deleteItem(item);
+	lock.unlock();
+	writeStorage(false, false);
+}
 
+void Namespace::ApplyTransaction(Transaction &tx, size_t &applied) {
 	PerfStatCalculatorMT calc(updatePerfCounter_, enablePerfCounters_);
 	WLock lock(mtx_);
 	calc.LockHit();
 
+	applied = 0;
+	auto &steps = tx.GetSteps();
+	for (size_t i = 0; i < steps.size(); i++) {
+		try {
+			checkTransactionStep(steps[i].item, steps[i].mode);
+		} catch (const Error &err) {
+			throw Error(err.code(), "Item %d of transaction is not valid: %s", int(i), err.what().c_str());
+		}
+	}
+
+	// Caches are invalidated once, after all items are applied
+	inTransaction_ = true;
+	txChangedIndexes_.clear();
+	txInvalidateAll_ = false;
+	auto endTransaction = [this]() {
+		inTransaction_ = false;
+		if (txInvalidateAll_) {
+			invalidateQueryCache();
+			invalidateJoinCache();
+		} else if (!txChangedIndexes_.empty()) {
+			invalidateQueryCache(&txChangedIndexes_);
+			invalidateJoinCache(&txChangedIndexes_);
+		}
+	};
+
+	try {
+		for (auto &step : steps) {
+			if (step.mode == ModeDelete) {
+				deleteItem(step.item);
+			} else {
+				modifyItem(step.item, true, step.mode, nullptr);
+			}
+			applied++;
+		}
+	} catch (...) {
+		endTransaction();
+		throw;
+	}
+	endTransaction();
+	// All changes of transaction are written to storage by single batch out of namespace lock
+	queueTagsMatcher();
+	lock.unlock();
+	writeStorage(true, true);
+}
+
+void Namespace::checkTransactionStep(Item &item, int mode) {
+	if (!item.impl_) throw item.Status().ok() ? Error(errParams, "Item is not initialized") : item.Status();
+	if (mode != ModeUpdate && mode != ModeInsert && mode != ModeUpsert && mode != ModeDelete) {
+		throw Error(errParams, "Unknown modify mode %d", mode);
+	}
+	// Item is converted to the current payload type of namespace, so it is applied by the same way
+	string jsonSlice;
+	updateTagsMatcherFromItem(item.impl_, jsonSlice);
+	findByPK(item.impl_);
+	item.setID(-1);
+	if (mode != ModeDelete) checkPrecepts(item.impl_);
+}
+
+void Namespace::deleteItem(Item &item) {
+	ItemImpl *ritem = item.impl_;
+	string jsonSliceBuf;
+
 	updateTagsMatcherFromItem(ritem, jsonSliceBuf);
 
 	auto itItem = findByPK(ritem);
@@ -462,21 +565,40 @@ void Namespace::Delete(Item &item) {
 	}
 
 	item.setID(id);
-	item.setLSN(lsnCounter_++);
-	doDelete(id);
+	item.setLSN(doDelete(id));
 }
 
-void Namespace::doDelete(IdType id) {
+int64_t Namespace::doDelete(IdType id) {
 	assert(items_.exists(id));
 
 	Payload pl(payloadType_, items_[id]);
 
+	// Deleted item is not in namespace anymore, so WAL keeps its JSON
+	int64_t lsn = lsnCounter_++;
+	string json;
+	if (wal_.MaxSize()) {
+		WrSerializer ser;
+		ConstPayload cpl(payloadType_, items_[id]);
+		JsonBuilder builder(ser, JsonBuilder::TypePlain);
+		JsonEncoder(&tagsMatcher_).Encode(&cpl, builder);
+		json = ser.Slice().ToString();
+	}
+	wal_.Add(lsn, kWALOpModifyItem, ModeDelete, -1, std::move(json));
+
 	if (storage_) {
-		WrSerializer pk;
+		WrSerializer pk, walKey, walData;
 		pk << kStorageItemPrefix;
 		pl.SerializeFields(pk, pkFields());
-		updates_->Remove(pk.Slice());
-		++unflushedCount_;
+		if (wal_.MaxSize()) wal_.GetStorageRecord(lsn, walKey, walData);
+		std::lock_guard<std::mutex> updatesLock(storageUpdates_mtx_);
+		storageUpdates_.emplace_back();
+		storageUpdates_.back().key = pk.Slice().ToString();
+		storageUpdates_.back().remove = true;
+		if (walKey.Len()) {
+			storageUpdates_.emplace_back();
+			storageUpdates_.back().key = walKey.Slice().ToString();
+			storageUpdates_.back().value = walData.Slice().ToString();
+		}
 	}
 
 	// erase last item
@@ -509,6 +631,20 @@ void Namespace::doDelete(IdType id) {
 	items_[id].Free();
 	markUpdated();
 	free_.emplace(id);
+	return lsn;
+}
+
+void Namespace::addWALRecord(int type, int mode, string &&data) {
+	int64_t lsn = lsnCounter_++;
+	wal_.Add(lsn, type, mode, -1, std::move(data));
+	if (storage_ && wal_.MaxSize()) {
+		WrSerializer key, value;
+		wal_.GetStorageRecord(lsn, key, value);
+		std::lock_guard<std::mutex> updatesLock(storageUpdates_mtx_);
+		storageUpdates_.emplace_back();
+		storageUpdates_.back().key = key.Slice().ToString();
+		storageUpdates_.back().value = value.Slice().ToString();
+	}
 }
 
 void Namespace::Delete(const Query &q, QueryResults &result) {
@@ -527,6 +663,132 @@ void Namespace::Delete(const Query &q, QueryResults &result) {
 		logPrintf(LogInfo, "Deleted %d items in %d µs", int(result.Count()),
 				  int(duration_cast<microseconds>(high_resolution_clock::now() - tmStart).count()));
 	}
+	lock.unlock();
+	writeStorage(false, false);
+}
+
+WALChunk Namespace::GetWAL(int64_t lastLSN, int limit) {
+	RLock lock(mtx_);
+
+	WALChunk chunk;
+	chunk.lastLSN = lastLSN;
+	chunk.nsLSN = wal_.NextLSN() - 1;
+	// Follower asks for LSN of namespace only, before it copies namespace
+	if (limit <= 0) return chunk;
+
+	if (lastLSN + 1 < wal_.FirstLSN() || lastLSN + 1 > wal_.NextLSN()) {
+		throw Error(errOutdatedWAL, "WAL of namespace '%s' does not keep changes after LSN %lld. It keeps LSN from %lld to %lld",
+					name_.c_str(), static_cast<long long>(lastLSN), static_cast<long long>(wal_.FirstLSN()),
+					static_cast<long long>(wal_.NextLSN() - 1));
+	}
+
+	WrSerializer ser;
+	for (int64_t lsn = lastLSN + 1; lsn < wal_.NextLSN() && int(chunk.records.size()) < limit; lsn++) {
+		chunk.lastLSN = lsn;
+		const WALTracker::Entry &entry = *wal_.Get(lsn);
+		if (entry.type != kWALOpModifyItem || entry.mode == ModeDelete) {
+			chunk.records.push_back(WALTracker::ToRecord(entry));
+			continue;
+		}
+		// Item was changed again or deleted later, so its actual state is sent by the later record
+		if (entry.id < 0 || !items_.exists(entry.id) || items_[entry.id].GetLSN() != lsn) continue;
+
+		ser.Reset();
+		ConstPayload pl(payloadType_, items_[entry.id]);
+		JsonBuilder builder(ser, JsonBuilder::TypePlain);
+		JsonEncoder(&tagsMatcher_).Encode(&pl, builder);
+
+		WALRecord rec;
+		rec.lsn = lsn;
+		rec.type = kWALOpModifyItem;
+		// Follower may already have item, e.g. after sync by snapshot, so items are upserted
+		rec.mode = ModeUpsert;
+		rec.data = ser.Slice().ToString();
+		chunk.records.push_back(std::move(rec));
+	}
+	return chunk;
+}
+
+SnapshotChunk Namespace::GetSnapshot(int64_t lsn, IdType fromID, size_t maxSize) {
+	RLock lock(mtx_);
+
+	SnapshotChunk chunk;
+	WrSerializer ser;
+	if (lsn < 0) {
+		// Definition is taken under the same lock as LSN, so later changes of indexes are in WAL after LSN
+		lsn = wal_.NextLSN() - 1;
+		fromID = 0;
+		getDefinition().GetJSON(ser);
+		chunk.nsDef = ser.Slice().ToString();
+	}
+	chunk.lsn = lsn;
+	ser.Reset();
+	tagsMatcher_.serialize(ser);
+	chunk.tagsMatcher = ser.Slice().ToString();
+
+	CJsonEncoder encoder(&tagsMatcher_);
+	size_t size = 0;
+	IdType id = std::max(fromID, IdType(0));
+	for (; id < IdType(items_.size()) && size < maxSize; id++) {
+		// Items, which were changed after LSN of snapshot, are taken from WAL. So each PK is sent once, even if item was
+		// deleted and inserted to row, which is not sent yet
+		if (items_[id].IsFree() || items_[id].GetLSN() > lsn) continue;
+
+		ser.Reset();
+		ser.PutUInt64(items_[id].GetLSN());
+		ConstPayload pl(payloadType_, items_[id]);
+		{
+			CJsonBuilder builder(ser, CJsonBuilder::TypePlain);
+			encoder.Encode(&pl, builder);
+		}
+		size += ser.Len();
+		chunk.records.push_back(ser.Slice().ToString());
+	}
+	chunk.nextID = id < IdType(items_.size()) ? id : -1;
+	return chunk;
+}
+
+void Namespace::ApplySnapshotChunk(SnapshotChunk &chunk) {
+	{
+		WLock lock(mtx_);
+		// Tags are set before indexes, so json paths of indexes get the same tags, as in CJSON of records
+		Serializer ser(chunk.tagsMatcher.data(), chunk.tagsMatcher.size());
+		tagsMatcher_.deserialize(ser);
+		tagsMatcher_.setUpdated();
+	}
+
+	if (!chunk.nsDef.empty()) {
+		NamespaceDef nsDef;
+		auto err = nsDef.FromJSON(&chunk.nsDef[0]);
+		if (!err.ok()) throw err;
+		for (auto &indexDef : nsDef.indexes) AddIndex(indexDef);
+	}
+
+	WLock lock(mtx_);
+	NsLoader loader(this);
+	loader(std::move(chunk.records), kStorageItemPrefix);
+
+	if (chunk.nextID < 0) {
+		// Namespace continues LSN of snapshot, and its WAL starts after it
+		if (lsnCounter_ <= chunk.lsn) lsnCounter_ = chunk.lsn + 1;
+		wal_.Reset(lsnCounter_);
+	}
+	flushStorage();
+}
+
+static bool isEqualValues(const VariantArray &lhs, const VariantArray &rhs) {
+	if (lhs.size() != rhs.size()) return false;
+	for (size_t i = 0; i < lhs.size(); ++i) {
+		if (lhs[i].Type() != rhs[i].Type() || lhs[i] != rhs[i]) return false;
+	}
+	return true;
+}
+
+static bool isEqualField(const Payload &lhs, const Payload &rhs, int field) {
+	VariantArray lhsValues, rhsValues;
+	lhs.Get(field, lhsValues);
+	rhs.Get(field, rhsValues);
+	return isEqualValues(lhsValues, rhsValues);
 }
 
 void Namespace::doUpsert(ItemImpl *ritem, IdType id, bool doUpdate) {
@@ -540,14 +802,27 @@ void Namespace::doUpsert(ItemImpl *ritem, IdType id, bool doUpdate) {
 	if (doUpdate) {
 		plData.Clone(pl.RealSize());
 	}
-	markUpdated();
+	// Indexes with changed values. Unchanged indexes are not touched, to keep their idsets and caches
+	FieldsSet changedIndexes;
 
 	// keep them in nsamespace, to prevent allocs
 	// VariantArray krefs, skrefs;
 
+	// Composite indexes, which values will be changed. Composite by json paths are updated always
+	FieldsSet changedComposites;
+	for (int field = indexes_.firstCompositePos(); field < indexes_.totalSize(); ++field) {
+		const FieldsSet &fields = indexes_[field]->Fields();
+		bool changed = !doUpdate || fields.getTagsPathsLength();
+		for (auto f = fields.begin(); f != fields.end() && !changed; ++f) {
+			if (*f == IndexValueType::SetByJsonPath) continue;
+			changed = !isEqualField(pl, plNew, *f);
+		}
+		if (changed) changedComposites.push_back(field);
+	}
+
 	// Delete from composite indexes first
 	if (doUpdate) {
-		for (int field = indexes_.firstCompositePos(); field < indexes_.totalSize(); ++field) {
+		for (auto field : changedComposites) {
 			indexes_[field]->Delete(Variant(plData), id);
 		}
 	}
@@ -582,9 +857,11 @@ void Namespace::doUpsert(ItemImpl *ritem, IdType id, bool doUpdate) {
 			} else {
 				pl.Get(field, krefs, index.Opts().IsArray());
 			}
+			if (isEqualValues(krefs, skrefs)) continue;
 			for (auto key : krefs) index.Delete(key, id);
 			if (!krefs.size()) index.Delete(Variant(), id);
 		}
+		changedIndexes.push_back(field);
 		// Put value to index
 		krefs.resize(0);
 		krefs.reserve(skrefs.size());
@@ -597,9 +874,14 @@ void Namespace::doUpsert(ItemImpl *ritem, IdType id, bool doUpdate) {
 	} while (++field != borderIdx);
 
 	// Upsert to composite indexes
-	for (int field = indexes_.firstCompositePos(); field < indexes_.totalSize(); ++field) {
+	for (auto field : changedComposites) {
 		indexes_[field]->Upsert(Variant(plData), id);
+		changedIndexes.push_back(field);
 	}
+
+	// Item was not changed, so idsets and sort orders are still valid
+	if (changedIndexes.empty()) return;
+	markUpdated(doUpdate ? &changedIndexes : nullptr);
 }
 
 void Namespace::updateTagsMatcherFromItem(ItemImpl *ritem, string &jsonSliceBuf) {
@@ -626,14 +908,18 @@ void Namespace::updateTagsMatcherFromItem(ItemImpl *ritem, string &jsonSliceBuf)
 }
 
 void Namespace::modifyItem(Item &item, bool store, int mode) {
-	// Item to doUpsert
-	ItemImpl *itemImpl = item.impl_;
-	string jsonSlice;
-
 	PerfStatCalculatorMT calc(updatePerfCounter_, enablePerfCounters_);
 	WLock lock(mtx_);
 	calc.LockHit();
 
+	modifyItem(item, store, mode, &lock);
+}
+
+void Namespace::modifyItem(Item &item, bool store, int mode, WLock *lock) {
+	// Item to doUpsert
+	ItemImpl *itemImpl = item.impl_;
+	string jsonSlice;
+
 	updateTagsMatcherFromItem(itemImpl, jsonSlice);
 
 	auto realItem = findByPK(itemImpl);
@@ -650,19 +936,39 @@ void Namespace::modifyItem(Item &item, bool store, int mode) {
 	setFieldsBasedOnPrecepts(itemImpl);
 
 	int64_t lsn = lsnCounter_++;
-	item.setLSN(items_[id].GetLSN());
 	item.setID(id);
 
 	doUpsert(itemImpl, id, exists);
+	items_[id].SetLSN(lsn);
+	item.setLSN(lsn);
+	wal_.Add(lsn, kWALOpModifyItem, mode, id);
 
 	if (storage_ && store) {
-		WrSerializer pk, data;
+		WrSerializer pk, walKey, walData;
 		pk << kStorageItemPrefix;
 		newValue.SerializeFields(pk, pkFields());
-		data.PutUInt64(lsn);
-		itemImpl->GetCJSON(data);
-		updates_->Put(pk.Slice(), data.Slice());
-		++unflushedCount_;
+		if (wal_.MaxSize()) wal_.GetStorageRecord(lsn, walKey, walData);
+
+		// CJSON of item is encoded out of namespace lock from the row. Queue keeps order of updates of the same PK
+		std::unique_lock<std::mutex> updatesLock(storageUpdates_mtx_);
+		storageUpdates_.emplace_back();
+		StorageUpdate &update = storageUpdates_.back();
+		update.key = pk.Slice().ToString();
+		update.row = items_[id];
+		update.payloadType = payloadType_;
+		update.tagsMatcher = tagsMatcher_;
+		update.lsn = lsn;
+		if (walKey.Len()) {
+			storageUpdates_.emplace_back();
+			storageUpdates_.back().key = walKey.Slice().ToString();
+			storageUpdates_.back().value = walData.Slice().ToString();
+		}
+		updatesLock.unlock();
+
+		if (lock) {
+			lock->unlock();
+			writeStorage(false, false);
+		}
 	}
 }
 
@@ -696,7 +1002,17 @@ pair<IdType, bool> Namespace::findByPK(ItemImpl *ritem) {
 }
 
 void Namespace::commit(const NSCommitContext &ctx, SelectLockUpgrader *lockUpgrader) {
-	bool needCommit = (!sortOrdersBuilt_ && (ctx.phases() & CommitContext::MakeSortOrders));
+	bool needSortOrders = false;
+	if (ctx.phases() & CommitContext::MakeSortOrders) {
+		if (ctx.sortIndex() == IndexValueType::NotSet) {
+			for (int i = 0; i < int(indexes_.size()) && !needSortOrders; ++i)
+				needSortOrders = indexes_[i]->IsOrdered() && !sortedIndexes_.contains(i);
+		} else {
+			assert(ctx.sortIndex() >= 0 && ctx.sortIndex() < int(indexes_.size()));
+			needSortOrders = indexes_[ctx.sortIndex()]->IsOrdered() && !sortedIndexes_.contains(ctx.sortIndex());
+		}
+	}
+	bool needCommit = needSortOrders;
 
 	if (ctx.indexes())
 		for (auto idxNo : *ctx.indexes()) needCommit = needCommit || !preparedIndexes_.contains(idxNo) || !commitedIndexes_.contains(idxNo);
@@ -710,6 +1026,7 @@ void Namespace::commit(const NSCommitContext &ctx, SelectLockUpgrader *lockUpgra
 	// Commit changes
 	if ((ctx.phases() & CommitContext::MakeIdsets) && !commitedIndexes_.containsAll(indexes_.size())) {
 		assert(indexes_.firstCompositePos() != 0);
+		NSCommitContext forcedCtx(*this, ctx.phases() | CommitContext::MakeSortOrders, ctx.indexes(), ctx.sortIndex());
 		int field = indexes_.firstCompositePos();
 		bool was = false;
 		do {
@@ -719,7 +1036,8 @@ void Namespace::commit(const NSCommitContext &ctx, SelectLockUpgrader *lockUpgra
 					{
 						PerfStatCalculatorST calc(indexes_[field]->GetCommitPerfCounter(), enablePerfCounters_);
 						calc.LockHit();
-						was = indexes_[field]->Commit(ctx);
+						// Outdated sorted ids are rebuilt from committed idsets, so such index is committed regardless of queries count
+						was = indexes_[field]->Commit(outdatedSortedIds_.contains(field) ? forcedCtx : ctx);
 					}
 					if (was) commitedIndexes_.push_back(field);
 				}
@@ -727,32 +1045,17 @@ void Namespace::commit(const NSCommitContext &ctx, SelectLockUpgrader *lockUpgra
 		} while (++field != indexes_.firstCompositePos());
 		if (was) logPrintf(LogTrace, "Namespace::Commit ('%s'),%d items", name_.c_str(), int(items_.size()));
 		//	items_.shrink_to_fit();
+		updateSortedIds();
 	}
 
-	if (!sortOrdersBuilt_ && (ctx.phases() & CommitContext::MakeSortOrders)) {
-		// Update sort orders and sort_id for each index
-
-		int i = 1;
-		for (auto &idxIt : indexes_) {
-			if (idxIt->IsOrdered()) {
-				NSUpdateSortedContext sortCtx(*this, i++);
-				idxIt->MakeSortOrders(sortCtx);
-				// Build in multiple threads
-				int maxIndexWorkers = std::thread::hardware_concurrency();
-				unique_ptr<thread[]> thrs(new thread[maxIndexWorkers]);
-				auto indexes = &this->indexes_;
-
-				for (int i = 0; i < maxIndexWorkers; i++) {
-					thrs[i] = std::thread(
-						[&](int i) {
-							for (int j = i; j < int(indexes->size()); j += maxIndexWorkers) indexes->at(j)->UpdateSortedIds(sortCtx);
-						},
-						i);
-				}
-				for (int i = 0; i < maxIndexWorkers; i++) thrs[i].join();
+	if (needSortOrders) {
+		// Update sort orders and sort_id for requested index (or for each ordered index)
+		for (int i = 0; i < int(indexes_.size()); ++i) {
+			if ((ctx.sortIndex() == IndexValueType::NotSet || ctx.sortIndex() == i) && indexes_[i]->IsOrdered() &&
+				!sortedIndexes_.contains(i)) {
+				makeSortOrders(i);
 			}
 		}
-		sortOrdersBuilt_ = true;
 	}
 
 	if (ctx.indexes()) {
@@ -766,13 +1069,157 @@ void Namespace::commit(const NSCommitContext &ctx, SelectLockUpgrader *lockUpgra
 	}
 }
 
-void Namespace::markUpdated() {
-	sortOrdersBuilt_ = false;
-	sortedQueriesCount_ = 0;
+// Threads to make sort orders. Pool is shared by all the namespaces
+static WorkerPool &sortWorkers() {
+	static WorkerPool workers(std::max(int(std::thread::hardware_concurrency()) - 1, 0));
+	return workers;
+}
+
+void Namespace::makeSortOrders(int idxNo) {
+	NSUpdateSortedContext sortCtx(*this, getSortId(idxNo));
+	indexes_[idxNo]->MakeSortOrders(sortCtx);
+	if (onDemandSortedIds_) {
+		// Selects convert ids of other indexes to positions in sort orders by ranks of rows
+		indexes_[idxNo]->SetSortRanks(std::move(sortCtx.ids2Sorts()));
+		sortedIndexes_.push_back(idxNo);
+		return;
+	}
+	// Build in multiple threads
+	sortWorkers().Run(indexes_.size(), [&](int i) { indexes_[i]->UpdateSortedIds(sortCtx); });
+	sortedIndexes_.push_back(idxNo);
+}
+
+// Rebuilds sorted copies of ids of committed outdated indexes by sort orders, which are still valid
+void Namespace::updateSortedIds() {
+	FieldsSet updated;
+	for (auto idxNo : outdatedSortedIds_)
+		if (commitedIndexes_.contains(idxNo)) updated.push_back(idxNo);
+	if (updated.empty()) return;
+
+	vector<unique_ptr<NSUpdateSortedContext>> sortCtxs;
+	for (auto sortIdx : sortedIndexes_) {
+		sortCtxs.emplace_back(new NSUpdateSortedContext(*this, getSortId(sortIdx)));
+		auto &ids2Sorts = sortCtxs.back()->ids2Sorts();
+		auto &sortOrders = indexes_[sortIdx]->SortOrders();
+		for (size_t pos = 0; pos < sortOrders.size(); ++pos) ids2Sorts[sortOrders[pos]] = pos;
+	}
+	sortWorkers().Run(updated.size(), [&](int i) {
+		for (auto &sortCtx : sortCtxs) indexes_[updated[i]]->UpdateSortedIds(*sortCtx);
+	});
+	for (auto idxNo : updated) outdatedSortedIds_.erase(idxNo);
+}
+
+// Sort orders of ordered index depend only on its own keys, so update of items keeps sort orders of not changed indexes.
+// Insert or delete of items shifts positions of rows, so all the sort orders are invalidated
+void Namespace::invalidateSortOrders(const FieldsSet *changedIndexes) {
+	if (!changedIndexes) {
+		sortedIndexes_.clear();
+		outdatedSortedIds_.clear();
+		sortedQueriesCount_ = 0;
+		return;
+	}
+	bool invalidated = false;
+	for (auto idxNo : *changedIndexes) {
+		if (idxNo < 0 || !sortedIndexes_.contains(idxNo)) continue;
+		sortedIndexes_.erase(idxNo);
+		invalidated = true;
+	}
+	// Sorted copies of ids are not kept in on demand mode: selects use ranks of rows in sort orders
+	if (sortedIndexes_.empty()) {
+		outdatedSortedIds_.clear();
+	} else if (!onDemandSortedIds_) {
+		for (auto idxNo : *changedIndexes)
+			if (idxNo >= 0) outdatedSortedIds_.push_back(idxNo);
+	}
+	if (invalidated) sortedQueriesCount_ = 0;
+}
+
+void Namespace::SetOnDemandSortedIds(bool enable) {
+	WLock lock(mtx_);
+	if (onDemandSortedIds_ == enable) return;
+	onDemandSortedIds_ = enable;
+	// Sort orders are rebuilt in new mode. Idsets release sorted copies, when they are committed again
+	for (auto &index : indexes_) index->SetSortRanks({});
+	markUpdated();
+}
+
+static int64_t steadyNowMs() {
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Namespace::SetWALSize(size_t size) {
+	WLock lck(mtx_);
+	wal_.Resize(size);
+}
+
+void Namespace::OptimizeIndexes(int quietPeriodMs) {
+	if (indexesOptimized_ || steadyNowMs() - lastUpdateTime_ < quietPeriodMs) return;
+
+	WLock lock(mtx_);
+	// Namespace could be updated while waiting for lock
+	if (indexesOptimized_ || steadyNowMs() - lastUpdateTime_ < quietPeriodMs) return;
+
+	auto tmStart = high_resolution_clock::now();
+	FieldsSet indexes;
+	for (int i = 0; i < int(indexes_.size()) && i < maxIndexes; ++i) indexes.push_back(i);
+	commit(NSCommitContext(*this, CommitContext::MakeIdsets | CommitContext::MakeSortOrders, &indexes), nullptr);
+	for (auto &index : indexes_) index->RebuildStatistics();
+	compactPayloads();
+	indexesOptimized_ = true;
+
+	logPrintf(LogTrace, "Namespace::OptimizeIndexes (%s) done in %d µs", name_.c_str(),
+			  int(duration_cast<microseconds>(high_resolution_clock::now() - tmStart).count()));
+}
+
+// Moves payloads from sparse slabs and from heap to other slabs, so empty slabs are returned to system.
+// Payloads, which are shared with query results or composite indexes, are not moved
+void Namespace::compactPayloads() {
+	bool hasSparseSlabs = payloadAllocator_->BeginCompaction();
+	if (hasSparseSlabs || !payloadsCompacted_) {
+		bool hasComposite = false;
+		for (auto &index : indexes_) hasComposite = hasComposite || isComposite(index->Type());
+
+		// Keys of composite indexes share payloads with items, so they are replaced by relocated payloads. Old payloads are kept,
+		// while keys are replaced, so their data can't be reused by relocated ones
+		Index::RelocatedPayloads relocatedShared;
+		vector<PayloadValue> oldShared;
+		int relocated = 0;
+		for (auto &item : items_) {
+			if (!hasComposite || !item.IsShared()) {
+				relocated += item.Relocate(*payloadAllocator_);
+				continue;
+			}
+			PayloadValue old = item;
+			if (!item.Relocate(*payloadAllocator_)) continue;
+			relocatedShared.emplace(old.Ptr(), item);
+			oldShared.push_back(std::move(old));
+			relocated++;
+		}
+		for (auto &index : indexes_) {
+			if (isComposite(index->Type())) index->RelocatePayloads(relocatedShared);
+		}
+		logPrintf(LogTrace, "Namespace::compactPayloads (%s) moved %d payloads", name_.c_str(), relocated);
+	}
+	payloadAllocator_->EndCompaction();
+	payloadsCompacted_ = true;
+}
+
+void Namespace::markUpdated(const FieldsSet *changedIndexes) {
+	lastUpdateTime_ = steadyNowMs();
+	indexesOptimized_ = false;
 	preparedIndexes_.clear();
 	commitedIndexes_.clear();
-	invalidateQueryCache();
-	invalidateJoinCache();
+	invalidateSortOrders(changedIndexes);
+	if (inTransaction_) {
+		if (!changedIndexes) {
+			txInvalidateAll_ = true;
+		} else {
+			for (auto idx : *changedIndexes) txChangedIndexes_.push_back(idx);
+		}
+		return;
+	}
+	invalidateQueryCache(changedIndexes);
+	invalidateJoinCache(changedIndexes);
 }
 
 void Namespace::Select(QueryResults &result, SelectCtx &params) {
@@ -816,12 +1263,23 @@ NamespaceDef Namespace::GetDefinition() {
 }
 
 NamespaceMemStat Namespace::GetMemStat() {
-	RLock lck(mtx_);
-
 	NamespaceMemStat ret;
 	ret.name = name_;
+	if (loading_.inProgress) {
+		// Namespace is locked by loader, so return only progress of loading
+		ret.Loading.inProgress = true;
+		ret.Loading.itemsCount = loading_.itemsCount;
+		ret.Loading.dataSize = loading_.dataSize;
+		ret.Loading.errorsCount = loading_.errorsCount;
+		ret.storageOK = true;
+		ret.storagePath = dbpath_;
+		return ret;
+	}
+
+	RLock lck(mtx_);
 	ret.joinCache = joinCache_->GetMemStat();
 	ret.queryCache = queryCache_->GetMemStat();
+	ret.resultsCache = resultsCache_->GetMemStat();
 
 	ret.itemsCount = items_.size() - free_.size();
 	for (auto &item : items_) {
@@ -830,8 +1288,10 @@ NamespaceMemStat Namespace::GetMemStat() {
 
 	ret.emptyItemsCount = free_.size();
 
-	ret.Total.dataSize = ret.dataSize + items_.capacity() * sizeof(PayloadValue);
-	ret.Total.cacheSize = ret.joinCache.totalSize + ret.queryCache.totalSize;
+	ret.payloads = payloadAllocator_->GetMemStat();
+
+	ret.Total.dataSize = ret.dataSize + items_.capacity() * sizeof(PayloadValue) + ret.payloads.freeSize;
+	ret.Total.cacheSize = ret.joinCache.totalSize + ret.queryCache.totalSize + ret.resultsCache.totalSize;
 
 	for (auto &idx : indexes_) {
 		auto istat = idx->GetMemStat();
@@ -937,18 +1397,20 @@ void Namespace::saveIndexesToStorage() {
 					string_view(reinterpret_cast<const char *>(ser.Buf()), ser.Len()));
 }
 
-void Namespace::EnableStorage(const string &path, StorageOpts opts) {
+void Namespace::EnableStorage(const string &path, StorageOpts opts, datastorage::StorageType storageType,
+							  datastorage::BlockCache::Ptr blockCache) {
 	string dbpath = fs::JoinPath(path, name_);
-	datastorage::StorageType storageType = datastorage::StorageType::LevelDB;
 
 	WLock lock(mtx_);
 	if (storage_) {
 		throw Error(errLogic, "Storage already enabled for namespace '%s' on path '%s'", name_.c_str(), path.c_str());
 	}
+	std::lock_guard<std::mutex> storageLock(storage_mtx_);
 
 	bool success = false;
 	while (!success) {
 		storage_.reset(datastorage::StorageFactory::create(storageType));
+		storage_->SetBlockCache(blockCache);
 		Error status = storage_->Open(dbpath, opts);
 		if (!status.ok()) {
 			if (!opts.IsDropOnFileFormatError()) {
@@ -979,94 +1441,171 @@ void Namespace::EnableStorage(const string &path, StorageOpts opts) {
 void Namespace::LoadFromStorage() {
 	WLock lock(mtx_);
 
-	StorageOpts opts;
-	opts.FillCache(false);
-	size_t ldcount = 0;
 	getCachedMode();
 	logPrintf(LogTrace, "Loading items to '%s' from storage", name_.c_str());
-	unique_ptr<datastorage::Cursor> dbIter(storage_->GetCursor(opts));
-	ItemImpl item(payloadType_, tagsMatcher_);
-	item.Unsafe(true);
-	int errCount = 0;
-	Error lastErr = errOK;
-	for (dbIter->Seek(kStorageItemPrefix);
-		 dbIter->Valid() && dbIter->GetComparator().Compare(dbIter->Key(), string_view(kStorageItemPrefix "\xFF")) < 0; dbIter->Next()) {
-		string_view dataSlice = dbIter->Value();
-		if (dataSlice.size() > 0) {
-			if (!pkFields().size()) {
-				throw Error(errLogic, "Can't load data storage of '%s' - there are no PK fields in ns", name_.c_str());
-			}
-			if (dataSlice.size() < sizeof(int64_t)) {
-				lastErr = Error(errParseBin, "Not enougth data in data slice");
-				logPrintf(LogTrace, "Error load item to '%s' from storage: '%s'", name_.c_str(), lastErr.what().c_str());
-				errCount++;
-				continue;
-			}
-			int64_t lsn = *reinterpret_cast<const int64_t *>(dataSlice.data());
-
-			auto err = item.FromCJSON(dataSlice.substr(sizeof(lsn)));
-			if (!err.ok()) {
-				logPrintf(LogTrace, "Error load item to '%s' from storage: '%s'", name_.c_str(), err.what().c_str());
-				errCount++;
-				lastErr = err;
-				continue;
-			}
-
-			IdType id = items_.size();
-			items_.emplace_back(PayloadValue(item.GetPayload().RealSize()));
-			item.Value().SetLSN(lsn);
-			doUpsert(&item, id, false);
-			if (lsn >= lsnCounter_) {
-				lsnCounter_ = lsn + 1;
-			}
-
-			ldcount += dataSlice.size();
+	loading_.itemsCount = 0;
+	loading_.dataSize = 0;
+	loading_.errorsCount = 0;
+	loading_.inProgress = true;
+	try {
+		NsLoader loader(this);
+		loader(kStorageItemPrefix);
+	} catch (...) {
+		loading_.inProgress = false;
+		throw;
+	}
+	loading_.inProgress = false;
+
+	// Records of items in WAL are bound to rows by LSN of loaded items
+	if (storage_) wal_.Load(*storage_);
+	if (wal_.NextLSN() > lsnCounter_) lsnCounter_ = wal_.NextLSN();
+	if (wal_.NextLSN() != lsnCounter_) {
+		// Storage has changes, which are not in WAL. E.g. it was written by version without WAL
+		wal_.Reset(lsnCounter_);
+	} else {
+		for (IdType id = 0; id < IdType(items_.size()); id++) {
+			if (!items_[id].IsFree()) wal_.BindItem(items_[id].GetLSN(), id);
 		}
 	}
-	logPrintf(LogInfo, "[%s] Done loading storage. %d items loaded (%d errors %s), lsn=%d, total size=%dM", name_.c_str(),
-			  int(items_.size()), errCount, lastErr.what().c_str(), int(lsnCounter_), int(ldcount / (1024 * 1024)));
+
+	logPrintf(LogInfo, "[%s] Done loading storage. %d items loaded (%d errors), lsn=%d, total size=%dM", name_.c_str(), int(items_.size()),
+			  int(loading_.errorsCount), int(lsnCounter_), int(loading_.dataSize / (1024 * 1024)));
 }
 
 void Namespace::FlushStorage() {
-	WLock wlock(mtx_);
-	flushStorage();
+	{
+		WLock wlock(mtx_);
+		if (!storage_) return;
+		queueTagsMatcher();
+	}
+	writeStorage(true, true);
 }
 
 void Namespace::flushStorage() {
 	if (storage_) {
-		putCachedMode();
-
-		if (tagsMatcher_.isUpdated()) {
-			WrSerializer ser;
-			tagsMatcher_.serialize(ser);
-			updates_->Put(string_view(kStorageTagsPrefix), string_view(reinterpret_cast<const char *>(ser.Buf()), ser.Len()));
-			unflushedCount_++;
-			tagsMatcher_.clearUpdated();
-			logPrintf(LogTrace, "Saving tags of namespace %s:\n%s", name_.c_str(), tagsMatcher_.dump().c_str());
+		queueTagsMatcher();
+		writeStorage(true, true);
+	}
+}
+
+void Namespace::queueTagsMatcher() {
+	if (!storage_ || !tagsMatcher_.isUpdated()) return;
+	WrSerializer ser;
+	tagsMatcher_.serialize(ser);
+	tagsMatcher_.clearUpdated();
+	logPrintf(LogTrace, "Saving tags of namespace %s:\n%s", name_.c_str(), tagsMatcher_.dump().c_str());
+
+	std::lock_guard<std::mutex> updatesLock(storageUpdates_mtx_);
+	storageUpdates_.emplace_back();
+	storageUpdates_.back().key = kStorageTagsPrefix;
+	storageUpdates_.back().value = ser.Slice().ToString();
+}
+
+void Namespace::writeStorage(bool wait, bool flush) {
+	std::unique_lock<std::mutex> storageLock(storage_mtx_, std::defer_lock);
+	for (;;) {
+		if (wait) {
+			storageLock.lock();
+		} else if (!storageLock.try_lock()) {
+			return;
 		}
+		if (!storage_) return;
+
+		vector<StorageUpdate> updates;
+		for (;;) {
+			{
+				std::lock_guard<std::mutex> updatesLock(storageUpdates_mtx_);
+				if (storageUpdates_.empty()) break;
+				std::swap(updates, storageUpdates_);
+			}
+			WrSerializer data;
+			for (auto &update : updates) {
+				if (update.remove) {
+					updates_->Remove(update.key);
+				} else if (update.row.IsFree()) {
+					updates_->Put(update.key, update.value);
+				} else {
+					data.Reset();
+					data.PutUInt64(update.lsn);
+					ConstPayload pl(update.payloadType, update.row);
+					CJsonBuilder builder(data, CJsonBuilder::TypePlain);
+					CJsonEncoder(&update.tagsMatcher).Encode(&pl, builder);
+					updates_->Put(update.key, data.Slice());
+				}
+				++unflushedCount_;
+			}
+			updates.clear();
+		}
+
+		if (flush) {
+			putCachedMode();
+			if (unflushedCount_) {
+				Error status = storage_->Write(StorageOpts().FillCache(), *(updates_.get()));
+				if (!status.ok()) throw Error(errLogic, "Error write ns '%s' to storage: %s", name_.c_str(), status.what().c_str());
+				updates_->Clear();
+				unflushedCount_ = 0;
+			}
+		}
+		storageLock.unlock();
 
-		if (unflushedCount_) {
-			Error status = storage_->Write(StorageOpts().FillCache(), *(updates_.get()));
-			if (!status.ok()) throw Error(errLogic, "Error write ns '%s' to storage: %s", name_.c_str(), status.what().c_str());
-			updates_->Clear();
-			unflushedCount_ = 0;
+		// Writer, which queued update after the last check, but failed to lock storage before unlock, has left it to this thread
+		{
+			std::lock_guard<std::mutex> updatesLock(storageUpdates_mtx_);
+			if (storageUpdates_.empty()) return;
 		}
+		wait = false;
 	}
 }
 
 void Namespace::DeleteStorage() {
 	WLock lck(mtx_);
 	if (storage_) {
+		std::lock_guard<std::mutex> storageLock(storage_mtx_);
+		{
+			std::lock_guard<std::mutex> updatesLock(storageUpdates_mtx_);
+			storageUpdates_.clear();
+		}
 		storage_->Destroy(dbpath_.c_str());
 		dbpath_.clear();
 		storage_.reset();
 	}
 }
 
+void Namespace::MoveStorage(const string &path, StorageOpts opts, datastorage::StorageType storageType,
+							datastorage::BlockCache::Ptr blockCache) {
+	string dbpath = fs::JoinPath(path, name_);
+
+	WLock lck(mtx_);
+	if (!storage_) {
+		throw Error(errLogic, "Storage is not enabled for namespace '%s'", name_.c_str());
+	}
+	flushStorage();
+	std::lock_guard<std::mutex> storageLock(storage_mtx_);
+	updates_.reset();
+	storage_.reset();
+	if (fs::Rename(dbpath_, dbpath) < 0) {
+		throw Error(errLogic, "Can't move storage of namespace '%s' from '%s' to '%s' - %s", name_.c_str(), dbpath_.c_str(),
+					dbpath.c_str(), strerror(errno));
+	}
+	dbpath_ = dbpath;
+
+	storage_.reset(datastorage::StorageFactory::create(storageType));
+	storage_->SetBlockCache(blockCache);
+	Error status = storage_->Open(dbpath, opts);
+	if (!status.ok()) {
+		storage_ = nullptr;
+		dbpath_.clear();
+		throw Error(errLogic, "Can't enable storage for namespace '%s' on path '%s' - %s", name_.c_str(), path.c_str(),
+					status.what().c_str());
+	}
+	updates_.reset(storage_->GetUpdatesCollection());
+}
+
 void Namespace::CloseStorage() {
 	WLock lck(mtx_);
 	if (storage_) {
 		flushStorage();
+		std::lock_guard<std::mutex> storageLock(storage_mtx_);
 		dbpath_.clear();
 		storage_.reset();
 	}
@@ -1115,6 +1654,11 @@ string Namespace::getMeta(const string &key) {
 void Namespace::PutMeta(const string &key, const string_view &data) {
 	WLock lock(mtx_);
 	putMeta(key, data);
+
+	WrSerializer ser;
+	ser.PutVString(key);
+	ser.PutVString(data);
+	addWALRecord(kWALPutMeta, 0, ser.Slice().ToString());
 }
 
 // Put meta data to storage by key
@@ -1158,13 +1702,32 @@ Namespace *Namespace::Clone(Namespace::Ptr ns) {
 	return new Namespace(*ns);
 }
 
+// Amount of sorted copies, which are kept in each idset
 int Namespace::getSortedIdxCount() const {
+	if (onDemandSortedIds_) return 0;
 	int cnt = 0;
 	for (auto &it : indexes_)
 		if (it->IsOrdered()) cnt++;
 	return cnt;
 }
 
+// Indexes, which are used by query conditions and sorting. Non indexed fields are stored in tuple (index 0)
+FieldsSet Namespace::getQueryIndexes(const Query &q) const {
+	FieldsSet indexes;
+	int idxNo;
+	for (auto &qe : q.entries) indexes.push_back(getIndexByName(qe.index, idxNo) ? idxNo : 0);
+	for (auto &se : q.sortingEntries_) indexes.push_back(getIndexByName(se.column, idxNo) ? idxNo : 0);
+	return indexes;
+}
+
+// Each ordered index has own slot for sorted ids in idsets. sortId 0 is reserved for unsorted ids
+SortType Namespace::getSortId(int idxNo) const {
+	SortType sortId = 1;
+	for (int i = 0; i < idxNo; ++i)
+		if (indexes_[i]->IsOrdered()) sortId++;
+	return sortId;
+}
+
 IdType Namespace::createItem(size_t realSize) {
 	IdType id = 0;
 	if (free_.size()) {
@@ -1172,26 +1735,78 @@ IdType Namespace::createItem(size_t realSize) {
 		free_.erase(free_.begin());
 		assert(id < IdType(items_.size()));
 		assert(items_[id].IsFree());
-		items_[id] = PayloadValue(realSize);
+		items_[id] = PayloadValue(realSize, nullptr, 0, payloadAllocator_.get());
 	} else {
 		id = items_.size();
-		items_.emplace_back(PayloadValue(realSize));
+		items_.emplace_back(PayloadValue(realSize, nullptr, 0, payloadAllocator_.get()));
 	}
 	return id;
 }
 
-void Namespace::invalidateQueryCache() {
+static bool isIndexesChanged(const FieldsSet &indexes, const FieldsSet &changedIndexes) {
+	for (auto idx : indexes) {
+		if (changedIndexes.contains(idx)) return true;
+	}
+	return false;
+}
+
+void Namespace::invalidateQueryCache(const FieldsSet *changedIndexes) {
 	if (!queryCache_->Empty()) {
-		logPrintf(LogTrace, "[*] invalidate query cache. namespace: %s\n", name_.c_str());
-		queryCache_.reset(new QueryCache);
+		if (changedIndexes) {
+			queryCache_->Invalidate([changedIndexes](const QueryCacheVal &val) { return isIndexesChanged(val.indexes, *changedIndexes); });
+		} else {
+			logPrintf(LogTrace, "[*] invalidate query cache. namespace: %s\n", name_.c_str());
+			queryCache_.reset(new QueryCache);
+		}
+	}
+	if (!resultsCache_->Empty()) {
+		if (changedIndexes) {
+			// Ids of items are not changed by update, so results are still valid, if indexes of query were not changed
+			resultsCache_->Invalidate(
+				[changedIndexes](const QueryResultsCacheVal &val) { return isIndexesChanged(val.indexes, *changedIndexes); });
+		} else {
+			logPrintf(LogTrace, "[*] invalidate results cache. namespace: %s\n", name_.c_str());
+			resultsCache_.reset(new QueryResultsCache);
+		}
 	}
 }
-void Namespace::invalidateJoinCache() {
+
+bool Namespace::isResultsCacheEnabled() {
+	RLock lock(cache_mtx_);
+	return cacheMode_ == CacheModeAggressive;
+}
+void Namespace::invalidateJoinCache(const FieldsSet *changedIndexes) {
 	if (!joinCache_->Empty()) {
+		if (changedIndexes) {
+			// preResult with iterators refers to idsets of indexes, and preResult with sorting refers to sort orders,
+			// so they are not valid after any update
+			joinCache_->Invalidate([changedIndexes](const JoinCacheVal &val) {
+				// Hash table refers to rows of namespace, so it is not valid after any update too
+				if (val.hashTable) return true;
+				return (val.preResult && (val.preResult->mode != SelectCtx::PreResult::ModeIdSet || !val.preResult->sortBy.empty())) ||
+					   isIndexesChanged(val.indexes, *changedIndexes);
+			});
+			return;
+		}
 		logPrintf(LogTrace, "[*] invalidate join cache. namespace: %s\n", name_.c_str());
 		joinCache_.reset(new JoinCache);
 	}
 }
+void Namespace::checkPrecepts(ItemImpl *ritem) {
+	for (auto &precept : ritem->GetPrecepts()) {
+		SelectFuncParser sqlFunc;
+		SelectFuncStruct sqlFuncStruct = sqlFunc.Parse(precept);
+		if (sqlFuncStruct.isFunction && sqlFuncStruct.funcName != "now" && sqlFuncStruct.funcName != "serial") {
+			throw Error(errParams, "Unknown function %s", sqlFuncStruct.funcName.c_str());
+		}
+
+		VariantArray krs;
+		ritem->GetPayload().Get(sqlFuncStruct.field, krs);
+		if (krs.empty()) throw Error(errParams, "Field %s of precept has no value", sqlFuncStruct.field.c_str());
+		if (!sqlFuncStruct.isFunction) Variant(make_key_string(sqlFuncStruct.value)).convert(krs[0].Type());
+	}
+}
+
 void Namespace::setFieldsBasedOnPrecepts(ItemImpl *ritem) {
 	for (auto &precept : ritem->GetPrecepts()) {
 		SelectFuncParser sqlFunc;
@@ -1278,15 +1893,25 @@ void Namespace::GetIndsideFromJoinCache(JoinCacheRes &ctx) {
 	}
 }
 
-void Namespace::PutToJoinCache(JoinCacheRes &res, SelectCtx::PreResult::Ptr preResult) {
+void Namespace::PutToJoinCache(JoinCacheRes &res, SelectCtx::PreResult::Ptr preResult, const Query &q) {
 	JoinCacheVal joinCacheVal;
 	res.needPut = false;
 	joinCacheVal.inited = true;
 	joinCacheVal.preResult = preResult;
+	joinCacheVal.indexes = getQueryIndexes(q);
+	joinCache_->Put(res.key, joinCacheVal);
+}
+void Namespace::PutToJoinCache(JoinCacheRes &res, JoinHashTable::Ptr hashTable) {
+	JoinCacheVal joinCacheVal;
+	res.needPut = false;
+	joinCacheVal.inited = true;
+	joinCacheVal.hashTable = hashTable;
 	joinCache_->Put(res.key, joinCacheVal);
 }
-void Namespace::PutToJoinCache(JoinCacheRes &res, JoinCacheVal &val) {
+void Namespace::PutToJoinCache(JoinCacheRes &res, JoinCacheVal &val, const Query &q1, const Query &q2) {
 	val.inited = true;
+	val.indexes = getQueryIndexes(q1);
+	for (auto idx : getQueryIndexes(q2)) val.indexes.push_back(idx);
 	joinCache_->Put(res.key, val);
 }
 void Namespace::SetCacheMode(CacheMode cacheMode) {
@@ -12,10 +12,14 @@
 #include "index/keyentry.h"
 #include "joincache.h"
 #include "namespacedef.h"
+#include "payload/payloadallocator.h"
 #include "payload/payloadiface.h"
 #include "perfstatcounter.h"
 #include "query/querycache.h"
+#include "replicator/snapshot.h"
+#include "replicator/waltracker.h"
 #include "storage/idatastorage.h"
+#include "storage/storagetype.h"
 
 namespace reindexer {
 
@@ -30,6 +34,7 @@ class QueryResults;
 struct SelectCtx;
 class SelectLockUpgrader;
 class Index;
+class Transaction;
 
 class Namespace {
 protected:
@@ -37,20 +42,24 @@ protected:
 	friend class NsDescriber;
 	friend class NsSelectFuncInterface;
 	friend class ReindexerImpl;
+	friend class NsLoader;
 
 	class NSCommitContext : public CommitContext {
 	public:
-		NSCommitContext(const Namespace &ns, int phases, const FieldsSet *indexes = nullptr)
-			: ns_(ns), sorted_indexes_(ns_.getSortedIdxCount()), phases_(phases), indexes_(indexes) {}
+		NSCommitContext(const Namespace &ns, int phases, const FieldsSet *indexes = nullptr, int sortIndex = IndexValueType::NotSet)
+			: ns_(ns), sorted_indexes_(ns_.getSortedIdxCount()), phases_(phases), indexes_(indexes), sortIndex_(sortIndex) {}
 		int getSortedIdxCount() const override { return sorted_indexes_; }
 		int phases() const override { return phases_; }
 		const FieldsSet *indexes() const { return indexes_; }
+		// Index to make sort orders for on MakeSortOrders phase. If not set, sort orders are made for all ordered indexes
+		int sortIndex() const { return sortIndex_; }
 
 	protected:
 		const Namespace &ns_;
 		int sorted_indexes_;
 		int phases_;
 		const FieldsSet *indexes_;
+		int sortIndex_;
 	};
 
 	class NSUpdateSortedContext : public UpdateSortedContext {
@@ -106,9 +115,13 @@ public:
 
 	const string &GetName() { return name_; }
 
-	void EnableStorage(const string &path, StorageOpts opts);
+	void EnableStorage(const string &path, StorageOpts opts, datastorage::StorageType storageType = datastorage::StorageType::LevelDB,
+					   datastorage::BlockCache::Ptr blockCache = nullptr);
 	void LoadFromStorage();
 	void DeleteStorage();
+	// Close storage, move it to path and open it there. Storage keeps all items and indexes of namespace, so they are not reloaded
+	void MoveStorage(const string &path, StorageOpts opts, datastorage::StorageType storageType = datastorage::StorageType::LevelDB,
+					 datastorage::BlockCache::Ptr blockCache = nullptr);
 
 	void AddIndex(const IndexDef &indexDef);
 	void UpdateIndex(const IndexDef &indexDef);
@@ -120,12 +133,21 @@ public:
 	void Upsert(Item &item, bool store = true);
 
 	void Delete(Item &item);
+	// Apply all modifications of transaction under single lock. Items are checked before the first of them is applied,
+	// so invalid item does not leave transaction partially applied. Amount of applied steps is set to applied
+	void ApplyTransaction(Transaction &tx, size_t &applied);
 	void Select(QueryResults &result, SelectCtx &params);
 	NamespaceDef GetDefinition();
 	NamespaceMemStat GetMemStat();
 	NamespacePerfStat GetPerfStat();
 	vector<string> EnumMeta();
 	void Delete(const Query &query, QueryResults &result);
+	// Get records of WAL with LSN greater than lastLSN. Throws errOutdatedWAL, if WAL does not keep changes after lastLSN
+	WALChunk GetWAL(int64_t lastLSN, int limit);
+	// Get chunk of snapshot of items, which were not changed after LSN of snapshot. lsn = -1 starts new snapshot
+	SnapshotChunk GetSnapshot(int64_t lsn, IdType fromID, size_t maxSize);
+	// Load chunk of snapshot of namespace of other database to this empty namespace
+	void ApplySnapshotChunk(SnapshotChunk &chunk);
 	void FlushStorage();
 	void CloseStorage();
 	void SetCacheMode(CacheMode cacheMode);
@@ -144,21 +166,32 @@ public:
 
 	void FillResult(QueryResults &result, IdSet::Ptr ids, const h_vector<std::string, 4> &selectFilter);
 
+	// Commit idsets, sort orders and fulltext indexes, if namespace was not updated during quietPeriodMs
+	void OptimizeIndexes(int quietPeriodMs);
+
 	void EnablePerfCounters(bool enable = true) { enablePerfCounters_ = enable; }
 	void SetQueriesLogLevel(LogLevel lvl) {
 		WLock lck(mtx_);
 		queriesLogLevel_ = lvl;
 	}
+	// Build sorted idsets on demand by positions of rows in sort orders, instead of keeping sorted copies of each idset
+	void SetOnDemandSortedIds(bool enable);
+	// Set maximum amount of records in WAL. 0 - WAL is disabled
+	void SetWALSize(size_t size);
 
 protected:
 	void saveIndexesToStorage();
 	bool loadIndexesFromStorage();
-	void markUpdated();
+	void markUpdated(const FieldsSet *changedIndexes = nullptr);
 	void doUpsert(ItemImpl *ritem, IdType id, bool doUpdate);
 	void modifyItem(Item &item, bool store = true, int mode = ModeUpsert);
+	void deleteItem(Item &item);
 	void updateTagsMatcherFromItem(ItemImpl *ritem, string &jsonSliceBuf);
 	void updateItems(PayloadType oldPlType, const FieldsSet &changedFields, int deltaFields);
-	void doDelete(IdType id);
+	// Returns LSN of delete
+	int64_t doDelete(IdType id);
+	// Add record of index or meta change to WAL and to storage
+	void addWALRecord(int type, int mode, string &&data);
 	void commit(const NSCommitContext &ctx, SelectLockUpgrader *lockUpgrader);
 	void insertIndex(Index *newIndex, int idxNo, const string &realName);
 	void addIndex(const IndexDef &indexDef);
@@ -169,7 +202,13 @@ protected:
 	IndexDef getIndexDefinition(const string &indexName);
 
 	string getMeta(const string &key);
+	// Writes batch of updates to storage. Must be called under write lock
 	void flushStorage();
+	// Queues tags matcher to storage, if it was updated. Must be called under write lock
+	void queueTagsMatcher();
+	// Moves queued updates to batch of storage, and writes batch, if flush is set. Must be called out of namespace lock
+	// @param wait - wait for other writer of storage, or leave updates in queue to it
+	void writeStorage(bool wait, bool flush);
 	void putMeta(const string &key, const string_view &data);
 	void putCachedMode();
 	void getCachedMode();
@@ -177,14 +216,24 @@ protected:
 	pair<IdType, bool> findByPK(ItemImpl *ritem);
 
 	int getSortedIdxCount() const;
+	FieldsSet getQueryIndexes(const Query &q) const;
+	SortType getSortId(int idxNo) const;
+	void makeSortOrders(int idxNo);
+	void updateSortedIds();
+	void invalidateSortOrders(const FieldsSet *changedIndexes);
 
 	void setFieldsBasedOnPrecepts(ItemImpl *ritem);
+	// Throws error, if precepts of item can't be applied
+	void checkPrecepts(ItemImpl *ritem);
+	// Throws error, if step of transaction can't be applied
+	void checkTransactionStep(Item &item, int mode);
 
 	int64_t funcGetSerial(SelectFuncStruct sqlFuncStruct);
 
-	void PutToJoinCache(JoinCacheRes &res, SelectCtx::PreResult::Ptr preResult);
+	void PutToJoinCache(JoinCacheRes &res, SelectCtx::PreResult::Ptr preResult, const Query &q);
 
-	void PutToJoinCache(JoinCacheRes &res, JoinCacheVal &val);
+	void PutToJoinCache(JoinCacheRes &res, JoinCacheVal &val, const Query &q1, const Query &q2);
+	void PutToJoinCache(JoinCacheRes &res, JoinHashTable::Ptr hashTable);
 	void GetFromJoinCache(JoinCacheRes &ctx);
 	void GetIndsideFromJoinCache(JoinCacheRes &ctx);
 
@@ -207,23 +256,66 @@ protected:
 	datastorage::UpdatesCollection::Ptr updates_;
 	int unflushedCount_;
 
+	// Update of storage, which is queued under namespace lock, and is encoded and put to batch of storage out of it
+	struct StorageUpdate {
+		string key;
+		string value;
+		bool remove = false;
+		// Row of item. Its CJSON is encoded to value. Row is shared with namespace, so update of item clones it
+		PayloadValue row;
+		PayloadType payloadType;
+		TagsMatcher tagsMatcher;
+		int64_t lsn = 0;
+	};
+	vector<StorageUpdate> storageUpdates_;
+	std::mutex storageUpdates_mtx_;
+
 	shared_timed_mutex mtx_;
 	shared_timed_mutex cache_mtx_;
+	// Guards updates_ and writes of storage_. Writers don't wait for it under mtx_: they queue updates to storageUpdates_
+	// Lock order is mtx_ -> storage_mtx_ -> storageUpdates_mtx_
+	std::mutex storage_mtx_;
 
 	// Commit phases state
-	bool sortOrdersBuilt_;
 	std::atomic<int> sortedQueriesCount_;
-	FieldsSet preparedIndexes_, commitedIndexes_;
+	// Ordered indexes with valid sort orders. Sort orders are made on demand for index, which is used for sorting,
+	// so write to namespace costs only one rebuild for the next sorted query, not rebuild of all ordered indexes
+	FieldsSet preparedIndexes_, commitedIndexes_, sortedIndexes_;
+	// Indexes, which idsets were changed after sort orders were made. Their sorted copies of ids are rebuilt on commit
+	FieldsSet outdatedSortedIds_;
+	// Background optimization state. Time is in ms of steady clock
+	std::atomic<int64_t> lastUpdateTime_{0};
+	std::atomic<bool> indexesOptimized_{false};
+
+	// Progress of loading from storage. Is read by GetMemStat without lock, while loader holds namespace lock
+	struct LoadingState {
+		std::atomic<bool> inProgress{false};
+		std::atomic<size_t> itemsCount{0};
+		std::atomic<size_t> dataSize{0};
+		std::atomic<size_t> errorsCount{0};
+	} loading_;
+
+	// Transaction state. Caches invalidation is deferred to the end of transaction
+	bool inTransaction_ = false;
+	bool txInvalidateAll_ = false;
+	FieldsSet txChangedIndexes_;
 
 	unordered_map<string, string> meta_;
 
 	string dbpath_;
 
 	shared_ptr<QueryCache> queryCache_;
+	// Full results of repeated queries. Used only in aggressive cache mode
+	shared_ptr<QueryResultsCache> resultsCache_;
 
 	int sparseIndexesCount_ = 0;
 	VariantArray krefs, skrefs;
 
+	// Allocator of payloads of items, matched to current payload type
+	PayloadAllocator::Ptr payloadAllocator_;
+	// Payloads were moved to slabs of allocator after change of payload type
+	bool payloadsCompacted_ = true;
+
 private:
 	Namespace(const Namespace &src);
 
@@ -231,10 +323,16 @@ private:
 	typedef shared_lock<shared_timed_mutex> RLock;
 	typedef unique_lock<shared_timed_mutex> WLock;
 
+	// Modify item under already acquired lock. If lock is set, it will be released before serialization of item to storage
+	void modifyItem(Item &item, bool store, int mode, WLock *lock);
+
 	IdType createItem(size_t realSize);
 
-	void invalidateQueryCache();
-	void invalidateJoinCache();
+	void compactPayloads();
+
+	void invalidateQueryCache(const FieldsSet *changedIndexes = nullptr);
+	bool isResultsCacheEnabled();
+	void invalidateJoinCache(const FieldsSet *changedIndexes = nullptr);
 	JoinCache::Ptr joinCache_;
 	CacheMode cacheMode_;
 	bool needPutCacheMode_;
@@ -242,7 +340,11 @@ private:
 	PerfStatCounterMT updatePerfCounter_, selectPerfCounter_;
 	std::atomic<bool> enablePerfCounters_;
 	LogLevel queriesLogLevel_;
+	// Indexes do not keep copies of idsets, sorted by each ordered index. Sort indexes keep ranks of rows instead
+	bool onDemandSortedIds_;
 	int64_t lsnCounter_;
+	// Ring of the last changes, which are streamed to followers
+	WALTracker wal_;
 	vector<std::unique_ptr<ItemImpl>> pool_;
 };
 
@@ -17,6 +17,13 @@ void NamespaceMemStat::GetJSON(WrSerializer &ser) {
 	builder.Put("storage_ok", storageOK);
 	builder.Put("storage_path", storagePath);
 
+	if (Loading.inProgress) {
+		builder.Object("loading")
+			.Put("items_count", Loading.itemsCount)
+			.Put("data_size", Loading.dataSize)
+			.Put("errors_count", Loading.errorsCount);
+	}
+
 	builder.Object("total").Put("data_size", Total.dataSize).Put("indexes_size", Total.indexesSize).Put("cache_size", Total.cacheSize);
 
 	{
@@ -27,6 +34,14 @@ void NamespaceMemStat::GetJSON(WrSerializer &ser) {
 		auto obj = builder.Object("query_cache");
 		queryCache.GetJSON(obj);
 	}
+	{
+		auto obj = builder.Object("results_cache");
+		resultsCache.GetJSON(obj);
+	}
+	{
+		auto obj = builder.Object("payloads");
+		payloads.GetJSON(obj);
+	}
 
 	auto arr = builder.Array("indexes");
 	for (auto &index : indexes) {
@@ -35,6 +50,12 @@ void NamespaceMemStat::GetJSON(WrSerializer &ser) {
 	}
 };
 
+void PayloadsMemStat::GetJSON(JsonBuilder &builder) {
+	builder.Put("slabs_count", slabsCount);
+	builder.Put("slabs_size", slabsSize);
+	builder.Put("free_size", freeSize);
+}
+
 void LRUCacheMemStat::GetJSON(JsonBuilder &builder) {
 	builder.Put("total_size", totalSize);
 	builder.Put("items_count", itemsCount);
@@ -20,6 +20,16 @@ struct LRUCacheMemStat {
 	size_t hitCountLimit = 0;
 };
 
+// Slabs of payload buffers
+struct PayloadsMemStat {
+	void GetJSON(JsonBuilder &builder);
+
+	size_t slabsCount = 0;
+	size_t slabsSize = 0;
+	// Memory of free blocks in slabs
+	size_t freeSize = 0;
+};
+
 struct IndexMemStat {
 	void GetJSON(JsonBuilder &builder);
 	std::string name;
@@ -48,8 +58,16 @@ struct NamespaceMemStat {
 		size_t indexesSize = 0;
 		size_t cacheSize = 0;
 	} Total;
+	struct {
+		bool inProgress = false;
+		size_t itemsCount = 0;
+		size_t dataSize = 0;
+		size_t errorsCount = 0;
+	} Loading;
 	LRUCacheMemStat joinCache;
 	LRUCacheMemStat queryCache;
+	LRUCacheMemStat resultsCache;
+	PayloadsMemStat payloads;
 	std::vector<IndexMemStat> indexes;
 };
 
@@ -0,0 +1,311 @@
+#include "core/nsloader.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include "core/index/index.h"
+#include "core/itemimpl.h"
+#include "core/namespace.h"
+#include "tools/logger.h"
+#include "tools/workerpool.h"
+
+namespace reindexer {
+
+// Amount of records in batch
+static const size_t kLoadBatchSize = 8192;
+// Amount of records, decoded by worker at once
+static const int kDecodeChunkSize = 256;
+// Maximum amount of batches, waiting for the next stage
+static const size_t kLoadQueueSize = 2;
+
+class NsLoader::Queue {
+public:
+	// Push batch to queue. Blocks while queue is full. Returns false, if queue was closed
+	bool Push(BatchPtr &&batch) {
+		std::unique_lock<std::mutex> lck(mtx_);
+		notFull_.wait(lck, [this]() { return batches_.size() < kLoadQueueSize || closed_; });
+		if (closed_) return false;
+		batches_.push_back(std::move(batch));
+		notEmpty_.notify_one();
+		return true;
+	}
+	// Pop batch from queue. Blocks while queue is empty. Returns false, if queue was closed and has no batches
+	bool Pop(BatchPtr &batch) {
+		std::unique_lock<std::mutex> lck(mtx_);
+		notEmpty_.wait(lck, [this]() { return !batches_.empty() || closed_; });
+		if (batches_.empty()) return false;
+		batch = std::move(batches_.front());
+		batches_.pop_front();
+		notFull_.notify_one();
+		return true;
+	}
+	// Close queue: producer has no more batches, or consumer will not pop batches anymore
+	void Close() {
+		std::lock_guard<std::mutex> lck(mtx_);
+		closed_ = true;
+		notEmpty_.notify_all();
+		notFull_.notify_all();
+	}
+
+protected:
+	std::mutex mtx_;
+	std::condition_variable notEmpty_, notFull_;
+	std::deque<BatchPtr> batches_;
+	bool closed_ = false;
+};
+
+NsLoader::NsLoader(Namespace *ns, int threads) : ns_(ns), threads_(threads) {
+	if (threads_ <= 0) threads_ = std::max(int(std::thread::hardware_concurrency()), 1);
+
+	// Tuple is put to index after fields, because sparse indexes read it from payload.
+	// Composite indexes read payload, so they are filled after all fields are set, and composite indexes by json paths
+	// are filled after tuple index
+	auto &indexes = ns_->indexes_;
+	vector<int> fields, tupleAndComposites{0}, jsonComposites;
+	for (int field = 1; field < indexes.firstCompositePos(); ++field) fields.push_back(field);
+	for (int field = indexes.firstCompositePos(); field < indexes.totalSize(); ++field) {
+		(indexes[field]->Fields().getTagsPathsLength() ? jsonComposites : tupleAndComposites).push_back(field);
+	}
+	for (auto step : {&fields, &tupleAndComposites, &jsonComposites}) {
+		if (!step->empty()) indexSteps_.push_back(std::move(*step));
+	}
+}
+
+void NsLoader::operator()(const string &prefix) {
+	load([&](Queue &raw) { readStorage(prefix, raw); });
+	if (errCount_) {
+		logPrintf(LogInfo, "[%s] %d items were not loaded from storage: %s", ns_->name_.c_str(), int(errCount_), lastErr_.what().c_str());
+	}
+}
+
+void NsLoader::operator()(vector<string> &&records, const string &prefix) {
+	// Storage keys of records are built by PK of loaded items, so batches are stored after indexing
+	storePrefix_ = &prefix;
+	load([&](Queue &raw) { readRecords(records, raw); });
+	storePrefix_ = nullptr;
+	if (errCount_) {
+		throw Error(errParseBin, "%d items of snapshot of '%s' were not loaded: %s", int(errCount_), ns_->name_.c_str(),
+					lastErr_.what().c_str());
+	}
+}
+
+void NsLoader::parallelFor(int count, const std::function<void(int, int)> &f) {
+	int workers = std::min(threads_, count);
+	if (workers <= 1) {
+		for (int i = 0; i < count; i++) f(i, 0);
+		return;
+	}
+	// Each task of pool is a worker, which takes next item, when it is done with previous one
+	std::atomic<int> next{0};
+	workers_->Run(workers, [&](int w) {
+		try {
+			for (int i = next++; i < count; i = next++) f(i, w);
+		} catch (...) {
+			next = count;
+			throw;
+		}
+	});
+}
+
+void NsLoader::load(std::function<void(Queue &)> read) {
+	// Threads of decoder and indexer stages are started once for the whole loading
+	WorkerPool workers(threads_ - 1);
+	workers_ = &workers;
+	Queue raw, decoded;
+	std::exception_ptr err;
+	std::thread reader([&]() {
+		try {
+			read(raw);
+		} catch (...) {
+			err = std::current_exception();
+		}
+		raw.Close();
+	});
+	std::thread decoder([&]() {
+		decodeBatches(raw, decoded);
+		decoded.Close();
+	});
+
+	try {
+		BatchPtr batch;
+		while (decoded.Pop(batch)) indexBatch(*batch);
+	} catch (...) {
+		raw.Close();
+		decoded.Close();
+		reader.join();
+		decoder.join();
+		workers_ = nullptr;
+		throw;
+	}
+	reader.join();
+	decoder.join();
+	workers_ = nullptr;
+	if (err) std::rethrow_exception(err);
+
+	ns_->markUpdated();
+}
+
+void NsLoader::readStorage(const string &prefix, Queue &out) {
+	StorageOpts opts;
+	opts.FillCache(false);
+
+	// Records are read in order of storage files, not in order of keys
+	BatchPtr batch(new Batch);
+	batch->records.reserve(kLoadBatchSize);
+	bool stopped = false;
+	auto err = ns_->storage_->ReadPrefix(opts, prefix, [&](const string_view &, const string_view &dataSlice) {
+		if (!dataSlice.size()) return true;
+		batch->records.emplace_back();
+		batch->records.back().data.assign(dataSlice.data(), dataSlice.size());
+		if (batch->records.size() == kLoadBatchSize) {
+			if (!out.Push(std::move(batch))) {
+				stopped = true;
+				return false;
+			}
+			batch.reset(new Batch);
+			batch->records.reserve(kLoadBatchSize);
+		}
+		return true;
+	});
+	if (!err.ok()) throw err;
+	if (!stopped && !batch->records.empty()) out.Push(std::move(batch));
+}
+
+void NsLoader::readRecords(vector<string> &records, Queue &out) {
+	for (size_t pos = 0; pos < records.size(); pos += kLoadBatchSize) {
+		BatchPtr batch(new Batch);
+		size_t end = std::min(records.size(), pos + kLoadBatchSize);
+		batch->records.resize(end - pos);
+		for (size_t i = pos; i < end; i++) batch->records[i - pos].data = std::move(records[i]);
+		if (!out.Push(std::move(batch))) return;
+	}
+}
+
+void NsLoader::decodeBatches(Queue &in, Queue &out) {
+	BatchPtr batch;
+	while (in.Pop(batch)) {
+		decodeBatch(*batch);
+		if (!out.Push(std::move(batch))) break;
+	}
+}
+
+void NsLoader::decodeBatch(Batch &batch) {
+	int chunks = (batch.records.size() + kDecodeChunkSize - 1) / kDecodeChunkSize;
+	// Item for decoding per worker
+	vector<unique_ptr<ItemImpl>> items(std::min(threads_, chunks));
+
+	parallelFor(chunks, [&](int chunk, int worker) {
+		auto &item = items[worker];
+		if (!item) {
+			item.reset(new ItemImpl(ns_->payloadType_, ns_->tagsMatcher_));
+			item->Unsafe(true);
+		}
+		auto end = std::min(batch.records.size(), size_t(chunk + 1) * kDecodeChunkSize);
+		for (auto i = size_t(chunk) * kDecodeChunkSize; i < end; i++) {
+			Record &rec = batch.records[i];
+			if (rec.data.size() < sizeof(int64_t)) {
+				rec.err = Error(errParseBin, "Not enougth data in data slice");
+				continue;
+			}
+			rec.lsn = *reinterpret_cast<const int64_t *>(rec.data.data());
+			rec.err = item->FromCJSON(string_view(rec.data).substr(sizeof(rec.lsn)));
+			if (!rec.err.ok()) continue;
+
+			// Copy payload. Strings of payload still point to record data, except tuple, which is copied to record
+			Payload pl = item->GetPayload();
+			rec.value = PayloadValue(pl.RealSize(), item->Value().Ptr(), 0, ns_->payloadAllocator_.get());
+			rec.value.SetLSN(rec.lsn);
+			VariantArray tuple;
+			pl.Get(0, tuple);
+			string_view tupleData = p_string(tuple[0]);
+			rec.tuple.assign(tupleData.data(), tupleData.size());
+			Payload(ns_->payloadType_, rec.value).Set(0, {Variant(p_string(&rec.tuple))});
+		}
+	});
+}
+
+void NsLoader::indexBatch(Batch &batch) {
+	auto &items = ns_->items_;
+	for (auto &rec : batch.records) {
+		if (!rec.err.ok()) {
+			logPrintf(LogTrace, "Error load item to '%s' from storage: '%s'", ns_->name_.c_str(), rec.err.what().c_str());
+			errCount_++;
+			lastErr_ = rec.err;
+			ns_->loading_.errorsCount++;
+			continue;
+		}
+		if (!ns_->pkFields().size()) {
+			throw Error(errLogic, "Can't load data storage of '%s' - there are no PK fields in ns", ns_->name_.c_str());
+		}
+		rec.id = items.size();
+		items.emplace_back();
+		items.back() = std::move(rec.value);
+		if (rec.lsn >= ns_->lsnCounter_) ns_->lsnCounter_ = rec.lsn + 1;
+	}
+
+	vector<VariantArray> krefs(threads_), skrefs(threads_);
+	for (auto &step : indexSteps_) {
+		parallelFor(step.size(), [&](int i, int worker) { upsertIndex(step[i], batch, krefs[worker], skrefs[worker]); });
+	}
+
+	for (auto &rec : batch.records) {
+		if (rec.id < 0) continue;
+		ns_->loading_.itemsCount++;
+		ns_->loading_.dataSize += rec.data.size();
+	}
+	if (storePrefix_ && ns_->storage_) storeBatch(*storePrefix_, batch);
+}
+
+void NsLoader::storeBatch(const string &prefix, Batch &batch) {
+	WrSerializer pk;
+	std::lock_guard<std::mutex> storageLock(ns_->storage_mtx_);
+	for (auto &rec : batch.records) {
+		if (rec.id < 0) continue;
+		pk.Reset();
+		pk << prefix;
+		ConstPayload(ns_->payloadType_, ns_->items_[rec.id]).SerializeFields(pk, ns_->pkFields());
+		ns_->updates_->Put(pk.Slice(), rec.data);
+		ns_->unflushedCount_++;
+	}
+}
+
+void NsLoader::upsertIndex(int field, Batch &batch, VariantArray &krefs, VariantArray &skrefs) {
+	Index &index = *ns_->indexes_[field];
+	if (field >= ns_->indexes_.firstCompositePos()) {
+		for (auto &rec : batch.records) {
+			if (rec.id >= 0) index.Upsert(Variant(ns_->items_[rec.id]), rec.id);
+		}
+		return;
+	}
+
+	bool isIndexSparse = index.Opts().IsSparse();
+	bool isArray = !isIndexSparse && ns_->payloadType_.Field(field).IsArray();
+	for (auto &rec : batch.records) {
+		if (rec.id < 0) continue;
+		// Each worker sets only own field of payload, so arrays are not resized here: they already have the final size
+		Payload pl(ns_->payloadType_, ns_->items_[rec.id]);
+		if (isIndexSparse) {
+			pl.GetByJsonPath(index.Fields().getTagsPath(0), skrefs, index.KeyType());
+		} else {
+			pl.Get(field, skrefs);
+		}
+		if (index.Opts().GetCollateMode() == CollateUTF8)
+			for (auto &key : skrefs) key.EnsureUTF8();
+
+		krefs.resize(0);
+		krefs.reserve(skrefs.size());
+		for (auto key : skrefs) krefs.push_back(index.Upsert(key, rec.id));
+
+		if (isArray) {
+			for (size_t i = 0; i < krefs.size(); i++) pl.Set(field, i, krefs[i]);
+		} else if (!isIndexSparse && krefs.size()) {
+			pl.Set(field, krefs);
+		}
+		if (!skrefs.size()) index.Upsert(Variant(), rec.id);
+	}
+}
+
+}  // namespace reindexer
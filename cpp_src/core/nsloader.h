@@ -0,0 +1,80 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "core/keyvalue/variant.h"
+#include "core/payload/payloadvalue.h"
+#include "tools/errors.h"
+
+namespace reindexer {
+
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+class Namespace;
+class WorkerPool;
+
+/// Loader of namespace items from storage.<br>
+/// Loading is pipelined: reader stage reads raw records from storage, decoder stage decodes CJSON of records
+/// to payloads by several threads, and indexer stage puts payloads to namespace and inserts keys to indexes,
+/// each index by separate worker thread. Stages are connected by bounded queues of batches.<br>
+/// Namespace must be locked for write by caller during loading.
+class NsLoader {
+public:
+	/// @param ns - namespace to load items to.
+	/// @param threads - maximum amount of decoder and index worker threads. If 0, amount of hardware threads is used.
+	NsLoader(Namespace *ns, int threads = 0);
+
+	/// Load all items from storage of namespace
+	/// @param prefix - prefix of storage keys of items.
+	void operator()(const string &prefix);
+	/// Load items from records of snapshot, and put them to storage of namespace, if storage is enabled
+	/// @param records - records of items in storage format: LSN and CJSON of item.
+	/// @param prefix - prefix of storage keys of items.
+	void operator()(vector<string> &&records, const string &prefix);
+
+protected:
+	// Record of storage
+	struct Record {
+		string data;
+		int64_t lsn = 0;
+		PayloadValue value;
+		// Storage for tuple of payload, until it will be put to tuple index
+		string tuple;
+		IdType id = -1;
+		Error err;
+	};
+	struct Batch {
+		vector<Record> records;
+	};
+	typedef unique_ptr<Batch> BatchPtr;
+	// Bounded queue of batches between stages
+	class Queue;
+
+	void load(std::function<void(Queue &)> read);
+	// Calls f(i, worker) for each i in [0,count) by up to threads_ workers of pool. Exception of worker is rethrown to caller
+	void parallelFor(int count, const std::function<void(int, int)> &f);
+	void readStorage(const string &prefix, Queue &out);
+	void readRecords(vector<string> &records, Queue &out);
+	void storeBatch(const string &prefix, Batch &batch);
+	void decodeBatches(Queue &in, Queue &out);
+	void decodeBatch(Batch &batch);
+	void indexBatch(Batch &batch);
+	void upsertIndex(int field, Batch &batch, VariantArray &krefs, VariantArray &skrefs);
+
+	Namespace *ns_;
+	int threads_;
+	// Pool of decoder and index workers, which is kept during loading
+	WorkerPool *workers_ = nullptr;
+	// Indexes, which are filled in parallel on each step of indexer stage
+	vector<vector<int>> indexSteps_;
+	// Prefix of storage keys of loaded records, if records are put to storage
+	const string *storePrefix_ = nullptr;
+	size_t errCount_ = 0;
+	Error lastErr_;
+};
+
+}  // namespace reindexer
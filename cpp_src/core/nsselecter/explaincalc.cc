@@ -11,25 +11,26 @@ namespace reindexer {
 
 void ExplainCalc::LogDump(int logLevel) {
 	if (logLevel >= LogInfo) {
-		logPrintf(LogInfo, "Got %d items in %d µs [prepare %d µs, select %d µs, postprocess %d µs loop %d µs], sortindex %s", count_,
-				  to_us(total_), to_us(prepare_), to_us(select_), to_us(postprocess_), to_us(loop_), sortIndex_.data());
+		logPrintf(LogInfo, "Got %d items in %d µs [prepare %d µs, select %d µs, postprocess %d µs loop %d µs by %d threads], sortindex %s",
+				  count_, to_us(total_), to_us(prepare_), to_us(select_), to_us(postprocess_), to_us(loop_), loopThreads_, sortIndex_.data());
 	}
 
 	if (logLevel >= LogTrace) {
 		if (selectors_) {
 			for (SelectIterator &s : *selectors_) {
-				logPrintf(LogInfo, "%s: %d idsets, %d comparators, cost %g, matched %d, %s", s.name.c_str(), s.size(),
-						  s.comparators_.size(), s.Cost(iters_), s.GetMatchedCount(), s.Dump().c_str());
+				logPrintf(LogInfo, "%s: %d idsets, %d comparators, cost %g, estimated %d, matched %d, %s", s.name.c_str(), s.size(),
+						  s.comparators_.size(), s.Cost(iters_), int(s.estimatedRows), s.GetMatchedCount(), s.Dump().c_str());
 			}
 		}
 
 		if (jselectors_) {
 			for (auto &js : *jselectors_) {
 				if (js.type == JoinType::LeftJoin || js.type == JoinType::Merge) {
-					logPrintf(LogInfo, "%s %s: called %d\n", Query::JoinTypeName(js.type), js.ns.c_str(), js.called);
+					logPrintf(LogInfo, "%s %s (%s): called %d\n", Query::JoinTypeName(js.type), js.ns.c_str(), JoinStrategyName(js.strategy),
+							  js.called);
 				} else {
-					logPrintf(LogInfo, "%s %s: called %d, matched %d\n", Query::JoinTypeName(js.type), js.ns.c_str(), js.called,
-							  js.matched);
+					logPrintf(LogInfo, "%s %s (%s): called %d, matched %d\n", Query::JoinTypeName(js.type), js.ns.c_str(),
+							  JoinStrategyName(js.strategy), js.called, js.matched);
 				}
 			}
 		}
@@ -45,6 +46,7 @@ string ExplainCalc::GetJSON() {
 		json.Put("indexes_us", to_us(select_));
 		json.Put("postprocess_us", to_us(postprocess_));
 		json.Put("loop_us", to_us(loop_));
+		json.Put("loop_threads", loopThreads_);
 		json.Put("sort_index", sortIndex_);
 		auto jsonSelArr = json.Array("selectors");
 
@@ -57,6 +59,7 @@ string ExplainCalc::GetJSON() {
 					jsonSel.Put("keys", s.size());
 					jsonSel.Put("comparators", s.comparators_.size());
 					jsonSel.Put("cost", s.Cost(iters_));
+					if (s.estimatedRows >= 0) jsonSel.Put("estimated", s.estimatedRows);
 				} else
 					jsonSel.Put("items", s.GetMaxIterations());
 				jsonSel.Put("matched", s.GetMatchedCount());
@@ -69,6 +72,7 @@ string ExplainCalc::GetJSON() {
 				auto jsonSel = jsonSelArr.Object();
 				jsonSel.Put("field", js.ns);
 				jsonSel.Put("method", JoinTypeName(js.type));
+				jsonSel.Put("strategy", JoinStrategyName(js.strategy));
 				jsonSel.Put("matched", js.matched);
 			}
 		}
@@ -101,6 +105,17 @@ const char *ExplainCalc::JoinTypeName(JoinType type) {
 	}
 }
 
+const char *ExplainCalc::JoinStrategyName(int strategy) {
+	switch (strategy) {
+		case JoinedSelector::NestedLoop:
+			return "nested_loop";
+		case JoinedSelector::Hash:
+			return "hash";
+		default:
+			return "<unknown>";
+	}
+}
+
 void reindexer::ExplainCalc::StartTiming() {
 	if (enabled_) lap();
 }
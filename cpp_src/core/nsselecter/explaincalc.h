@@ -34,6 +34,7 @@ public:
 
 	void PutCount(int cnt) { count_ = cnt; }
 	void PutSortIndex(string_view index);
+	void PutLoopThreads(int threads) { loopThreads_ = threads; }
 	void PutSelectors(h_vector<SelectIterator> *qres);
 	void PutJoinedSelectors(JoinedSelectors *jselectors);
 
@@ -44,6 +45,7 @@ protected:
 	duration lap();
 	static int to_us(const duration &d);
 	static const char *JoinTypeName(JoinType jtype);
+	static const char *JoinStrategyName(int strategy);
 
 protected:
 	time_point last_point_, pause_point_;
@@ -53,6 +55,7 @@ protected:
 	h_vector<SelectIterator> *selectors_ = nullptr;
 	JoinedSelectors *jselectors_ = nullptr;
 	int iters_ = 0;
+	int loopThreads_ = 1;
 	int count_;
 	bool enabled_;
 	bool started_;
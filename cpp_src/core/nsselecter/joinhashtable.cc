@@ -0,0 +1,74 @@
+#include "joinhashtable.h"
+#include <algorithm>
+#include "core/payload/payloadiface.h"
+
+namespace reindexer {
+
+JoinHashTable::JoinHashTable(const PayloadType &payloadType, const h_vector<int, 2> &fields, const h_vector<KeyValueType, 2> &keyTypes)
+	: payloadType_(payloadType), fields_(fields), keyTypes_(keyTypes) {
+	assert(fields_.size() && fields_.size() == keyTypes_.size());
+}
+
+void JoinHashTable::Add(IdType id, const PayloadValue &value) {
+	assert(rows_.empty() || rows_.back().id < id);
+	int pos = rows_.size();
+	rows_.push_back(ItemRef(id, value));
+
+	VariantArray keys;
+	ConstPayload(payloadType_, value).Get(fields_[0], keys, true);
+	for (auto &key : keys) {
+		auto &positions = map_[key];
+		if (positions.empty() || positions.back() != pos) positions.push_back(pos);
+	}
+}
+
+bool JoinHashTable::Find(Keys &keys, unsigned limit, QueryResults &result) const {
+	assert(keys.size() == fields_.size());
+	for (size_t i = 0; i < keys.size(); ++i) {
+		if (keys[i].empty()) return false;
+		for (auto &key : keys[i]) key.convert(keyTypes_[i]);
+	}
+
+	h_vector<int, 16> matched;
+	for (auto &key : keys[0]) {
+		auto it = map_.find(key);
+		if (it != map_.end()) matched.insert(matched.end(), it->second.begin(), it->second.end());
+	}
+	// Keep order of rowIds, the same as nested select does
+	if (keys[0].size() > 1) {
+		std::sort(matched.begin(), matched.end());
+		matched.erase(std::unique(matched.begin(), matched.end()), matched.end());
+	}
+
+	bool found = false;
+	for (int pos : matched) {
+		const ItemRef &row = rows_[pos];
+		bool match = true;
+		for (size_t i = 1; i < fields_.size() && match; ++i) match = matchField(row, i, keys[i]);
+		if (!match) continue;
+
+		found = true;
+		if (!limit) break;
+		result.Add(row);
+		--limit;
+	}
+	return found;
+}
+
+size_t JoinHashTable::HeapSize() const {
+	// Positions of rows, which are not kept inline by map entries, take not more than one int per row
+	return rows_.capacity() * (sizeof(ItemRef) + sizeof(int)) + map_.bucket_count() * sizeof(std::pair<Variant, h_vector<int, 1>>);
+}
+
+bool JoinHashTable::matchField(const ItemRef &row, int fieldPos, const VariantArray &keys) const {
+	VariantArray values;
+	ConstPayload(payloadType_, row.value).Get(fields_[fieldPos], values);
+	for (auto &value : values) {
+		for (auto &key : keys) {
+			if (value == key) return true;
+		}
+	}
+	return false;
+}
+
+}  // namespace reindexer
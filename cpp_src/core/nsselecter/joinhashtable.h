@@ -0,0 +1,55 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "core/keyvalue/variant.h"
+#include "core/payload/payloadtype.h"
+#include "core/query/queryresults.h"
+#include "estl/fast_hash_map.h"
+#include "estl/h_vector.h"
+
+namespace reindexer {
+
+using std::shared_ptr;
+using std::vector;
+
+/// Hash table over rows of joined namespace, which is used instead of nested select for each row of main namespace.
+/// Table is kept in join cache of joined namespace, while joined namespace is not changed.
+/// Rows are hashed by values of 1-st join field, other join fields are checked on lookup.
+class JoinHashTable {
+public:
+	typedef shared_ptr<JoinHashTable> Ptr;
+	/// Values of main namespace item for each join field
+	typedef h_vector<VariantArray, 2> Keys;
+
+	/// @param payloadType - PayloadType of joined namespace.
+	/// @param fields - joined namespace field index for each join entry.
+	/// @param keyTypes - key type of each field.
+	JoinHashTable(const PayloadType &payloadType, const h_vector<int, 2> &fields, const h_vector<KeyValueType, 2> &keyTypes);
+
+	/// Adds row of joined namespace. Rows must be added in ascending order of ids
+	/// @param id - rowId of item.
+	/// @param value - payload of item.
+	void Add(IdType id, const PayloadValue &value);
+	/// Finds rows, matched to values of main namespace item.
+	/// @param keys - values of join fields of main namespace item. Will be converted to fields key types.
+	/// @param limit - maximum amount of rows to put to result.
+	/// @param result - QueryResults to put matched rows to.
+	/// @return true if at least one row was matched.
+	bool Find(Keys &keys, unsigned limit, QueryResults &result) const;
+	/// Amount of rows in table
+	size_t Size() const { return rows_.size(); }
+	/// Approximate size of table in memory
+	size_t HeapSize() const;
+
+protected:
+	bool matchField(const ItemRef &row, int fieldPos, const VariantArray &keys) const;
+
+	PayloadType payloadType_;
+	h_vector<int, 2> fields_;
+	h_vector<KeyValueType, 2> keyTypes_;
+	vector<ItemRef> rows_;
+	fast_hash_map<Variant, h_vector<int, 1>> map_;
+};
+
+}  // namespace reindexer
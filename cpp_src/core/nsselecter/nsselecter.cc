@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <sstream>
 
 #include "core/index/index.h"
@@ -6,6 +7,7 @@
 #include "nsselecter.h"
 #include "tools/logger.h"
 #include "tools/stringstools.h"
+#include "tools/workerpool.h"
 
 using std::chrono::high_resolution_clock;
 using std::next;
@@ -16,6 +18,16 @@ using std::stringstream;
 // Number of sorted queries to namespace after last updated, to call very expensive buildSortOrders, to do futher queries fast
 // If number of queries was less, than kBuildSortOrdersHitCount, then slow post process sort (applyGeneralSort) is
 const int kBuildSortOrdersHitCount = 5;
+// Condition, which is estimated to match more than kComparatorRowsRatio times rows, than the most selective condition,
+// is checked by comparator on rows of the most selective condition, instead of selecting its idsets
+const int64_t kComparatorRowsRatio = 16;
+// The most selective condition is selected by idsets, if it's estimated to match less than 1/kIdsetRowsRatio of namespace items
+const int64_t kIdsetRowsRatio = 8;
+// Minimal amount of extra results, collected before dropping of results, which are out of query limit, on sort after select loop
+const size_t kTopKMinCompactSize = 1024;
+// Amount of chunks of rows per thread of parallel select loop. Threads take next chunk, when they are done with previous one,
+// so chunks, which take more time, do not leave other threads idle
+const int kSelectChunksPerThread = 8;
 
 namespace reindexer {
 
@@ -50,6 +62,26 @@ void NsSelecter::operator()(QueryResults &result, SelectCtx &ctx) {
 	}
 
 	bool isFt = containsFullTextIndexes(*whereEntries);
+
+	// Full results are cached only for plain queries: results of joined, merged and fulltext queries depend on other data
+	QueryResultsCache::Iterator cachedResults;
+	if (!isFt && !ctx.preResult && !ctx.joinedSelectors && !ctx.nsid && ctx.query.joinQueries_.empty() &&
+		ctx.query.mergeQueries_.empty() && ctx.query.selectFunctions_.empty() && !ctx.query.explain_ && ns_->isResultsCacheEnabled()) {
+		cachedResults = ns_->resultsCache_->Get({ctx.query, SkipJoinQueries | SkipMergeQueries});
+		if (cachedResults.key && cachedResults.val.ids) {
+			result.addNSContext(ns_->payloadType_, ns_->tagsMatcher_, FieldsSet(ns_->tagsMatcher_, ctx.query.selectFilter_));
+			for (auto id : *cachedResults.val.ids) result.Add({id, ns_->items_[id], 0, ctx.nsid});
+			for (auto &ag : cachedResults.val.aggregationResults) result.aggregationResults.push_back(ag);
+			result.totalCount += cachedResults.val.totalCount;
+			logPrintf(LogTrace, "[*] using results from cache: %d items\t namespace: %s\n", int(cachedResults.val.ids->size()),
+					  ns_->name_.c_str());
+			return;
+		}
+	}
+	size_t resultsStart = result.Items().size();
+	size_t aggregationsStart = result.aggregationResults.size();
+	int totalCountStart = result.totalCount;
+
 	if (!ctx.skipIndexesLookup && !isFt) substituteCompositeIndexes(tmpWhereEntries);
 	convertWhereValues(*const_cast<QueryEntries *>(whereEntries));
 
@@ -79,7 +111,7 @@ void NsSelecter::operator()(QueryResults &result, SelectCtx &ctx) {
 	}
 
 	// Check if commit needed
-	bool needSortOrders = !sortBy.empty() && (ns_->sortedQueriesCount_ > kBuildSortOrdersHitCount || ctx.preResult || ctx.joinedSelectors);
+	bool needSortOrders = !sortBy.empty() && sortBy[0].index >= 0 && (ns_->sortedQueriesCount_ > kBuildSortOrdersHitCount || ctx.preResult || ctx.joinedSelectors);
 
 	if (!whereEntries->empty() || needSortOrders) {
 		FieldsSet indexesForCommit;
@@ -93,7 +125,7 @@ void NsSelecter::operator()(QueryResults &result, SelectCtx &ctx) {
 			if (indexesForCommit.contains(ns_->indexes_[i]->Fields())) indexesForCommit.push_back(i);
 		}
 		ns_->commit(Namespace::NSCommitContext(*ns_, CommitContext::MakeIdsets | (needSortOrders ? CommitContext::MakeSortOrders : 0),
-											   &indexesForCommit),
+											   &indexesForCommit, needSortOrders ? sortBy[0].index : IndexValueType::NotSet),
 					ctx.lockUpgrader);
 	}
 
@@ -122,6 +154,7 @@ void NsSelecter::operator()(QueryResults &result, SelectCtx &ctx) {
 
 	prepareIteratorsForSelectLoop(*whereEntries, qres, ctx.sortingCtx.firstColumnSortId, isFt);
 	prepareEqualPositionComparator(ctx.query, *whereEntries, qres);
+	combineBitmaps(qres);
 
 	explain.SetSelectTime();
 
@@ -215,16 +248,25 @@ void NsSelecter::operator()(QueryResults &result, SelectCtx &ctx) {
 	lctx.calcTotal = needCalcTotal;
 	if (isFt) result.haveProcent = true;
 	if (!sortingData.empty()) lctx.sortingCtxIdx = 0;  // Sort by 1st column first
-	if (reverse && hasComparators && hasScan) selectLoop<true, true, true>(lctx, result);
-	if (!reverse && hasComparators && hasScan) selectLoop<false, true, true>(lctx, result);
-	if (reverse && !hasComparators && hasScan) selectLoop<true, false, true>(lctx, result);
-	if (!reverse && !hasComparators && hasScan) selectLoop<false, false, true>(lctx, result);
-	if (reverse && hasComparators && !hasScan) selectLoop<true, true, false>(lctx, result);
-	if (!reverse && hasComparators && !hasScan) selectLoop<false, true, false>(lctx, result);
-	if (reverse && !hasComparators && !hasScan) selectLoop<true, false, false>(lctx, result);
-	if (!reverse && !hasComparators && !hasScan) selectLoop<false, false, false>(lctx, result);
+	lctx.threads = getLoopThreads(lctx, reverse);
+	if (lctx.threads > 1) {
+		if (hasComparators && hasScan) parallelSelectLoop<true, true>(lctx, result);
+		if (!hasComparators && hasScan) parallelSelectLoop<false, true>(lctx, result);
+		if (hasComparators && !hasScan) parallelSelectLoop<true, false>(lctx, result);
+		if (!hasComparators && !hasScan) parallelSelectLoop<false, false>(lctx, result);
+	} else {
+		if (reverse && hasComparators && hasScan) selectLoop<true, true, true>(lctx, result);
+		if (!reverse && hasComparators && hasScan) selectLoop<false, true, true>(lctx, result);
+		if (reverse && !hasComparators && hasScan) selectLoop<true, false, true>(lctx, result);
+		if (!reverse && !hasComparators && hasScan) selectLoop<false, false, true>(lctx, result);
+		if (reverse && hasComparators && !hasScan) selectLoop<true, true, false>(lctx, result);
+		if (!reverse && hasComparators && !hasScan) selectLoop<false, true, false>(lctx, result);
+		if (reverse && !hasComparators && !hasScan) selectLoop<true, false, false>(lctx, result);
+		if (!reverse && !hasComparators && !hasScan) selectLoop<false, false, false>(lctx, result);
+	}
 
 	explain.SetLoopTime();
+	explain.PutLoopThreads(lctx.threads);
 	explain.StopTiming();
 	explain.PutSortIndex(!sortingData.empty() && sortingData[0].index ? sortingData[0].index->Name() : "-"_sv);
 	explain.PutCount((ctx.preResult && ctx.preResult->mode == SelectCtx::PreResult::ModeBuild) ? ctx.preResult->ids.size()
@@ -245,7 +287,20 @@ void NsSelecter::operator()(QueryResults &result, SelectCtx &ctx) {
 
 	if (needPutCachedTotal) {
 		logPrintf(LogTrace, "[*] put totalCount value into query cache: %d\t namespace: %s\n", result.totalCount, ns_->name_.c_str());
-		ns_->queryCache_->Put({ctx.query}, {static_cast<size_t>(result.totalCount)});
+		ns_->queryCache_->Put({ctx.query}, {static_cast<size_t>(result.totalCount), ns_->getQueryIndexes(ctx.query)});
+	}
+	if (cachedResults.key) {
+		QueryResultsCacheVal val;
+		val.ids = std::make_shared<IdSet>();
+		val.ids->reserve(result.Items().size() - resultsStart);
+		for (auto it = result.Items().begin() + resultsStart; it != result.Items().end(); ++it) val.ids->Add(it->id, IdSet::Unordered);
+		val.aggregationResults.assign(result.aggregationResults.begin() + aggregationsStart, result.aggregationResults.end());
+		val.totalCount = result.totalCount - totalCountStart;
+		val.indexes = ns_->getQueryIndexes(ctx.query);
+		int idxNo;
+		for (auto &ag : ctx.query.aggregations_) val.indexes.push_back(ns_->getIndexByName(ag.index_, idxNo) ? idxNo : 0);
+		logPrintf(LogTrace, "[*] put results into cache: %d items\t namespace: %s\n", int(val.ids->size()), ns_->name_.c_str());
+		ns_->resultsCache_->Put({ctx.query, SkipJoinQueries | SkipMergeQueries}, val);
 	}
 	if (ctx.preResult && ctx.preResult->mode == SelectCtx::PreResult::ModeBuild) {
 		ctx.preResult->mode = SelectCtx::PreResult::ModeIdSet;
@@ -255,7 +310,7 @@ void NsSelecter::operator()(QueryResults &result, SelectCtx &ctx) {
 	}
 }
 
-void NsSelecter::applyCustomSort(ItemRefVector &queryResult, const SelectCtx &ctx) {
+NsSelecter::ItemIterator NsSelecter::applyCustomSort(ItemRefVector &queryResult, const SelectCtx &ctx) {
 	if (ctx.query.mergeQueries_.size() > 1) throw Error(errLogic, "Force sort could not be applied to 'merged' queries.");
 
 	assert(!ctx.query.sortingEntries_.empty());
@@ -301,6 +356,7 @@ void NsSelecter::applyCustomSort(ItemRefVector &queryResult, const SelectCtx &ct
 
 					  return sortMap.find(firstItemValue[0])->second < sortMap.find(secondItemValue[0])->second;
 				  });
+		return sortEnd;
 	} else {
 		// implementation for composite indexes
 		FieldsSet fields = ns_->indexes_[idx]->Fields();
@@ -320,9 +376,19 @@ void NsSelecter::applyCustomSort(ItemRefVector &queryResult, const SelectCtx &ct
 		std::sort(queryResult.begin(), sortEnd, [&sortMap](const ItemRef &lhs, const ItemRef &rhs) {
 			return sortMap.find(lhs.value)->second < sortMap.find(rhs.value)->second;
 		});
+		return sortEnd;
 	}
 }
 
+template <typename T>
+static void sortByColumn(ItemRefVector::iterator itFirst, ItemRefVector::iterator itLast, ItemRefVector::iterator itEnd, const void *columnData,
+						 bool desc) {
+	const T *column = static_cast<const T *>(columnData);
+	std::partial_sort(itFirst, itLast, itEnd, [column, desc](const ItemRef &lhs, const ItemRef &rhs) {
+		return desc ? (column[rhs.id] < column[lhs.id]) : (column[lhs.id] < column[rhs.id]);
+	});
+}
+
 void NsSelecter::applyGeneralSort(ConstItemIterator itFirst, ConstItemIterator itLast, ConstItemIterator itEnd, const SelectCtx &ctx) {
 	if (ctx.query.mergeQueries_.size() > 1) {
 		throw Error(errLogic, "Sorting cannot be applied to merged queries.");
@@ -371,6 +437,27 @@ void NsSelecter::applyGeneralSort(ConstItemIterator itFirst, ConstItemIterator i
 		collateOpts.push_back(ctx.sortingCtx.entries[i].opts);
 	}
 
+	// Sort by single scalar index, which keeps column, compares values from column instead of payloads
+	int sortIdx = ctx.sortingCtx.entries[0].data->index;
+	if (!multiSort && sortIdx >= 0 && sortIdx < ns_->indexes_.firstCompositePos() && !ns_->indexes_[sortIdx]->Opts().IsSparse()) {
+		const void *column = ns_->indexes_[sortIdx]->ColumnData();
+		bool desc = ctx.sortingCtx.entries[0].data->desc;
+		if (column) {
+			switch (payloadType->Field(sortIdx).Type()) {
+				case KeyValueBool:
+					return sortByColumn<bool>(itFirst, itLast, itEnd, column, desc);
+				case KeyValueInt:
+					return sortByColumn<int>(itFirst, itLast, itEnd, column, desc);
+				case KeyValueInt64:
+					return sortByColumn<int64_t>(itFirst, itLast, itEnd, column, desc);
+				case KeyValueDouble:
+					return sortByColumn<double>(itFirst, itLast, itEnd, column, desc);
+				default:
+					break;
+			}
+		}
+	}
+
 	std::partial_sort(itFirst, itLast, itEnd, [&payloadType, &fields, &collateOpts, &ctx](const ItemRef &lhs, const ItemRef &rhs) {
 		size_t firstDifferentFieldIdx = 0;
 		int cmpRes = ConstPayload(payloadType, lhs.value).Compare(rhs.value, fields, firstDifferentFieldIdx, collateOpts);
@@ -387,6 +474,15 @@ void NsSelecter::applyGeneralSort(ConstItemIterator itFirst, ConstItemIterator i
 	});
 }
 
+void NsSelecter::sortResults(ItemRefVector &queryResult, size_t limit, const SelectCtx &ctx) {
+	// Items with forced sort order are placed first, and the rest of items are sorted by general sort
+	ItemIterator first = queryResult.begin();
+	if (!ctx.query.forcedSortOrder.empty()) first = applyCustomSort(queryResult, ctx);
+	size_t forced = first - queryResult.begin();
+	size_t rest = limit > forced ? std::min(limit - forced, size_t(queryResult.end() - first)) : 0;
+	applyGeneralSort(first, first + rest, queryResult.end(), ctx);
+}
+
 void NsSelecter::setLimitAndOffset(ItemRefVector &queryResult, size_t offset, size_t limit) {
 	const unsigned totalRows = queryResult.size();
 	if (offset > 0) {
@@ -398,6 +494,14 @@ void NsSelecter::setLimitAndOffset(ItemRefVector &queryResult, size_t offset, si
 	}
 }
 
+void NsSelecter::eraseJoined(QueryResults &result, size_t from, size_t to) {
+	if (result.joined_.empty()) return;
+	for (size_t i = from; i < to; ++i) {
+		auto &item = result.Items()[i];
+		if (item.nsid < result.joined_.size()) result.joined_[item.nsid].erase(item.id);
+	}
+}
+
 bool NsSelecter::containsFullTextIndexes(const QueryEntries &entries) {
 	bool result = false;
 	for (const QueryEntry &entry : entries) {
@@ -455,8 +559,57 @@ void NsSelecter::convertWhereValues(QueryEntries &entries) {
 	}
 }
 
+vector<NsSelecter::EntryPlan> NsSelecter::planQueryEntries(const QueryEntries &entries, SortType sortId) {
+	vector<EntryPlan> plans(entries.size());
+	// Only standalone AND conditions are planned. Conditions of OR groups, NOT and distinct are selected by index heuristics
+	auto isPlanned = [&](size_t i) {
+		const QueryEntry &qe = entries[i];
+		return qe.op == OpAnd && !qe.distinct && plans[i].estimatedRows >= 0 && (i + 1 == entries.size() || entries[i + 1].op != OpOr);
+	};
+
+	int64_t minRows = -1;
+	size_t driver = 0;
+	for (size_t i = 0; i < entries.size(); ++i) {
+		const QueryEntry &qe = entries[i];
+		if (qe.idxNo == IndexValueType::SetByJsonPath || isFullText(ns_->indexes_[qe.idxNo]->Type())) continue;
+		plans[i].estimatedRows = ns_->indexes_[qe.idxNo]->EstimateRows(qe.values, qe.condition);
+		if (isPlanned(i) && (minRows < 0 || plans[i].estimatedRows < minRows)) {
+			minRows = plans[i].estimatedRows;
+			driver = i;
+		}
+	}
+	if (minRows < 0) return plans;
+
+	int64_t itemsCount = ns_->items_.size() - ns_->free_.size();
+	for (size_t i = 0; i < entries.size(); ++i) {
+		if (!isPlanned(i)) continue;
+		auto &index = ns_->indexes_[entries[i].idxNo];
+		// Range of index, which is used for sorting, is selected as single range of sort orders
+		if (sortId && index->SortId() == sortId) continue;
+		if (i == driver) {
+			// The most selective condition drives select loop, so it's selected by idsets,
+			// even if index prefers comparator because of amount of keys in range
+			if (index->IsOrdered() && plans[i].estimatedRows * kIdsetRowsRatio < itemsCount) plans[i].strategy = Index::ForceIdset;
+		} else if (plans[i].estimatedRows > minRows * kComparatorRowsRatio && !index->Opts().IsSparse() && !isComposite(index->Type())) {
+			// It's cheaper to check condition on rows of driver, than to merge its idsets
+			plans[i].strategy = Index::ForceComparator;
+		}
+	}
+	return plans;
+}
+
 void NsSelecter::prepareIteratorsForSelectLoop(const QueryEntries &entries, RawQueryResult &result, unsigned sortId, bool is_ft) {
 	bool fullText = false;
+	vector<EntryPlan> plans = is_ft ? vector<EntryPlan>(entries.size()) : planQueryEntries(entries, sortId);
+
+	// Idsets do not keep copies of ids, sorted by sort index: other indexes select rowIds,
+	// which are converted to positions in sort orders by ranks of rows in sort index
+	const Index *sortIndex = nullptr;
+	if (sortId && ns_->onDemandSortedIds_) {
+		for (auto &index : ns_->indexes_) {
+			if (index->IsOrdered() && index->SortId() == sortId && !index->SortRanks().empty()) sortIndex = index.get();
+		}
+	}
 	for (size_t i = 0; i < entries.size(); ++i) {
 		const QueryEntry &qe(entries[i]);
 		TagsPath tagsPath;
@@ -477,7 +630,7 @@ void NsSelecter::prepareIteratorsForSelectLoop(const QueryEntries &entries, RawQ
 			fullText = isFullText(index->Type());
 			sparseIndex = index->Opts().IsSparse();
 
-			Index::ResultType type = Index::Optimal;
+			Index::ResultType type = plans[i].strategy;
 			if (is_ft && qe.distinct) throw Error(errQueryExec, "distinct and full text - can't do it");
 			if (is_ft)
 				type = Index::ForceComparator;
@@ -493,7 +646,11 @@ void NsSelecter::prepareIteratorsForSelectLoop(const QueryEntries &entries, RawQ
 			{
 				PerfStatCalculatorST calc(index->GetSelectPerfCounter(), ns_->enablePerfCounters_);
 				calc.LockHit();
-				selectResults = index->SelectKey(qe.values, qe.condition, sortId, type, ctx);
+				bool mapToSortRanks = sortIndex && index.get() != sortIndex && !fullText;
+				selectResults = index->SelectKey(qe.values, qe.condition, mapToSortRanks ? 0 : sortId, type, ctx);
+				if (mapToSortRanks) {
+					for (auto &res : selectResults) res.MapToSortRanks(sortIndex->SortRanks());
+				}
 			}
 		}
 		for (SelectKeyResult &res : selectResults) {
@@ -507,10 +664,14 @@ void NsSelecter::prepareIteratorsForSelectLoop(const QueryEntries &entries, RawQ
 					}
 					result.back().distinct |= qe.distinct;
 					result.back().name += " OR " + qe.index;
+					if (result.back().estimatedRows >= 0) {
+						result.back().estimatedRows = plans[i].estimatedRows >= 0 ? result.back().estimatedRows + plans[i].estimatedRows : -1;
+					}
 					break;
 				case OpNot:
 				case OpAnd:
 					result.push_back(SelectIterator(res, qe.op, qe.distinct, qe.index, fullText));
+					result.back().estimatedRows = plans[i].estimatedRows;
 					if (!byJsonPath && !sparseIndex) {
 						result.back().Bind(ns_->payloadType_, qe.idxNo);
 					}
@@ -525,6 +686,46 @@ void NsSelecter::prepareIteratorsForSelectLoop(const QueryEntries &entries, RawQ
 	}
 }
 
+void NsSelecter::combineBitmaps(RawQueryResult &qres) {
+	auto isCombinable = [](const SelectIterator &it) {
+		return it.bitmap_ && it.comparators_.empty() && !it.distinct && (it.op == OpAnd || it.op == OpNot);
+	};
+	int count = 0, andCount = 0;
+	for (auto &it : qres) {
+		if (!isCombinable(it)) continue;
+		count++;
+		if (it.op == OpAnd) andCount++;
+	}
+	if (count < 2 || !andCount) return;
+
+	// Intersect conditions by bitmaps operations, and use single idset instead of them in selectLoop
+	IdSetBitmap combined;
+	string name;
+	bool first = true;
+	for (auto &it : qres) {
+		if (!isCombinable(it) || it.op != OpAnd) continue;
+		if (first) {
+			combined = *it.bitmap_;
+			first = false;
+		} else {
+			combined.And(*it.bitmap_);
+			name += " AND ";
+		}
+		name += it.name;
+	}
+	for (auto &it : qres) {
+		if (!isCombinable(it) || it.op != OpNot) continue;
+		combined.AndNot(*it.bitmap_);
+		name += " AND NOT " + it.name;
+	}
+	qres.erase(std::remove_if(qres.begin(), qres.end(), isCombinable), qres.end());
+
+	SelectKeyResult res;
+	res.push_back(SingleSelectKeyResult(combined.ToIdSet()));
+	qres.push_back(SelectIterator(res, OpAnd, false, name));
+	qres.back().estimatedRows = combined.Size();
+}
+
 void NsSelecter::prepareEqualPositionComparator(const Query &query, const QueryEntries &entries, RawQueryResult &result) {
 	if (query.equalPositions_.empty()) return;
 	for (const EqualPosition &ep : query.equalPositions_) {
@@ -585,6 +786,131 @@ bool NsSelecter::proccessJoin(SelectCtx &sctx, IdType properRowId, bool found, b
 	return found;
 }
 
+template <bool reverse, bool hasComparators>
+bool NsSelecter::checkRowConditions(RawQueryResult &qres, IdType &rowId, IdType properRowId, bool &finish) {
+	bool found = true;
+	assert(static_cast<size_t>(properRowId) < ns_->items_.size());
+	assert(ns_->items_[properRowId].Ptr());
+	for (auto cur = qres.begin() + 1; cur != qres.end(); cur++) {
+		if (!hasComparators || !cur->TryCompare(ns_->items_, properRowId)) {
+			while (((reverse && cur->Val() > rowId) || (!reverse && cur->Val() < rowId)) && cur->Next(rowId)) {
+			};
+			if (cur->End()) {
+				finish = true;
+				found = false;
+			} else if ((reverse && cur->Val() < rowId) || (!reverse && cur->Val() > rowId)) {
+				found = false;
+			}
+		}
+		bool isNot = cur->op == OpNot;
+		if ((isNot && found) || (!isNot && !found)) {
+			found = false;
+			for (; cur != qres.end(); cur++) {
+				if (cur->comparators_.size() || cur->op == OpNot || cur->End()) continue;
+				if (reverse && cur->Val() < rowId) rowId = cur->Val() + 1;
+				if (!reverse && cur->Val() > rowId) rowId = cur->Val() - 1;
+			}
+			break;
+		} else if (isNot && !found) {
+			found = true;
+			finish = false;
+		}
+	}
+	return found;
+}
+
+int NsSelecter::getLoopThreads(const LoopCtx &ctx, bool reverse) {
+	const SelectCtx &sctx = ctx.sctx;
+	if (!sctx.workers || sctx.parallelThreshold <= 0 || reverse || ctx.ftIndex) return 1;
+	// Joins, distincts, merges and building of preresults depend on order of rows processing
+	if (sctx.preResult || sctx.joinedSelectors || sctx.reqMatchedOnceFlag || sctx.nsid || !sctx.query.mergeQueries_.empty()) return 1;
+	for (auto &r : *ctx.qres) {
+		if (r.distinct) return 1;
+	}
+	// Rows are iterated in order of sort index, and loop is stopped by limit
+	if (ctx.sortingCtxIdx != IndexValueType::NotSet && sctx.sortingCtx.entries[ctx.sortingCtxIdx].index) return 1;
+	// Loop is stopped by limit, if all the matched rows are not needed
+	bool needAllRows = sctx.isForceAll || sctx.query.count == UINT_MAX || ctx.calcTotal || !sctx.query.aggregations_.empty();
+	if (!needAllRows || (*ctx.qres)[0].GetMaxIterations() < sctx.parallelThreshold) return 1;
+	return sctx.workers->Concurrency();
+}
+
+template <bool hasComparators, bool hasScan>
+void NsSelecter::parallelSelectLoop(LoopCtx &ctx, QueryResults &result) {
+	SelectCtx &sctx = ctx.sctx;
+	// Rows of namespace are split to ranges with about equal amount of ids of the first iterator,
+	// each range is processed by worker with own copy of iterators
+	int chunks = ctx.threads * kSelectChunksPerThread;
+	IdType rowsCount = ns_->items_.size();
+	vector<IdType> bounds;
+	(*ctx.qres)[0].SplitIds(chunks, bounds);
+	if (bounds.empty()) {
+		for (int i = 1; i < chunks; i++) bounds.push_back(int64_t(rowsCount) * i / chunks);
+	}
+	bounds.insert(bounds.begin(), 0);
+	bounds.push_back(rowsCount);
+	vector<LoopChunkResult> chunkResults(chunks);
+	sctx.workers->Run(chunks, [&](int i) { selectLoopChunk<hasComparators, hasScan>(ctx, bounds[i], bounds[i + 1], chunkResults[i]); });
+
+	ItemRefVector &items = result.Items();
+	auto aggregators = getAggregators(sctx.query);
+	for (auto &chunk : chunkResults) {
+		// Ranges of chunks are sequential, so merged items are ordered by rowId, same as after serial loop
+		for (auto &item : chunk.items) result.Add(item);
+		for (size_t i = 0; i < aggregators.size(); i++) aggregators[i].Merge(chunk.aggregators[i]);
+		for (size_t i = 0; i < ctx.qres->size(); i++) (*ctx.qres)[i].AddMatchedCount(chunk.matchedCounts[i]);
+		if (ctx.calcTotal) result.totalCount += chunk.totalCount;
+		if (chunk.totalCount) sctx.matchedAtLeastOnce = true;
+	}
+
+	if (ctx.sortingCtxIdx != IndexValueType::NotSet) {
+		sortResults(items, size_t(sctx.query.start) + sctx.query.count, sctx);
+		setLimitAndOffset(items, sctx.query.start, sctx.query.count);
+	} else if (!sctx.isForceAll) {
+		setLimitAndOffset(items, sctx.query.start, sctx.query.count);
+	}
+
+	for (auto &aggregator : aggregators) {
+		result.aggregationResults.push_back(aggregator.GetResult());
+	}
+}
+
+template <bool hasComparators, bool hasScan>
+void NsSelecter::selectLoopChunk(LoopCtx &ctx, IdType from, IdType to, LoopChunkResult &res) {
+	SelectCtx &sctx = ctx.sctx;
+	RawQueryResult qres = *ctx.qres;
+	for (auto &r : qres) r.Seek(from);
+	res.aggregators = getAggregators(sctx.query);
+
+	// Each chunk keeps only rows, which may get to result after limit: the first start+count rows, if rows are not sorted,
+	// or the best start+count rows, if rows are sorted after loop
+	bool isUnordered = ctx.sortingCtxIdx != IndexValueType::NotSet;
+	size_t limit = sctx.isForceAll && !isUnordered ? SIZE_MAX : size_t(sctx.query.start) + sctx.query.count;
+	size_t topKCompactSize = isUnordered && sctx.query.count != UINT_MAX ? std::max(limit * 2, limit + kTopKMinCompactSize) : 0;
+
+	auto &first = qres[0];
+	IdType rowId = from;
+	bool finish = false;
+	while (!finish && first.Next(rowId)) {
+		rowId = first.Val();
+		if (rowId >= to) break;
+		if (hasScan && ns_->items_[rowId].IsFree()) continue;
+		if (!checkRowConditions<false, hasComparators>(qres, rowId, rowId, finish)) continue;
+
+		res.totalCount++;
+		if (res.aggregators.size()) {
+			for (auto &aggregator : res.aggregators) aggregator.Aggregate(ns_->items_[rowId], rowId);
+		} else if (isUnordered || res.items.size() < limit) {
+			res.items.push_back({rowId, ns_->items_[rowId], 0, sctx.nsid});
+			if (topKCompactSize && res.items.size() >= topKCompactSize) {
+				sortResults(res.items, limit, sctx);
+				res.items.erase(res.items.begin() + limit, res.items.end());
+			}
+		}
+	}
+	for (size_t i = 0; i < qres.size(); i++) res.matchedCounts.push_back(qres[i].GetMatchedCount() - (*ctx.qres)[i].GetMatchedCount());
+}
+
 template <bool reverse, bool hasComparators, bool hasScan>
 void NsSelecter::selectLoop(LoopCtx &ctx, QueryResults &result) {
 	unsigned start = 0;
@@ -632,6 +958,14 @@ void NsSelecter::selectLoop(LoopCtx &ctx, QueryResults &result) {
 	VariantArray prevValues;
 	size_t multisortLimitLeft = 0, multisortLimitRight = 0;
 
+	// Results are sorted after loop, so only start+count best items are needed.
+	// Keep them bounded: when results grow up to topKCompactSize, partially sort them and drop the tail
+	size_t topK = size_t(sctx.query.start) + sctx.query.count;
+	size_t topKCompactSize = 0;
+	if (isUnordered && sctx.query.count != UINT_MAX && !aggregators.size()) {
+		topKCompactSize = std::max(topK * 2, topK + kTopKMinCompactSize);
+	}
+
 	// TODO: nested conditions support. Like (A  OR B OR C) AND (X OR Z)
 	assert(!firstSortIndex || firstSortIndex->IsOrdered());
 	auto &first = *ctx.qres->begin();
@@ -646,35 +980,7 @@ void NsSelecter::selectLoop(LoopCtx &ctx, QueryResults &result) {
 			properRowId = firstSortIndex->SortOrders()[rowId];
 		}
 
-		bool found = true;
-		assert(static_cast<size_t>(properRowId) < ns_->items_.size());
-		PayloadValue &pv = ns_->items_[properRowId];
-		assert(pv.Ptr());
-		for (auto cur = ctx.qres->begin() + 1; cur != ctx.qres->end(); cur++) {
-			if (!hasComparators || !cur->TryCompare(pv, properRowId)) {
-				while (((reverse && cur->Val() > rowId) || (!reverse && cur->Val() < rowId)) && cur->Next(rowId)) {
-				};
-				if (cur->End()) {
-					finish = true;
-					found = false;
-				} else if ((reverse && cur->Val() < rowId) || (!reverse && cur->Val() > rowId)) {
-					found = false;
-				}
-			}
-			bool isNot = cur->op == OpNot;
-			if ((isNot && found) || (!isNot && !found)) {
-				found = false;
-				for (; cur != ctx.qres->end(); cur++) {
-					if (cur->comparators_.size() || cur->op == OpNot || cur->End()) continue;
-					if (reverse && cur->Val() < rowId) rowId = cur->Val() + 1;
-					if (!reverse && cur->Val() > rowId) rowId = cur->Val() - 1;
-				}
-				break;
-			} else if (isNot && !found) {
-				found = true;
-				finish = false;
-			}
-		}
+		bool found = checkRowConditions<reverse, hasComparators>(*ctx.qres, rowId, properRowId, finish);
 
 		if (found && sctx.joinedSelectors) {
 			found = proccessJoin(sctx, properRowId, found, !start && count, hasInnerJoin);
@@ -698,6 +1004,7 @@ void NsSelecter::selectLoop(LoopCtx &ctx, QueryResults &result) {
 				} else {
 					if (recentValues != prevValues) {
 						if (start) {
+							eraseJoined(result, 0, result.Items().size());
 							result.Items().clear();
 							multisortLimitLeft = 0;
 							lastResSize = 0;
@@ -722,6 +1029,11 @@ void NsSelecter::selectLoop(LoopCtx &ctx, QueryResults &result) {
 				--start;
 			} else if (count) {
 				addSelectResult(proc, rowId, properRowId, sctx, aggregators, result);
+				if (topKCompactSize && result.Items().size() >= topKCompactSize) {
+					sortResults(result.Items(), topK, sctx);
+					eraseJoined(result, topK, result.Items().size());
+					result.Items().erase(result.Items().begin() + topK, result.Items().end());
+				}
 				--count;
 				if (!count && multiSort && !multisortFinished) getSortIndexValue(sortCtx, properRowId, prevValues);
 			}
@@ -731,20 +1043,11 @@ void NsSelecter::selectLoop(LoopCtx &ctx, QueryResults &result) {
 	}
 
 	if (multiSort || isUnordered) {
-		int endPos = result.Items().size();
-		if (isUnordered) {
-			endPos = std::min(sctx.query.count + sctx.query.start, result.Items().size());
-		}
-		ItemIterator first = result.Items().begin();
-		ItemIterator last = result.Items().begin() + endPos;
-		ItemIterator end = result.Items().end();
-		applyGeneralSort(first, last, end, sctx);
-
-		if (!ctx.sctx.query.forcedSortOrder.empty()) {
-			applyCustomSort(result.Items(), sctx);
-		}
+		sortResults(result.Items(), isUnordered ? topK : result.Items().size(), sctx);
 
 		const size_t offset = isUnordered ? sctx.query.start : multisortLimitLeft;
+		eraseJoined(result, 0, std::min(offset, size_t(result.Items().size())));
+		if (result.Items().size() > offset + sctx.query.count) eraseJoined(result, offset + sctx.query.count, result.Items().size());
 		setLimitAndOffset(result.Items(), offset, sctx.query.count);
 	}
 
@@ -774,7 +1077,7 @@ void NsSelecter::getSortIndexValue(const SelectCtx::SortingCtx::Entry *sortCtx,
 void NsSelecter::addSelectResult(uint8_t proc, IdType rowId, IdType properRowId, const SelectCtx &sctx,
 								 h_vector<Aggregator, 4> &aggregators, QueryResults &result) {
 	if (aggregators.size()) {
-		for (auto &aggregator : aggregators) aggregator.Aggregate(ns_->items_[properRowId]);
+		for (auto &aggregator : aggregators) aggregator.Aggregate(ns_->items_[properRowId], properRowId);
 	} else if (sctx.preResult && sctx.preResult->mode == SelectCtx::PreResult::ModeBuild) {
 		sctx.preResult->ids.Add(rowId, IdSet::Unordered);
 	} else {
@@ -793,7 +1096,7 @@ h_vector<Aggregator, 4> NsSelecter::getAggregators(const Query &q) {
 			if (ns_->indexes_[idx]->Opts().IsSparse()) {
 				ret.back().Bind(ns_->payloadType_, -1, ns_->indexes_[idx]->Fields().getTagsPath(0));
 			} else {
-				ret.back().Bind(ns_->payloadType_, idx, TagsPath());
+				ret.back().Bind(ns_->payloadType_, idx, TagsPath(), ns_->indexes_[idx]->ColumnData());
 			}
 		} else {
 			ret.back().Bind(ns_->payloadType_, -1, ns_->tagsMatcher_.path2tag(ag.index_));
@@ -918,13 +1221,13 @@ void NsSelecter::prepareSortingContext(const SortingEntries &sortBy, SelectCtx &
 			sortingCtx.index = sortIndex;
 
 			if (sortIndex->IsOrdered() && i == 0) {
-				if (ctx.sortingCtx.entries.empty() && ns_->sortOrdersBuilt_) {
+				if (ctx.sortingCtx.entries.empty() && ns_->sortedIndexes_.contains(sortingEntry.index)) {
 					ctx.sortingCtx.firstColumnSortId = sortIndex->SortId();
 				}
 				ns_->sortedQueriesCount_++;
 			}
 
-			if (!sortIndex->IsOrdered() || isFt || !ns_->sortOrdersBuilt_) {
+			if (!sortIndex->IsOrdered() || isFt || !ns_->sortedIndexes_.contains(sortingEntry.index)) {
 				if (i == 0) ctx.isForceAll = true;
 				sortingCtx.isOrdered = false;
 				sortingCtx.index = nullptr;  // TODO: get rid of this magic in the future
@@ -933,6 +1236,7 @@ void NsSelecter::prepareSortingContext(const SortingEntries &sortBy, SelectCtx &
 			sortingCtx.opts = sortIndex->Opts().collateOpts_;
 			ctx.sortingCtx.entries.push_back(std::move(sortingCtx));
 		} else if (sortingEntry.index == IndexValueType::SetByJsonPath) {
+			if (i == 0) ctx.isForceAll = true;
 			SelectCtx::SortingCtx::Entry sortingCtx;
 			sortingCtx.data = &sortingEntry;
 			sortingCtx.isOrdered = false;
@@ -2,6 +2,7 @@
 #include <chrono>
 #include <functional>
 #include "core/aggregator.h"
+#include "core/index/index.h"
 #include "core/nsselecter/selectiterator.h"
 #include "core/query/query.h"
 #include "core/query/queryresults.h"
@@ -18,15 +19,19 @@ using std::chrono::microseconds;
 
 struct JoinedSelector {
 	typedef std::function<bool(IdType, int nsId, ConstPayload, bool)> FuncType;
+	enum Strategy { NestedLoop, Hash };
 	JoinType type;
 	bool nodata;
 	FuncType func;
 	int called, matched;
 	string ns;
+	Strategy strategy;
 };
 
 typedef vector<JoinedSelector> JoinedSelectors;
 
+class WorkerPool;
+
 class SelectLockUpgrader {
 public:
 	virtual ~SelectLockUpgrader() = default;
@@ -43,6 +48,10 @@ struct SelectCtx {
 	bool skipIndexesLookup = false;
 	SelectLockUpgrader *lockUpgrader;
 	SelectFunctionsHolder *functions = nullptr;
+	// Pool of workers for parallel select loop, or nullptr if parallel select is disabled
+	WorkerPool *workers = nullptr;
+	// Minimum amount of expected iterations of select loop to execute it by workers
+	int parallelThreshold = 0;
 	struct PreResult {
 		enum Mode { ModeBuild, ModeIterators, ModeIdSet };
 
@@ -77,25 +86,52 @@ public:
 	void operator()(QueryResults &result, SelectCtx &ctx);
 
 private:
+	// Plan of condition: estimated amount of matched rows and strategy of select by index
+	struct EntryPlan {
+		int64_t estimatedRows = -1;
+		Index::ResultType strategy = Index::Optimal;
+	};
+
 	struct LoopCtx {
 		LoopCtx(SelectCtx &ctx) : sctx(ctx) {}
 		RawQueryResult *qres = nullptr;
 		bool ftIndex = false;
 		bool calcTotal = false;
 		int sortingCtxIdx = IndexValueType::NotSet;
+		int threads = 1;
 		SelectCtx &sctx;
 	};
 
+	// Result of select loop over range of rowIds, executed by worker
+	struct LoopChunkResult {
+		ItemRefVector items;
+		h_vector<Aggregator, 4> aggregators;
+		vector<int> matchedCounts;
+		int totalCount = 0;
+	};
+
 	template <bool reverse, bool haveComparators, bool haveDistinct>
 	void selectLoop(LoopCtx &ctx, QueryResults &result);
-	void applyCustomSort(ItemRefVector &result, const SelectCtx &ctx);
+	template <bool haveComparators, bool haveScan>
+	void parallelSelectLoop(LoopCtx &ctx, QueryResults &result);
+	template <bool haveComparators, bool haveScan>
+	void selectLoopChunk(LoopCtx &ctx, IdType from, IdType to, LoopChunkResult &res);
+	template <bool reverse, bool haveComparators>
+	bool checkRowConditions(RawQueryResult &qres, IdType &rowId, IdType properRowId, bool &finish);
+	int getLoopThreads(const LoopCtx &ctx, bool reverse);
 
 	using ItemIterator = ItemRefVector::iterator;
 	using ConstItemIterator = const ItemIterator &;
+	// Returns end of items, which are found in forced sort order
+	ItemIterator applyCustomSort(ItemRefVector &result, const SelectCtx &ctx);
 	void applyGeneralSort(ConstItemIterator itFirst, ConstItemIterator itLast, ConstItemIterator itEnd, const SelectCtx &ctx);
+	// Sort first limit items of result by forced and general sort orders
+	void sortResults(ItemRefVector &result, size_t limit, const SelectCtx &ctx);
 
 	bool containsFullTextIndexes(const QueryEntries &entries);
 	void prepareIteratorsForSelectLoop(const QueryEntries &entries, RawQueryResult &result, SortType sortId, bool is_ft);
+	vector<EntryPlan> planQueryEntries(const QueryEntries &entries, SortType sortId);
+	void combineBitmaps(RawQueryResult &qres);
 	void prepareEqualPositionComparator(const Query &query, const QueryEntries &entries, RawQueryResult &result);
 	void addSelectResult(uint8_t proc, IdType rowId, IdType properRowId, const SelectCtx &sctx, h_vector<Aggregator, 4> &aggregators,
 						 QueryResults &result);
@@ -107,6 +143,8 @@ private:
 	int getCompositeIndex(const FieldsSet &fieldsmask);
 	bool mergeQueryEntries(QueryEntry *lhs, QueryEntry *rhs);
 	void setLimitAndOffset(ItemRefVector &result, size_t offset, size_t limit);
+	// Erases joined items of results [from, to), which are dropped from results
+	void eraseJoined(QueryResults &result, size_t from, size_t to);
 	KeyValueType detectQueryEntryIndexType(const QueryEntry &qentry) const;
 	void prepareSortingContext(const SortingEntries &sortBy, SelectCtx &ctx, bool isFt);
 	void prepareSortingIndexes(SortingEntries &sortBy);
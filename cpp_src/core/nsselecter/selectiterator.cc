@@ -5,6 +5,9 @@
 
 namespace reindexer {
 
+// Maximum amount of samples of ids, which are sorted to split iterator to parts
+const size_t kMaxSplitSamples = 1 << 16;
+
 using std::min;
 using std::max;
 
@@ -58,6 +61,9 @@ void SelectIterator::Start(bool reverse) {
 
 	lastVal_ = isReverse_ ? INT_MAX : INT_MIN;
 	type_ = isReverse_ ? Reverse : Forward;
+	batchBegin_ = batchEnd_ = 0;
+	lastComparedId_ = -2;
+	sequentialCount_ = 0;
 	if (isUnsorted) {
 		type_ = Unsorted;
 
@@ -72,6 +78,38 @@ void SelectIterator::Start(bool reverse) {
 	}
 }
 
+bool SelectIterator::compareBatch(const vector<PayloadValue> &items, IdType rowId) {
+	static constexpr int kMinSequentialRows = 8;
+	static constexpr int kMinBatchSize = 32;
+	static constexpr int kMaxBatchSize = 1024;
+	static constexpr int kMaxSequentialGap = 4;
+
+	// Batches are used only for rows, which are accessed densely in one direction, e.g. by scan or by dense idset.
+	// Rows, accessed by sort order or by sparse idset are compared one by one
+	int delta = isReverse_ ? lastComparedId_ - rowId : rowId - lastComparedId_;
+	bool sequential = delta > 0 && delta <= kMaxSequentialGap;
+	sequentialCount_ = sequential ? sequentialCount_ + 1 : 0;
+	if (distinct || sequentialCount_ < kMinSequentialRows) {
+		batchSize_ = kMinBatchSize;
+		for (auto &cmp : comparators_)
+			if (cmp.Compare(items[rowId], rowId)) return true;
+		return false;
+	}
+
+	if (isReverse_) {
+		batchBegin_ = max(0, rowId - batchSize_ + 1);
+		batchEnd_ = rowId + 1;
+	} else {
+		batchBegin_ = rowId;
+		batchEnd_ = min(int(items.size()), rowId + batchSize_);
+	}
+	batchMatched_.assign(batchEnd_ - batchBegin_, 0);
+	for (auto &cmp : comparators_) cmp.CompareBatch(items, batchBegin_, batchEnd_ - batchBegin_, batchMatched_.data());
+	// Grow batch while access is sequential, so small limits do not cause compare of many extra rows
+	batchSize_ = min(batchSize_ * 2, kMaxBatchSize);
+	return batchMatched_[rowId - batchBegin_];
+}
+
 // Generic next implementation
 bool SelectIterator::nextFwd(IdType minHint) {
 	if (minHint > lastVal_) lastVal_ = minHint - 1;
@@ -227,6 +265,49 @@ bool SelectIterator::nextUnsorted() {
 	return false;
 }
 
+void SelectIterator::Seek(IdType rowId) {
+	assert(!isReverse_);
+	for (auto it = begin(); it != end(); it++) {
+		if (it->isRange_) {
+			it->rIt_ = min(it->rEnd_, max(it->rIt_, rowId));
+		} else if (it->useBtree_) {
+			it->itset_ = it->set_->lower_bound(rowId);
+		} else {
+			it->it_ = std::lower_bound(it->it_, it->end_, rowId);
+		}
+	}
+}
+
+void SelectIterator::SplitIds(int parts, vector<IdType> &bounds) const {
+	bounds.clear();
+	if (parts < 2 || !comparators_.empty() || size() * parts > kMaxSplitSamples) return;
+
+	// Each idset is sampled by ids at equal steps. Sample is weighted by amount of ids till the next sample
+	vector<std::pair<IdType, int64_t>> samples;
+	samples.reserve(size() * parts);
+	int64_t total = 0;
+	for (auto &r : *this) {
+		if (r.useBtree_) return;
+		int64_t count = r.isRange_ ? r.rEnd_ - r.rIt_ : r.end_ - r.it_;
+		if (count <= 0) continue;
+		for (int64_t i = 0; i < parts; i++) {
+			int64_t pos = count * i / parts, next = count * (i + 1) / parts;
+			if (pos == next) continue;
+			samples.push_back({r.isRange_ ? IdType(r.rIt_ + pos) : r.it_[pos], next - pos});
+		}
+		total += count;
+	}
+	if (samples.empty()) return;
+
+	std::sort(samples.begin(), samples.end());
+	int64_t before = 0;
+	for (auto &sample : samples) {
+		while (int(bounds.size()) < parts - 1 && before >= total * int64_t(bounds.size() + 1) / parts) bounds.push_back(sample.first);
+		before += sample.second;
+	}
+	while (int(bounds.size()) < parts - 1) bounds.push_back(samples.back().first + 1);
+}
+
 void SelectIterator::ExcludeLastSet() {
 	if (!End() && lastIt_ != end()) {
 		assert(!lastIt_->isRange_);
@@ -240,7 +321,19 @@ void SelectIterator::ExcludeLastSet() {
 	}
 }
 
+void SelectIterator::appendBitmap(const SelectKeyResult &other) {
+	// Result of OR is kept as bitmap only if both parts are bitmaps
+	if (bitmap_ && other.bitmap_ && comparators_.empty() && other.comparators_.empty()) {
+		auto bitmap = std::make_shared<IdSetBitmap>(*bitmap_);
+		bitmap->Or(*other.bitmap_);
+		bitmap_ = bitmap;
+	} else {
+		bitmap_.reset();
+	}
+}
+
 void SelectIterator::Append(SelectKeyResult &other) {
+	appendBitmap(other);
 	for (auto &r : other) push_back(std::move(r));
 	for (auto &c : other.comparators_) {
 		comparators_.push_back(std::move(c));
@@ -248,6 +341,7 @@ void SelectIterator::Append(SelectKeyResult &other) {
 }
 
 void SelectIterator::AppendAndBind(SelectKeyResult &other, PayloadType type, int field) {
+	appendBitmap(other);
 	for (auto &r : other) push_back(std::move(r));
 	for (auto &c : other.comparators_) {
 		c.Bind(type, field);
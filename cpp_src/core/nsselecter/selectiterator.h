@@ -63,6 +63,16 @@ public:
 		return res;
 	}
 
+	/// Moves forward iteration to the first rowId, which is not less than rowId.
+	/// Must be called after Start and before iteration.
+	/// @param rowId - rowId to start iteration from.
+	void Seek(IdType rowId);
+	/// Splits ids of iterator to parts with about equal amount of ids.
+	/// Must be called after Start and before iteration.
+	/// @param parts - amount of parts.
+	/// @param bounds - output rowIds, which parts start from, except the first part. Empty, if ids can't be split
+	void SplitIds(int parts, vector<IdType> &bounds) const;
+
 	/// Sets Unsorted iteration mode
 	inline void SetUnsorted() { isUnsorted = true; }
 
@@ -79,19 +89,21 @@ public:
 	/// @param type - PayloadType of selected ns.
 	/// @param field - field index.
 	void Bind(PayloadType type, int field);
-	/// Uses each comparator to compare with pl.
-	/// @param pl - PayloadValue to be compared.
+	/// Uses each comparator to compare with row of namespace.
+	/// If rows are accessed sequentially, comparators are evaluated by batches of rows,
+	/// and results of batch are used by next calls.
+	/// @param items - items of namespace.
 	/// @param rowId - rowId.
-	inline bool TryCompare(const PayloadValue &pl, int rowId) {
-		for (auto &cmp : comparators_)
-			if (cmp.Compare(pl, rowId)) {
-				matchedCount_++;
-				return true;
-			}
-		return false;
+	inline bool TryCompare(const vector<PayloadValue> &items, IdType rowId) {
+		bool res = (rowId >= batchBegin_ && rowId < batchEnd_) ? batchMatched_[rowId - batchBegin_] : compareBatch(items, rowId);
+		lastComparedId_ = rowId;
+		if (res) matchedCount_++;
+		return res;
 	}
 	/// @return amonut of matched items
 	int GetMatchedCount() { return matchedCount_; }
+	/// Adds amount of items, matched by copy of iterator
+	void AddMatchedCount(int count) { matchedCount_ += count; }
 
 	/// Excludes last set of ids from each result
 	/// to remove duplicated keys
@@ -128,6 +140,8 @@ public:
 	OpType op;
 	bool distinct;
 	string name;
+	/// Amount of rows, which were expected to match by statistics of index, or -1 if unknown
+	int64_t estimatedRows = -1;
 
 protected:
 	// Iterates to a next item of result
@@ -140,6 +154,9 @@ protected:
 	bool nextRevSingleRange(IdType minHint);
 	bool nextRevSingleIdset(IdType minHint);
 	bool nextUnsorted();
+	void appendBitmap(const SelectKeyResult &other);
+	// Compares rowId, which is out of current batch. Starts new batch on sequential access.
+	bool compareBatch(const vector<PayloadValue> &items, IdType rowId);
 
 	bool isUnsorted = false;
 	bool isReverse_ = false;
@@ -150,6 +167,14 @@ protected:
 	IdType end_ = 0;
 	int matchedCount_ = 0;
 	int counter_ = 0;
+
+	// State of batched comparators evaluation
+	vector<uint8_t> batchMatched_;
+	IdType batchBegin_ = 0;
+	IdType batchEnd_ = 0;
+	IdType lastComparedId_ = -2;
+	int sequentialCount_ = 0;
+	int batchSize_ = 0;
 };
 
 }  // namespace reindexer
@@ -0,0 +1,207 @@
+#include "payloadallocator.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <new>
+#include "payloadvalue.h"
+
+namespace reindexer {
+
+// Slabs are aligned to their size, so slab of block is found by its address
+static const size_t kSlabSize = 64 * 1024;
+// Bigger blocks are allocated from heap, to keep at least 8 blocks per slab
+static const size_t kMaxBlockSize = kSlabSize / 8;
+static const size_t kBlockAlign = 16;
+static const size_t kSlabHeaderSize = 128;
+
+struct PayloadAllocator::Slab {
+	uint8_t *data() { return reinterpret_cast<uint8_t *>(this) + kSlabHeaderSize; }
+
+	PayloadAllocator *owner;
+	SizeClass *sizeClass;
+	// Neighbours in list of all slabs of class
+	Slab *prev = nullptr, *next = nullptr;
+	// Neighbours in list of slabs with free blocks
+	Slab *prevPartial = nullptr, *nextPartial = nullptr;
+	// Freed blocks. Each free block keeps pointer to the next one
+	uint8_t *freeList = nullptr;
+	size_t capacity;
+	size_t used = 0;
+	// Amount of blocks, which were never allocated
+	size_t fresh = 0;
+	bool partial = false;
+	// Slab is sparse and is being compacted: blocks are not allocated from it
+	bool evacuating = false;
+};
+
+static_assert(kSlabHeaderSize % kBlockAlign == 0, "Slab header must keep alignment of blocks");
+
+static uint8_t *allocSlabMemory() {
+	void *mem = nullptr;
+#ifdef _WIN32
+	mem = _aligned_malloc(kSlabSize, kSlabSize);
+#else
+	if (posix_memalign(&mem, kSlabSize, kSlabSize)) mem = nullptr;
+#endif
+	if (!mem) throw std::bad_alloc();
+	return static_cast<uint8_t *>(mem);
+}
+
+static void freeSlabMemory(void *mem) {
+#ifdef _WIN32
+	_aligned_free(mem);
+#else
+	free(mem);
+#endif
+}
+
+PayloadAllocator::PayloadAllocator(size_t payloadSize) {
+	static_assert(sizeof(Slab) <= kSlabHeaderSize, "Slab header does not fit to reserved space");
+	// Size classes grow by 25%, to fit payloads with embedded arrays
+	size_t blockSize = payloadSize + sizeof(PayloadValue::dataHeader);
+	for (;;) {
+		blockSize = (blockSize + kBlockAlign - 1) / kBlockAlign * kBlockAlign;
+		if (blockSize > kMaxBlockSize) break;
+		classes_.emplace_back();
+		classes_.back().blockSize = blockSize;
+		blockSize += std::max(blockSize / 4, kBlockAlign);
+	}
+}
+
+PayloadAllocator::~PayloadAllocator() { assert(slabsCount_ == 0); }
+
+PayloadAllocator::Slab *PayloadAllocator::slabOf(const uint8_t *block) {
+	return reinterpret_cast<Slab *>(reinterpret_cast<uintptr_t>(block) & ~uintptr_t(kSlabSize - 1));
+}
+
+PayloadAllocator *PayloadAllocator::Owner(const uint8_t *block) { return slabOf(block)->owner; }
+
+uint8_t *PayloadAllocator::Alloc(size_t size) {
+	auto it = std::lower_bound(classes_.begin(), classes_.end(), size,
+							   [](const SizeClass &sizeClass, size_t size) { return sizeClass.blockSize < size; });
+	if (it == classes_.end()) return nullptr;
+
+	std::lock_guard<std::mutex> lck(mtx_);
+	Slab *slab = it->partial ? it->partial : newSlab(*it);
+	uint8_t *block;
+	if (slab->freeList) {
+		block = slab->freeList;
+		slab->freeList = *reinterpret_cast<uint8_t **>(block);
+	} else {
+		block = slab->data() + slab->fresh++ * it->blockSize;
+	}
+	if (++slab->used == slab->capacity) unlinkPartial(slab);
+	usedSize_ += it->blockSize;
+	return block;
+}
+
+void PayloadAllocator::Free(uint8_t *block) {
+	Slab *slab = slabOf(block);
+	PayloadAllocator *owner = slab->owner;
+	bool releaseOwner;
+	{
+		std::lock_guard<std::mutex> lck(owner->mtx_);
+		releaseOwner = owner->freeBlock(slab, block);
+	}
+	if (releaseOwner) intrusive_ptr_release(owner);
+}
+
+PayloadAllocator::Slab *PayloadAllocator::newSlab(SizeClass &sizeClass) {
+	Slab *slab = new (allocSlabMemory()) Slab;
+	slab->owner = this;
+	slab->sizeClass = &sizeClass;
+	slab->capacity = (kSlabSize - kSlabHeaderSize) / sizeClass.blockSize;
+	slab->next = sizeClass.slabs;
+	if (slab->next) slab->next->prev = slab;
+	sizeClass.slabs = slab;
+	linkPartial(slab);
+
+	slabsCount_++;
+	intrusive_ptr_add_ref(this);
+	return slab;
+}
+
+bool PayloadAllocator::freeBlock(Slab *slab, uint8_t *block) {
+	SizeClass &sizeClass = *slab->sizeClass;
+	*reinterpret_cast<uint8_t **>(block) = slab->freeList;
+	slab->freeList = block;
+	usedSize_ -= sizeClass.blockSize;
+
+	if (--slab->used) {
+		if (!slab->partial && !slab->evacuating) linkPartial(slab);
+		return false;
+	}
+
+	// Empty slab is returned to system
+	if (slab->partial) unlinkPartial(slab);
+	if (slab->prev) slab->prev->next = slab->next;
+	if (slab->next) slab->next->prev = slab->prev;
+	if (sizeClass.slabs == slab) sizeClass.slabs = slab->next;
+	slab->~Slab();
+	freeSlabMemory(slab);
+	slabsCount_--;
+	return true;
+}
+
+// New blocks are allocated from the slab, which got free block last, so holes are filled first
+void PayloadAllocator::linkPartial(Slab *slab) {
+	SizeClass &sizeClass = *slab->sizeClass;
+	slab->prevPartial = nullptr;
+	slab->nextPartial = sizeClass.partial;
+	if (slab->nextPartial) slab->nextPartial->prevPartial = slab;
+	sizeClass.partial = slab;
+	slab->partial = true;
+}
+
+void PayloadAllocator::unlinkPartial(Slab *slab) {
+	SizeClass &sizeClass = *slab->sizeClass;
+	if (slab->prevPartial) slab->prevPartial->nextPartial = slab->nextPartial;
+	if (slab->nextPartial) slab->nextPartial->prevPartial = slab->prevPartial;
+	if (sizeClass.partial == slab) sizeClass.partial = slab->nextPartial;
+	slab->prevPartial = slab->nextPartial = nullptr;
+	slab->partial = false;
+}
+
+bool PayloadAllocator::BeginCompaction() {
+	std::lock_guard<std::mutex> lck(mtx_);
+	bool found = false;
+	for (auto &sizeClass : classes_) {
+		for (Slab *slab = sizeClass.slabs; slab; slab = slab->next) {
+			// Slab is sparse, if less than half of its blocks are used
+			if (slab->used * 2 >= slab->capacity) continue;
+			if (slab->partial) unlinkPartial(slab);
+			slab->evacuating = true;
+			found = true;
+		}
+	}
+	return found;
+}
+
+void PayloadAllocator::EndCompaction() {
+	std::lock_guard<std::mutex> lck(mtx_);
+	for (auto &sizeClass : classes_) {
+		for (Slab *slab = sizeClass.slabs; slab; slab = slab->next) {
+			if (!slab->evacuating) continue;
+			slab->evacuating = false;
+			if (slab->used < slab->capacity) linkPartial(slab);
+		}
+	}
+}
+
+bool PayloadAllocator::IsCompacted(const uint8_t *block) {
+	Slab *slab = slabOf(block);
+	if (slab->owner != this) return false;
+	std::lock_guard<std::mutex> lck(mtx_);
+	return !slab->evacuating;
+}
+
+PayloadsMemStat PayloadAllocator::GetMemStat() {
+	std::lock_guard<std::mutex> lck(mtx_);
+	PayloadsMemStat ret;
+	ret.slabsCount = slabsCount_;
+	ret.slabsSize = slabsCount_ * kSlabSize;
+	ret.freeSize = ret.slabsSize - usedSize_;
+	return ret;
+}
+
+}  // namespace reindexer
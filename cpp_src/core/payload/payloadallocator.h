@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "core/namespacestat.h"
+#include "estl/intrusive_ptr.h"
+
+namespace reindexer {
+
+/// Slab allocator of payload buffers of namespace.
+/// Blocks of size classes, matched to size of payload type, are allocated from aligned slabs. Bigger blocks are not served.
+/// Allocator is kept alive by its owners and by each slab with allocated blocks, so payloads may outlive namespace.
+class PayloadAllocator {
+public:
+	typedef intrusive_ptr<PayloadAllocator> Ptr;
+
+	/// @param payloadSize - size of payload without embedded arrays.
+	PayloadAllocator(size_t payloadSize);
+	~PayloadAllocator();
+	PayloadAllocator(const PayloadAllocator &) = delete;
+	PayloadAllocator &operator=(const PayloadAllocator &) = delete;
+
+	/// Allocates block from slab
+	/// @param size - size of block
+	/// @return block, or nullptr, if size is too big for slabs
+	uint8_t *Alloc(size_t size);
+	/// Returns block to slab of its allocator
+	static void Free(uint8_t *block);
+	/// @return allocator of block
+	static PayloadAllocator *Owner(const uint8_t *block);
+
+	/// Starts compaction: sparse slabs are excluded from allocation, so their blocks can be moved to other slabs.
+	/// @return false, if there are no sparse slabs
+	bool BeginCompaction();
+	/// Sparse slabs, which still have blocks, are used for allocation again
+	void EndCompaction();
+	/// @return true, if block is allocated by this allocator and is not in sparse slab
+	bool IsCompacted(const uint8_t *block);
+
+	PayloadsMemStat GetMemStat();
+
+protected:
+	struct Slab;
+	struct SizeClass {
+		size_t blockSize;
+		// All slabs of class
+		Slab *slabs = nullptr;
+		// Slabs with free blocks, which are used for allocation
+		Slab *partial = nullptr;
+	};
+
+	static Slab *slabOf(const uint8_t *block);
+	Slab *newSlab(SizeClass &sizeClass);
+	// Returns true, if slab was released and owner must be released too
+	bool freeBlock(Slab *slab, uint8_t *block);
+	void linkPartial(Slab *slab);
+	void unlinkPartial(Slab *slab);
+
+	std::vector<SizeClass> classes_;
+	std::mutex mtx_;
+	size_t slabsCount_ = 0;
+	size_t usedSize_ = 0;
+	std::atomic<int> refcount_{0};
+
+	friend void intrusive_ptr_add_ref(PayloadAllocator *x);
+	friend void intrusive_ptr_release(PayloadAllocator *x);
+};
+
+inline void intrusive_ptr_add_ref(PayloadAllocator *x) {
+	if (x) x->refcount_++;
+}
+
+inline void intrusive_ptr_release(PayloadAllocator *x) {
+	if (x && x->refcount_-- == 1) delete x;
+}
+
+}  // namespace reindexer
@@ -1,11 +1,12 @@
 #include "payloadvalue.h"
 #include <chrono>
+#include "payloadallocator.h"
 #include "string.h"
 #include "tools/errors.h"
 namespace reindexer {
 
-PayloadValue::PayloadValue(size_t size, const uint8_t *ptr, size_t cap) : p_(nullptr) {
-	p_ = alloc((cap != 0) ? cap : size);
+PayloadValue::PayloadValue(size_t size, const uint8_t *ptr, size_t cap, PayloadAllocator *allocator) : p_(nullptr) {
+	p_ = alloc((cap != 0) ? cap : size, allocator);
 
 	if (ptr)
 		memcpy(Ptr(), ptr, size);
@@ -21,11 +22,13 @@ PayloadValue::PayloadValue(const PayloadValue &other) : p_(other.p_) {
 
 PayloadValue::~PayloadValue() { release(); }
 
-uint8_t *PayloadValue::alloc(size_t cap) {
-	auto pn = reinterpret_cast<uint8_t *>(operator new(cap + sizeof(dataHeader)));
+uint8_t *PayloadValue::alloc(size_t cap, PayloadAllocator *allocator) {
+	uint8_t *pn = allocator ? allocator->Alloc(cap + sizeof(dataHeader)) : nullptr;
+	bool isSlabBlock = pn;
+	if (!pn) pn = reinterpret_cast<uint8_t *>(operator new(cap + sizeof(dataHeader)));
 	dataHeader *nheader = reinterpret_cast<dataHeader *>(pn);
 	new (nheader) dataHeader();
-	nheader->cap = cap;
+	nheader->cap = isSlabBlock ? (cap | dataHeader::kSlabBlock) : cap;
 	if (p_) {
 		nheader->lsn = header()->lsn;
 	}
@@ -33,10 +36,17 @@ uint8_t *PayloadValue::alloc(size_t cap) {
 	return pn;
 }
 
+PayloadAllocator *PayloadValue::allocator() const { return header()->isSlabBlock() ? PayloadAllocator::Owner(p_) : nullptr; }
+
 void PayloadValue::release() {
 	if (p_ && header()->refcount.fetch_sub(1) == 1) {
+		bool isSlabBlock = header()->isSlabBlock();
 		header()->~dataHeader();
-		delete p_;
+		if (isSlabBlock) {
+			PayloadAllocator::Free(p_);
+		} else {
+			delete p_;
+		}
 	}
 	p_ = nullptr;
 }
@@ -48,10 +58,10 @@ void PayloadValue::Clone(size_t size) {
 	}
 	assert(size || p_);
 
-	auto pn = alloc(p_ ? header()->cap : size);
+	auto pn = p_ ? alloc(header()->capacity(), allocator()) : alloc(size, nullptr);
 	if (p_) {
 		// Make new data & copy
-		memcpy(pn + sizeof(dataHeader), Ptr(), header()->cap);
+		memcpy(pn + sizeof(dataHeader), Ptr(), header()->capacity());
 		// Release old data
 		release();
 	} else {
@@ -65,9 +75,9 @@ void PayloadValue::Resize(size_t oldSize, size_t newSize) {
 	assert(p_);
 	assert(header()->refcount.load() == 1);
 
-	if (newSize <= header()->cap) return;
+	if (newSize <= header()->capacity()) return;
 
-	auto pn = alloc(newSize);
+	auto pn = alloc(newSize, allocator());
 	memcpy(pn + sizeof(dataHeader), Ptr(), oldSize);
 	memset(pn + sizeof(dataHeader) + oldSize, 0, newSize - oldSize);
 
@@ -76,4 +86,21 @@ void PayloadValue::Resize(size_t oldSize, size_t newSize) {
 	p_ = pn;
 }
 
+bool PayloadValue::Relocate(PayloadAllocator &allocator) {
+	if (!p_) return false;
+	if (header()->isSlabBlock() && allocator.IsCompacted(p_)) return false;
+
+	size_t cap = header()->capacity();
+	uint8_t *pn = allocator.Alloc(cap + sizeof(dataHeader));
+	if (!pn) return false;
+	dataHeader *nheader = new (pn) dataHeader();
+	nheader->cap = cap | dataHeader::kSlabBlock;
+	nheader->lsn = header()->lsn;
+	memcpy(pn + sizeof(dataHeader), Ptr(), cap);
+
+	release();
+	p_ = pn;
+	return true;
+}
+
 }  // namespace reindexer
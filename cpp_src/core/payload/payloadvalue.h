@@ -6,6 +6,8 @@
 
 namespace reindexer {
 
+class PayloadAllocator;
+
 // The full item's payload object. It must be speed & size optimized
 class PayloadValue {
 public:
@@ -14,6 +16,11 @@ public:
 		dataHeader() : refcount(1), cap(0), lsn(-1) {}
 
 		~dataHeader() { assert(refcount.load() == 0); }
+		size_t capacity() const { return cap & ~kSlabBlock; }
+		bool isSlabBlock() const { return cap & kSlabBlock; }
+
+		// Flag of cap: data is allocated by PayloadAllocator
+		static const unsigned kSlabBlock = 1u << 31;
 		refcounter refcount;
 		unsigned cap;
 		int64_t lsn;
@@ -21,8 +28,8 @@ public:
 
 	PayloadValue() : p_(nullptr) {}
 	PayloadValue(const PayloadValue &);
-	// Alloc payload store with size, and copy data from another array
-	PayloadValue(size_t size, const uint8_t *ptr = nullptr, size_t cap = 0);
+	// Alloc payload store with size, and copy data from another array. Data is allocated from slabs of allocator, if it is set
+	PayloadValue(size_t size, const uint8_t *ptr = nullptr, size_t cap = 0, PayloadAllocator *allocator = nullptr);
 	~PayloadValue();
 	PayloadValue &operator=(const PayloadValue &other) {
 		if (&other != this) {
@@ -46,16 +53,22 @@ public:
 	void Clone(size_t size = 0);
 	// Resize
 	void Resize(size_t oldSize, size_t newSize);
+	// Move data to slab of allocator, if data is in heap or it is not compacted by allocator. Shared data is copied, and other holders
+	// keep the old one. Returns true, if data was moved
+	bool Relocate(PayloadAllocator &allocator);
+	bool IsShared() const { return p_ && header()->refcount.load() > 1; }
 	// Get data pointer
 	uint8_t *Ptr() const { return p_ + sizeof(dataHeader); }
 	void SetLSN(int64_t lsn) { header()->lsn = lsn; }
 	int64_t GetLSN() const { return p_ ? header()->lsn : 0; }
 	bool IsFree() const { return bool(p_ == nullptr); }
 	void Free() { release(); }
-	size_t GetCapacity() const { return header()->cap; }
+	size_t GetCapacity() const { return header()->capacity(); }
 
 protected:
-	uint8_t *alloc(size_t cap);
+	uint8_t *alloc(size_t cap, PayloadAllocator *allocator);
+	// Allocator of current data, or nullptr if data is in heap
+	PayloadAllocator *allocator() const;
 	void release();
 
 	dataHeader *header() { return reinterpret_cast<dataHeader *>(p_); }
@@ -1,6 +1,9 @@
 #pragma once
 
+#include "core/idset.h"
 #include "core/lrucache.h"
+#include "core/payload/fieldsset.h"
+#include "core/query/aggregationresult.h"
 #include "estl/h_vector.h"
 #include "query.h"
 #include "tools/serializer.h"
@@ -13,18 +16,37 @@ namespace reindexer {
 
 struct QueryCacheVal {
 	QueryCacheVal() = default;
-	QueryCacheVal(const size_t& total) : total_count(total) {}
+	QueryCacheVal(const size_t& total, const FieldsSet& idxs = FieldsSet()) : total_count(total), indexes(idxs) {}
 
 	size_t Size() const { return 0; }
 
 	int total_count = -1;
+	// Indexes, which were used by query. Value is valid until items are updated only by other indexes
+	FieldsSet indexes;
+};
+
+struct QueryResultsCacheVal {
+	QueryResultsCacheVal() = default;
+
+	size_t Size() const {
+		size_t size = ids ? sizeof(IdSet) + ids->heap_size() : 0;
+		for (auto& ag : aggregationResults) size += sizeof(AggregationResult) + ag.facets.size() * sizeof(FacetResult);
+		return size;
+	}
+
+	// Ids of result items after offset and limit, or nullptr if results of query are not cached yet
+	IdSet::Ptr ids;
+	vector<AggregationResult> aggregationResults;
+	int totalCount = 0;
+	// Indexes, which were used by query. Value is valid until items are updated only by other indexes
+	FieldsSet indexes;
 };
 
 struct QueryCacheKey {
 	QueryCacheKey() {}
-	QueryCacheKey(const Query& q) {
+	QueryCacheKey(const Query& q, int serializeMode = SkipJoinQueries | SkipMergeQueries | SkipLimitOffset) {
 		WrSerializer ser;
-		q.Serialize(ser, (SkipJoinQueries | SkipMergeQueries | SkipLimitOffset));
+		q.Serialize(ser, serializeMode);
 		buf.reserve(ser.Len());
 		buf.assign(ser.Buf(), ser.Buf() + ser.Len());
 	}
@@ -50,4 +72,7 @@ struct HashQueryCacheKey {
 
 struct QueryCache : LRUCache<QueryCacheKey, QueryCacheVal, HashQueryCacheKey, EqQueryCacheKey> {};
 
+// Cache of full results of queries: keys are queries with limit and offset
+struct QueryResultsCache : LRUCache<QueryCacheKey, QueryResultsCacheVal, HashQueryCacheKey, EqQueryCacheKey> {};
+
 }  // namespace reindexer
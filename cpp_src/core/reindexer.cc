@@ -5,9 +5,9 @@ namespace reindexer {
 
 Reindexer::Reindexer() { impl_ = new ReindexerImpl(); }
 Reindexer::~Reindexer() { delete impl_; }
-Error Reindexer::Connect(const string& dsn) { return impl_->Connect(dsn); }
-Error Reindexer::EnableStorage(const string& storagePath, bool skipPlaceholderCheck) {
-	return impl_->EnableStorage(storagePath, skipPlaceholderCheck);
+Error Reindexer::Connect(const string& dsn, const ConnectOpts& opts) { return impl_->Connect(dsn, opts); }
+Error Reindexer::EnableStorage(const string& storagePath, bool skipPlaceholderCheck, const ConnectOpts& opts) {
+	return impl_->EnableStorage(storagePath, skipPlaceholderCheck, opts);
 }
 Error Reindexer::AddNamespace(const NamespaceDef& nsDef) { return impl_->AddNamespace(nsDef); }
 Error Reindexer::OpenNamespace(const string& name, const StorageOpts& storage, CacheMode cacheMode) {
@@ -20,11 +20,20 @@ Error Reindexer::Update(const string& _namespace, Item& item, Completion cmpl) {
 Error Reindexer::Upsert(const string& _namespace, Item& item, Completion cmpl) { return impl_->Upsert(_namespace, item, cmpl); }
 Error Reindexer::Delete(const string& _namespace, Item& item, Completion cmpl) { return impl_->Delete(_namespace, item, cmpl); }
 Item Reindexer::NewItem(const string& _namespace) { return impl_->NewItem(_namespace); }
+Transaction Reindexer::NewTransaction(const string& _namespace) { return impl_->NewTransaction(_namespace); }
+Error Reindexer::CommitTransaction(Transaction& tx) { return impl_->CommitTransaction(tx); }
 Error Reindexer::GetMeta(const string& _namespace, const string& key, string& data) { return impl_->GetMeta(_namespace, key, data); }
 Error Reindexer::PutMeta(const string& _namespace, const string& key, const string_view& data) {
 	return impl_->PutMeta(_namespace, key, data);
 }
 Error Reindexer::EnumMeta(const string& _namespace, vector<string>& keys) { return impl_->EnumMeta(_namespace, keys); }
+Error Reindexer::GetWAL(const string& _namespace, int64_t lastLSN, int limit, WALChunk& chunk) {
+	return impl_->GetWAL(_namespace, lastLSN, limit, chunk);
+}
+Error Reindexer::GetSnapshot(const string& _namespace, int64_t lsn, int64_t fromID, int maxSize, SnapshotChunk& chunk) {
+	return impl_->GetSnapshot(_namespace, lsn, fromID, maxSize, chunk);
+}
+Error Reindexer::LoadSnapshot(const string& _namespace, SnapshotFetcher fetch) { return impl_->LoadSnapshot(_namespace, fetch); }
 Error Reindexer::Delete(const Query& q, QueryResults& result) { return impl_->Delete(q, result); }
 Error Reindexer::Select(const string_view& query, QueryResults& result, Completion cmpl) { return impl_->Select(query, result, cmpl); }
 Error Reindexer::Select(const Query& q, QueryResults& result, Completion cmpl) { return impl_->Select(q, result, cmpl); }
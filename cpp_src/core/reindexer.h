@@ -1,8 +1,12 @@
 #pragma once
 
+#include "core/connectopts.h"
 #include "core/namespacedef.h"
 #include "core/query/query.h"
 #include "core/query/queryresults.h"
+#include "core/transaction.h"
+#include "replicator/snapshot.h"
+#include "replicator/walrecord.h"
 
 namespace reindexer {
 using std::vector;
@@ -31,12 +35,14 @@ public:
 
 	/// Connect - connect to reindexer database in embeded mode
 	/// @param dsn - uri of database, like: `builtin:///var/lib/reindexer/dbname` or just `/var/lib/reindexer/dbname`
-	Error Connect(const string &dsn);
+	/// @param opts - options of database: engine and tunables of storage
+	Error Connect(const string &dsn, const ConnectOpts &opts = ConnectOpts());
 
 	/// Enable storage. Must be called before InitSystemNamespaces
 	/// @param storagePath - file system path to database storage
 	/// @param skipPlaceholderCheck - If set, then reindexer will not check folder for placeholder
-	Error EnableStorage(const string &storagePath, bool skipPlaceholderCheck = false);
+	/// @param opts - options of database: engine and tunables of storage
+	Error EnableStorage(const string &storagePath, bool skipPlaceholderCheck = false, const ConnectOpts &opts = ConnectOpts());
 
 	/// Open or create namespace
 	/// @param nsName - Name of namespace
@@ -111,6 +117,14 @@ public:
 	/// Flush changes to storage
 	/// @param nsName - Name of namespace
 	Error Commit(const string &nsName);
+	/// Create new transaction for namespace
+	/// @param nsName - Name of namespace
+	/// @return Transaction ready for adding of modifications, created by NewItem of the same namespace
+	Transaction NewTransaction(const string &nsName);
+	/// Apply all modifications of transaction to namespace. Modifications are applied under single lock of namespace,
+	/// and are written to storage by single batch. On success item.GetID() of each transaction step will return internal Item ID
+	/// @param tx - Transaction, obtained by call to NewTransaction
+	Error CommitTransaction(Transaction &tx);
 	/// Allocate new item for namespace
 	/// @param nsName - Name of namespace
 	/// @return Item ready for filling and futher Upsert/Insert/Delete/Update call
@@ -129,6 +143,25 @@ public:
 	/// @param nsName - Name of namespace
 	/// @param keys - std::vector filled with meta keys
 	Error EnumMeta(const string &nsName, vector<string> &keys);
+	/// Get changes of namespace from its write-ahead log
+	/// @param nsName - Name of namespace
+	/// @param lastLSN - LSN of the last change, which is already known. -1 to get all kept changes
+	/// @param limit - maximum amount of records in chunk. 0 - get only LSN of the last change of namespace
+	/// @param chunk - output chunk of WAL. Returns errOutdatedWAL, if WAL does not keep changes after lastLSN
+	Error GetWAL(const string &nsName, int64_t lastLSN, int limit, WALChunk &chunk);
+	/// Get chunk of snapshot of namespace. Snapshot keeps items, which were not changed after LSN of snapshot,
+	/// so the rest of changes is got from WAL after LSN of snapshot
+	/// @param nsName - Name of namespace
+	/// @param lsn - LSN of snapshot, as returned by the first chunk. -1 to get the first chunk of new snapshot
+	/// @param fromID - row, which chunk starts from, as returned by nextID of previous chunk
+	/// @param maxSize - approximate maximum size of items of chunk in bytes
+	/// @param chunk - output chunk of snapshot
+	Error GetSnapshot(const string &nsName, int64_t lsn, int64_t fromID, int maxSize, SnapshotChunk &chunk);
+	/// Replace namespace by snapshot of namespace of other database. New namespace is loaded aside, and replaces
+	/// the current one, when all chunks are loaded. Indexes of new namespace are built by batches of items, as on load from storage
+	/// @param nsName - Name of namespace
+	/// @param fetch - function, which fetches chunks of snapshot, e.g. by GetSnapshot of other database
+	Error LoadSnapshot(const string &nsName, SnapshotFetcher fetch);
 
 	/// Init system namepaces, and load config from config namespace
 	Error InitSystemNamespaces();
@@ -1,6 +1,9 @@
 #include "core/reindexerimpl.h"
 #include <stdio.h>
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
+#include <cstring>
 #include <thread>
 #include "core/cjson/jsondecoder.h"
 #include "core/index/index.h"
@@ -8,6 +11,7 @@
 #include "core/namespacedef.h"
 #include "core/selectfunc/selectfunc.h"
 #include "kx/kxsort.h"
+#include "storage/storagefactory.h"
 #include "tools/errors.h"
 #include "tools/fsops.h"
 #include "tools/logger.h"
@@ -23,19 +27,38 @@ const char* kMemStatsNamespace = "#memstats";
 const char* kNamespacesNamespace = "#namespaces";
 const char* kConfigNamespace = "#config";
 const char* kStoragePlaceholderFilename = ".reindexer.storage";
+// Directory of database, where snapshots are loaded before they replace storages of namespaces
+const char* kSnapshotStorageDir = ".snapshot";
+
+// Maximum amount of joined items, for which join is done by hash table instead of nested select for each item of main namespace
+const int kMaxHashJoinItems = 100000;
 
 namespace reindexer {
 
-ReindexerImpl::ReindexerImpl() : profConfig_(std::make_shared<DBProfilingConfig>()) { stopFlusher_ = false; }
+ReindexerImpl::ReindexerImpl() : profConfig_(std::make_shared<DBProfilingConfig>()) {
+	stopFlusher_ = false;
+	stopOptimizer_ = false;
+	optimizerWakeup_ = false;
+	optimizationTimeoutMs_ = 0;
+	parallelSelectThreshold_ = 0;
+}
 
 ReindexerImpl::~ReindexerImpl() {
 	if (storagePath_.length()) {
 		stopFlusher_ = true;
 		flusher_.join();
 	}
+	if (optimizer_.joinable()) {
+		{
+			std::lock_guard<std::mutex> lck(optimizerMtx_);
+			stopOptimizer_ = true;
+			optimizerCond_.notify_all();
+		}
+		optimizer_.join();
+	}
 }
 
-Error ReindexerImpl::EnableStorage(const string& storagePath, bool skipPlaceholderCheck) {
+Error ReindexerImpl::EnableStorage(const string& storagePath, bool skipPlaceholderCheck, const ConnectOpts& opts) {
 	if (!storagePath_.empty()) {
 		return Error(errParams, "Storage already enabled\n");
 	}
@@ -58,18 +81,39 @@ Error ReindexerImpl::EnableStorage(const string& storagePath, bool skipPlacehold
 		}
 	}
 
-	if (!isEmpty && !skipPlaceholderCheck) {
-		FILE* f = fopen(fs::JoinPath(storagePath, kStoragePlaceholderFilename).c_str(), "r");
-		if (f) {
-			fclose(f);
-		} else {
+	datastorage::StorageType storageType = opts.storageType;
+	bool hasPlaceholder = !isEmpty && !skipPlaceholderCheck;
+	if (hasPlaceholder) {
+		string placeholder;
+		if (fs::ReadFile(fs::JoinPath(storagePath, kStoragePlaceholderFilename), placeholder) < 0) {
 			return Error(errParams, "Cowadly refusing to use directory '%s' - it's not empty, and doesn't contains reindexer placeholder",
 						 storagePath.c_str());
 		}
-	} else {
+		// Existing database can be read only by the engine, which wrote it. Placeholder of old versions is empty: they used only LevelDB
+		storageType = datastorage::StorageType::LevelDB;
+		while (!placeholder.empty() && isspace(placeholder.back())) placeholder.pop_back();
+		if (!placeholder.empty()) {
+			auto err = datastorage::StorageTypeFromString(placeholder, storageType);
+			if (!err.ok()) {
+				return Error(errParams, "Can't use directory '%s' for reindexer storage - %s", storagePath.c_str(), err.what().c_str());
+			}
+		}
+		if (storageType != opts.storageType) {
+			logPrintf(LogWarning, "Database '%s' was created by storage engine '%s', so it is used instead of '%s'", storagePath.c_str(),
+					  datastorage::StorageTypeToString(storageType), datastorage::StorageTypeToString(opts.storageType));
+		}
+	}
+
+	if (!datastorage::StorageFactory::IsSupported(storageType)) {
+		return Error(errParams, "Storage engine '%s' is not supported by this build of reindexer",
+					 datastorage::StorageTypeToString(storageType));
+	}
+
+	if (!hasPlaceholder) {
 		FILE* f = fopen(fs::JoinPath(storagePath, kStoragePlaceholderFilename).c_str(), "w");
 		if (f) {
-			fwrite("leveldb", 7, 1, f);
+			const char* engine = datastorage::StorageTypeToString(storageType);
+			fwrite(engine, strlen(engine), 1, f);
 			fclose(f);
 		} else {
 			return Error(errParams, "Can't create placeholder in directory '%s' for reindexer storage - reason %s", storagePath.c_str(),
@@ -77,6 +121,9 @@ Error ReindexerImpl::EnableStorage(const string& storagePath, bool skipPlacehold
 		}
 	}
 
+	storageType_ = storageType;
+	storageTunables_ = opts.storageTunables;
+	blockCache_ = datastorage::StorageFactory::CreateBlockCache(storageType, storageTunables_.GetBlockCacheSize());
 	storagePath_ = storagePath;
 
 	flusher_ = std::thread([this]() { this->flusherThread(); });
@@ -84,13 +131,13 @@ Error ReindexerImpl::EnableStorage(const string& storagePath, bool skipPlacehold
 	return errOK;
 }
 
-Error ReindexerImpl::Connect(const string& dsn) {
+Error ReindexerImpl::Connect(const string& dsn, const ConnectOpts& opts) {
 	string path = dsn;
 	if (dsn.compare(0, 10, "builtin://") == 0) {
 		path = dsn.substr(10);
 	}
 
-	auto err = EnableStorage(path);
+	auto err = EnableStorage(path, false, opts);
 	if (!err.ok()) return err;
 
 	vector<reindexer::fs::DirEntry> foundNs;
@@ -137,11 +184,11 @@ Error ReindexerImpl::AddNamespace(const NamespaceDef& nsDef) {
 		}
 		ns = std::make_shared<Namespace>(nsDef.name, nsDef.cacheMode);
 		if (nsDef.storage.IsEnabled() && !storagePath_.empty()) {
-			ns->EnableStorage(storagePath_, nsDef.storage);
+			enableStorage(*ns, nsDef.storage);
 		}
 		for (auto& indexDef : nsDef.indexes) ns->AddIndex(indexDef);
 		if (nsDef.storage.IsEnabled() && !storagePath_.empty()) {
-			ns->LoadFromStorage();
+			loadNamespace(ns);
 		}
 		lock_guard<shared_timed_mutex> lock(mtx_);
 		namespaces_.insert({nsDef.name, ns});
@@ -169,8 +216,8 @@ Error ReindexerImpl::OpenNamespace(const string& name, const StorageOpts& storag
 		}
 		ns = std::make_shared<Namespace>(name, cacheMode);
 		if (storage.IsEnabled() && !storagePath_.empty()) {
-			ns->EnableStorage(storagePath_, storage);
-			ns->LoadFromStorage();
+			enableStorage(*ns, storage);
+			loadNamespace(ns);
 		}
 		lock_guard<shared_timed_mutex> lock(mtx_);
 		namespaces_.insert({name, ns});
@@ -181,6 +228,31 @@ Error ReindexerImpl::OpenNamespace(const string& name, const StorageOpts& storag
 	return errOK;
 }
 
+void ReindexerImpl::enableStorage(Namespace& ns, const StorageOpts& opts, const string& path) {
+	// Namespace, which sets own size of block cache, does not share cache of database
+	auto blockCache = opts.GetBlockCacheSize() ? nullptr : blockCache_;
+	ns.EnableStorage(path.empty() ? storagePath_ : path, StorageOpts(opts).Tunables(storageTunables_), storageType_, blockCache);
+}
+
+void ReindexerImpl::loadNamespace(Namespace::Ptr ns) {
+	{
+		lock_guard<shared_timed_mutex> lock(mtx_);
+		loadingNamespaces_.push_back(ns);
+	}
+	auto unregister = [&]() {
+		lock_guard<shared_timed_mutex> lock(mtx_);
+		loadingNamespaces_.erase(std::find(loadingNamespaces_.begin(), loadingNamespaces_.end(), ns));
+	};
+	try {
+		ns->LoadFromStorage();
+	} catch (...) {
+		unregister();
+		throw;
+	}
+	unregister();
+	wakeOptimizer();
+}
+
 Error ReindexerImpl::DropNamespace(const string& _namespace) { return closeNamespace(_namespace, true); }
 Error ReindexerImpl::CloseNamespace(const string& _namespace) { return closeNamespace(_namespace, false); }
 
@@ -216,6 +288,7 @@ Error ReindexerImpl::Insert(const string& nsName, Item& item, Completion cmpl) {
 	try {
 		auto ns = getNamespace(nsName);
 		ns->Insert(item);
+		wakeOptimizer();
 		if (item.GetID() != -1) {
 			updateSystemNamespace(nsName, item);
 			observers_.OnModifyItem(nsName, item.impl_, ModeInsert);
@@ -232,6 +305,7 @@ Error ReindexerImpl::Update(const string& nsName, Item& item, Completion cmpl) {
 	try {
 		auto ns = getNamespace(nsName);
 		ns->Update(item);
+		wakeOptimizer();
 		if (item.GetID() != -1) {
 			updateSystemNamespace(nsName, item);
 			observers_.OnModifyItem(nsName, item.impl_, ModeUpdate);
@@ -248,6 +322,7 @@ Error ReindexerImpl::Upsert(const string& nsName, Item& item, Completion cmpl) {
 	try {
 		auto ns = getNamespace(nsName);
 		ns->Upsert(item);
+		wakeOptimizer();
 		if (item.GetID() != -1) {
 			updateSystemNamespace(nsName, item);
 			observers_.OnModifyItem(nsName, item.impl_, ModeUpsert);
@@ -270,6 +345,35 @@ Item ReindexerImpl::NewItem(const string& _namespace) {
 	}
 }
 
+Transaction ReindexerImpl::NewTransaction(const string& _namespace) { return Transaction(_namespace); }
+
+Error ReindexerImpl::CommitTransaction(Transaction& tx) {
+	Error err;
+	size_t applied = 0;
+	try {
+		auto ns = getNamespace(tx.GetName());
+		ns->ApplyTransaction(tx, applied);
+	} catch (const Error& e) {
+		err = e;
+	}
+	if (!applied) return err;
+
+	// Steps, which were applied before error, are kept in namespace, so observers are notified of them too
+	wakeOptimizer();
+	auto& steps = tx.GetSteps();
+	for (size_t i = 0; i < applied; i++) {
+		auto& step = steps[i];
+		if (step.mode != ModeDelete && step.item.GetID() == -1) continue;
+		try {
+			if (step.mode != ModeDelete) updateSystemNamespace(tx.GetName(), step.item);
+		} catch (const Error& e) {
+			if (err.ok()) err = e;
+		}
+		observers_.OnModifyItem(tx.GetName(), step.item.impl_, step.mode);
+	}
+	return err;
+}
+
 Error ReindexerImpl::GetMeta(const string& _namespace, const string& key, string& data) {
 	try {
 		data = getNamespace(_namespace)->GetMeta(key);
@@ -279,6 +383,86 @@ Error ReindexerImpl::GetMeta(const string& _namespace, const string& key, string
 	return errOK;
 }
 
+Error ReindexerImpl::GetWAL(const string& _namespace, int64_t lastLSN, int limit, WALChunk& chunk) {
+	try {
+		chunk = getNamespace(_namespace)->GetWAL(lastLSN, limit);
+	} catch (const Error& err) {
+		return err;
+	}
+	return errOK;
+}
+
+Error ReindexerImpl::GetSnapshot(const string& _namespace, int64_t lsn, int64_t fromID, int maxSize, SnapshotChunk& chunk) {
+	try {
+		chunk = getNamespace(_namespace)->GetSnapshot(lsn, fromID, maxSize);
+	} catch (const Error& err) {
+		return err;
+	}
+	return errOK;
+}
+
+Error ReindexerImpl::LoadSnapshot(const string& _namespace, SnapshotFetcher fetch) {
+	if (!validateObjectName(_namespace)) {
+		return Error(errParams, "Namespace name contains invalid character. Only alphas, digits,'_','-, are allowed");
+	}
+	auto ns = std::make_shared<Namespace>(_namespace, CacheMode::CacheModeOn);
+	const StorageOpts storageOpts = StorageOpts().Enabled().CreateIfMissing();
+	// Snapshot is loaded to storage in separate directory, so current namespace keeps own storage, until the last chunk is loaded
+	const string snapshotPath = storagePath_.empty() ? string() : fs::JoinPath(storagePath_, kSnapshotStorageDir);
+	// Storage of replaced namespace is moved aside, and is dropped after unlock
+	const string replacedPath = snapshotPath.empty() ? string() : fs::JoinPath(snapshotPath, _namespace + ".replaced");
+	// Replaced namespace is destroyed after unlock
+	Namespace::Ptr oldNs;
+	try {
+		if (!snapshotPath.empty()) {
+			// Storages may be left by failed load of previous snapshot
+			fs::RmDirAll(fs::JoinPath(snapshotPath, _namespace));
+			fs::RmDirAll(replacedPath);
+			if (fs::MkDirAll(snapshotPath) < 0) {
+				return Error(errLogic, "Can't create directory for snapshot of namespace '%s' on path '%s'", _namespace.c_str(),
+							 snapshotPath.c_str());
+			}
+			enableStorage(*ns, storageOpts, snapshotPath);
+		}
+
+		SnapshotChunk chunk;
+		int64_t lsn = -1;
+		for (int64_t fromID = 0; fromID >= 0; fromID = chunk.nextID) {
+			auto err = fetch(lsn, fromID, chunk);
+			if (!err.ok()) throw err;
+			lsn = chunk.lsn;
+			ns->ApplySnapshotChunk(chunk);
+		}
+
+		// Database is locked for the whole replacement, so writes are applied either to current namespace before its storage is closed,
+		// or to the new namespace with storage on the same path. Storage of current namespace is dropped after the swap
+		lock_guard<shared_timed_mutex> lock(mtx_);
+		auto nsIt = namespaces_.find(_namespace);
+		if (nsIt != namespaces_.end()) oldNs = nsIt->second;
+		if (!snapshotPath.empty()) {
+			if (oldNs) oldNs->CloseStorage();
+			const string nsPath = fs::JoinPath(storagePath_, _namespace);
+			if (fs::Stat(nsPath) != fs::StatError && fs::Rename(nsPath, replacedPath) < 0) {
+				throw Error(errLogic, "Can't move storage of namespace '%s' to '%s' - %s", _namespace.c_str(), replacedPath.c_str(),
+							strerror(errno));
+			}
+			ns->MoveStorage(storagePath_, StorageOpts(storageOpts).Tunables(storageTunables_), storageType_, blockCache_);
+		}
+		namespaces_[_namespace] = ns;
+	} catch (const Error& err) {
+		// Storage of incomplete snapshot is dropped, and current namespace is not changed
+		if (!snapshotPath.empty()) {
+			ns->DeleteStorage();
+			fs::RmDirAll(fs::JoinPath(snapshotPath, _namespace));
+		}
+		return err;
+	}
+	if (!replacedPath.empty()) fs::RmDirAll(replacedPath);
+	wakeOptimizer();
+	applyConfig();
+	return errOK;
+}
+
 Error ReindexerImpl::PutMeta(const string& nsName, const string& key, const string_view& data) {
 	try {
 		getNamespace(nsName)->PutMeta(key, data);
@@ -303,6 +487,7 @@ Error ReindexerImpl::Delete(const string& nsName, Item& item, Completion cmpl) {
 	try {
 		auto ns = getNamespace(nsName);
 		ns->Delete(item);
+		wakeOptimizer();
 		observers_.OnModifyItem(nsName, item.impl_, ModeDelete);
 	} catch (const Error& e) {
 		err = e;
@@ -314,6 +499,7 @@ Error ReindexerImpl::Delete(const Query& q, QueryResults& result) {
 	try {
 		auto ns = getNamespace(q._namespace);
 		ns->Delete(q, result);
+		wakeOptimizer();
 		// TODO
 		// observers_.OnModifyItem(nsName, item.impl_, ModeDelete);
 	} catch (const Error& err) {
@@ -363,6 +549,7 @@ Error ReindexerImpl::Select(const Query& q, QueryResults& result, Completion cmp
 
 	mtx_.lock_shared();
 	auto profCfg = profConfig_;
+	auto selectWorkers = selectWorkers_;
 	mtx_.unlock_shared();
 
 	PerfStatCalculatorMT calc(mainNs->selectPerfCounter_, mainNs->enablePerfCounters_);  // todo more accurate detect joined queries
@@ -396,7 +583,7 @@ Error ReindexerImpl::Select(const Query& q, QueryResults& result, Completion cmp
 				result.joined_.resize(1 + q.mergeQueries_.size());
 			}
 
-			doSelect(q, result, locks, func);
+			doSelect(q, result, locks, func, selectWorkers.get());
 			result.lockResults();
 			func.Process(result);
 
@@ -420,6 +607,8 @@ JoinedSelectors ReindexerImpl::prepareJoinedSelectors(const Query& q, QueryResul
 													  SelectFunctionsHolder& func) {
 	JoinedSelectors joinedSelectors;
 	auto ns = locks.Get(q._namespace);
+	// Rows of main namespace, for which joined rows are looked up
+	int64_t mainRows = q.joinQueries_.empty() ? 0 : estimateSelectedRows(q, ns);
 
 	// For each joined queries
 	for (auto& jq : q.joinQueries_) {
@@ -449,7 +638,7 @@ JoinedSelectors ReindexerImpl::prepareJoinedSelectors(const Query& q, QueryResul
 		if (joinRes.haveData) {
 			preResult = joinRes.it.val.preResult;
 		} else if (joinRes.needPut) {
-			jns->PutToJoinCache(joinRes, preResult);
+			jns->PutToJoinCache(joinRes, preResult, jq);
 		}
 
 		// Do join for each item in main result
@@ -473,6 +662,40 @@ JoinedSelectors ReindexerImpl::prepareJoinedSelectors(const Query& q, QueryResul
 			}
 			jItemQ.entries.push_back(qe);
 		}
+
+		auto hashTable = getJoinHashTable(jq, jns, preResult, mainRows, locks);
+		if (hashTable) {
+			auto hashJoinSelector = [&result, &jq, jns, hashTable, pos, ns](IdType id, int nsId, ConstPayload payload, bool match) {
+				// Get values of join fields from main item
+				JoinHashTable::Keys keys(jq.joinEntries_.size());
+				int cnt = 0;
+				for (auto& je : jq.joinEntries_) {
+					bool nonIndexedField = (je.idxNo == IndexValueType::SetByJsonPath);
+					bool isIndexSparse = !nonIndexedField && ns->indexes_[je.idxNo]->Opts().IsSparse();
+					if (nonIndexedField || isIndexSparse) {
+						payload.GetByJsonPath(je.index_, ns->tagsMatcher_, keys[cnt], KeyValueUndefined);
+					} else {
+						payload.Get(je.idxNo, keys[cnt]);
+					}
+					cnt++;
+				}
+
+				QueryResults joinItemR;
+				joinItemR.addNSContext(jns->payloadType_, jns->tagsMatcher_, FieldsSet());
+				bool found = hashTable->Find(keys, match ? jq.count : 0, joinItemR);
+				if (match && found) {
+					auto& jres = result.joined_[nsId].emplace(id, QRVector()).first->second;
+
+					if (pos >= jres.size()) jres.resize(pos + 1);
+
+					jres[pos] = std::move(joinItemR);
+				}
+				return found;
+			};
+			joinedSelectors.push_back({jq.joinType, jq.count == 0, hashJoinSelector, 0, 0, jns->name_, JoinedSelector::Hash});
+			continue;
+		}
+
 		queries.push_back(std::move(jItemQ));
 		pjItemQ = &queries.back();
 
@@ -505,7 +728,7 @@ JoinedSelectors ReindexerImpl::prepareJoinedSelectors(const Query& q, QueryResul
 
 			jns->GetIndsideFromJoinCache(joinRes);
 			if (joinRes.needPut) {
-				jns->PutToJoinCache(joinRes, preResult);
+				jns->PutToJoinCache(joinRes, preResult, jq);
 			}
 			if (joinResLong.haveData) {
 				found = joinResLong.it.val.ids_->size();
@@ -530,7 +753,7 @@ JoinedSelectors ReindexerImpl::prepareJoinedSelectors(const Query& q, QueryResul
 				for (auto& r : joinItemR.Items()) {
 					val.ids_->Add(r.id, IdSet::Unordered);
 				}
-				jns->PutToJoinCache(joinResLong, val);
+				jns->PutToJoinCache(joinResLong, val, jq, *pjItemQ);
 			}
 			if (match && found) {
 				auto& jres = result.joined_[nsId].emplace(id, QRVector()).first->second;
@@ -543,12 +766,110 @@ JoinedSelectors ReindexerImpl::prepareJoinedSelectors(const Query& q, QueryResul
 		};
 		auto cache_func_selector = std::bind(joinedSelector, std::move(joinRes), _1, _2, _3, _4);
 
-		joinedSelectors.push_back({jq.joinType, jq.count == 0, cache_func_selector, 0, 0, jns->name_});
+		joinedSelectors.push_back({jq.joinType, jq.count == 0, cache_func_selector, 0, 0, jns->name_, JoinedSelector::NestedLoop});
 	}
 	return joinedSelectors;
 }
 
-void ReindexerImpl::doSelect(const Query& q, QueryResults& result, NsLocker& locks, SelectFunctionsHolder& func) {
+int64_t ReindexerImpl::estimateSelectedRows(const Query& q, Namespace::Ptr ns) {
+	int64_t rows = ns->items_.size() - ns->free_.size();
+	for (size_t i = 0; i < q.entries.size(); ++i) {
+		const QueryEntry& qe = q.entries[i];
+		// Only standalone AND conditions bound amount of rows
+		if (qe.op != OpAnd || qe.distinct || (i + 1 < q.entries.size() && q.entries[i + 1].op == OpOr)) continue;
+		int idxNo = IndexValueType::NotSet;
+		if (!ns->getIndexByName(qe.index, idxNo) || isFullText(ns->indexes_[idxNo]->Type())) continue;
+		Index& index = *ns->indexes_[idxNo];
+		VariantArray keys = qe.values;
+		try {
+			for (auto& key : keys) key.convert(index.SelectKeyType(), &ns->payloadType_, &index.Fields());
+		} catch (const Error&) {
+			continue;
+		}
+		int64_t estimated = index.EstimateRows(keys, qe.condition);
+		if (estimated >= 0) rows = std::min(rows, estimated);
+	}
+	// Unsorted query stops after start+count rows are selected
+	if (q.sortingEntries_.empty() && q.forcedSortOrder.empty() && q.aggregations_.empty() && q.calcTotal == ModeNoTotal &&
+		q.count != UINT_MAX) {
+		rows = std::min(rows, int64_t(q.start) + q.count);
+	}
+	return rows;
+}
+
+JoinHashTable::Ptr ReindexerImpl::getJoinHashTable(const Query& jq, Namespace::Ptr jns, SelectCtx::PreResult::Ptr preResult,
+												   int64_t mainRows, NsLocker& locks) {
+	// Hash join is possible only for equality conditions and default order of joined items
+	if (jq.joinEntries_.empty() || !jq.sortingEntries_.empty() || !jq.forcedSortOrder.empty() || !jq.aggregations_.empty() ||
+		!jq.selectFunctions_.empty()) {
+		return nullptr;
+	}
+
+	h_vector<int, 2> fields;
+	h_vector<KeyValueType, 2> keyTypes;
+	for (auto& je : jq.joinEntries_) {
+		int joinIdx = IndexValueType::NotSet;
+		if (je.op_ != OpAnd || je.condition_ != CondEq || !jns->getIndexByName(je.joinIndex_, joinIdx)) return nullptr;
+		// Only dense indexed fields of joined namespace are supported
+		if (joinIdx <= 0 || joinIdx >= jns->payloadType_.NumFields()) return nullptr;
+		const Index& index = *jns->indexes_[joinIdx];
+		if (index.KeyType() == KeyValueString && index.Opts().GetCollateMode() != CollateNone) return nullptr;
+		fields.push_back(joinIdx);
+		keyTypes.push_back(index.KeyType());
+	}
+	for (auto& qe : jq.entries) {
+		int idxNo = IndexValueType::NotSet;
+		if (jns->getIndexByName(qe.index, idxNo) && isFullText(jns->indexes_[idxNo]->Type())) return nullptr;
+	}
+
+	JoinCacheRes cacheRes;
+	cacheRes.key.SetHashTableData(jq);
+	jns->GetFromJoinCache(cacheRes);
+	if (cacheRes.haveData && cacheRes.it.val.hashTable) return cacheRes.it.val.hashTable;
+
+	// Table is built by one pass over joined rows, and nested loop does select by index for each main row,
+	// so table is built only if there are more main rows than joined ones
+	int64_t joinedRows = jns->items_.size() - jns->free_.size();
+	if (!jq.entries.empty()) {
+		if (!preResult || !preResult->sortBy.empty()) return nullptr;
+		switch (preResult->mode) {
+			case SelectCtx::PreResult::ModeIdSet:
+				joinedRows = preResult->ids.size();
+				break;
+			case SelectCtx::PreResult::ModeIterators:
+				for (auto& it : preResult->iterators) {
+					if (it.op == OpAnd && !it.comparators_.size()) joinedRows = std::min(joinedRows, int64_t(it.GetMaxIterations()));
+				}
+				break;
+			default:
+				return nullptr;
+		}
+	}
+	if (joinedRows > kMaxHashJoinItems || joinedRows >= mainRows) return nullptr;
+
+	auto table = std::make_shared<JoinHashTable>(jns->payloadType_, fields, keyTypes);
+	if (jq.entries.empty()) {
+		for (IdType id = 0; id < IdType(jns->items_.size()); ++id) {
+			if (!jns->items_[id].IsFree()) table->Add(id, jns->items_[id]);
+		}
+	} else if (preResult->mode == SelectCtx::PreResult::ModeIdSet) {
+		for (auto id : preResult->ids) table->Add(id, jns->items_[id]);
+	} else {
+		// Materialize preResult iterators once
+		Query q(jq._namespace);
+		q.Debug(jq.debugLevel);
+		SelectCtx ctx(q, &locks);
+		ctx.preResult = preResult;
+		ctx.skipIndexesLookup = true;
+		QueryResults qr;
+		jns->Select(qr, ctx);
+		for (auto& r : qr.Items()) table->Add(r.id, r.value);
+	}
+	if (cacheRes.needPut) jns->PutToJoinCache(cacheRes, table);
+	return table;
+}
+
+void ReindexerImpl::doSelect(const Query& q, QueryResults& result, NsLocker& locks, SelectFunctionsHolder& func, WorkerPool* workers) {
 	auto ns = locks.Get(q._namespace);
 	if (!ns) {
 		throw Error(errParams, "Namespace '%s' is not exists", q._namespace.c_str());
@@ -568,6 +889,8 @@ void ReindexerImpl::doSelect(const Query& q, QueryResults& result, NsLocker& loc
 		ctx.joinedSelectors = joinedSelectors.size() ? &joinedSelectors : nullptr;
 		ctx.nsid = 0;
 		ctx.isForceAll = !q.mergeQueries_.empty() || !q.forcedSortOrder.empty();
+		ctx.workers = workers;
+		ctx.parallelThreshold = parallelSelectThreshold_;
 		ns->Select(result, ctx);
 	}
 
@@ -650,6 +973,7 @@ Error ReindexerImpl::AddIndex(const string& nsName, const IndexDef& indexDef) {
 	try {
 		auto ns = getNamespace(nsName);
 		ns->AddIndex(indexDef);
+		wakeOptimizer();
 		observers_.OnModifyIndex(nsName, indexDef, ModeInsert);
 	} catch (const Error& err) {
 		return err;
@@ -661,6 +985,7 @@ Error ReindexerImpl::UpdateIndex(const string& nsName, const IndexDef& indexDef)
 	try {
 		auto ns = getNamespace(nsName);
 		ns->UpdateIndex(indexDef);
+		wakeOptimizer();
 		observers_.OnModifyIndex(nsName, indexDef, ModeUpdate);
 	} catch (const Error& err) {
 		return err;
@@ -672,6 +997,7 @@ Error ReindexerImpl::DropIndex(const string& nsName, const string& indexName) {
 	try {
 		auto ns = getNamespace(nsName);
 		ns->DropIndex(indexName);
+		wakeOptimizer();
 		observers_.OnDropIndex(nsName, indexName);
 	} catch (const Error& err) {
 		return err;
@@ -712,7 +1038,7 @@ Error ReindexerImpl::EnumNamespaces(vector<NamespaceDef>& defs, bool bEnumAll) {
 				string dbpath = fs::JoinPath(storagePath_, d.name);
 				unique_ptr<Namespace> tmpNs(new Namespace(d.name, CacheMode::CacheModeOn));
 				try {
-					tmpNs->EnableStorage(storagePath_, StorageOpts());
+					enableStorage(*tmpNs, StorageOpts());
 					defs.push_back(tmpNs->GetDefinition());
 				} catch (reindexer::Error) {
 				}
@@ -742,6 +1068,37 @@ void ReindexerImpl::flusherThread() {
 	nsFlush();
 }
 
+void ReindexerImpl::optimizerThread() {
+	std::unique_lock<std::mutex> lck(optimizerMtx_);
+	while (!stopOptimizer_) {
+		optimizerCond_.wait(lck, [this]() { return stopOptimizer_ || optimizerWakeup_; });
+		optimizerWakeup_ = false;
+		int timeoutMs = optimizationTimeoutMs_;
+		if (timeoutMs <= 0) continue;
+		// Namespaces are optimized after quiet period. Namespaces, which are updated while waiting, wake optimizer again,
+		// so they are optimized by one of the next rounds
+		if (optimizerCond_.wait_for(lck, std::chrono::milliseconds(timeoutMs), [this]() { return bool(stopOptimizer_); })) break;
+		lck.unlock();
+		auto nsarray = getNamespaces();
+		for (auto& ns : nsarray) {
+			if (stopOptimizer_) break;
+			try {
+				ns->OptimizeIndexes(timeoutMs);
+			} catch (const Error& err) {
+				logPrintf(LogError, "Background optimization of namespace '%s' failed: %s", ns->GetName().c_str(), err.what().c_str());
+			}
+		}
+		lck.lock();
+	}
+}
+
+void ReindexerImpl::wakeOptimizer() {
+	if (optimizationTimeoutMs_ <= 0 || optimizerWakeup_.load(std::memory_order_relaxed)) return;
+	std::lock_guard<std::mutex> lck(optimizerMtx_);
+	optimizerWakeup_ = true;
+	optimizerCond_.notify_all();
+}
+
 void ReindexerImpl::createSystemNamespaces() {
 	AddNamespace(NamespaceDef(kPerfStatsNamespace, StorageOpts())
 					 .AddIndex("name", "hash", "string", IndexOpts().PK())
@@ -789,11 +1146,24 @@ std::vector<string> defDBConfig = {
 			"memstats":true
 		}
 	})json",
+	R"json({
+		"type":"optimization", 
+		"optimization":{
+			"timeout_ms":0,
+			"parallel_select_threads":1,
+			"parallel_select_threshold":100000
+		}
+	})json",
 	R"json({
 		"type":"log_queries", 
 		"log_queries":[
 			{"namespace":"*","log_level":"none"}
 	]})json",
+	R"json({
+		"type":"namespaces", 
+		"namespaces":[
+			{"namespace":"*","sorted_ids_mode":"copy","wal_size":100000}
+	]})json",
 };
 
 Error ReindexerImpl::InitSystemNamespaces() {
@@ -835,8 +1205,8 @@ void ReindexerImpl::syncSystemNamespaces(const string& name) {
 	auto nsarray = getNamespaces();
 	WrSerializer ser;
 
-	auto forEachNS = [&](Namespace::Ptr sysNs, std::function<void(Namespace::Ptr ns)> filler) {
-		for (auto& ns : nsarray) {
+	auto forEachNS = [&](Namespace::Ptr sysNs, const std::vector<Namespace::Ptr>& namespaces, std::function<void(Namespace::Ptr ns)> filler) {
+		for (auto& ns : namespaces) {
 			ser.Reset();
 			filler(ns);
 			auto item = sysNs->NewItem();
@@ -850,15 +1220,20 @@ void ReindexerImpl::syncSystemNamespaces(const string& name) {
 	mtx_.unlock_shared();
 
 	if (profCfg->perfStats && (name.empty() || name == kPerfStatsNamespace)) {
-		forEachNS(getNamespace(kPerfStatsNamespace), [&](Namespace::Ptr ns) { ns->GetPerfStat().GetJSON(ser); });
+		forEachNS(getNamespace(kPerfStatsNamespace), nsarray, [&](Namespace::Ptr ns) { ns->GetPerfStat().GetJSON(ser); });
 	}
 
 	if (profCfg->memStats && (name.empty() || name == kMemStatsNamespace)) {
-		forEachNS(getNamespace(kMemStatsNamespace), [&](Namespace::Ptr ns) { ns->GetMemStat().GetJSON(ser); });
+		// Namespaces, which are being loaded from storage, report progress of loading
+		auto memstatsArray = nsarray;
+		mtx_.lock_shared();
+		memstatsArray.insert(memstatsArray.end(), loadingNamespaces_.begin(), loadingNamespaces_.end());
+		mtx_.unlock_shared();
+		forEachNS(getNamespace(kMemStatsNamespace), memstatsArray, [&](Namespace::Ptr ns) { ns->GetMemStat().GetJSON(ser); });
 	}
 
 	if (name.empty() || name == kNamespacesNamespace) {
-		forEachNS(getNamespace(kNamespacesNamespace), [&](Namespace::Ptr ns) { ns->GetDefinition().GetJSON(ser, true); });
+		forEachNS(getNamespace(kNamespacesNamespace), nsarray, [&](Namespace::Ptr ns) { ns->GetDefinition().GetJSON(ser, true); });
 	}
 
 	if (profCfg->queriesPerfStats && (name.empty() || name == kQueriesPerfStatsNamespace)) {
@@ -906,6 +1281,26 @@ void ReindexerImpl::updateSystemNamespace(const string& nsName, Item& item) {
 					ns->EnablePerfCounters(cfg->perfStats);
 				}
 
+			} else if (!strcmp(elem->key, "optimization")) {
+				DBOptimizationConfig cfg;
+				auto err = cfg.FromJSON(elem->value);
+				if (!err.ok()) throw err;
+				optimizationTimeoutMs_ = cfg.timeoutMs;
+				parallelSelectThreshold_ = cfg.parallelSelectThreshold;
+
+				lock_guard<shared_timed_mutex> lock(mtx_);
+				if (cfg.timeoutMs > 0 && !optimizer_.joinable()) {
+					optimizer_ = std::thread([this]() { this->optimizerThread(); });
+				}
+				// Namespaces, which were updated before optimizer was enabled, are optimized too
+				wakeOptimizer();
+				// Queries, which are running, keep old pool until they are done
+				int poolThreads = std::max(cfg.parallelSelectThreads - 1, 0);
+				if (!poolThreads) {
+					selectWorkers_.reset();
+				} else if (!selectWorkers_ || selectWorkers_->Concurrency() != poolThreads + 1) {
+					selectWorkers_ = std::make_shared<WorkerPool>(poolThreads);
+				}
 			} else if (!strcmp(elem->key, "log_queries")) {
 				DBLoggingConfig cfg;
 				auto err = cfg.FromJSON(elem->value);
@@ -923,6 +1318,34 @@ void ReindexerImpl::updateSystemNamespace(const string& nsName, Item& item) {
 					}
 					ns->SetQueriesLogLevel(logLevel);
 				}
+			} else if (!strcmp(elem->key, "namespaces")) {
+				DBNamespacesConfig cfg;
+				auto err = cfg.FromJSON(elem->value);
+				if (!err.ok()) throw err;
+				bool defOnDemand = false;
+				if (cfg.onDemandSortedIds.find("*") != cfg.onDemandSortedIds.end()) {
+					defOnDemand = cfg.onDemandSortedIds.find("*")->second;
+				}
+				size_t defWALSize = kDefaultWALSize;
+				if (cfg.walSize.find("*") != cfg.walSize.end()) {
+					defWALSize = cfg.walSize.find("*")->second;
+				}
+
+				auto nsarray = getNamespaces();
+				for (auto& ns : nsarray) {
+					bool onDemand = defOnDemand;
+					if (cfg.onDemandSortedIds.find(ns->GetName()) != cfg.onDemandSortedIds.end()) {
+						onDemand = cfg.onDemandSortedIds.find(ns->GetName())->second;
+					}
+					ns->SetOnDemandSortedIds(onDemand);
+					// Changes of system namespaces are not replicated
+					if (ns->GetName()[0] == '#') continue;
+					size_t walSize = defWALSize;
+					if (cfg.walSize.find(ns->GetName()) != cfg.walSize.end()) {
+						walSize = cfg.walSize.find(ns->GetName())->second;
+					}
+					ns->SetWALSize(walSize);
+				}
 			}
 		}
 	};
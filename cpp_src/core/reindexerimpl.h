@@ -1,11 +1,16 @@
 #pragma once
 
 #include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
+#include "core/connectopts.h"
 #include "core/namespace.h"
+#include "core/nsselecter/joinhashtable.h"
 #include "core/nsselecter/nsselecter.h"
+#include "core/transaction.h"
 #include "dbconfig.h"
 #include "estl/fast_hash_map.h"
 #include "estl/h_vector.h"
@@ -14,6 +19,7 @@
 #include "querystat.h"
 #include "replicator/updatesobserver.h"
 #include "tools/errors.h"
+#include "tools/workerpool.h"
 
 using std::shared_ptr;
 using std::string;
@@ -27,8 +33,8 @@ public:
 	ReindexerImpl();
 	~ReindexerImpl();
 
-	Error Connect(const string &dsn);
-	Error EnableStorage(const string &storagePath, bool skipPlaceholderCheck = false);
+	Error Connect(const string &dsn, const ConnectOpts &opts = ConnectOpts());
+	Error EnableStorage(const string &storagePath, bool skipPlaceholderCheck = false, const ConnectOpts &opts = ConnectOpts());
 	Error OpenNamespace(const string &_namespace, const StorageOpts &opts = StorageOpts().Enabled().CreateIfMissing(),
 						CacheMode cacheMode = CacheMode::CacheModeOn);
 	Error AddNamespace(const NamespaceDef &nsDef);
@@ -47,9 +53,14 @@ public:
 	Error Select(const Query &query, QueryResults &result, Completion cmpl = nullptr);
 	Error Commit(const string &namespace_);
 	Item NewItem(const string &_namespace);
+	Transaction NewTransaction(const string &_namespace);
+	Error CommitTransaction(Transaction &tx);
 	Error GetMeta(const string &_namespace, const string &key, string &data);
 	Error PutMeta(const string &_namespace, const string &key, const string_view &data);
 	Error EnumMeta(const string &_namespace, vector<string> &keys);
+	Error GetWAL(const string &_namespace, int64_t lastLSN, int limit, WALChunk &chunk);
+	Error GetSnapshot(const string &_namespace, int64_t lsn, int64_t fromID, int maxSize, SnapshotChunk &chunk);
+	Error LoadSnapshot(const string &_namespace, SnapshotFetcher fetch);
 	Error InitSystemNamespaces();
 	Error SubscribeUpdates(IUpdatesObserver *observer, bool subscribe);
 
@@ -98,9 +109,14 @@ protected:
 		bool locked_ = false;
 		bool upgraded_ = false;
 	};
-	void doSelect(const Query &q, QueryResults &res, NsLocker &locker, SelectFunctionsHolder &func);
+	void doSelect(const Query &q, QueryResults &res, NsLocker &locker, SelectFunctionsHolder &func, WorkerPool *workers);
 	JoinedSelectors prepareJoinedSelectors(const Query &q, QueryResults &result, NsLocker &locks, h_vector<Query, 4> &queries,
 										   SelectFunctionsHolder &func);
+	// Gets hash table of joined rows from join cache, or builds it, if it costs less than nested selects for main rows
+	JoinHashTable::Ptr getJoinHashTable(const Query &jq, Namespace::Ptr jns, SelectCtx::PreResult::Ptr preResult, int64_t mainRows,
+										NsLocker &locks);
+	// Estimates amount of rows of namespace, which are selected by query, by statistics of indexes
+	int64_t estimateSelectedRows(const Query &q, Namespace::Ptr ns);
 
 	void syncSystemNamespaces(const string &nsName);
 	void createSystemNamespaces();
@@ -108,19 +124,43 @@ protected:
 	Error applyConfig();
 
 	void flusherThread();
+	void optimizerThread();
+	// Wakes optimizer after update of namespace
+	void wakeOptimizer();
 	Error closeNamespace(const string &_namespace, bool dropStorage);
+	// Load namespace from storage. Namespace is visible in #memstats with progress of loading, until it is loaded
+	void loadNamespace(Namespace::Ptr ns);
+	// Enables storage of namespace with engine and tunables of database
+	void enableStorage(Namespace &ns, const StorageOpts &opts, const string &path = string());
 	Namespace::Ptr getNamespace(const string &_namespace);
 	std::vector<Namespace::Ptr> getNamespaces();
 	std::vector<string> getNamespacesNames();
 
 	fast_hash_map<string, Namespace::Ptr, nocase_hash_str, nocase_equal_str> namespaces_;
+	// Namespaces, which are being loaded from storage and are not added to namespaces_ yet
+	vector<Namespace::Ptr> loadingNamespaces_;
 
 	shared_timed_mutex mtx_;
 	string storagePath_;
+	datastorage::StorageType storageType_ = datastorage::StorageType::LevelDB;
+	StorageOpts storageTunables_;
+	// Block cache of storage engine, shared by all the namespaces
+	datastorage::BlockCache::Ptr blockCache_;
 
 	std::thread flusher_;
 	std::atomic<bool> stopFlusher_;
 
+	std::thread optimizer_;
+	std::atomic<bool> stopOptimizer_;
+	std::atomic<int> optimizationTimeoutMs_;
+	// Optimizer sleeps until namespaces are updated
+	std::mutex optimizerMtx_;
+	std::condition_variable optimizerCond_;
+	std::atomic<bool> optimizerWakeup_;
+	// Workers for parallel select loop, shared by all the queries. nullptr - parallel select is disabled
+	std::shared_ptr<WorkerPool> selectWorkers_;
+	std::atomic<int> parallelSelectThreshold_;
+
 	QueriesStatTracer queriesStatTracker_;
 	std::shared_ptr<DBProfilingConfig> profConfig_;
 	std::mutex profCfgMtx_;
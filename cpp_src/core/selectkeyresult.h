@@ -1,10 +1,13 @@
 #pragma once
 
+#include <algorithm>
 #include <climits>
 #include <memory>
+#include <vector>
 
 #include "core/comparator.h"
 #include "core/idset.h"
+#include "core/idsetbitmap.h"
 #include "index/keyentry.h"
 
 namespace reindexer {
@@ -135,6 +138,9 @@ protected:
 class SelectKeyResult : public h_vector<SingleSelectKeyResult, 1> {
 public:
 	h_vector<Comparator, 1> comparators_;
+	/// Compressed bitmap of all the ids of result.
+	/// Available only for cached results of indexes with bitmap option.
+	IdSetBitmap::Ptr bitmap_;
 
 	/// Represents data as one sorted set.
 	/// Creates 1 set from all the inner
@@ -180,6 +186,20 @@ public:
 		push_back(SingleSelectKeyResult(mergedIds));
 		return mergedIds;
 	}
+
+	/// Converts rowIds of result to positions of rows
+	/// in sort orders of sort index. Used, when idsets
+	/// do not keep copies of ids, sorted by sort index.
+	/// @param ranks - position in sort orders for each rowId.
+	void MapToSortRanks(const std::vector<SortType> &ranks) {
+		if (empty()) return;
+		auto ids = mergeIdsets();
+		IdType *data = ids->data();
+		for (size_t i = 0; i < ids->size(); i++) data[i] = ranks[data[i]];
+		std::sort(data, data + ids->size());
+		// Bitmap keeps rowIds, so it can't be used with positions in sort orders
+		bitmap_.reset();
+	}
 };  // namespace reindexer
 
 /// Result of selecting data for
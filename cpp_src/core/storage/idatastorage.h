@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <memory>
 #include "estl/string_view.h"
 #include "tools/errors.h"
@@ -27,11 +28,23 @@ public:
 	using Ptr = shared_ptr<const Snapshot>;
 };
 
+/// Block cache of storage engine. One cache is shared by storages of all the namespaces of database
+class BlockCache {
+public:
+	virtual ~BlockCache() = default;
+	using Ptr = shared_ptr<BlockCache>;
+};
+
 /// Low-level data storage abstraction.
 class IDataStorage {
 public:
 	virtual ~IDataStorage() = default;
 
+	/// Sets block cache, which is shared with other storages. Must be called before Open.
+	/// Storage with shared cache ignores StorageOpts::BlockCacheSize
+	/// @param cache - cache, which is created by StorageFactory for engine of this storage.
+	virtual void SetBlockCache(BlockCache::Ptr cache) { (void)cache; }
+
 	/// Opens a storage.
 	/// @param path - path to storage.
 	/// @param opts - options.
@@ -81,7 +94,8 @@ public:
 	virtual void ReleaseSnapshot(Snapshot::Ptr snapshot) = 0;
 
 	/// Flushes all updates to Storage.
-	virtual void Flush() = 0;
+	/// @return Error, if updates could not be flushed.
+	virtual Error Flush() = 0;
 
 	/// Allocates and returns Cursor object to a Storage.
 	/// The client itself is responsible for it's deallocation.
@@ -89,6 +103,15 @@ public:
 	/// @return newly created Cursor object.
 	virtual Cursor* GetCursor(StorageOpts& opts) = 0;
 
+	/// Reads all the records, which keys start from prefix, in order, which is the fastest for engine.
+	/// Records are not ordered by keys. Default implementation reads them by cursor.
+	/// @param opts - options.
+	/// @param prefix - prefix of keys.
+	/// @param visitor - called for each record. Reading is stopped, if it returns false.
+	/// @return Error code or ok.
+	virtual Error ReadPrefix(StorageOpts& opts, const string_view& prefix,
+							 std::function<bool(const string_view& key, const string_view& value)> visitor);
+
 	/// Allocates and returns UpdatesCollection object to a Storage.
 	/// The client itself is responsible for it's deallocation.
 	/// @return newly created UpdatesCollection object.
@@ -173,5 +196,15 @@ public:
 	///         3. > 0 if "a" > "b"
 	virtual int Compare(const string_view& a, const string_view& b) const = 0;
 };
+
+inline Error IDataStorage::ReadPrefix(StorageOpts& opts, const string_view& prefix,
+									  std::function<bool(const string_view& key, const string_view& value)> visitor) {
+	std::unique_ptr<Cursor> dbIter(GetCursor(opts));
+	string end = prefix.ToString() + "\xFF";
+	for (dbIter->Seek(prefix); dbIter->Valid() && dbIter->GetComparator().Compare(dbIter->Key(), end) < 0; dbIter->Next()) {
+		if (!visitor(dbIter->Key(), dbIter->Value())) break;
+	}
+	return errOK;
+}
 }  // namespace datastorage
 }  // namespace reindexer
@@ -1,5 +1,6 @@
 #include "leveldbstorage.h"
 
+#include <leveldb/cache.h>
 #include <leveldb/comparator.h>
 #include <leveldb/db.h>
 #include <leveldb/iterator.h>
@@ -17,10 +18,16 @@ void toReadOptions(const StorageOpts& opts, leveldb::ReadOptions& ropts) {
 namespace reindexer {
 namespace datastorage {
 
+LevelDbBlockCache::LevelDbBlockCache(size_t size) : cache(leveldb::NewLRUCache(size)) {}
+
+LevelDbBlockCache::~LevelDbBlockCache() {}
+
 LevelDbStorage::LevelDbStorage() {}
 
 LevelDbStorage::~LevelDbStorage() {}
 
+void LevelDbStorage::SetBlockCache(BlockCache::Ptr cache) { blockCache_ = std::dynamic_pointer_cast<LevelDbBlockCache>(cache); }
+
 Error LevelDbStorage::Open(const string& path, const StorageOpts& opts) {
 	if (path.empty()) {
 		throw Error(errParams, "Cannot enable storage: the path is empty '%s'", path.c_str());
@@ -28,7 +35,12 @@ Error LevelDbStorage::Open(const string& path, const StorageOpts& opts) {
 
 	leveldb::Options options;
 	options.create_if_missing = opts.IsCreateIfMissing();
-	options.max_open_files = 50;
+	options.max_open_files = opts.GetMaxOpenFiles() ? opts.GetMaxOpenFiles() : 50;
+	if (opts.GetWriteBufferSize()) options.write_buffer_size = opts.GetWriteBufferSize();
+	if (opts.GetCompression() == kStorageCompressionNone) options.compression = leveldb::kNoCompression;
+	if (opts.GetCompression() == kStorageCompressionSnappy) options.compression = leveldb::kSnappyCompression;
+	if (!blockCache_ && opts.GetBlockCacheSize()) blockCache_ = std::make_shared<LevelDbBlockCache>(opts.GetBlockCacheSize());
+	if (blockCache_) options.block_cache = blockCache_->cache.get();
 
 	leveldb::DB* db;
 	leveldb::Status status = leveldb::DB::Open(options, path.c_str(), &db);
@@ -101,14 +113,14 @@ void LevelDbStorage::ReleaseSnapshot(Snapshot::Ptr snapshot) {
 	snapshot.reset();
 }
 
-void LevelDbStorage::Flush() {
+Error LevelDbStorage::Flush() {
 	// LevelDB does not support Flush mechanism.
 	// It just doesn't know when an asynchronous
 	// write has completed. So the only way (the dump
 	// way) is to just close the Storage and then open
 	// it again. So that is what we do:
 	db_.reset();
-	Open(dbpath_, opts_);
+	return Open(dbpath_, opts_);
 }
 
 void LevelDbStorage::Destroy(const string& path) {
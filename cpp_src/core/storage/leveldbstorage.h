@@ -6,6 +6,7 @@
 using std::unique_ptr;
 
 namespace leveldb {
+class Cache;
 class DB;
 class Snapshot;
 class Iterator;
@@ -14,11 +15,20 @@ class Iterator;
 namespace reindexer {
 namespace datastorage {
 
+class LevelDbBlockCache : public BlockCache {
+public:
+	LevelDbBlockCache(size_t size);
+	~LevelDbBlockCache();
+
+	unique_ptr<leveldb::Cache> cache;
+};
+
 class LevelDbStorage : public IDataStorage {
 public:
 	LevelDbStorage();
 	~LevelDbStorage();
 
+	void SetBlockCache(BlockCache::Ptr cache) final;
 	Error Open(const string& path, const StorageOpts& opts) final;
 	Error Read(const StorageOpts& opts, const string_view& key, string& value) final;
 	Error Write(const StorageOpts& opts, const string_view& key, const string_view& value) final;
@@ -28,7 +38,7 @@ public:
 	Snapshot::Ptr MakeSnapshot() final;
 	void ReleaseSnapshot(Snapshot::Ptr) final;
 
-	void Flush() final;
+	Error Flush() final;
 	void Destroy(const string& path) final;
 	Cursor* GetCursor(StorageOpts& opts) final;
 	UpdatesCollection* GetUpdatesCollection() final;
@@ -36,6 +46,8 @@ public:
 private:
 	string dbpath_;
 	StorageOpts opts_;
+	// Block cache is shared by reopens of DB on Flush and by other storages of database, so it is destroyed after DB
+	shared_ptr<LevelDbBlockCache> blockCache_;
 	shared_ptr<leveldb::DB> db_;
 };
 
@@ -0,0 +1,651 @@
+#ifndef _WIN32
+
+#include "nativestorage.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <thread>
+#include "estl/fast_hash_map.h"
+#include "tools/customhash.h"
+#include "tools/fsops.h"
+#include "tools/logger.h"
+#include "vendor/murmurhash/MurmurHash3.h"
+
+namespace reindexer {
+namespace datastorage {
+
+// Header of record: checksum, size of key, size of value and flags. Key and value follow it.
+// Checksum covers the rest of header, key and value, so record, which was not written completely, ends segment
+const size_t kNativeHeaderSize = 4 * sizeof(uint32_t);
+const uint32_t kNativeRecordDeleted = 1;
+const char* kNativeSegmentExt = ".seg";
+// Segments are compacted, if their live records take less than this part of them
+const double kNativeCompactionLiveRatio = 0.5;
+// Interval of checks of compaction by background thread
+const std::chrono::seconds kNativeCompactionInterval(10);
+
+static const char* storageNotInitialized = "Storage is not initialized";
+
+static uint32_t recordChecksum(const char* record, size_t size) {
+	uint32_t hash;
+	MurmurHash3_x86_32(record + sizeof(uint32_t), int(size - sizeof(uint32_t)), 0, &hash);
+	return hash;
+}
+
+static size_t recordSize(size_t keySize, size_t valueSize) { return kNativeHeaderSize + keySize + valueSize; }
+
+static Error writeAll(int fd, const char* data, size_t size, size_t offset) {
+	while (size) {
+		ssize_t written = pwrite(fd, data, size, offset);
+		if (written < 0) {
+			if (errno == EINTR) continue;
+			return Error(errLogic, "Can't write to segment of storage: %s", strerror(errno));
+		}
+		data += written;
+		offset += written;
+		size -= written;
+	}
+	return errOK;
+}
+
+/// Segment file, which is mapped to memory. Records are written by pwrite, and are read by mapping, which shares page cache with file
+struct NativeSegment {
+	NativeSegment(uint32_t segmentID, const string& segmentPath) : id(segmentID), path(segmentPath) {}
+	~NativeSegment() {
+		if (data) munmap(const_cast<char*>(data), capacity);
+		if (fd >= 0) close(fd);
+	}
+	NativeSegment(const NativeSegment&) = delete;
+	NativeSegment& operator=(const NativeSegment&) = delete;
+
+	// Opens segment file, and maps it to memory. File is extended to minCapacity: extended tail is zeroed, so it ends records
+	Error Open(size_t minCapacity) {
+		fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+		if (fd < 0) return Error(errLogic, "Can't open segment '%s': %s", path.c_str(), strerror(errno));
+		struct stat st;
+		if (fstat(fd, &st) < 0) return Error(errLogic, "Can't stat segment '%s': %s", path.c_str(), strerror(errno));
+		capacity = st.st_size;
+		if (minCapacity > capacity) {
+			if (ftruncate(fd, minCapacity) < 0) return Error(errLogic, "Can't extend segment '%s': %s", path.c_str(), strerror(errno));
+			capacity = minCapacity;
+		}
+		// Segment file may be left empty by crash on its creation
+		if (!capacity) return errOK;
+		void* ptr = mmap(nullptr, capacity, PROT_READ, MAP_SHARED, fd, 0);
+		if (ptr == MAP_FAILED) return Error(errLogic, "Can't map segment '%s': %s", path.c_str(), strerror(errno));
+		data = static_cast<const char*>(ptr);
+		return errOK;
+	}
+
+	const uint32_t id;
+	const string path;
+	int fd = -1;
+	const char* data = nullptr;
+	size_t capacity = 0;
+	// End of written records
+	size_t size = 0;
+	// Size of records, which are not overwritten or deleted
+	size_t liveBytes = 0;
+};
+
+struct NativeKeyHash {
+	size_t operator()(const string_view& key) const { return _Hash_bytes(key.data(), key.size()); }
+};
+
+/// State of storage: segments and index of keys to their live records
+struct NativeState {
+	Error Open(const string& storagePath, const StorageOpts& opts);
+	void Close();
+	// Appends records to the active segment, and applies them to index
+	Error Append(const vector<NativeBatchBuffer::Record>& records, bool sync);
+	int Compact();
+
+	// Reads records of segment, and applies them to index
+	// @return false, if segment ends by incomplete or corrupted record
+	bool load(NativeSegment& seg);
+	Error addSegment(size_t minCapacity);
+	// Key must point to record of loc in mapped segment
+	void put(const string_view& key, NativeLocation loc);
+	void erase(const string_view& key);
+	// Appends live records of the oldest segment again, and removes it
+	Error compactSegment(NativeSegment& seg);
+	NativeSegment& active() { return *segments.rbegin()->second; }
+
+	std::mutex mtx;
+	bool closed = true;
+	string path;
+	size_t segmentSize = kNativeSegmentSize;
+	// Keys of index point to keys of live records in mapped segments, so they are not copied to heap
+	fast_hash_map<string_view, NativeLocation, NativeKeyHash> index;
+	map<uint32_t, shared_ptr<NativeSegment>> segments;
+	// Amount of running ReadPrefix calls. Segments are not compacted during them, so live records are not moved to segments,
+	// which are read again
+	int readers = 0;
+};
+
+/// Background thread, which compacts all native storages of process
+class NativeCompactor {
+public:
+	static NativeCompactor& Instance() {
+		static NativeCompactor compactor;
+		return compactor;
+	}
+	~NativeCompactor() {
+		{
+			std::lock_guard<std::mutex> lck(mtx_);
+			terminate_ = true;
+			cond_.notify_all();
+		}
+		if (thread_.joinable()) thread_.join();
+	}
+
+	void Add(std::weak_ptr<NativeState> state) {
+		std::lock_guard<std::mutex> lck(mtx_);
+		states_.push_back(state);
+		if (!thread_.joinable()) thread_ = std::thread([this]() { run(); });
+	}
+
+protected:
+	void run() {
+		std::unique_lock<std::mutex> lck(mtx_);
+		while (!terminate_) {
+			cond_.wait_for(lck, kNativeCompactionInterval, [this]() { return terminate_; });
+			if (terminate_) break;
+
+			vector<shared_ptr<NativeState>> states;
+			for (auto it = states_.begin(); it != states_.end();) {
+				auto state = it->lock();
+				if (!state) {
+					it = states_.erase(it);
+					continue;
+				}
+				states.push_back(state);
+				++it;
+			}
+			lck.unlock();
+			for (auto& state : states) state->Compact();
+			states.clear();
+			lck.lock();
+		}
+	}
+
+	std::mutex mtx_;
+	std::condition_variable cond_;
+	bool terminate_ = false;
+	vector<std::weak_ptr<NativeState>> states_;
+	std::thread thread_;
+};
+
+static string segmentName(uint32_t id) {
+	char name[32];
+	snprintf(name, sizeof(name), "%08u%s", id, kNativeSegmentExt);
+	return name;
+}
+
+Error NativeState::Open(const string& storagePath, const StorageOpts& opts) {
+	if (!fs::DirectoryExists(storagePath)) {
+		if (!opts.IsCreateIfMissing()) return Error(errLogic, "Storage '%s' does not exist", storagePath.c_str());
+		if (fs::MkDirAll(storagePath) < 0) {
+			return Error(errLogic, "Can't create storage '%s': %s", storagePath.c_str(), strerror(errno));
+		}
+	}
+
+	vector<fs::DirEntry> entries;
+	if (fs::ReadDir(storagePath, entries) < 0) return Error(errLogic, "Can't read storage '%s': %s", storagePath.c_str(), strerror(errno));
+	vector<uint32_t> ids;
+	const size_t extLen = strlen(kNativeSegmentExt);
+	for (auto& entry : entries) {
+		if (entry.isDir || entry.name.size() <= extLen || entry.name.compare(entry.name.size() - extLen, extLen, kNativeSegmentExt)) {
+			continue;
+		}
+		ids.push_back(strtoul(entry.name.c_str(), nullptr, 10));
+	}
+	std::sort(ids.begin(), ids.end());
+
+	path = storagePath;
+	segmentSize = opts.GetWriteBufferSize() ? opts.GetWriteBufferSize() : kNativeSegmentSize;
+	index.clear();
+	segments.clear();
+
+	// Later segments overwrite records of earlier ones
+	bool corrupted = false;
+	for (auto id : ids) {
+		auto seg = std::make_shared<NativeSegment>(id, fs::JoinPath(path, segmentName(id)));
+		auto err = seg->Open(0);
+		if (!err.ok()) return err;
+		segments.emplace(id, seg);
+		corrupted = !load(*seg);
+	}
+	// New records are not appended after corrupted one, because its tail could be taken for records on the next open
+	if (segments.empty() || corrupted) {
+		auto err = addSegment(0);
+		if (!err.ok()) return err;
+	}
+	closed = false;
+	return errOK;
+}
+
+void NativeState::Close() {
+	closed = true;
+	index.clear();
+	// Segments are unmapped, when cursors release them
+	segments.clear();
+}
+
+bool NativeState::load(NativeSegment& seg) {
+	if (!seg.capacity) return true;
+	char* data = const_cast<char*>(seg.data);
+	// Segment is read sequentially, so kernel reads ahead it
+	madvise(data, seg.capacity, MADV_SEQUENTIAL);
+	madvise(data, seg.capacity, MADV_WILLNEED);
+
+	bool ok = true;
+	size_t offset = 0;
+	while (offset + kNativeHeaderSize <= seg.capacity) {
+		uint32_t header[4];
+		memcpy(header, seg.data + offset, sizeof(header));
+		uint32_t checksum = header[0], keySize = header[1], valueSize = header[2], flags = header[3];
+		// Zeroed tail of segment
+		if (!checksum && !keySize) break;
+
+		size_t size = recordSize(keySize, valueSize);
+		if (!keySize || size > seg.capacity - offset || recordChecksum(seg.data + offset, size) != checksum) {
+			logPrintf(LogWarning, "Storage segment '%s' is truncated at %d: record is not complete or corrupted", seg.path.c_str(),
+					  int(offset));
+			ok = false;
+			break;
+		}
+		string_view key(seg.data + offset + kNativeHeaderSize, keySize);
+		if (flags & kNativeRecordDeleted) {
+			erase(key);
+		} else {
+			put(key, NativeLocation{seg.id, uint32_t(offset + kNativeHeaderSize + keySize), valueSize});
+		}
+		offset += size;
+	}
+	seg.size = offset;
+
+	madvise(data, seg.capacity, MADV_NORMAL);
+	return ok;
+}
+
+Error NativeState::addSegment(size_t minCapacity) {
+	uint32_t id = segments.empty() ? 1 : segments.rbegin()->first + 1;
+	auto seg = std::make_shared<NativeSegment>(id, fs::JoinPath(path, segmentName(id)));
+	auto err = seg->Open(std::max(segmentSize, minCapacity));
+	if (!err.ok()) return err;
+	segments.emplace(id, seg);
+	return errOK;
+}
+
+void NativeState::put(const string_view& key, NativeLocation loc) {
+	auto it = index.find(key);
+	if (it != index.end()) {
+		// Key of index is replaced, because segment of the old record may be removed by compaction
+		segments[it->second.segment]->liveBytes -= recordSize(key.size(), it->second.size);
+		index.erase(it);
+	}
+	index.emplace(key, loc);
+	segments[loc.segment]->liveBytes += recordSize(key.size(), loc.size);
+}
+
+void NativeState::erase(const string_view& key) {
+	auto it = index.find(key);
+	if (it == index.end()) return;
+	segments[it->second.segment]->liveBytes -= recordSize(key.size(), it->second.size);
+	index.erase(it);
+}
+
+Error NativeState::Append(const vector<NativeBatchBuffer::Record>& records, bool sync) {
+	if (closed) throw Error(errParams, "%s", storageNotInitialized);
+
+	// Records are written to segment by chunks, and are applied to index after write
+	string buf;
+	size_t first = 0;
+	auto flush = [&](size_t end) {
+		if (buf.empty()) return Error();
+		NativeSegment& seg = active();
+		auto err = writeAll(seg.fd, buf.data(), buf.size(), seg.size);
+		if (!err.ok()) return err;
+		size_t offset = seg.size;
+		for (size_t i = first; i < end; i++) {
+			auto& rec = records[i];
+			if (rec.deleted) {
+				erase(rec.key);
+			} else {
+				put(string_view(seg.data + offset + kNativeHeaderSize, rec.key.size()),
+					NativeLocation{seg.id, uint32_t(offset + kNativeHeaderSize + rec.key.size()), uint32_t(rec.value.size())});
+			}
+			offset += recordSize(rec.key.size(), rec.value.size());
+		}
+		seg.size = offset;
+		buf.clear();
+		first = end;
+		return Error();
+	};
+
+	for (size_t i = 0; i < records.size(); i++) {
+		auto& rec = records[i];
+		size_t size = recordSize(rec.key.size(), rec.value.size());
+		if (active().size + buf.size() + size > active().capacity) {
+			auto err = flush(i);
+			if (!err.ok()) return err;
+			if (active().size + size > active().capacity) {
+				if (sync && fdatasync(active().fd) < 0) return Error(errLogic, "Can't sync segment of storage: %s", strerror(errno));
+				err = addSegment(size);
+				if (!err.ok()) return err;
+			}
+		}
+
+		uint32_t header[4] = {0, uint32_t(rec.key.size()), uint32_t(rec.value.size()), rec.deleted ? kNativeRecordDeleted : 0};
+		size_t offset = buf.size();
+		buf.append(reinterpret_cast<const char*>(header), sizeof(header));
+		buf.append(rec.key);
+		buf.append(rec.value);
+		header[0] = recordChecksum(&buf[offset], size);
+		memcpy(&buf[offset], &header[0], sizeof(header[0]));
+	}
+	auto err = flush(records.size());
+	if (!err.ok()) return err;
+
+	if (sync && fdatasync(active().fd) < 0) return Error(errLogic, "Can't sync segment of storage: %s", strerror(errno));
+	return errOK;
+}
+
+int NativeState::Compact() {
+	std::unique_lock<std::mutex> lck(mtx);
+	int removed = 0;
+	// Oldest segments are compacted first, so deleted records of removed segment can't uncover records of the same keys in older ones
+	while (!closed && !readers && segments.size() > 1) {
+		// Sealed segments are compacted, if their prefix has enough garbage
+		size_t total = 0, live = 0;
+		bool compact = false;
+		for (auto it = segments.begin(); it != std::prev(segments.end()); ++it) {
+			total += it->second->size;
+			live += it->second->liveBytes;
+			if (total - live >= segmentSize && live < total * kNativeCompactionLiveRatio) {
+				compact = true;
+				break;
+			}
+		}
+		if (!compact) break;
+
+		auto seg = segments.begin()->second;
+		auto err = compactSegment(*seg);
+		if (!err.ok()) {
+			logPrintf(LogError, "Can't compact storage segment '%s': %s", seg->path.c_str(), err.what().c_str());
+			break;
+		}
+		removed++;
+		// Writes are not blocked for compaction of all segments
+		lck.unlock();
+		lck.lock();
+	}
+	return removed;
+}
+
+Error NativeState::compactSegment(NativeSegment& seg) {
+	vector<NativeBatchBuffer::Record> records;
+	for (size_t offset = 0; offset < seg.size;) {
+		uint32_t header[4];
+		memcpy(header, seg.data + offset, sizeof(header));
+		uint32_t keySize = header[1], valueSize = header[2], flags = header[3];
+		size_t valueOffset = offset + kNativeHeaderSize + keySize;
+		if (!(flags & kNativeRecordDeleted)) {
+			string_view key(seg.data + offset + kNativeHeaderSize, keySize);
+			auto it = index.find(key);
+			if (it != index.end() && it->second.segment == seg.id && it->second.offset == valueOffset) {
+				records.push_back({key.ToString(), string(seg.data + valueOffset, valueSize), false});
+			}
+		}
+		offset += recordSize(keySize, valueSize);
+	}
+
+	// Copies of live records are synced, before segment is removed
+	auto err = Append(records, true);
+	if (!err.ok()) return err;
+	if (seg.liveBytes) return Error(errLogic, "Segment has %d bytes of live records after compaction", int(seg.liveBytes));
+	if (unlink(seg.path.c_str()) < 0) return Error(errLogic, "Can't remove segment: %s", strerror(errno));
+	segments.erase(seg.id);
+	return errOK;
+}
+
+NativeStorage::NativeStorage() : state_(std::make_shared<NativeState>()) { NativeCompactor::Instance().Add(state_); }
+
+NativeStorage::~NativeStorage() {
+	std::lock_guard<std::mutex> lck(state_->mtx);
+	state_->Close();
+}
+
+Error NativeStorage::Open(const string& path, const StorageOpts& opts) {
+	if (path.empty()) {
+		throw Error(errParams, "Cannot enable storage: the path is empty '%s'", path.c_str());
+	}
+
+	std::lock_guard<std::mutex> lck(state_->mtx);
+	auto err = state_->Open(path, opts);
+	if (!err.ok()) state_->Close();
+	return err;
+}
+
+Error NativeStorage::Read(const StorageOpts&, const string_view& key, string& value) {
+	std::lock_guard<std::mutex> lck(state_->mtx);
+	if (state_->closed) throw Error(errParams, "%s", storageNotInitialized);
+
+	auto it = state_->index.find(key);
+	if (it == state_->index.end()) return Error(errNotFound, "NotFound");
+	const NativeSegment& seg = *state_->segments[it->second.segment];
+	value.assign(seg.data + it->second.offset, it->second.size);
+	return Error();
+}
+
+Error NativeStorage::Write(const StorageOpts& opts, const string_view& key, const string_view& value) {
+	vector<NativeBatchBuffer::Record> records = {{key.ToString(), value.ToString(), false}};
+	std::lock_guard<std::mutex> lck(state_->mtx);
+	return state_->Append(records, opts.IsSync());
+}
+
+Error NativeStorage::Write(const StorageOpts& opts, UpdatesCollection& buffer) {
+	NativeBatchBuffer* batchBuffer = static_cast<NativeBatchBuffer*>(&buffer);
+	std::lock_guard<std::mutex> lck(state_->mtx);
+	return state_->Append(batchBuffer->records_, opts.IsSync());
+}
+
+Error NativeStorage::Delete(const StorageOpts& opts, const string_view& key) {
+	vector<NativeBatchBuffer::Record> records = {{key.ToString(), string(), true}};
+	std::lock_guard<std::mutex> lck(state_->mtx);
+	if (state_->closed) throw Error(errParams, "%s", storageNotInitialized);
+	if (state_->index.find(key) == state_->index.end()) return Error();
+	return state_->Append(records, opts.IsSync());
+}
+
+Snapshot::Ptr NativeStorage::MakeSnapshot() { return std::make_shared<NativeSnapshot>(); }
+
+void NativeStorage::ReleaseSnapshot(Snapshot::Ptr snapshot) {
+	if (!snapshot) throw Error(errParams, "Storage pointer is null");
+	snapshot.reset();
+}
+
+Error NativeStorage::Flush() {
+	std::lock_guard<std::mutex> lck(state_->mtx);
+	if (!state_->closed && fdatasync(state_->active().fd) < 0) {
+		return Error(errLogic, "Can't sync segment of storage: %s", strerror(errno));
+	}
+	return errOK;
+}
+
+void NativeStorage::Destroy(const string& path) {
+	{
+		std::lock_guard<std::mutex> lck(state_->mtx);
+		state_->Close();
+	}
+	if (fs::RmDirAll(path) < 0) {
+		printf("Cannot destroy DB: %s, %s\n", path.c_str(), strerror(errno));
+	}
+}
+
+Cursor* NativeStorage::GetCursor(StorageOpts&) {
+	std::lock_guard<std::mutex> lck(state_->mtx);
+	if (state_->closed) throw Error(errParams, "%s", storageNotInitialized);
+	return new NativeIterator(state_);
+}
+
+UpdatesCollection* NativeStorage::GetUpdatesCollection() { return new NativeBatchBuffer(); }
+
+Error NativeStorage::ReadPrefix(StorageOpts&, const string_view& prefix,
+								std::function<bool(const string_view& key, const string_view& value)> visitor) {
+	// Records, which are written after call, may be not read
+	vector<shared_ptr<NativeSegment>> segments;
+	{
+		std::lock_guard<std::mutex> lck(state_->mtx);
+		if (state_->closed) throw Error(errParams, "%s", storageNotInitialized);
+		for (auto& seg : state_->segments) segments.push_back(seg.second);
+		state_->readers++;
+	}
+	auto state = state_;
+	auto release = [state](int*) {
+		std::lock_guard<std::mutex> lck(state->mtx);
+		state->readers--;
+	};
+	std::unique_ptr<int, decltype(release)> reader(&state_->readers, release);
+
+	// Segments are kept mapped, so records are valid, even if they are overwritten while visitor is called
+	vector<std::pair<string_view, string_view>> records;
+	for (auto& seg : segments) {
+		if (!seg->capacity) continue;
+		char* data = const_cast<char*>(seg->data);
+		madvise(data, seg->capacity, MADV_SEQUENTIAL);
+		madvise(data, seg->capacity, MADV_WILLNEED);
+
+		// Record is live, if index refers to it, so only the last record of each key is taken
+		records.clear();
+		{
+			std::lock_guard<std::mutex> lck(state_->mtx);
+			for (size_t offset = 0; offset < seg->size;) {
+				uint32_t header[4];
+				memcpy(header, seg->data + offset, sizeof(header));
+				uint32_t keySize = header[1], valueSize = header[2], flags = header[3];
+				size_t valueOffset = offset + kNativeHeaderSize + keySize;
+				string_view key(seg->data + offset + kNativeHeaderSize, keySize);
+				if (!(flags & kNativeRecordDeleted) && key.substr(0, prefix.size()) == prefix) {
+					auto it = state_->index.find(key);
+					if (it != state_->index.end() && it->second.segment == seg->id && it->second.offset == valueOffset) {
+						records.push_back({key, string_view(seg->data + valueOffset, valueSize)});
+					}
+				}
+				offset += recordSize(keySize, valueSize);
+			}
+		}
+		bool stop = false;
+		for (auto& rec : records) {
+			if (!visitor(rec.first, rec.second)) {
+				stop = true;
+				break;
+			}
+		}
+		madvise(data, seg->capacity, MADV_NORMAL);
+		if (stop) break;
+	}
+	return errOK;
+}
+
+int NativeStorage::Compact() { return state_->Compact(); }
+
+NativeBatchBuffer::NativeBatchBuffer() {}
+
+NativeBatchBuffer::~NativeBatchBuffer() {}
+
+void NativeBatchBuffer::Put(const string_view& key, const string_view& value) {
+	records_.push_back({key.ToString(), value.ToString(), false});
+}
+
+void NativeBatchBuffer::Remove(const string_view& key) { records_.push_back({key.ToString(), string(), true}); }
+
+void NativeBatchBuffer::Clear() { records_.clear(); }
+
+NativeIterator::NativeIterator(shared_ptr<NativeState> state) : state_(state) {}
+
+NativeIterator::~NativeIterator() {}
+
+void NativeIterator::seek(const string_view* bound, bool forward, bool inclusive) {
+	std::lock_guard<std::mutex> lck(state_->mtx);
+	heap_.clear();
+	forward_ = forward;
+	for (auto& it : state_->index) {
+		int res = bound ? comparator_.Compare(it.first, *bound) * (forward ? 1 : -1) : 1;
+		if (res > 0 || (inclusive && !res)) heap_.push_back({it.first, it.second});
+	}
+	std::make_heap(heap_.begin(), heap_.end(), [this](const Entry& lhs, const Entry& rhs) { return heapLess(lhs, rhs); });
+	segments_ = state_->segments;
+	pop();
+}
+
+void NativeIterator::pop() {
+	valid_ = !heap_.empty();
+	if (!valid_) {
+		segments_.clear();
+		return;
+	}
+	std::pop_heap(heap_.begin(), heap_.end(), [this](const Entry& lhs, const Entry& rhs) { return heapLess(lhs, rhs); });
+	current_ = heap_.back();
+	heap_.pop_back();
+}
+
+bool NativeIterator::heapLess(const Entry& lhs, const Entry& rhs) const {
+	int res = comparator_.Compare(lhs.key, rhs.key);
+	return forward_ ? res > 0 : res < 0;
+}
+
+bool NativeIterator::Valid() const { return valid_; }
+
+void NativeIterator::SeekToFirst() { seek(nullptr, true, true); }
+
+void NativeIterator::SeekToLast() { seek(nullptr, false, true); }
+
+void NativeIterator::Seek(const string_view& target) { seek(&target, true, true); }
+
+void NativeIterator::Next() {
+	if (!valid_) return;
+	if (forward_) return pop();
+	// Direction is changed, so records after the current one are taken again
+	string key = current_.key.ToString();
+	string_view bound(key);
+	seek(&bound, true, false);
+}
+
+void NativeIterator::Prev() {
+	if (!valid_) return;
+	if (!forward_) return pop();
+	string key = current_.key.ToString();
+	string_view bound(key);
+	seek(&bound, false, false);
+}
+
+string_view NativeIterator::Key() const { return valid_ ? current_.key : string_view(); }
+
+string_view NativeIterator::Value() const {
+	if (!valid_) return string_view();
+	auto it = segments_.find(current_.loc.segment);
+	return string_view(it->second->data + current_.loc.offset, current_.loc.size);
+}
+
+Comparator& NativeIterator::GetComparator() { return comparator_; }
+
+int NativeComparator::Compare(const string_view& a, const string_view& b) const {
+	size_t size = std::min(a.size(), b.size());
+	int res = size ? memcmp(a.data(), b.data(), size) : 0;
+	if (res) return res;
+	return a.size() < b.size() ? -1 : (a.size() > b.size() ? 1 : 0);
+}
+
+}  // namespace datastorage
+}  // namespace reindexer
+
+#endif  // _WIN32
@@ -0,0 +1,146 @@
+#pragma once
+
+#ifndef _WIN32
+
+#include <map>
+#include <mutex>
+#include <vector>
+#include "idatastorage.h"
+#include "tools/errors.h"
+
+using std::unique_ptr;
+
+namespace reindexer {
+namespace datastorage {
+
+using std::map;
+using std::vector;
+
+/// Default size of segment of native storage
+const size_t kNativeSegmentSize = 64 << 20;
+
+struct NativeSegment;
+struct NativeState;
+
+/// Location of value of live record in segment
+struct NativeLocation {
+	uint32_t segment;
+	uint32_t offset;
+	uint32_t size;
+};
+
+/// Native append-only storage engine. Data of namespace is kept in RAM, so storage is only a durability log, which is read on start.
+/// Records of keys and values are appended to segment files, and hash index of keys to records is kept in memory. Segments are mapped
+/// to memory: records are read without copying, and index refers to keys in mapped segments. On open segments are read sequentially
+/// with prefetch, and ReadPrefix reads values in order of files, so open is bound by disk bandwidth. Segments, which keep mostly
+/// overwritten and deleted records, are compacted in background: their live records are appended again, and segment files are removed.<br>
+/// StorageOpts::WriteBufferSize sets size of segment
+class NativeStorage : public IDataStorage {
+public:
+	NativeStorage();
+	~NativeStorage();
+
+	Error Open(const string& path, const StorageOpts& opts) final;
+	Error Read(const StorageOpts& opts, const string_view& key, string& value) final;
+	Error Write(const StorageOpts& opts, const string_view& key, const string_view& value) final;
+	Error Write(const StorageOpts& opts, UpdatesCollection& buffer) final;
+	Error Delete(const StorageOpts& opts, const string_view& key) final;
+
+	/// Cursor keeps state of storage, which was on its last seek, so snapshot is not needed
+	Snapshot::Ptr MakeSnapshot() final;
+	void ReleaseSnapshot(Snapshot::Ptr) final;
+
+	Error Flush() final;
+	void Destroy(const string& path) final;
+	Cursor* GetCursor(StorageOpts& opts) final;
+	UpdatesCollection* GetUpdatesCollection() final;
+	/// Reads live records of segments in order of files
+	Error ReadPrefix(StorageOpts& opts, const string_view& prefix,
+					 std::function<bool(const string_view& key, const string_view& value)> visitor) final;
+
+	/// Compacts segments, if most of their records are overwritten or deleted. It is called periodically by background thread
+	/// @return amount of removed segments
+	int Compact();
+
+private:
+	// State is shared with cursors and background compaction, so it outlives storage, while they use it
+	shared_ptr<NativeState> state_;
+};
+
+class NativeBatchBuffer : public UpdatesCollection {
+public:
+	NativeBatchBuffer();
+	~NativeBatchBuffer();
+
+	void Put(const string_view& key, const string_view& value) final;
+	void Remove(const string_view& key) final;
+	void Clear() final;
+
+	struct Record {
+		string key;
+		string value;
+		bool deleted;
+	};
+
+private:
+	vector<Record> records_;
+	friend class NativeStorage;
+};
+
+class NativeComparator : public Comparator {
+public:
+	NativeComparator() = default;
+	~NativeComparator() = default;
+
+	int Compare(const string_view& a, const string_view& b) const final;
+};
+
+// Cursor takes records of index on each seek, including implicit seek on change of direction by Next or Prev.
+// Writes, which are done after seek, are not seen by cursor until the next seek
+class NativeIterator : public Cursor {
+public:
+	NativeIterator(shared_ptr<NativeState> state);
+	~NativeIterator();
+
+	bool Valid() const final;
+	void SeekToFirst() final;
+	void SeekToLast() final;
+	void Seek(const string_view& target) final;
+	void Next() final;
+	void Prev() final;
+
+	string_view Key() const final;
+	string_view Value() const final;
+
+	Comparator& GetComparator() final;
+
+	struct Entry {
+		string_view key;
+		NativeLocation loc;
+	};
+
+private:
+	// Takes records of index with keys after (forward) or before (backward) bound, and moves to the first of them.
+	// All the records are taken, if bound is null
+	void seek(const string_view* bound, bool forward, bool inclusive);
+	void pop();
+	// Heap keeps the next record on top: the least key for forward order, and the greatest one for backward order
+	bool heapLess(const Entry& lhs, const Entry& rhs) const;
+
+	shared_ptr<NativeState> state_;
+	// Index is not ordered, so records are taken to heap, and are ordered lazily: loops are usually stopped at the end of prefix
+	vector<Entry> heap_;
+	bool forward_ = true;
+	bool valid_ = false;
+	Entry current_;
+	// Segments are kept mapped, so keys and values of taken records stay valid, even if they are compacted or overwritten
+	map<uint32_t, shared_ptr<NativeSegment>> segments_;
+	NativeComparator comparator_;
+};
+
+class NativeSnapshot : public Snapshot {};
+
+}  // namespace datastorage
+}  // namespace reindexer
+
+#endif  // _WIN32
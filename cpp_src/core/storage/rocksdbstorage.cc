@@ -0,0 +1,199 @@
+#ifdef REINDEX_WITH_ROCKSDB
+
+#include "rocksdbstorage.h"
+
+#include <assert.h>
+#include <rocksdb/cache.h>
+#include <rocksdb/comparator.h>
+#include <rocksdb/db.h>
+#include <rocksdb/iterator.h>
+#include <rocksdb/slice.h>
+#include <rocksdb/table.h>
+
+static const char* storageNotInitialized = "Storage is not initialized";
+
+static void toWriteOptions(const StorageOpts& opts, rocksdb::WriteOptions& wopts) { wopts.sync = opts.IsSync(); }
+
+static void toReadOptions(const StorageOpts& opts, rocksdb::ReadOptions& ropts) {
+	ropts.fill_cache = opts.IsFillCache();
+	ropts.verify_checksums = opts.IsVerifyChecksums();
+}
+
+namespace reindexer {
+namespace datastorage {
+
+RocksDbBlockCache::RocksDbBlockCache(size_t size) : cache(rocksdb::NewLRUCache(size)) {}
+
+RocksDbBlockCache::~RocksDbBlockCache() {}
+
+RocksDbStorage::RocksDbStorage() {}
+
+RocksDbStorage::~RocksDbStorage() {}
+
+void RocksDbStorage::SetBlockCache(BlockCache::Ptr cache) { blockCache_ = std::dynamic_pointer_cast<RocksDbBlockCache>(cache); }
+
+Error RocksDbStorage::Open(const string& path, const StorageOpts& opts) {
+	if (path.empty()) {
+		throw Error(errParams, "Cannot enable storage: the path is empty '%s'", path.c_str());
+	}
+
+	rocksdb::Options options;
+	options.create_if_missing = opts.IsCreateIfMissing();
+	options.max_open_files = opts.GetMaxOpenFiles() ? opts.GetMaxOpenFiles() : -1;
+	if (opts.GetWriteBufferSize()) options.write_buffer_size = opts.GetWriteBufferSize();
+	if (opts.GetCompression() == kStorageCompressionNone) options.compression = rocksdb::kNoCompression;
+	if (opts.GetCompression() == kStorageCompressionSnappy) options.compression = rocksdb::kSnappyCompression;
+	if (!blockCache_ && opts.GetBlockCacheSize()) blockCache_ = std::make_shared<RocksDbBlockCache>(opts.GetBlockCacheSize());
+	if (blockCache_) {
+		rocksdb::BlockBasedTableOptions tableOptions;
+		tableOptions.block_cache = blockCache_->cache;
+		options.table_factory.reset(rocksdb::NewBlockBasedTableFactory(tableOptions));
+	}
+
+	rocksdb::DB* db;
+	rocksdb::Status status = rocksdb::DB::Open(options, path, &db);
+	if (status.ok()) {
+		db_ = shared_ptr<rocksdb::DB>(db);
+		opts_ = opts;
+		dbpath_ = path;
+		return Error();
+	}
+
+	return Error(errLogic, "%s", status.ToString().c_str());
+}
+
+Error RocksDbStorage::Read(const StorageOpts& opts, const string_view& key, string& value) {
+	if (!db_) throw Error(errParams, "%s", storageNotInitialized);
+
+	rocksdb::ReadOptions options;
+	toReadOptions(opts, options);
+	rocksdb::Status status = db_->Get(options, rocksdb::Slice(key.data(), key.size()), &value);
+	if (status.ok()) return Error();
+	return Error(status.IsNotFound() ? errNotFound : errLogic, "%s", status.ToString().c_str());
+}
+
+Error RocksDbStorage::Write(const StorageOpts& opts, const string_view& key, const string_view& value) {
+	if (!db_) throw Error(errParams, "%s", storageNotInitialized);
+
+	rocksdb::WriteOptions options;
+	toWriteOptions(opts, options);
+	rocksdb::Status status = db_->Put(options, rocksdb::Slice(key.data(), key.size()), rocksdb::Slice(value.data(), value.size()));
+	if (status.ok()) return Error();
+	return Error(status.IsNotFound() ? errNotFound : errLogic, "%s", status.ToString().c_str());
+}
+
+Error RocksDbStorage::Write(const StorageOpts& opts, UpdatesCollection& buffer) {
+	if (!db_) throw Error(errParams, "%s", storageNotInitialized);
+
+	rocksdb::WriteOptions options;
+	toWriteOptions(opts, options);
+	RocksDbBatchBuffer* batchBuffer = static_cast<RocksDbBatchBuffer*>(&buffer);
+	rocksdb::Status status = db_->Write(options, &batchBuffer->batchWrite_);
+	if (status.ok()) return Error();
+	return Error(status.IsNotFound() ? errNotFound : errLogic, "%s", status.ToString().c_str());
+}
+
+Error RocksDbStorage::Delete(const StorageOpts& opts, const string_view& key) {
+	if (!db_) throw Error(errParams, "%s", storageNotInitialized);
+
+	rocksdb::WriteOptions options;
+	toWriteOptions(opts, options);
+	rocksdb::Status status = db_->Delete(options, rocksdb::Slice(key.data(), key.size()));
+	if (status.ok()) return Error();
+	return Error(errLogic, "%s", status.ToString().c_str());
+}
+
+Snapshot::Ptr RocksDbStorage::MakeSnapshot() {
+	if (!db_) throw Error(errParams, "%s", storageNotInitialized);
+	const rocksdb::Snapshot* rdbSnapshot = db_->GetSnapshot();
+	assert(rdbSnapshot);
+	return std::make_shared<RocksDbSnapshot>(rdbSnapshot);
+}
+
+void RocksDbStorage::ReleaseSnapshot(Snapshot::Ptr snapshot) {
+	if (!db_) throw Error(errParams, "%s", storageNotInitialized);
+	if (!snapshot) throw Error(errParams, "Storage pointer is null");
+	const RocksDbSnapshot* rocksDbSnapshot = static_cast<const RocksDbSnapshot*>(snapshot.get());
+	db_->ReleaseSnapshot(rocksDbSnapshot->snapshot_);
+	snapshot.reset();
+}
+
+Error RocksDbStorage::Flush() {
+	// Unlike LevelDB, RocksDB flushes memtable without reopen of DB
+	if (!db_) return Error();
+	rocksdb::Status status = db_->Flush(rocksdb::FlushOptions());
+	if (status.ok()) return Error();
+	return Error(errLogic, "%s", status.ToString().c_str());
+}
+
+void RocksDbStorage::Destroy(const string& path) {
+	rocksdb::Options options;
+	options.create_if_missing = true;
+	db_.reset();
+	rocksdb::Status status = rocksdb::DestroyDB(path, options);
+	if (!status.ok()) {
+		printf("Cannot destroy DB: %s, %s\n", path.c_str(), status.ToString().c_str());
+	}
+}
+
+Cursor* RocksDbStorage::GetCursor(StorageOpts& opts) {
+	if (!db_) throw Error(errParams, "%s", storageNotInitialized);
+	rocksdb::ReadOptions options;
+	toReadOptions(opts, options);
+	options.fill_cache = false;
+	return new RocksDbIterator(db_->NewIterator(options));
+}
+
+UpdatesCollection* RocksDbStorage::GetUpdatesCollection() { return new RocksDbBatchBuffer(); }
+
+RocksDbBatchBuffer::RocksDbBatchBuffer() {}
+
+RocksDbBatchBuffer::~RocksDbBatchBuffer() {}
+
+void RocksDbBatchBuffer::Put(const string_view& key, const string_view& value) {
+	batchWrite_.Put(rocksdb::Slice(key.data(), key.size()), rocksdb::Slice(value.data(), value.size()));
+}
+
+void RocksDbBatchBuffer::Remove(const string_view& key) { batchWrite_.Delete(rocksdb::Slice(key.data(), key.size())); }
+
+void RocksDbBatchBuffer::Clear() { batchWrite_.Clear(); }
+
+RocksDbIterator::RocksDbIterator(rocksdb::Iterator* iterator) : iterator_(iterator) {}
+
+RocksDbIterator::~RocksDbIterator() {}
+
+bool RocksDbIterator::Valid() const { return iterator_->Valid(); }
+
+void RocksDbIterator::SeekToFirst() { return iterator_->SeekToFirst(); }
+
+void RocksDbIterator::SeekToLast() { return iterator_->SeekToLast(); }
+
+void RocksDbIterator::Seek(const string_view& target) { return iterator_->Seek(rocksdb::Slice(target.data(), target.size())); }
+
+void RocksDbIterator::Next() { return iterator_->Next(); }
+
+void RocksDbIterator::Prev() { return iterator_->Prev(); }
+
+string_view RocksDbIterator::Key() const {
+	rocksdb::Slice key = iterator_->key();
+	return string_view(key.data(), key.size());
+}
+
+string_view RocksDbIterator::Value() const {
+	rocksdb::Slice value = iterator_->value();
+	return string_view(value.data(), value.size());
+}
+
+Comparator& RocksDbIterator::GetComparator() { return comparator_; }
+
+int RocksDbComparator::Compare(const string_view& a, const string_view& b) const {
+	return rocksdb::BytewiseComparator()->Compare(rocksdb::Slice(a.data(), a.size()), rocksdb::Slice(b.data(), b.size()));
+}
+
+RocksDbSnapshot::RocksDbSnapshot(const rocksdb::Snapshot* snapshot) : snapshot_(snapshot) {}
+
+RocksDbSnapshot::~RocksDbSnapshot() { snapshot_ = nullptr; }
+}  // namespace datastorage
+}  // namespace reindexer
+
+#endif  // REINDEX_WITH_ROCKSDB
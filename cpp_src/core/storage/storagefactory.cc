@@ -1,5 +1,7 @@
 #include "storagefactory.h"
 #include "leveldbstorage.h"
+#include "nativestorage.h"
+#include "rocksdbstorage.h"
 
 namespace reindexer {
 namespace datastorage {
@@ -8,9 +10,77 @@ IDataStorage* StorageFactory::create(StorageType type) {
 	switch (type) {
 		case StorageType::LevelDB:
 			return new LevelDbStorage();
+#ifdef REINDEX_WITH_ROCKSDB
+		case StorageType::RocksDB:
+			return new RocksDbStorage();
+#endif
+#ifndef _WIN32
+		case StorageType::Native:
+			return new NativeStorage();
+#endif
 		default:
-			throw std::runtime_error("No such storage type!");
+			throw Error(errParams, "Storage engine '%s' is not supported by this build of reindexer", StorageTypeToString(type));
 	}
 }
+
+BlockCache::Ptr StorageFactory::CreateBlockCache(StorageType type, size_t size) {
+	if (!size) return nullptr;
+	switch (type) {
+		case StorageType::LevelDB:
+			return std::make_shared<LevelDbBlockCache>(size);
+#ifdef REINDEX_WITH_ROCKSDB
+		case StorageType::RocksDB:
+			return std::make_shared<RocksDbBlockCache>(size);
+#endif
+		default:
+			return nullptr;
+	}
+}
+
+bool StorageFactory::IsSupported(StorageType type) {
+	switch (type) {
+		case StorageType::LevelDB:
+			return true;
+		case StorageType::RocksDB:
+#ifdef REINDEX_WITH_ROCKSDB
+			return true;
+#else
+			return false;
+#endif
+		case StorageType::Native:
+#ifndef _WIN32
+			return true;
+#else
+			return false;
+#endif
+	}
+	return false;
+}
+
+const char* StorageTypeToString(StorageType type) {
+	switch (type) {
+		case StorageType::LevelDB:
+			return "leveldb";
+		case StorageType::RocksDB:
+			return "rocksdb";
+		case StorageType::Native:
+			return "native";
+	}
+	return "unknown";
+}
+
+Error StorageTypeFromString(const string& name, StorageType& type) {
+	if (name == "leveldb") {
+		type = StorageType::LevelDB;
+	} else if (name == "rocksdb") {
+		type = StorageType::RocksDB;
+	} else if (name == "native") {
+		type = StorageType::Native;
+	} else {
+		return Error(errParams, "Unknown storage engine '%s'", name.c_str());
+	}
+	return errOK;
+}
+
 }  // namespace datastorage
 }  // namespace reindexer
@@ -1,15 +1,19 @@
 #pragma once
 
 #include "idatastorage.h"
+#include "storagetype.h"
 
 namespace reindexer {
 namespace datastorage {
 
-enum class StorageType { LevelDB = 0 };
-
 class StorageFactory {
 public:
 	static IDataStorage* create(StorageType);
+	/// Creates block cache, which is shared by storages of engine
+	/// @return nullptr, if size is 0 or engine does not use block cache
+	static BlockCache::Ptr CreateBlockCache(StorageType, size_t size);
+	/// @return true, if engine is compiled into this build
+	static bool IsSupported(StorageType);
 };
 }  // namespace datastorage
 }  // namespace reindexer
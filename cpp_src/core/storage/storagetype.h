@@ -0,0 +1,22 @@
+#pragma once
+
+#include <string>
+#include "tools/errors.h"
+
+namespace reindexer {
+namespace datastorage {
+
+using std::string;
+
+enum class StorageType { LevelDB = 0, RocksDB = 1, Native = 2 };
+
+/// @return name of storage engine, which is kept in placeholder file of database
+const char* StorageTypeToString(StorageType type);
+/// Parses name of storage engine
+/// @param name - name of engine: `leveldb`, `rocksdb` or `native`
+/// @param type - parsed engine
+/// @return errParams, if engine is unknown
+Error StorageTypeFromString(const string& name, StorageType& type);
+
+}  // namespace datastorage
+}  // namespace reindexer
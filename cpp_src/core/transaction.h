@@ -0,0 +1,63 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "core/item.h"
+#include "core/type_consts.h"
+
+namespace reindexer {
+
+using std::string;
+using std::vector;
+
+/// Transaction is the batch of modifications of single namespace.<br>
+/// All modifications are applied by Reindexer::CommitTransaction under single lock of namespace,
+/// caches of namespace are invalidated once, and changes are written to storage by single batch.<br>
+/// *Thread safety*: Transaction is not thread safe itself.
+class Transaction {
+public:
+	/// Modification of one item
+	struct Step {
+		Item item;
+		ItemModifyMode mode;
+	};
+
+	/// Create empty transaction
+	/// @param nsName - Name of namespace
+	Transaction(const string &nsName) : nsName_(nsName) {}
+	Transaction(const Transaction &) = delete;
+	Transaction(Transaction &&) = default;
+	Transaction &operator=(const Transaction &) = delete;
+	Transaction &operator=(Transaction &&) = default;
+
+	/// Add Insert of item to transaction
+	/// @param item - Item, obtained by call to NewItem of the same namespace
+	void Insert(Item &&item) { Modify(std::move(item), ModeInsert); }
+	/// Add Update of item to transaction
+	/// @param item - Item, obtained by call to NewItem of the same namespace
+	void Update(Item &&item) { Modify(std::move(item), ModeUpdate); }
+	/// Add Upsert of item to transaction
+	/// @param item - Item, obtained by call to NewItem of the same namespace
+	void Upsert(Item &&item) { Modify(std::move(item), ModeUpsert); }
+	/// Add Delete of item to transaction
+	/// @param item - Item, obtained by call to NewItem of the same namespace
+	void Delete(Item &&item) { Modify(std::move(item), ModeDelete); }
+	/// Add modification of item to transaction
+	/// @param item - Item, obtained by call to NewItem of the same namespace
+	/// @param mode - Modification mode
+	void Modify(Item &&item, ItemModifyMode mode) { steps_.push_back({std::move(item), mode}); }
+
+	/// Get name of namespace
+	const string &GetName() const { return nsName_; }
+	/// Get modifications of transaction. After commit item.GetID() of each step returns internal Item ID,
+	/// or -1, if item was not modified
+	vector<Step> &GetSteps() { return steps_; }
+	/// Check if transaction is empty
+	bool IsEmpty() const { return steps_.empty(); }
+
+protected:
+	string nsName_;
+	vector<Step> steps_;
+};
+
+}  // namespace reindexer
@@ -89,7 +89,8 @@ enum ErrorCode {
 	errNotValid = 11,
 	errNetwork = 12,
 	errNotFound = 13,
-	errStateInvalidated = 14
+	errStateInvalidated = 14,
+	errOutdatedWAL = 15
 };
 
 enum OpType { OpOr = 1, OpAnd = 2, OpNot = 3 };
@@ -128,7 +129,14 @@ enum {
 	kResultsWithJoined = 0x100
 };
 
-typedef enum IndexOpt { kIndexOptPK = 1 << 7, kIndexOptArray = 1 << 6, kIndexOptDense = 1 << 5, kIndexOptSparse = 1 << 3 } IndexOpt;
+typedef enum IndexOpt {
+	kIndexOptPK = 1 << 7,
+	kIndexOptArray = 1 << 6,
+	kIndexOptDense = 1 << 5,
+	kIndexOptSparse = 1 << 3,
+	kIndexOptBitmap = 1 << 2,
+	kIndexOptColumn = 1 << 1
+} IndexOpt;
 
 typedef enum StotageOpt {
 	kStorageOptEnabled = 1 << 0,
@@ -139,13 +147,19 @@ typedef enum StotageOpt {
 	kStorageOptSync = 1 << 5
 } StorageOpt;
 
+typedef enum StorageCompression {
+	kStorageCompressionDefault = 0,
+	kStorageCompressionNone = 1,
+	kStorageCompressionSnappy = 2
+} StorageCompression;
+
 enum CollateMode { CollateNone = 0, CollateASCII, CollateUTF8, CollateNumeric, CollateCustom };
 
 enum ItemModifyMode { ModeUpdate = 0, ModeInsert = 1, ModeUpsert = 2, ModeDelete = 3 };
 
 typedef struct StorageOpts {
 #ifdef __cplusplus
-	StorageOpts() : options(0) {}
+	StorageOpts() : options(0), compression(kStorageCompressionDefault), maxOpenFiles(0), blockCacheSize(0), writeBufferSize(0) {}
 
 	bool IsEnabled() const { return options & kStorageOptEnabled; }
 	bool IsDropOnFileFormatError() const { return options & kStorageOptDropOnFileFormatError; }
@@ -153,6 +167,10 @@ typedef struct StorageOpts {
 	bool IsVerifyChecksums() const { return options & kStorageOptVerifyChecksums; }
 	bool IsFillCache() const { return options & kStorageOptFillCache; }
 	bool IsSync() const { return options & kStorageOptSync; }
+	StorageCompression GetCompression() const { return StorageCompression(compression); }
+	int GetMaxOpenFiles() const { return maxOpenFiles; }
+	uint64_t GetBlockCacheSize() const { return blockCacheSize; }
+	uint64_t GetWriteBufferSize() const { return writeBufferSize; }
 
 	StorageOpts& Enabled(bool value = true) {
 		options = value ? options | kStorageOptEnabled : options & ~(kStorageOptEnabled);
@@ -183,6 +201,40 @@ typedef struct StorageOpts {
 		options = value ? options | kStorageOptSync : options & ~(kStorageOptSync);
 		return *this;
 	}
+
+	StorageOpts& Compression(StorageCompression value) {
+		compression = value;
+		return *this;
+	}
+
+	StorageOpts& MaxOpenFiles(int value) {
+		maxOpenFiles = value;
+		return *this;
+	}
+
+	StorageOpts& BlockCacheSize(uint64_t value) {
+		blockCacheSize = value;
+		return *this;
+	}
+
+	StorageOpts& WriteBufferSize(uint64_t value) {
+		writeBufferSize = value;
+		return *this;
+	}
+
+	/// Takes tunables of storage engine, which are not set, from defaults
+	StorageOpts& Tunables(const StorageOpts& defaults) {
+		if (compression == kStorageCompressionDefault) compression = defaults.compression;
+		if (!maxOpenFiles) maxOpenFiles = defaults.maxOpenFiles;
+		if (!blockCacheSize) blockCacheSize = defaults.blockCacheSize;
+		if (!writeBufferSize) writeBufferSize = defaults.writeBufferSize;
+		return *this;
+	}
 #endif
 	uint8_t options;
+	// Tunables of storage engine. 0 - default value of engine
+	uint8_t compression;
+	int32_t maxOpenFiles;
+	uint64_t blockCacheSize;
+	uint64_t writeBufferSize;
 } StorageOpts;
@@ -0,0 +1,95 @@
+#include "storage_engine.h"
+
+#include <functional>
+#include "tools/fsops.h"
+
+using reindexer::IndexDef;
+using reindexer::Item;
+using reindexer::NamespaceDef;
+
+static const char* kStorageEngineNs = "StorageEngine";
+// Amount of items, which are written to storage by one flush
+static const size_t kStorageEngineFlushBatch = 10000;
+
+StorageEngine::StorageEngine(const string& storagePath, reindexer::datastorage::StorageType storageType, size_t maxItems)
+	: path_(reindexer::fs::JoinPath(storagePath, reindexer::datastorage::StorageTypeToString(storageType))), maxItems_(maxItems) {
+	opts_.WithStorageType(storageType);
+}
+
+Error StorageEngine::Initialize() {
+	reindexer::fs::RmDirAll(path_);
+	db_.reset(new Reindexer);
+	auto err = db_->Connect(path_, opts_);
+	if (!err.ok()) return err;
+	return db_->AddNamespace(NamespaceDef(kStorageEngineNs)
+								 .AddIndex("id", "hash", "int", IndexOpts().PK())
+								 .AddIndex("name", "hash", "string", IndexOpts())
+								 .AddIndex("year", "tree", "int", IndexOpts()));
+}
+
+void StorageEngine::RegisterAllCases() {
+	string prefix = string("StorageEngine/") + reindexer::datastorage::StorageTypeToString(opts_.storageType) + "/";
+	benchmark::RegisterBenchmark((prefix + "Flush").c_str(), std::bind(&StorageEngine::Flush, this, std::placeholders::_1))
+		->Unit(benchmark::kMillisecond)
+		->UseRealTime();
+	// Namespaces are loaded by background threads, so only real time is meaningful
+	benchmark::RegisterBenchmark((prefix + "Load").c_str(), std::bind(&StorageEngine::Load, this, std::placeholders::_1))
+		->Unit(benchmark::kMillisecond)
+		->UseRealTime()
+		->Iterations(5);
+}
+
+Error StorageEngine::upsertItems(size_t from, size_t count) {
+	for (size_t i = from; i < from + count; i++) {
+		Item item = db_->NewItem(kStorageEngineNs);
+		if (!item.Status().ok()) return item.Status();
+		int id = i % maxItems_;
+		auto err = item.FromJSON("{\"id\":" + std::to_string(id) + ",\"name\":\"name_" + std::to_string(i) + "\",\"year\":" +
+								 std::to_string(1900 + id % 120) + ",\"description\":\"" + string(200, 'a' + id % 26) + "\"}");
+		if (!err.ok()) return err;
+		err = db_->Upsert(kStorageEngineNs, item);
+		if (!err.ok()) return err;
+	}
+	return Error();
+}
+
+// Items are written to namespace, and then are flushed to storage by one batch
+void StorageEngine::Flush(State& state) {
+	for (auto _ : state) {
+		state.PauseTiming();
+		auto err = upsertItems(itemsCount_, kStorageEngineFlushBatch);
+		if (!err.ok()) state.SkipWithError(err.what().c_str());
+		itemsCount_ += kStorageEngineFlushBatch;
+		state.ResumeTiming();
+
+		err = db_->Commit(kStorageEngineNs);
+		if (!err.ok()) state.SkipWithError(err.what().c_str());
+	}
+	state.counters["Items/s"] = benchmark::Counter(state.iterations() * kStorageEngineFlushBatch, benchmark::Counter::kIsRate);
+}
+
+// Database is loaded from storage, like on start of server
+void StorageEngine::Load(State& state) {
+	if (itemsCount_ < maxItems_) {
+		auto err = upsertItems(itemsCount_, maxItems_ - itemsCount_);
+		if (!err.ok()) state.SkipWithError(err.what().c_str());
+		itemsCount_ = maxItems_;
+	}
+	// Storage is locked by engine, so it is released by the current database
+	db_.reset();
+
+	for (auto _ : state) {
+		unique_ptr<Reindexer> db(new Reindexer);
+		auto err = db->Connect(path_, opts_);
+		if (!err.ok()) state.SkipWithError(err.what().c_str());
+		// Database is destroyed out of measurement
+		state.PauseTiming();
+		db.reset();
+		state.ResumeTiming();
+	}
+	state.counters["Items/s"] = benchmark::Counter(state.iterations() * maxItems_, benchmark::Counter::kIsRate);
+
+	db_.reset(new Reindexer);
+	auto err = db_->Connect(path_, opts_);
+	if (!err.ok()) state.SkipWithError(err.what().c_str());
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+
+#include "core/reindexer.h"
+
+using std::string;
+using std::unique_ptr;
+
+using benchmark::State;
+
+using reindexer::ConnectOpts;
+using reindexer::Error;
+using reindexer::Reindexer;
+
+/// Compares storage engines: throughput of write of items to storage, and of load of database from storage on start
+class StorageEngine {
+public:
+	StorageEngine(const string& storagePath, reindexer::datastorage::StorageType storageType, size_t maxItems);
+
+	/// @return error, if engine is not supported by this build
+	Error Initialize();
+	void RegisterAllCases();
+
+protected:
+	void Flush(State& state);
+	void Load(State& state);
+
+	Error upsertItems(size_t from, size_t count);
+
+	string path_;
+	ConnectOpts opts_;
+	size_t maxItems_;
+	size_t itemsCount_ = 0;
+	unique_ptr<Reindexer> db_;
+};
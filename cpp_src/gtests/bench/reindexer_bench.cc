@@ -5,6 +5,7 @@
 #include "api_tv_composite.h"
 #include "api_tv_simple.h"
 #include "join_items.h"
+#include "storage_engine.h"
 
 #include "tools/fsops.h"
 
@@ -46,12 +47,25 @@ int main(int argc, char** argv) {
 	err = apiTvComposite.Initialize();
 	if (!err.ok()) return err.code();
 
+	StorageEngine levelDb(STORAGE_PATH "_engines", reindexer::datastorage::StorageType::LevelDB, kItemsInBenchDataset);
+	err = levelDb.Initialize();
+	if (!err.ok()) return err.code();
+
+	// RocksDB and native engine are compared with LevelDB, if reindexer is built with them
+	StorageEngine rocksDb(STORAGE_PATH "_engines", reindexer::datastorage::StorageType::RocksDB, kItemsInBenchDataset);
+	bool withRocksDb = rocksDb.Initialize().ok();
+	StorageEngine nativeDb(STORAGE_PATH "_engines", reindexer::datastorage::StorageType::Native, kItemsInBenchDataset);
+	bool withNativeDb = nativeDb.Initialize().ok();
+
 	::benchmark::Initialize(&argc, argv);
 	if (::benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
 
 	joinItems.RegisterAllCases();
 	apiTvSimple.RegisterAllCases();
 	apiTvComposite.RegisterAllCases();
+	levelDb.RegisterAllCases();
+	if (withRocksDb) rocksDb.RegisterAllCases();
+	if (withNativeDb) nativeDb.RegisterAllCases();
 
 	::benchmark::RunSpecifiedBenchmarks();
 }
@@ -1,7 +1,11 @@
+#include <atomic>
+#include <chrono>
 #include <fstream>
+#include <thread>
 #include <vector>
 #include "reindexer_api.h"
 #include "tools/errors.h"
+#include "tools/fsops.h"
 
 #include "core/item.h"
 #include "core/keyvalue/key_string.h"
@@ -645,3 +649,571 @@ TEST_F(ReindexerApi, DslFieldsTest) {
 	TestDSLParseCorrectness(R"xxx({"req_total":"disabled"})xxx");
 	TestDSLParseCorrectness(R"xxx({"aggregations":[{"field":"field1", "type":"sum"}, {"field":"field2", "type":"avg"}]})xxx");
 }
+
+TEST_F(ReindexerApi, LoadFromStorage) {
+	const string dbPath = reindexer::fs::JoinPath(reindexer::fs::GetTempDir(), "reindex_load_test");
+	reindexer::fs::RmDirAll(dbPath);
+
+	// More items, than fits to one batch of loader
+	const int itemsCount = 20000;
+	{
+		Reindexer rx;
+		auto err = rx.Connect(dbPath);
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rx.OpenNamespace(default_namespace, StorageOpts().Enabled().CreateIfMissing());
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rx.AddIndex(default_namespace, {"id", "hash", "int", IndexOpts().PK()});
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rx.AddIndex(default_namespace, {"name", "hash", "string", IndexOpts()});
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rx.AddIndex(default_namespace, {"tags", "tree", "int", IndexOpts().Array()});
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rx.AddIndex(default_namespace, {"extra", "hash", "string", IndexOpts().Sparse()});
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rx.AddIndex(default_namespace, {"id+name", {"id", "name"}, "hash", "composite", IndexOpts()});
+		ASSERT_TRUE(err.ok()) << err.what();
+
+		for (int i = 0; i < itemsCount; i++) {
+			Item item = rx.NewItem(default_namespace);
+			ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+			string json = "{\"id\":" + std::to_string(i) + ",\"name\":\"name_" + std::to_string(i % 100) + "\",\"tags\":[" +
+						  std::to_string(i % 7) + "," + std::to_string(i % 11) + "]" +
+						  ((i % 2) ? ",\"extra\":\"extra_" + std::to_string(i % 3) + "\"" : string()) + "}";
+			err = item.FromJSON(json);
+			ASSERT_TRUE(err.ok()) << err.what();
+			err = rx.Upsert(default_namespace, item);
+			ASSERT_TRUE(err.ok()) << err.what();
+		}
+		err = rx.Commit(default_namespace);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+
+	Reindexer rx;
+	auto err = rx.Connect(dbPath);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	auto count = [&](const Query &q) {
+		QueryResults qr;
+		auto err = rx.Select(q, qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		return qr.Count();
+	};
+	EXPECT_EQ(count(Query(default_namespace)), size_t(itemsCount));
+	EXPECT_EQ(count(Query(default_namespace).Where("name", CondEq, "name_42")), size_t(itemsCount / 100));
+	size_t tagsCount = 0, extraCount = 0;
+	for (int i = 0; i < itemsCount; i++) {
+		tagsCount += (i % 7 == 3 || i % 11 == 3);
+		extraCount += (i % 2 && i % 3 == 1);
+	}
+	EXPECT_EQ(count(Query(default_namespace).Where("tags", CondEq, 3)), tagsCount);
+	EXPECT_EQ(count(Query(default_namespace).Where("extra", CondEq, "extra_1")), extraCount);
+	EXPECT_EQ(count(Query(default_namespace).WhereComposite("id+name", CondEq, {{Variant(142), Variant("name_42")}})), 1u);
+
+	QueryResults qr;
+	err = rx.Select(Query(default_namespace).Where("id", CondEq, 12345), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(qr.Count(), 1u);
+	Item item = qr[0].GetItem();
+	EXPECT_EQ(item["name"].As<string>(), "name_45");
+	VariantArray tags = item["tags"];
+	ASSERT_EQ(tags.size(), 2u);
+	EXPECT_EQ(tags[0].As<int>(), 12345 % 7);
+	EXPECT_EQ(tags[1].As<int>(), 12345 % 11);
+	EXPECT_EQ(item["extra"].As<string>(), "extra_0");
+
+	reindexer::fs::RmDirAll(dbPath);
+}
+
+TEST_F(ReindexerApi, WALStream) {
+	const string dbPath = reindexer::fs::JoinPath(reindexer::fs::GetTempDir(), "reindex_wal_test");
+	reindexer::fs::RmDirAll(dbPath);
+
+	const int itemsCount = 10;
+	auto upsertItem = [&](Reindexer &rx, int id, const string &name) {
+		Item item = rx.NewItem(default_namespace);
+		ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+		auto err = item.FromJSON("{\"id\":" + std::to_string(id) + ",\"name\":\"" + name + "\"}");
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rx.Upsert(default_namespace, item);
+		ASSERT_TRUE(err.ok()) << err.what();
+	};
+	auto getWAL = [&](Reindexer &rx, int64_t lastLSN, int limit) {
+		reindexer::WALChunk chunk;
+		auto err = rx.GetWAL(default_namespace, lastLSN, limit, chunk);
+		EXPECT_TRUE(err.ok()) << err.what();
+		return chunk;
+	};
+	// Short description of records to compare them
+	auto describe = [](const vector<reindexer::WALRecord> &records) {
+		vector<string> ret;
+		for (auto &rec : records) {
+			ret.push_back(std::to_string(rec.type) + ":" + std::to_string(rec.mode) + ":" + rec.data + ":" + rec.value);
+		}
+		return ret;
+	};
+
+	vector<string> expected;
+	{
+		Reindexer rx;
+		auto err = rx.Connect(dbPath);
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rx.OpenNamespace(default_namespace, StorageOpts().Enabled().CreateIfMissing());
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rx.AddIndex(default_namespace, {"id", "hash", "int", IndexOpts().PK()});
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rx.AddIndex(default_namespace, {"name", "hash", "string", IndexOpts()});
+		ASSERT_TRUE(err.ok()) << err.what();
+
+		for (int i = 0; i < itemsCount; i++) upsertItem(rx, i, "name" + std::to_string(i));
+		upsertItem(rx, 3, "updated");
+		Item item = rx.NewItem(default_namespace);
+		ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+		item["id"] = 5;
+		err = rx.Delete(default_namespace, item);
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rx.PutMeta(default_namespace, "key", "value");
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rx.DropIndex(default_namespace, "name");
+		ASSERT_TRUE(err.ok()) << err.what();
+
+		reindexer::WALChunk chunk = getWAL(rx, -1, 1000);
+		ASSERT_EQ(chunk.lastLSN, chunk.nsLSN);
+		// 2 indexes, items, 1 update, 1 delete, meta and dropped index
+		ASSERT_EQ(chunk.nsLSN, 2 + itemsCount + 4 - 1);
+		// Records of updated and deleted items are replaced by the later ones
+		ASSERT_EQ(chunk.records.size(), size_t(2 + itemsCount - 2 + 4));
+		expected = describe(chunk.records);
+		for (auto &rec : chunk.records) {
+			if (rec.type == reindexer::kWALOpModifyItem) {
+				ASSERT_NE(rec.data.find("\"id\":"), string::npos) << rec.data;
+			}
+		}
+		const auto &lastRecords = chunk.records;
+		size_t n = lastRecords.size();
+		EXPECT_EQ(lastRecords[n - 4].data, "{\"id\":3,\"name\":\"updated\"}");
+		EXPECT_EQ(lastRecords[n - 3].mode, ModeDelete);
+		EXPECT_NE(lastRecords[n - 3].data.find("\"id\":5"), string::npos) << lastRecords[n - 3].data;
+		EXPECT_EQ(lastRecords[n - 2].type, reindexer::kWALPutMeta);
+		EXPECT_EQ(lastRecords[n - 2].data, "key");
+		EXPECT_EQ(lastRecords[n - 2].value, "value");
+		EXPECT_EQ(lastRecords[n - 1].type, reindexer::kWALOpDropIndex);
+		EXPECT_EQ(lastRecords[n - 1].data, "name");
+
+		// Tail is read by chunks, starting from the last known LSN
+		vector<reindexer::WALRecord> records;
+		for (int64_t lastLSN = -1; lastLSN < chunk.nsLSN;) {
+			reindexer::WALChunk part = getWAL(rx, lastLSN, 3);
+			ASSERT_GT(part.lastLSN, lastLSN);
+			ASSERT_LE(part.records.size(), 3u);
+			records.insert(records.end(), part.records.begin(), part.records.end());
+			lastLSN = part.lastLSN;
+		}
+		ASSERT_EQ(describe(records), expected);
+
+		ASSERT_EQ(getWAL(rx, chunk.nsLSN, 1000).records.size(), 0u);
+		err = rx.GetWAL(default_namespace, chunk.nsLSN + 1, 1000, chunk);
+		ASSERT_EQ(err.code(), errOutdatedWAL) << err.what();
+	}
+
+	// WAL is loaded from storage
+	Reindexer rx;
+	auto err = rx.Connect(dbPath);
+	ASSERT_TRUE(err.ok()) << err.what();
+	reindexer::WALChunk chunk = getWAL(rx, -1, 1000);
+	ASSERT_EQ(describe(chunk.records), expected);
+	upsertItem(rx, 1, "reloaded");
+	chunk = getWAL(rx, -1, 1000);
+	ASSERT_EQ(chunk.records.size(), expected.size());
+	ASSERT_EQ(chunk.records.back().data, "{\"id\":1,\"name\":\"reloaded\"}");
+
+	// Followers, which are behind the kept tail, get error
+	err = rx.InitSystemNamespaces();
+	ASSERT_TRUE(err.ok()) << err.what();
+	Item cfg = rx.NewItem("#config");
+	err = cfg.FromJSON(R"json({"type":"namespaces","namespaces":[{"namespace":"*","wal_size":5}]})json");
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = rx.Upsert("#config", cfg);
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = rx.GetWAL(default_namespace, -1, 1000, chunk);
+	ASSERT_EQ(err.code(), errOutdatedWAL) << err.what();
+	chunk = getWAL(rx, chunk.nsLSN - 5, 1000);
+	ASSERT_EQ(chunk.records.back().data, "{\"id\":1,\"name\":\"reloaded\"}");
+
+	reindexer::fs::RmDirAll(dbPath);
+}
+
+TEST_F(ReindexerApi, ItemLSN) {
+	auto err = reindexer->OpenNamespace(default_namespace, StorageOpts().Enabled(false));
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = reindexer->AddIndex(default_namespace, {"id", "hash", "int", IndexOpts().PK()});
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	// Modified item gets LSN of its change, which is the LSN of record of WAL
+	vector<int64_t> lsns;
+	for (int mode : {ModeUpsert, ModeUpsert, ModeDelete}) {
+		Item item = reindexer->NewItem(default_namespace);
+		ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+		err = item.FromJSON("{\"id\":1,\"name\":\"name" + std::to_string(lsns.size()) + "\"}");
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = mode == ModeDelete ? reindexer->Delete(default_namespace, item) : reindexer->Upsert(default_namespace, item);
+		ASSERT_TRUE(err.ok()) << err.what();
+		lsns.push_back(item.GetLSN());
+
+		reindexer::WALChunk chunk;
+		err = reindexer->GetWAL(default_namespace, lsns.back() - 1, 10, chunk);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(chunk.records.size(), 1u);
+		ASSERT_EQ(chunk.records[0].lsn, lsns.back());
+		ASSERT_EQ(chunk.records[0].mode, mode);
+	}
+	ASSERT_EQ(lsns[1], lsns[0] + 1);
+	ASSERT_EQ(lsns[2], lsns[1] + 1);
+}
+
+TEST_F(ReindexerApi, SnapshotTransfer) {
+	const string dbPath = reindexer::fs::JoinPath(reindexer::fs::GetTempDir(), "reindex_snapshot_test");
+	reindexer::fs::RmDirAll(dbPath);
+
+	const int itemsCount = 1000;
+	auto upsertItem = [&](Reindexer &rx, const string &json) {
+		Item item = rx.NewItem(default_namespace);
+		ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+		auto err = item.FromJSON(json);
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rx.Upsert(default_namespace, item);
+		ASSERT_TRUE(err.ok()) << err.what();
+	};
+	auto itemJSON = [](int id, const string &name) {
+		return "{\"id\":" + std::to_string(id) + ",\"name\":\"" + name + "\",\"nested\":{\"value\":" + std::to_string(id * 2) + "}}";
+	};
+	auto getItems = [&](Reindexer &rx, const Query &q) {
+		QueryResults qr;
+		auto err = rx.Select(q, qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		vector<string> ret;
+		for (auto it : qr) {
+			reindexer::WrSerializer ser;
+			err = it.GetJSON(ser, false);
+			EXPECT_TRUE(err.ok()) << err.what();
+			ret.push_back(ser.Slice().ToString());
+		}
+		return ret;
+	};
+
+	Reindexer leader;
+	auto err = leader.OpenNamespace(default_namespace, StorageOpts());
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = leader.AddIndex(default_namespace, {"id", "hash", "int", IndexOpts().PK()});
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = leader.AddIndex(default_namespace, {"name", "tree", "string", IndexOpts()});
+	ASSERT_TRUE(err.ok()) << err.what();
+	for (int i = 0; i < itemsCount; i++) upsertItem(leader, itemJSON(i, "name" + std::to_string(i)));
+
+	{
+		Reindexer follower;
+		err = follower.Connect(dbPath);
+		ASSERT_TRUE(err.ok()) << err.what();
+
+		// Leader is changed while snapshot is transferred: item, which is changed after LSN of snapshot, is not sent,
+		// and changes are applied from WAL
+		int chunksCount = 0;
+		int64_t lsn = -1;
+		err = follower.LoadSnapshot(default_namespace, [&](int64_t snapshotLSN, int64_t fromID, reindexer::SnapshotChunk &chunk) {
+			if (chunksCount++ == 1) {
+				upsertItem(leader, itemJSON(0, "updated"));
+				upsertItem(leader, itemJSON(itemsCount - 1, "updated"));
+				upsertItem(leader, itemJSON(itemsCount, "inserted"));
+				Item item = leader.NewItem(default_namespace);
+				item["id"] = 1;
+				auto status = leader.Delete(default_namespace, item);
+				EXPECT_TRUE(status.ok()) << status.what();
+			}
+			auto status = leader.GetSnapshot(default_namespace, snapshotLSN, fromID, 4096, chunk);
+			EXPECT_TRUE(snapshotLSN < 0 || chunk.lsn == snapshotLSN);
+			EXPECT_EQ(chunk.nsDef.empty(), snapshotLSN >= 0);
+			lsn = chunk.lsn;
+			return status;
+		});
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_GT(chunksCount, 2);
+		ASSERT_EQ(getItems(follower, Query(default_namespace)).size(), size_t(itemsCount - 1));
+
+		reindexer::WALChunk wal;
+		err = leader.GetWAL(default_namespace, lsn, 1000, wal);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(wal.records.size(), 4u);
+		for (auto &rec : wal.records) {
+			Item item = follower.NewItem(default_namespace);
+			ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+			err = item.FromJSON(rec.data);
+			ASSERT_TRUE(err.ok()) << err.what();
+			err = rec.mode == ModeDelete ? follower.Delete(default_namespace, item) : follower.Upsert(default_namespace, item);
+			ASSERT_TRUE(err.ok()) << err.what();
+		}
+		auto allItems = Query(default_namespace).Sort("id", false);
+		ASSERT_EQ(getItems(follower, allItems), getItems(leader, allItems));
+	}
+
+	// Loaded snapshot is kept in storage, and indexes are built
+	Reindexer follower;
+	err = follower.Connect(dbPath);
+	ASSERT_TRUE(err.ok()) << err.what();
+	auto allItems = Query(default_namespace).Sort("id", false);
+	ASSERT_EQ(getItems(follower, allItems), getItems(leader, allItems));
+	auto found = getItems(follower, Query(default_namespace).Where("name", CondEq, "updated").Sort("id", false));
+	ASSERT_EQ(found, vector<string>({itemJSON(0, "updated"), itemJSON(itemsCount - 1, "updated")}));
+
+	reindexer::fs::RmDirAll(dbPath);
+}
+
+TEST_F(ReindexerApi, SnapshotFailedLoad) {
+	const string dbPath = reindexer::fs::JoinPath(reindexer::fs::GetTempDir(), "reindex_snapshot_failed_test");
+	reindexer::fs::RmDirAll(dbPath);
+
+	const int itemsCount = 1000;
+	auto upsertItems = [&](Reindexer &rx, const string &name) {
+		for (int i = 0; i < itemsCount; i++) {
+			Item item = rx.NewItem(default_namespace);
+			ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+			auto err = item.FromJSON("{\"id\":" + std::to_string(i) + ",\"name\":\"" + name + "\"}");
+			ASSERT_TRUE(err.ok()) << err.what();
+			err = rx.Upsert(default_namespace, item);
+			ASSERT_TRUE(err.ok()) << err.what();
+		}
+	};
+	auto countItems = [&](Reindexer &rx, const string &name) {
+		QueryResults qr;
+		auto err = rx.Select(Query(default_namespace).Where("name", CondEq, name), qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		return qr.Count();
+	};
+
+	Reindexer leader;
+	auto err = leader.OpenNamespace(default_namespace, StorageOpts());
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = leader.AddIndex(default_namespace, {"id", "hash", "int", IndexOpts().PK()});
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = leader.AddIndex(default_namespace, {"name", "tree", "string", IndexOpts()});
+	ASSERT_TRUE(err.ok()) << err.what();
+	upsertItems(leader, "first");
+
+	{
+		Reindexer follower;
+		err = follower.Connect(dbPath);
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = follower.LoadSnapshot(default_namespace, [&](int64_t snapshotLSN, int64_t fromID, reindexer::SnapshotChunk &chunk) {
+			return leader.GetSnapshot(default_namespace, snapshotLSN, fromID, 4096, chunk);
+		});
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(countItems(follower, "first"), size_t(itemsCount));
+
+		// Fetch of snapshot fails halfway: current namespace and its storage are kept
+		upsertItems(leader, "second");
+		int chunksCount = 0;
+		err = follower.LoadSnapshot(default_namespace, [&](int64_t snapshotLSN, int64_t fromID, reindexer::SnapshotChunk &chunk) {
+			if (chunksCount++ == 2) return Error(errNetwork, "Connection lost");
+			return leader.GetSnapshot(default_namespace, snapshotLSN, fromID, 4096, chunk);
+		});
+		ASSERT_EQ(err.code(), errNetwork) << err.what();
+		ASSERT_EQ(countItems(follower, "first"), size_t(itemsCount));
+		ASSERT_EQ(countItems(follower, "second"), 0u);
+		ASSERT_FALSE(reindexer::fs::DirectoryExists(reindexer::fs::JoinPath(dbPath, ".snapshot/" + default_namespace)));
+	}
+
+	Reindexer follower;
+	err = follower.Connect(dbPath);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(countItems(follower, "first"), size_t(itemsCount));
+
+	// Snapshot, which is loaded completely, replaces storage of namespace
+	err = follower.LoadSnapshot(default_namespace, [&](int64_t snapshotLSN, int64_t fromID, reindexer::SnapshotChunk &chunk) {
+		return leader.GetSnapshot(default_namespace, snapshotLSN, fromID, 4096, chunk);
+	});
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(countItems(follower, "second"), size_t(itemsCount));
+	err = follower.CloseNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = follower.OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(countItems(follower, "second"), size_t(itemsCount));
+	ASSERT_EQ(countItems(follower, "first"), 0u);
+
+	reindexer::fs::RmDirAll(dbPath);
+}
+
+TEST_F(ReindexerApi, SnapshotConcurrentWrites) {
+	const string dbPath = reindexer::fs::JoinPath(reindexer::fs::GetTempDir(), "reindex_snapshot_writes_test");
+	reindexer::fs::RmDirAll(dbPath);
+
+	auto upsertItem = [&](Reindexer &rx, int id, const string &name) {
+		Item item = rx.NewItem(default_namespace);
+		if (!item.Status().ok()) return item.Status();
+		auto err = item.FromJSON("{\"id\":" + std::to_string(id) + ",\"name\":\"" + name + "\"}");
+		if (!err.ok()) return err;
+		return rx.Upsert(default_namespace, item);
+	};
+	auto getItems = [&](Reindexer &rx) {
+		QueryResults qr;
+		auto err = rx.Select(Query(default_namespace).Sort("id", false), qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		vector<string> ret;
+		for (auto it : qr) {
+			reindexer::WrSerializer ser;
+			err = it.GetJSON(ser, false);
+			EXPECT_TRUE(err.ok()) << err.what();
+			ret.push_back(ser.Slice().ToString());
+		}
+		return ret;
+	};
+	auto loadSnapshot = [&](Reindexer &leader, Reindexer &follower) {
+		return follower.LoadSnapshot(default_namespace, [&](int64_t snapshotLSN, int64_t fromID, reindexer::SnapshotChunk &chunk) {
+			return leader.GetSnapshot(default_namespace, snapshotLSN, fromID, 4096, chunk);
+		});
+	};
+
+	Reindexer leader;
+	auto err = leader.OpenNamespace(default_namespace, StorageOpts());
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = leader.AddIndex(default_namespace, {"id", "hash", "int", IndexOpts().PK()});
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = leader.AddIndex(default_namespace, {"name", "tree", "string", IndexOpts()});
+	ASSERT_TRUE(err.ok()) << err.what();
+	for (int i = 0; i < 1000; i++) {
+		err = upsertItem(leader, i, "leader");
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+
+	vector<string> items;
+	int firstWrittenAfterLoad = 0;
+	{
+		Reindexer follower;
+		err = follower.Connect(dbPath);
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = loadSnapshot(leader, follower);
+		ASSERT_TRUE(err.ok()) << err.what();
+
+		// Items are written, while namespace is replaced by snapshot. Writes, which are applied to replaced namespace, are discarded
+		// with it, but each item of namespace, which serves requests after the load, is persisted
+		std::atomic<int> written{0};
+		std::atomic<bool> stop{false};
+		std::thread writer([&]() {
+			for (int id = 10000; !stop; id++) {
+				auto status = upsertItem(follower, id, "local");
+				ASSERT_TRUE(status.ok()) << status.what();
+				written = id;
+			}
+		});
+		for (int i = 0; i < 5; i++) {
+			err = loadSnapshot(leader, follower);
+			ASSERT_TRUE(err.ok()) << err.what();
+		}
+		firstWrittenAfterLoad = written + 1;
+		while (written < firstWrittenAfterLoad + 100) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		stop = true;
+		writer.join();
+
+		items = getItems(follower);
+		ASSERT_GE(items.size(), 1100u);
+	}
+
+	Reindexer follower;
+	err = follower.Connect(dbPath);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(getItems(follower), items);
+	QueryResults qr;
+	err = follower.Select(Query(default_namespace).Where("id", CondGe, firstWrittenAfterLoad), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_GE(qr.Count(), 100u);
+
+	reindexer::fs::RmDirAll(dbPath);
+}
+
+TEST_F(ReindexerApi, StorageEngine) {
+	using reindexer::datastorage::StorageType;
+	const string dbPath = reindexer::fs::JoinPath(reindexer::fs::GetTempDir(), "reindex_engine_test");
+	reindexer::fs::RmDirAll(dbPath);
+
+	auto tunables = StorageOpts().Compression(kStorageCompressionNone).BlockCacheSize(8 << 20).WriteBufferSize(1 << 20).MaxOpenFiles(100);
+	{
+		Reindexer rx;
+		auto err = rx.Connect(dbPath, reindexer::ConnectOpts().WithStorageTunables(tunables));
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rx.OpenNamespace(default_namespace);
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rx.AddIndex(default_namespace, {"id", "hash", "int", IndexOpts().PK()});
+		ASSERT_TRUE(err.ok()) << err.what();
+		Item item = rx.NewItem(default_namespace);
+		ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+		err = item.FromJSON(R"({"id":1,"value":"one"})");
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rx.Upsert(default_namespace, item);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+
+	// Engine of database is kept in placeholder, and existing database is opened by it, whatever engine is requested
+	string placeholder;
+	ASSERT_GT(reindexer::fs::ReadFile(reindexer::fs::JoinPath(dbPath, ".reindexer.storage"), placeholder), 0);
+	ASSERT_EQ(placeholder, "leveldb");
+	{
+		Reindexer rx;
+		auto err = rx.Connect(dbPath, reindexer::ConnectOpts().WithStorageType(StorageType::RocksDB));
+		ASSERT_TRUE(err.ok()) << err.what();
+		QueryResults qr;
+		err = rx.Select(Query(default_namespace), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(qr.Count(), 1u);
+	}
+	reindexer::fs::RmDirAll(dbPath);
+
+	// New database is created by requested engine, if it is supported by build
+	{
+		Reindexer rx;
+		auto err = rx.Connect(dbPath, reindexer::ConnectOpts().WithStorageType(StorageType::RocksDB));
+#ifdef REINDEX_WITH_ROCKSDB
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rx.OpenNamespace(default_namespace);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_GT(reindexer::fs::ReadFile(reindexer::fs::JoinPath(dbPath, ".reindexer.storage"), placeholder), 0);
+		ASSERT_EQ(placeholder, "rocksdb");
+#else
+		ASSERT_EQ(err.code(), errParams);
+		// Placeholder is not written, so database can be created later by supported engine
+		ASSERT_LT(reindexer::fs::ReadFile(reindexer::fs::JoinPath(dbPath, ".reindexer.storage"), placeholder), 0);
+#endif
+	}
+	reindexer::fs::RmDirAll(dbPath);
+
+#ifndef _WIN32
+	// Namespace is loaded from native storage on reopen
+	for (int i = 0; i < 2; i++) {
+		Reindexer rx;
+		auto err = rx.Connect(dbPath, reindexer::ConnectOpts().WithStorageType(StorageType::Native).WithStorageTunables(tunables));
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = rx.OpenNamespace(default_namespace);
+		ASSERT_TRUE(err.ok()) << err.what();
+		if (i == 0) {
+			err = rx.AddIndex(default_namespace, {"id", "hash", "int", IndexOpts().PK()});
+			ASSERT_TRUE(err.ok()) << err.what();
+			for (int id = 0; id < 100; id++) {
+				Item item = rx.NewItem(default_namespace);
+				ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+				err = item.FromJSON("{\"id\":" + std::to_string(id) + "}");
+				ASSERT_TRUE(err.ok()) << err.what();
+				err = id % 2 ? rx.Upsert(default_namespace, item) : rx.Insert(default_namespace, item);
+				ASSERT_TRUE(err.ok()) << err.what();
+			}
+			QueryResults qr;
+			err = rx.Delete(Query(default_namespace).Where("id", CondLt, 10), qr);
+			ASSERT_TRUE(err.ok()) << err.what();
+			continue;
+		}
+		ASSERT_GT(reindexer::fs::ReadFile(reindexer::fs::JoinPath(dbPath, ".reindexer.storage"), placeholder), 0);
+		ASSERT_EQ(placeholder, "native");
+		QueryResults qr;
+		err = rx.Select(Query(default_namespace), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(qr.Count(), 90u);
+	}
+	reindexer::fs::RmDirAll(dbPath);
+#endif
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+
+#include "core/reindexer.h"
+#include "server/dbmanager.h"
+#include "server/rpcserver.h"
+#include "tools/fsops.h"
+
+// Database, which is served by RPC server in background thread
+class RPCServerApi : public ::testing::Test {
+protected:
+	RPCServerApi(const std::string &path, const std::string &addr, const std::string &dbName)
+		: path_(path), addr_(addr), dbName_(dbName) {}
+
+	void SetUp() override {
+		reindexer::fs::RmDirAll(path_);
+		reindexer::fs::MkDirAll(reindexer::fs::JoinPath(path_, "server"));
+
+		dbMgr_.reset(new reindexer_server::DBManager(reindexer::fs::JoinPath(path_, "server"), true));
+		reindexer::Error err = dbMgr_->Init();
+		ASSERT_TRUE(err.ok()) << err.what();
+		reindexer_server::AuthContext auth;
+		err = dbMgr_->OpenDatabase(dbName_, auth, true);
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = auth.GetDB(reindexer_server::kRoleOwner, &db_);
+		ASSERT_TRUE(err.ok()) << err.what();
+
+		rpcServer_.reset(new reindexer_server::RPCServer(*dbMgr_, reindexer_server::LoggerWrapper()));
+		ASSERT_TRUE(rpcServer_->Start(addr_, loop_));
+		stop_.set(loop_);
+		stop_.set([this](reindexer::net::ev::async &a) {
+			rpcServer_->Stop();
+			a.loop.break_loop();
+		});
+		stop_.start();
+		running_ = true;
+		loopThread_ = std::thread([this]() {
+			while (running_) loop_.run();
+		});
+	}
+
+	void TearDown() override {
+		if (loopThread_.joinable()) {
+			running_ = false;
+			stop_.send();
+			loopThread_.join();
+		}
+		reindexer::fs::RmDirAll(path_);
+	}
+
+	std::string dsn() const { return "cproto://" + addr_ + "/" + dbName_; }
+
+	const std::string path_, addr_, dbName_;
+	std::unique_ptr<reindexer_server::DBManager> dbMgr_;
+	std::shared_ptr<reindexer::Reindexer> db_;
+	std::unique_ptr<reindexer_server::RPCServer> rpcServer_;
+	reindexer::net::ev::dynamic_loop loop_;
+	reindexer::net::ev::async stop_;
+	std::atomic<bool> running_{false};
+	std::thread loopThread_;
+};
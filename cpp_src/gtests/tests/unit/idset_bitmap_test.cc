@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <iterator>
+#include <set>
+#include <vector>
+
+#include "core/idsetbitmap.h"
+
+using std::set;
+using std::vector;
+using reindexer::IdSetBitmap;
+using reindexer::IdSetRef;
+
+static void checkEqual(const IdSetBitmap &bitmap, const set<IdType> &expected) {
+	ASSERT_EQ(bitmap.Size(), expected.size());
+	auto ids = bitmap.ToIdSet();
+	ASSERT_EQ(ids->size(), expected.size());
+	ASSERT_TRUE(std::equal(expected.begin(), expected.end(), ids->begin()));
+}
+
+TEST(IdSetBitmap, SetOperations) {
+	srand(42);
+	// Dense and sparse sets, which make both bitmap and array containers
+	auto makeSet = [](int count, int maxId) {
+		set<IdType> ret;
+		for (int i = 0; i < count; i++) ret.insert(rand() % maxId);
+		return ret;
+	};
+	vector<set<IdType>> sets = {makeSet(200000, 300000), makeSet(3000, 300000), makeSet(100000, 150000), makeSet(10, 1000000), {}};
+
+	for (auto &lhs : sets) {
+		for (auto &rhs : sets) {
+			vector<IdType> lhsIds(lhs.begin(), lhs.end());
+			IdSetBitmap lbm;
+			lbm.Add(IdSetRef(lhsIds.data(), lhsIds.size()));
+			IdSetBitmap rbm;
+			for (IdType id : rhs) rbm.Add(id);
+			checkEqual(lbm, lhs);
+			checkEqual(rbm, rhs);
+
+			set<IdType> expected;
+			IdSetBitmap res = lbm;
+			res.And(rbm);
+			std::set_intersection(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::inserter(expected, expected.end()));
+			checkEqual(res, expected);
+
+			expected.clear();
+			res = lbm;
+			res.Or(rbm);
+			std::set_union(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::inserter(expected, expected.end()));
+			checkEqual(res, expected);
+
+			expected.clear();
+			res = lbm;
+			res.AndNot(rbm);
+			std::set_difference(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::inserter(expected, expected.end()));
+			checkEqual(res, expected);
+		}
+	}
+
+	IdSetBitmap bitmap;
+	for (IdType id : sets[1]) bitmap.Add(id);
+	for (IdType id = 0; id < 300000; id++) ASSERT_EQ(bitmap.Contains(id), sets[1].count(id) != 0) << id;
+}
@@ -244,3 +244,100 @@ TEST_F(JoinSelectsApi, JoinByNonIndexedField) {
 	ASSERT_TRUE(err.ok()) << err.what();
 	ASSERT_TRUE(qr2.Count() == 1) << err.what();
 }
+
+TEST_F(JoinSelectsApi, HashJoinTest) {
+	Query queryAuthors = Query(authors_namespace).Where(age, CondGe, 50);
+	Query queryBooks = Query(books_namespace).Where(price, CondGe, 600);
+	Query joinQuery = Query(queryBooks).InnerJoin(authorid_fk, authorid, CondEq, queryAuthors).Explain();
+
+	reindexer::QueryResults joinQueryRes;
+	Error err = reindexer->Select(joinQuery, joinQueryRes);
+	ASSERT_TRUE(err.ok()) << err.what();
+	EXPECT_NE(joinQueryRes.GetExplainResults().find("\"strategy\":\"hash\""), string::npos) << joinQueryRes.GetExplainResults();
+
+	reindexer::QueryResults pureSelectRes;
+	err = reindexer->Select(queryBooks, pureSelectRes);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	QueryResultRows joinSelectRows;
+	QueryResultRows pureSelectRows;
+	for (auto it : pureSelectRes) {
+		Item booksItem(it.GetItem());
+		Variant authorIdKeyRef = booksItem[authorid_fk];
+
+		reindexer::QueryResults authorsSelectRes;
+		Query authorsQuery = Query(authors_namespace).Where(authorid, CondEq, authorIdKeyRef).Where(age, CondGe, 50);
+		err = reindexer->Select(authorsQuery, authorsSelectRes);
+		ASSERT_TRUE(err.ok()) << err.what();
+		if (!authorsSelectRes.Count()) continue;
+
+		QueryResultRow& pureSelectRow = pureSelectRows[booksItem[bookid].Get<int>()];
+		FillQueryResultFromItem(booksItem, pureSelectRow);
+		for (auto jit : authorsSelectRes) {
+			Item authorsItem(jit.GetItem());
+			FillQueryResultFromItem(authorsItem, pureSelectRow);
+		}
+	}
+
+	FillQueryResultRows(joinQueryRes, joinSelectRows);
+	EXPECT_TRUE(CompareQueriesResults(pureSelectRows, joinSelectRows));
+}
+
+TEST_F(JoinSelectsApi, HashJoinCostAndCache) {
+	Query queryAuthors = Query(authors_namespace).Where(age, CondGe, 50);
+
+	// Nested selects are cheaper, than hash table of joined rows, for a few rows of main namespace
+	for (const Query& queryBooks : {Query(books_namespace).Where(bookid, CondEq, 1), Query(books_namespace).Limit(3)}) {
+		reindexer::QueryResults qr;
+		Error err = reindexer->Select(Query(queryBooks).InnerJoin(authorid_fk, authorid, CondEq, queryAuthors).Explain(), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		EXPECT_NE(qr.GetExplainResults().find("\"strategy\":\"nested_loop\""), string::npos) << qr.GetExplainResults();
+	}
+
+	auto selectJoined = [&]() {
+		reindexer::QueryResults qr;
+		Error err = reindexer->Select(Query(books_namespace).InnerJoin(authorid_fk, authorid, CondEq, queryAuthors).Explain(), qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		EXPECT_NE(qr.GetExplainResults().find("\"strategy\":\"hash\""), string::npos) << qr.GetExplainResults();
+		return qr.Count();
+	};
+
+	// Hash table is taken from join cache by repeated queries
+	size_t joinedCount = selectJoined();
+	for (int i = 0; i < 3; ++i) ASSERT_EQ(selectJoined(), joinedCount);
+
+	// Cached hash table is dropped after update of joined namespace
+	reindexer::QueryResults authorsRes;
+	Error err = reindexer->Select(Query(authors_namespace), authorsRes);
+	ASSERT_TRUE(err.ok()) << err.what();
+	for (auto it : authorsRes) {
+		Item item = it.GetItem();
+		item[age] = 90;
+		Upsert(authors_namespace, item);
+	}
+	Commit(authors_namespace);
+
+	reindexer::QueryResults booksRes;
+	err = reindexer->Select(Query(books_namespace), booksRes);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_GT(booksRes.Count(), joinedCount);
+	ASSERT_EQ(selectJoined(), booksRes.Count());
+}
+
+TEST_F(JoinSelectsApi, JoinedItemsOfTopKResults) {
+	// Results are sorted by hash index after select loop, so only best rows are kept in loop, and joined items of dropped rows are erased
+	const unsigned limit = 10;
+	Query authorsQuery(authors_namespace);
+	Query query = Query(books_namespace).Sort(pages, false).Limit(limit).LeftJoin(authorid_fk, authorid, CondEq, authorsQuery);
+	reindexer::QueryResults qr;
+	Error err = reindexer->Select(query, qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(qr.Count(), limit);
+	ASSERT_EQ(qr.joined_.size(), 1);
+	ASSERT_LE(qr.joined_[0].size(), limit);
+	for (auto& joined : qr.joined_[0]) {
+		bool found = false;
+		for (auto& item : qr.Items()) found = found || item.id == joined.first;
+		ASSERT_TRUE(found) << "Joined items of row " << joined.first << ", which is not in results";
+	}
+}
@@ -1,4 +1,8 @@
 #include "ns_api.h"
+#include <thread>
+#include "core/namespace.h"
+#include "core/nsselecter/nsselecter.h"
+#include "tools/fsops.h"
 
 TEST_F(NsApi, UpsertWithPrecepts) {
 	Error err = reindexer->OpenNamespace(default_namespace);
@@ -93,3 +97,1061 @@ TEST_F(NsApi, UpdateIndex) {
 
 	ASSERT_TRUE(newIdxJson == receivedIdxJson);
 }
+
+TEST_F(NsApi, SortByOrderedIndexesWithUpdates) {
+	Error err = reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	const vector<string> sortFields = {"year", "rate"};
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK()},
+											   IndexDeclaration{sortFields[0].c_str(), "tree", "int", IndexOpts()},
+											   IndexDeclaration{sortFields[1].c_str(), "tree", "int", IndexOpts()}});
+
+	vector<int> years(1000), rates(1000);
+	auto upsertItems = [&](int from, int count, bool keepYears) {
+		for (int i = from; i < from + count; i++) {
+			if (!keepYears) years[i] = rand() % 100;
+			rates[i] = rand() % 1000;
+			Item item = NewItem(default_namespace);
+			item[idIdxName] = i;
+			item[sortFields[0]] = years[i];
+			item[sortFields[1]] = rates[i];
+			auto err = reindexer->Upsert(default_namespace, item);
+			ASSERT_TRUE(err.ok()) << err.what();
+		}
+		auto err = reindexer->Commit(default_namespace);
+		ASSERT_TRUE(err.ok()) << err.what();
+	};
+
+	string explain;
+	auto checkSorted = [&](const Query &q, const string &field, bool desc, size_t expectedCount) {
+		reindexer::QueryResults qr;
+		Error err = reindexer->Select(Query(q).Sort(field, desc).Explain(), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(qr.Count(), expectedCount);
+
+		int prev = desc ? INT_MAX : INT_MIN;
+		for (auto it : qr) {
+			int value = it.GetItem()[field].Get<int>();
+			ASSERT_TRUE(desc ? value <= prev : value >= prev) << "Wrong sort order by " << field;
+			prev = value;
+		}
+		explain = qr.GetExplainResults();
+	};
+
+	upsertItems(0, 1000, false);
+	for (int i = 0; i < 10; i++) {
+		// Enough queries to make sort orders, each sort field by turn
+		for (int j = 0; j < 20; j++) {
+			const string &field = sortFields[j % sortFields.size()];
+			checkSorted(Query(default_namespace), field, (j / 2) % 2, 1000);
+		}
+		upsertItems(rand() % 900, 100, false);
+	}
+
+	// Sort orders are made, after the queries by year
+	for (int j = 0; j < 10; j++) checkSorted(Query(default_namespace), sortFields[0], false, 1000);
+
+	// Updates of rates keep sort orders of years, so sorted queries by year use them without rebuild
+	for (int i = 0; i < 10; i++) {
+		upsertItems(rand() % 900, 100, true);
+		for (bool desc : {false, true}) {
+			size_t expectedCount = std::count_if(rates.begin(), rates.end(), [](int rate) { return rate >= 500; });
+			checkSorted(Query(default_namespace).Where(sortFields[1], CondGe, 500), sortFields[0], desc, expectedCount);
+			ASSERT_NE(explain.find("\"sort_index\":\"" + sortFields[0] + "\""), string::npos) << explain;
+		}
+	}
+}
+
+TEST_F(NsApi, QueryCacheInvalidation) {
+	Error err = reindexer->InitSystemNamespaces();
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK()},
+											   IndexDeclaration{"year", "tree", "int", IndexOpts()},
+											   IndexDeclaration{"name", "hash", "string", IndexOpts()}});
+
+	auto upsertItem = [&](int id, int year, const string &name) {
+		Item item = NewItem(default_namespace);
+		item[idIdxName] = id;
+		item["year"] = year;
+		item["name"] = name;
+		auto err = reindexer->Upsert(default_namespace, item);
+		ASSERT_TRUE(err.ok()) << err.what();
+	};
+	auto queryCacheItems = [&]() {
+		reindexer::QueryResults qr;
+		auto err = reindexer->Select(Query("#memstats").Where("name", CondEq, default_namespace), qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		EXPECT_EQ(qr.Count(), 1);
+		string json = qr.begin().GetItem().GetJSON().ToString();
+		auto pos = json.find("\"query_cache\":");
+		EXPECT_NE(pos, string::npos) << json;
+		pos = json.find("\"items_count\":", pos);
+		EXPECT_NE(pos, string::npos) << json;
+		return std::stoi(json.substr(pos + strlen("\"items_count\":")));
+	};
+	auto checkTotal = [&](int expected) {
+		// Several times to put total to cache and get it from cache
+		for (int i = 0; i < 3; i++) {
+			reindexer::QueryResults qr;
+			auto err = reindexer->Select(Query(default_namespace).Where("year", CondGe, 2000).CachedTotal().Limit(1), qr);
+			ASSERT_TRUE(err.ok()) << err.what();
+			ASSERT_EQ(qr.totalCount, expected);
+		}
+	};
+
+	for (int i = 0; i < 100; i++) upsertItem(i, 1950 + i, "name" + to_string(i));
+	checkTotal(50);
+	ASSERT_EQ(queryCacheItems(), 1);
+
+	// Update of field, which is not used by query, should keep cached total
+	upsertItem(10, 1960, "other name");
+	ASSERT_EQ(queryCacheItems(), 1);
+	checkTotal(50);
+
+	// Update of field, which is used by query, should invalidate cached total
+	upsertItem(10, 2010, "other name");
+	ASSERT_EQ(queryCacheItems(), 0);
+	checkTotal(51);
+
+	// Insert should invalidate cached total
+	upsertItem(100, 2050, "name100");
+	ASSERT_EQ(queryCacheItems(), 0);
+	checkTotal(52);
+}
+
+TEST_F(NsApi, BackgroundIndexesOptimization) {
+	Error err = reindexer->InitSystemNamespaces();
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	Item cfg = NewItem("#config");
+	err = cfg.FromJSON(R"json({"type":"optimization","optimization":{"timeout_ms":10}})json");
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = reindexer->Upsert("#config", cfg);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	err = reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK()},
+											   IndexDeclaration{"year", "tree", "int", IndexOpts()}});
+	for (int i = 0; i < 100; i++) {
+		Item item = NewItem(default_namespace);
+		item[idIdxName] = i;
+		item["year"] = 2000 + i % 10;
+		err = reindexer->Upsert(default_namespace, item);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+
+	// Sort orders are built by background optimizer without any sorted query
+	bool sortOrdersBuilt = false;
+	for (int i = 0; i < 50 && !sortOrdersBuilt; i++) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		reindexer::QueryResults qr;
+		err = reindexer->Select(Query("#memstats").Where("name", CondEq, default_namespace), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(qr.Count(), 1);
+		sortOrdersBuilt = qr.begin().GetItem().GetJSON().ToString().find("\"sort_orders_size\"") != string::npos;
+	}
+	ASSERT_TRUE(sortOrdersBuilt) << "Indexes were not optimized in background";
+}
+
+TEST_F(NsApi, TransactionTest) {
+	Error err = reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK()},
+											   IndexDeclaration{"year", "tree", "int", IndexOpts()}});
+
+	auto newItem = [&](int id, int year) {
+		Item item = NewItem(default_namespace);
+		item[idIdxName] = id;
+		item["year"] = year;
+		return item;
+	};
+	auto selectCount = [&](const Query &q) {
+		reindexer::QueryResults qr;
+		auto err = reindexer->Select(q, qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		return qr.Count();
+	};
+
+	reindexer::Transaction tx = reindexer->NewTransaction(default_namespace);
+	for (int i = 0; i < 1000; i++) tx.Upsert(newItem(i, 1000 + i));
+	err = reindexer->CommitTransaction(tx);
+	ASSERT_TRUE(err.ok()) << err.what();
+	for (auto &step : tx.GetSteps()) ASSERT_NE(step.item.GetID(), -1);
+	ASSERT_EQ(selectCount(Query(default_namespace)), 1000);
+
+	// Update, insert of existing and delete in single transaction
+	tx = reindexer->NewTransaction(default_namespace);
+	for (int i = 0; i < 100; i++) tx.Update(newItem(i, 3000));
+	tx.Insert(newItem(500, 3000));
+	for (int i = 900; i < 1000; i++) tx.Delete(newItem(i, 0));
+	err = reindexer->CommitTransaction(tx);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(tx.GetSteps()[100].item.GetID(), -1);
+
+	ASSERT_EQ(selectCount(Query(default_namespace)), 900);
+	ASSERT_EQ(selectCount(Query(default_namespace).Where("year", CondEq, 3000)), 100);
+
+	// Invalid item fails the whole transaction: items before it are not applied
+	for (auto invalid : {0, 1}) {
+		tx = reindexer->NewTransaction(default_namespace);
+		for (int i = 0; i < 50; i++) tx.Update(newItem(i, 4000));
+		Item item = newItem(60, 4000);
+		if (invalid == 0) {
+			item.SetPrecepts({"year=unknown()"});
+			tx.Upsert(std::move(item));
+		} else {
+			tx.Modify(std::move(item), ItemModifyMode(10));
+		}
+		err = reindexer->CommitTransaction(tx);
+		ASSERT_FALSE(err.ok());
+		ASSERT_NE(err.what().find("Item 50"), string::npos) << err.what();
+		ASSERT_EQ(selectCount(Query(default_namespace).Where("year", CondEq, 4000)), 0);
+		ASSERT_EQ(selectCount(Query(default_namespace).Where("year", CondEq, 3000)), 100);
+	}
+
+	// Transaction to unknown namespace should fail
+	tx = reindexer->NewTransaction("unknown_ns");
+	tx.Upsert(newItem(1, 1));
+	err = reindexer->CommitTransaction(tx);
+	ASSERT_FALSE(err.ok());
+}
+
+TEST_F(NsApi, ComparatorsBatchSelect) {
+	Error err = reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "tree", "int", IndexOpts().PK()},
+											   IndexDeclaration{"value", "-", "int", IndexOpts()},
+											   IndexDeclaration{"rate", "-", "double", IndexOpts()},
+											   IndexDeclaration{"flag", "-", "bool", IndexOpts()}});
+
+	const int kItemsCount = 5000;
+	for (int i = 0; i < kItemsCount; i++) {
+		Item item = NewItem(default_namespace);
+		item[idIdxName] = i;
+		item["value"] = i % 100;
+		item["rate"] = double(i % 7) / 2;
+		item["flag"] = bool(i % 3 == 0);
+		err = reindexer->Upsert(default_namespace, item);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+	// Deleted items make free rows inside of batches
+	for (int i = 0; i < kItemsCount; i += 10) {
+		Item item = NewItem(default_namespace);
+		item[idIdxName] = i;
+		err = reindexer->Delete(default_namespace, item);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+
+	auto isMatched = [](int id) { return id % 10 != 0 && id % 100 >= 20 && id % 100 <= 60 && double(id % 7) / 2 > 1 && id % 3 == 0; };
+	auto check = [&](bool desc, unsigned offset, unsigned limit) {
+		vector<int> expected;
+		for (int i = 0; i < kItemsCount; i++)
+			if (isMatched(i)) expected.push_back(i);
+		if (desc) std::reverse(expected.begin(), expected.end());
+		expected.erase(expected.begin(), expected.begin() + std::min(size_t(offset), expected.size()));
+		if (expected.size() > limit) expected.resize(limit);
+
+		Query q = Query(default_namespace)
+					  .Where("value", CondRange, {20, 60})
+					  .Where("rate", CondGt, 1.0)
+					  .Where("flag", CondEq, true)
+					  .Offset(offset)
+					  .Limit(limit);
+		if (desc) q.Sort(idIdxName, true);
+		reindexer::QueryResults qr;
+		err = reindexer->Select(q, qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(qr.Count(), expected.size());
+		for (size_t i = 0; i < expected.size(); i++) {
+			ASSERT_EQ(qr[i].GetItem()[idIdxName].As<int>(), expected[i]);
+		}
+	};
+
+	check(false, 0, UINT_MAX);
+	check(false, 100, 10);
+	check(false, 0, 1);
+	check(true, 0, UINT_MAX);
+	check(true, 50, 20);
+}
+
+TEST_F(NsApi, IndexColumns) {
+	Error err = reindexer->InitSystemNamespaces();
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK()},
+											   IndexDeclaration{"year", "tree", "int", IndexOpts().Column()},
+											   IndexDeclaration{"rate", "tree", "double", IndexOpts().Column()},
+											   IndexDeclaration{"price", "hash", "int64", IndexOpts().Column()},
+											   IndexDeclaration{"code", "hash", "int", IndexOpts().Column().Dense()},
+											   IndexDeclaration{"rank", "tree", "int", IndexOpts()}});
+
+	const int kItemsCount = 1000;
+	auto upsertItem = [&](int id, int year, double rate, int64_t price) {
+		Item item = NewItem(default_namespace);
+		item[idIdxName] = id;
+		item["year"] = year;
+		item["rate"] = rate;
+		item["price"] = price;
+		item["code"] = id;
+		item["rank"] = id % 10;
+		auto err = reindexer->Upsert(default_namespace, item);
+		ASSERT_TRUE(err.ok()) << err.what();
+	};
+	for (int i = 0; i < kItemsCount; i++) upsertItem(i, 1900 + i % 100, double(i % 37) / 4, int64_t(i % 53) * 1000);
+	for (int i = 0; i < kItemsCount; i += 5) {
+		Item item = NewItem(default_namespace);
+		item[idIdxName] = i;
+		err = reindexer->Delete(default_namespace, item);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+	upsertItem(1, 2050, 100.5, 1000000);
+
+	// Columns of indexes with column option are reported by memstats. Dense index does not keep column
+	{
+		reindexer::QueryResults qr;
+		err = reindexer->Select(Query("#memstats").Where("name", CondEq, default_namespace), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(qr.Count(), 1);
+		string json = qr.begin().GetItem().GetJSON().ToString();
+		for (const string idx : {"year", "rate", "price", "code", "rank"}) {
+			auto end = json.find("\"name\":\"" + idx + "\"");
+			ASSERT_NE(end, string::npos) << json;
+			auto pos = json.rfind("{\"uniq_keys_count\":", end);
+			ASSERT_NE(pos, string::npos) << json;
+			bool hasColumn = json.substr(pos, end - pos).find("\"column_size\":") != string::npos;
+			ASSERT_EQ(hasColumn, idx != "code" && idx != "rank") << idx << " " << json;
+		}
+	}
+
+	// Aggregations and sorting by scalar indexes are taken from columns
+	double sum = 0, minYear = 1e9, maxRate = -1;
+	for (int i = 0; i < kItemsCount; i++) {
+		if (i % 5 == 0) continue;
+		int year = i == 1 ? 2050 : 1900 + i % 100;
+		double rate = i == 1 ? 100.5 : double(i % 37) / 4;
+		sum += year;
+		minYear = std::min(minYear, double(year));
+		maxRate = std::max(maxRate, rate);
+	}
+	reindexer::QueryResults qr;
+	err = reindexer->Select(Query(default_namespace).Aggregate("year", AggSum).Aggregate("year", AggMin).Aggregate("rate", AggMax), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(qr.GetAggregationResults().size(), 3);
+	ASSERT_DOUBLE_EQ(qr.GetAggregationResults()[0].value, sum);
+	ASSERT_DOUBLE_EQ(qr.GetAggregationResults()[1].value, minYear);
+	ASSERT_DOUBLE_EQ(qr.GetAggregationResults()[2].value, maxRate);
+
+	qr.Clear();
+	err = reindexer->Select(Query(default_namespace).Sort("price", true).Limit(100), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(qr.Count(), 100);
+	ASSERT_EQ(qr[0].GetItem()[idIdxName].As<int>(), 1);
+	int64_t prev = 1000000;
+	for (auto it : qr) {
+		int64_t price = it.GetItem()["price"].As<int64_t>();
+		ASSERT_LE(price, prev);
+		prev = price;
+	}
+}
+
+TEST_F(NsApi, BitmapIndexes) {
+	Error err = reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK()},
+											   IndexDeclaration{"status", "hash", "int", IndexOpts().Bitmap()},
+											   IndexDeclaration{"category", "hash", "string", IndexOpts().Bitmap()},
+											   IndexDeclaration{"year", "tree", "int", IndexOpts().Bitmap()}});
+
+	const int kItemsCount = 20000;
+	for (int i = 0; i < kItemsCount; i++) {
+		Item item = NewItem(default_namespace);
+		item[idIdxName] = i;
+		item["status"] = i % 3;
+		item["category"] = "cat" + to_string(i % 7);
+		item["year"] = 2000 + i % 11;
+		err = reindexer->Upsert(default_namespace, item);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+
+	auto isMatched = [](int i) { return i % 3 != 1 && (i % 7 == 2 || i % 7 == 5) && i % 11 >= 3 && i % 11 <= 5 && i % 3 != 2; };
+	vector<int> expected;
+	for (int i = 0; i < kItemsCount; i++)
+		if (isMatched(i)) expected.push_back(i);
+
+	Query q = Query(default_namespace)
+				  .Where("status", CondSet, {0, 2})
+				  .Where("category", CondEq, "cat2")
+				  .Or()
+				  .Where("category", CondEq, "cat5")
+				  .Where("year", CondRange, {2003, 2005})
+				  .Not()
+				  .Where("status", CondSet, {2, 5});
+	// Bitmaps are cached after several selects, so results of all selects should be the same.
+	// Results of single keys are not cached, so only conditions by several keys are combined by bitmaps
+	for (int i = 0; i < 5; i++) {
+		reindexer::QueryResults qr;
+		err = reindexer->Select(Query(q).Explain(), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		vector<int> ids;
+		for (auto it : qr) ids.push_back(it.GetItem()[idIdxName].As<int>());
+		std::sort(ids.begin(), ids.end());
+		ASSERT_EQ(ids, expected) << qr.GetExplainResults();
+		if (i == 4) {
+			ASSERT_NE(qr.GetExplainResults().find(" AND NOT "), string::npos) << qr.GetExplainResults();
+		}
+	}
+}
+
+TEST_F(NsApi, QueryPlanner) {
+	Error err = reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK()},
+											   IndexDeclaration{"value", "tree", "int", IndexOpts()},
+											   IndexDeclaration{"category", "hash", "string", IndexOpts()}});
+
+	const int kItemsCount = 10000;
+	for (int i = 0; i < kItemsCount; i++) {
+		Item item = NewItem(default_namespace);
+		item[idIdxName] = i;
+		item["value"] = i;
+		item["category"] = (i % 1000 == 0) ? "rare" : "cat" + to_string(i % 5);
+		err = reindexer->Upsert(default_namespace, item);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+
+	// Returns explain of selector of field
+	auto getSelector = [](const string &explain, const string &field) {
+		auto pos = explain.find("\"field\":\"" + field + "\"");
+		if (pos == string::npos) return string();
+		return explain.substr(pos, explain.find('}', pos) - pos);
+	};
+
+	// Explicit sort disables sort by range index, so range is selected by the planned strategy
+	// Wide range and rare category: range should be checked by comparators, instead of merging of idsets
+	Query wide =
+		Query(default_namespace).Where("value", CondRange, {100, 9000}).Where("category", CondEq, "rare").Sort(idIdxName, false);
+	// Narrow range is the most selective condition: range should be selected by index, and category checked by comparator
+	Query narrow =
+		Query(default_namespace).Where("value", CondRange, {1000, 1099}).Where("category", CondEq, "cat0").Sort(idIdxName, false);
+
+	// Indexes are committed and histograms are built after several selects, so results of all selects should be the same
+	for (int i = 0; i < 10; i++) {
+		reindexer::QueryResults wideQr;
+		err = reindexer->Select(Query(wide).Explain(), wideQr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(wideQr.Count(), 9);
+
+		reindexer::QueryResults narrowQr;
+		err = reindexer->Select(Query(narrow).Explain(), narrowQr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(narrowQr.Count(), 19);
+		for (auto it : narrowQr) {
+			int v = it.GetItem()["value"].As<int>();
+			ASSERT_TRUE(v > 1000 && v <= 1099 && v % 5 == 0) << v;
+		}
+
+		if (i == 9) {
+			string wideSel = getSelector(wideQr.GetExplainResults(), "value");
+			ASSERT_NE(wideSel.find("\"estimated\":"), string::npos) << wideQr.GetExplainResults();
+			ASSERT_EQ(wideSel.find("\"comparators\":0"), string::npos) << wideQr.GetExplainResults();
+
+			string narrowSel = getSelector(narrowQr.GetExplainResults(), "value");
+			ASSERT_NE(narrowSel.find("\"estimated\":"), string::npos) << narrowQr.GetExplainResults();
+			ASSERT_NE(narrowSel.find("\"comparators\":0"), string::npos) << narrowQr.GetExplainResults();
+			ASSERT_EQ(getSelector(narrowQr.GetExplainResults(), "category").find("\"comparators\":0"), string::npos)
+				<< narrowQr.GetExplainResults();
+		}
+	}
+}
+
+TEST_F(NsApi, SortWithLimit) {
+	Error err = reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK()},
+											   IndexDeclaration{"price", "hash", "int", IndexOpts()}});
+
+	const int kItemsCount = 5000;
+	auto price = [](int i) { return (i * 7919) % 1000; };
+	auto extra = [](int i) { return (i * 104729) % 3000; };
+	for (int i = 0; i < kItemsCount; i++) {
+		Item item = NewItem(default_namespace);
+		err = item.FromJSON("{\"" + idIdxName + "\":" + to_string(i) + ",\"price\":" + to_string(price(i)) +
+							",\"extra\":" + to_string(extra(i)) + "}");
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = reindexer->Upsert(default_namespace, item);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+
+	const unsigned kOffset = 30, kLimit = 20;
+	auto checkQuery = [&](const Query &q, vector<int> ids, std::function<bool(int, int)> less) {
+		std::stable_sort(ids.begin(), ids.end(), less);
+		reindexer::QueryResults qr;
+		Error err = reindexer->Select(q, qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(qr.Count(), kLimit);
+		for (size_t i = 0; i < qr.Count(); i++) {
+			int id = qr[i].GetItem()[idIdxName].As<int>();
+			// Items with equal sort values may be returned in any order
+			ASSERT_FALSE(less(id, ids[kOffset + i]) || less(ids[kOffset + i], id)) << i << ": " << id << " != " << ids[kOffset + i];
+		}
+	};
+
+	vector<int> all;
+	for (int i = 0; i < kItemsCount; i++) all.push_back(i);
+	vector<int> filtered;
+	for (int i = 0; i < kItemsCount; i++)
+		if (i % 3) filtered.push_back(i);
+
+	// Sort by unordered index
+	checkQuery(Query(default_namespace).Sort("price", false).Offset(kOffset).Limit(kLimit), all,
+			   [&](int l, int r) { return price(l) < price(r); });
+	checkQuery(Query(default_namespace).Where(idIdxName, CondSet, filtered).Sort("price", true).Offset(kOffset).Limit(kLimit), filtered,
+			   [&](int l, int r) { return price(l) > price(r); });
+	// Sort by several columns
+	checkQuery(Query(default_namespace).Sort("price", true).Sort(idIdxName, false).Offset(kOffset).Limit(kLimit), all,
+			   [&](int l, int r) { return price(l) > price(r) || (price(l) == price(r) && l < r); });
+	// Sort by non indexed field
+	checkQuery(Query(default_namespace).Sort("extra", false).Offset(kOffset).Limit(kLimit), all,
+			   [&](int l, int r) { return extra(l) < extra(r); });
+
+	// Forced sort order: items with forced values are first, the rest are sorted by values
+	vector<int> forcedPrices = {500, 3, 999};
+	Query forcedQuery = Query(default_namespace).Sort("price", false).Offset(kOffset).Limit(kLimit);
+	for (int p : forcedPrices) forcedQuery.forcedSortOrder.push_back(Variant(p));
+	auto forcedRank = [&](int i) {
+		auto it = std::find(forcedPrices.begin(), forcedPrices.end(), price(i));
+		return it - forcedPrices.begin();
+	};
+	checkQuery(forcedQuery, all, [&](int l, int r) {
+		auto lr = forcedRank(l), rr = forcedRank(r);
+		return lr < rr || (lr == rr && price(l) < price(r));
+	});
+}
+
+TEST_F(NsApi, ParallelSelect) {
+	Error err = reindexer->InitSystemNamespaces();
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	Item cfg = NewItem("#config");
+	err = cfg.FromJSON(R"json({"type":"optimization","optimization":{"parallel_select_threads":4,"parallel_select_threshold":1000}})json");
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = reindexer->Upsert("#config", cfg);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	err = reindexer->OpenNamespace(default_namespace);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK()},
+											   IndexDeclaration{"value", "hash", "int", IndexOpts()},
+											   IndexDeclaration{"group", "hash", "string", IndexOpts()}});
+
+	const int kItemsCount = 20000;
+	auto value = [](int i) { return (i * 7919) % 1000; };
+	auto group = [](int i) { return "group" + to_string(i % 7); };
+	for (int i = 0; i < kItemsCount; i++) {
+		Item item = NewItem(default_namespace);
+		item[idIdxName] = i;
+		item["value"] = value(i);
+		item["group"] = group(i);
+		err = reindexer->Upsert(default_namespace, item);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+	// Deleted items are skipped by loop
+	for (int i = 0; i < kItemsCount; i += 10) {
+		Item item = NewItem(default_namespace);
+		item[idIdxName] = i;
+		err = reindexer->Delete(default_namespace, item);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+
+	vector<int> matched;
+	double sum = 0;
+	std::map<string, int> facets;
+	for (int i = 0; i < kItemsCount; i++) {
+		if (i % 10 == 0 || value(i) >= 300) continue;
+		matched.push_back(i);
+		sum += value(i);
+		facets[group(i)]++;
+	}
+
+	auto select = [&](const Query &q, reindexer::QueryResults &qr) {
+		Error err = reindexer->Select(Query(q).Explain(), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_NE(qr.GetExplainResults().find("\"loop_threads\":4"), string::npos) << qr.GetExplainResults();
+	};
+	auto getIds = [&](reindexer::QueryResults &qr) {
+		vector<int> ids;
+		for (auto it : qr) ids.push_back(it.GetItem()[idIdxName].As<int>());
+		return ids;
+	};
+
+	// All the matched items are returned in order of rowIds, same as by serial select
+	{
+		reindexer::QueryResults qr;
+		select(Query(default_namespace).Where("value", CondLt, 300), qr);
+		ASSERT_EQ(getIds(qr), matched);
+	}
+	// Total count and limited results
+	{
+		reindexer::QueryResults qr;
+		select(Query(default_namespace).Where("value", CondLt, 300).ReqTotal().Offset(15).Limit(10), qr);
+		ASSERT_EQ(qr.totalCount, int(matched.size()));
+		ASSERT_EQ(getIds(qr), vector<int>(matched.begin() + 15, matched.begin() + 25));
+	}
+	// Driving iterator is idset
+	{
+		reindexer::QueryResults qr;
+		select(Query(default_namespace).Where("group", CondEq, "group3").Where("value", CondLt, 300).ReqTotal(), qr);
+		vector<int> expected;
+		for (int i : matched)
+			if (group(i) == "group3") expected.push_back(i);
+		ASSERT_EQ(qr.totalCount, int(expected.size()));
+		ASSERT_EQ(getIds(qr), expected);
+	}
+	// Aggregations of workers are merged
+	{
+		reindexer::QueryResults qr;
+		select(Query(default_namespace).Where("value", CondLt, 300).Aggregate("value", AggSum).Aggregate("group", AggFacet), qr);
+		ASSERT_EQ(qr.GetAggregationResults().size(), 2);
+		ASSERT_DOUBLE_EQ(qr.GetAggregationResults()[0].value, sum);
+		std::map<string, int> resFacets;
+		for (auto &f : qr.GetAggregationResults()[1].facets) resFacets[f.value] = f.count;
+		ASSERT_EQ(resFacets, facets);
+	}
+	// Sorted results of workers are merged
+	{
+		reindexer::QueryResults qr;
+		select(Query(default_namespace).Where("value", CondLt, 300).Sort("value", true).Limit(20), qr);
+		vector<int> expected = matched;
+		std::stable_sort(expected.begin(), expected.end(), [&](int l, int r) { return value(l) > value(r); });
+		ASSERT_EQ(qr.Count(), 20);
+		for (size_t i = 0; i < qr.Count(); i++) ASSERT_EQ(qr[i].GetItem()["value"].As<int>(), value(expected[i])) << i;
+	}
+}
+
+TEST_F(NsApi, QueryResultsCache) {
+	Error err = reindexer->InitSystemNamespaces();
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = reindexer->OpenNamespace(default_namespace, StorageOpts().Enabled(false), CacheMode::CacheModeAggressive);
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK()},
+											   IndexDeclaration{"value", "tree", "int", IndexOpts()},
+											   IndexDeclaration{"group", "hash", "string", IndexOpts()}});
+
+	const int kItemsCount = 1000;
+	vector<int> values(kItemsCount);
+	auto upsertItem = [&](int id, int value, const string &group) {
+		Item item = NewItem(default_namespace);
+		item[idIdxName] = id;
+		item["value"] = value;
+		item["group"] = group;
+		Error err = reindexer->Upsert(default_namespace, item);
+		ASSERT_TRUE(err.ok()) << err.what();
+		values[id] = value;
+	};
+	for (int i = 0; i < kItemsCount; i++) upsertItem(i, (i * 7919) % 100, "group");
+
+	auto getCachedCount = [&]() {
+		reindexer::QueryResults qr;
+		Error err = reindexer->Select(Query("#memstats").Where("name", CondEq, default_namespace), qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		EXPECT_EQ(qr.Count(), 1);
+		string json = qr.begin().GetItem().GetJSON().ToString();
+		auto pos = json.find("\"results_cache\":{");
+		EXPECT_NE(pos, string::npos) << json;
+		pos = json.find("\"items_count\":", pos);
+		return std::stoi(json.substr(pos + strlen("\"items_count\":")));
+	};
+	// Query results must be the same, either they are taken from cache or not
+	auto checkQuery = [&](const string &group) {
+		vector<int> expected;
+		double sum = 0;
+		for (int i = kItemsCount - 1; i >= 0; i--) {
+			if (values[i] >= 10) continue;
+			expected.push_back(i);
+			sum += values[i];
+		}
+
+		reindexer::QueryResults qr;
+		Error err =
+			reindexer->Select(Query(default_namespace).Where("value", CondLt, 10).Sort(idIdxName, true).Limit(5).Offset(2).ReqTotal(), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(qr.TotalCount(), expected.size());
+		ASSERT_EQ(qr.Count(), 5);
+		for (size_t i = 0; i < qr.Count(); i++) {
+			Item item = qr[i].GetItem();
+			ASSERT_EQ(item[idIdxName].As<int>(), expected[i + 2]) << i;
+			ASSERT_EQ(item["group"].As<string>(), group) << i;
+		}
+
+		reindexer::QueryResults aggQr;
+		err = reindexer->Select(Query(default_namespace).Where("value", CondLt, 10).Aggregate("value", AggSum), aggQr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(aggQr.GetAggregationResults().size(), 1);
+		ASSERT_DOUBLE_EQ(aggQr.GetAggregationResults()[0].value, sum);
+	};
+
+	// Results are cached after hitCount of the same query, and then are taken from cache
+	for (int i = 0; i < 5; i++) checkQuery("group");
+	ASSERT_EQ(getCachedCount(), 2);
+
+	// Update of field, which is not used by query, keeps cached results
+	for (int i = 0; i < kItemsCount; i++) {
+		if (values[i] < 10) upsertItem(i, values[i], "other");
+	}
+	ASSERT_EQ(getCachedCount(), 2);
+	checkQuery("other");
+
+	// Update of field, which is used by query, invalidates cached results
+	upsertItem(kItemsCount - 1, 5, "other");
+	ASSERT_EQ(getCachedCount(), 0);
+	for (int i = 0; i < 5; i++) checkQuery("other");
+
+	// Delete invalidates cached results
+	{
+		Item item = NewItem(default_namespace);
+		item[idIdxName] = kItemsCount - 1;
+		err = reindexer->Delete(default_namespace, item);
+		ASSERT_TRUE(err.ok()) << err.what();
+		values[kItemsCount - 1] = 100;
+	}
+	ASSERT_EQ(getCachedCount(), 0);
+	checkQuery("other");
+}
+
+TEST_F(NsApi, OnDemandSortedIds) {
+	Error err = reindexer->InitSystemNamespaces();
+	ASSERT_TRUE(err.ok()) << err.what();
+	auto setSortedIdsMode = [&](const string &mode) {
+		Item cfg = NewItem("#config");
+		Error err = cfg.FromJSON(R"json({"type":"namespaces","namespaces":[{"namespace":"*","sorted_ids_mode":")json" + mode + R"json("}]})json");
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = reindexer->Upsert("#config", cfg);
+		ASSERT_TRUE(err.ok()) << err.what();
+	};
+	setSortedIdsMode("on_demand");
+
+	err = reindexer->OpenNamespace(default_namespace, StorageOpts().Enabled(false));
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK()},
+											   IndexDeclaration{"year", "tree", "int", IndexOpts()},
+											   IndexDeclaration{"age", "tree", "int", IndexOpts()},
+											   IndexDeclaration{"name", "hash", "string", IndexOpts()}});
+
+	// Years are unique, so order of results is completely defined by sort
+	const int kItemsCount = 1000;
+	vector<int> years(kItemsCount), ages(kItemsCount);
+	for (int i = 0; i < kItemsCount; i++) {
+		Item item = NewItem(default_namespace);
+		years[i] = (i * 7919) % kItemsCount;
+		ages[i] = i % 50;
+		item[idIdxName] = i;
+		item["year"] = years[i];
+		item["age"] = ages[i];
+		item["name"] = "name" + std::to_string(i % 10);
+		err = reindexer->Upsert(default_namespace, item);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+
+	auto checkQuery = [&](const Query &q, const std::function<bool(int)> &filter, bool desc) {
+		vector<int> expected;
+		for (int i = 0; i < kItemsCount; i++) {
+			if (filter(i)) expected.push_back(i);
+		}
+		std::sort(expected.begin(), expected.end(), [&](int lhs, int rhs) { return desc ? years[lhs] > years[rhs] : years[lhs] < years[rhs]; });
+
+		reindexer::WrSerializer sql;
+		q.GetSQL(sql);
+		reindexer::QueryResults qr;
+		Error err = reindexer->Select(q, qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(qr.Count(), expected.size()) << sql.Slice();
+		for (size_t i = 0; i < qr.Count(); i++) {
+			ASSERT_EQ(qr[i].GetItem()[idIdxName].As<int>(), expected[i]) << sql.Slice() << " " << i;
+		}
+	};
+	auto checkQueries = [&]() {
+		// Queries are repeated, so sort orders are built by namespace
+		for (int i = 0; i < 10; i++) {
+			checkQuery(Query(default_namespace).Where("name", CondEq, "name3").Sort("year", false), [](int id) { return id % 10 == 3; },
+					   false);
+			checkQuery(Query(default_namespace).Where("year", CondRange, {100, 300}).Sort("year", true),
+					   [&](int id) { return years[id] >= 100 && years[id] <= 300; }, true);
+			checkQuery(Query(default_namespace).Where("age", CondGt, 40).Sort("year", false), [&](int id) { return ages[id] > 40; }, false);
+			checkQuery(Query(default_namespace).Where("age", CondLt, 5).Where("name", CondSet, {"name1", "name2"}).Sort("year", true),
+					   [&](int id) { return ages[id] < 5 && (id % 10 == 1 || id % 10 == 2); }, true);
+		}
+	};
+	auto getSortOrdersSize = [&]() {
+		reindexer::QueryResults qr;
+		Error err = reindexer->Select(Query("#memstats").Where("name", CondEq, default_namespace), qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		EXPECT_EQ(qr.Count(), 1);
+		string json = qr.begin().GetItem().GetJSON().ToString();
+		int64_t size = 0;
+		for (auto pos = json.find("\"sort_orders_size\":"); pos != string::npos; pos = json.find("\"sort_orders_size\":", pos + 1)) {
+			size += std::stoll(json.substr(pos + strlen("\"sort_orders_size\":")));
+		}
+		return size;
+	};
+
+	checkQueries();
+	int64_t onDemandSize = getSortOrdersSize();
+	ASSERT_GT(onDemandSize, 0);
+
+	// Results are the same in copy mode, but sorted copies of idsets take more memory
+	setSortedIdsMode("copy");
+	checkQueries();
+	ASSERT_GT(getSortOrdersSize(), onDemandSize);
+
+	setSortedIdsMode("on_demand");
+	checkQueries();
+}
+
+TEST_F(NsApi, PayloadsCompaction) {
+	Error err = reindexer->InitSystemNamespaces();
+	ASSERT_TRUE(err.ok()) << err.what();
+	Item cfg = NewItem("#config");
+	err = cfg.FromJSON(R"json({"type":"optimization","optimization":{"timeout_ms":10}})json");
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = reindexer->Upsert("#config", cfg);
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	err = reindexer->OpenNamespace(default_namespace, StorageOpts().Enabled(false));
+	ASSERT_TRUE(err.ok()) << err.what();
+	// Keys of composite indexes share payloads with items
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK()},
+											   IndexDeclaration{"value", "tree", "int", IndexOpts()},
+											   IndexDeclaration{(idIdxName + "+value").c_str(), "hash", "composite", IndexOpts()},
+											   IndexDeclaration{("value+" + idIdxName).c_str(), "tree", "composite", IndexOpts()}});
+
+	const int kItemsCount = 20000;
+	for (int i = 0; i < kItemsCount; i++) {
+		Item item = NewItem(default_namespace);
+		item[idIdxName] = i;
+		item["value"] = i * 3;
+		err = reindexer->Upsert(default_namespace, item);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+
+	auto getPayloadsStat = [&](int64_t &slabsCount, int64_t &freeSize) {
+		reindexer::QueryResults qr;
+		Error err = reindexer->Select(Query("#memstats").Where("name", CondEq, default_namespace), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(qr.Count(), 1);
+		string json = qr.begin().GetItem().GetJSON().ToString();
+		auto pos = json.find("\"payloads\":{");
+		ASSERT_NE(pos, string::npos) << json;
+		auto getValue = [&](const string &name) {
+			auto valuePos = json.find("\"" + name + "\":", pos);
+			return std::stoll(json.substr(valuePos + name.size() + 3));
+		};
+		slabsCount = getValue("slabs_count");
+		freeSize = getValue("free_size");
+	};
+	int64_t slabsCount, freeSize;
+	getPayloadsStat(slabsCount, freeSize);
+	ASSERT_GT(slabsCount, 1);
+
+	// Deleted items leave free blocks in all slabs
+	for (int i = 0; i < kItemsCount; i++) {
+		if (i % 4 == 0) continue;
+		Item item = NewItem(default_namespace);
+		item[idIdxName] = i;
+		err = reindexer->Delete(default_namespace, item);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+	int64_t sparseSlabsCount, sparseFreeSize;
+	getPayloadsStat(sparseSlabsCount, sparseFreeSize);
+	ASSERT_EQ(sparseSlabsCount, slabsCount);
+	ASSERT_GT(sparseFreeSize, freeSize);
+
+	// Payloads are moved to compact slabs by background optimizer
+	int64_t compactedSlabsCount = sparseSlabsCount, compactedFreeSize = sparseFreeSize;
+	for (int i = 0; i < 50 && compactedSlabsCount == sparseSlabsCount; i++) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		getPayloadsStat(compactedSlabsCount, compactedFreeSize);
+	}
+	ASSERT_LT(compactedSlabsCount, sparseSlabsCount);
+	ASSERT_LT(compactedFreeSize, sparseFreeSize);
+
+	reindexer::QueryResults qr;
+	err = reindexer->Select(Query(default_namespace).Sort(idIdxName, false), qr);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(qr.Count(), kItemsCount / 4);
+	for (size_t i = 0; i < qr.Count(); i++) {
+		Item item = qr[i].GetItem();
+		ASSERT_EQ(item[idIdxName].As<int>(), int(i * 4));
+		ASSERT_EQ(item["value"].As<int>(), int(i * 12));
+	}
+
+	// Keys of composite indexes are replaced by relocated payloads
+	for (int i = 0; i < kItemsCount; i += 4 * 97) {
+		for (auto &index : {idIdxName + "+value", "value+" + idIdxName}) {
+			VariantArray key = index[0] == 'v' ? VariantArray{Variant(i * 3), Variant(i)} : VariantArray{Variant(i), Variant(i * 3)};
+			reindexer::QueryResults qr;
+			err = reindexer->Select(Query(default_namespace).WhereComposite(index.c_str(), CondEq, {key}), qr);
+			ASSERT_TRUE(err.ok()) << err.what();
+			ASSERT_EQ(qr.Count(), 1) << index << " " << i;
+			ASSERT_EQ(qr[0].GetItem()[idIdxName].As<int>(), i);
+		}
+	}
+}
+
+TEST_F(NsApi, StoreStringsDictionary) {
+	Error err = reindexer->OpenNamespace(default_namespace, StorageOpts().Enabled(false));
+	ASSERT_TRUE(err.ok()) << err.what();
+	DefineNamespaceDataset(default_namespace, {IndexDeclaration{idIdxName.c_str(), "hash", "int", IndexOpts().PK()},
+											   IndexDeclaration{"country", "-", "string", IndexOpts()},
+											   IndexDeclaration{"brand", "-", "string", IndexOpts().SetCollateMode(CollateASCII)},
+											   IndexDeclaration{"tags", "-", "string", IndexOpts().Array()}});
+
+	const vector<string> countries = {"RU", "US", "DE", "FR", "GB"};
+	const vector<string> brands = {"Acme", "ACME", "Globex", "Initech"};
+	const int kItemsCount = 500;
+	vector<string> itemCountries(kItemsCount), itemBrands(kItemsCount);
+	vector<vector<string>> itemTags(kItemsCount);
+	auto upsertItem = [&](int id, const string &country, const string &brand, const vector<string> &tags) {
+		string json = "{\"" + idIdxName + "\":" + std::to_string(id) + ",\"country\":\"" + country + "\",\"brand\":\"" + brand +
+					  "\",\"tags\":[";
+		for (size_t i = 0; i < tags.size(); i++) json += (i ? ",\"" : "\"") + tags[i] + "\"";
+		json += "]}";
+		Item item = NewItem(default_namespace);
+		Error err = item.FromJSON(json);
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = reindexer->Upsert(default_namespace, item);
+		ASSERT_TRUE(err.ok()) << err.what();
+		itemCountries[id] = country;
+		itemBrands[id] = brand;
+		itemTags[id] = tags;
+	};
+	for (int i = 0; i < kItemsCount; i++) {
+		upsertItem(i, countries[i % countries.size()], brands[i % brands.size()],
+				   {"tag" + std::to_string(i % 7), "tag" + std::to_string(i % 3)});
+	}
+
+	auto checkQuery = [&](const Query &q, const std::function<bool(int)> &filter) {
+		reindexer::QueryResults qr;
+		Error err = reindexer->Select(q, qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+		std::set<int> ids;
+		for (auto &it : qr) ids.insert(it.GetItem()[idIdxName].As<int>());
+		std::set<int> expected;
+		for (int i = 0; i < kItemsCount; i++) {
+			if (filter(i)) expected.insert(i);
+		}
+		reindexer::WrSerializer sql;
+		q.GetSQL(sql);
+		ASSERT_EQ(ids, expected) << sql.Slice();
+	};
+	auto hasTag = [&](int id, const string &tag) { return std::find(itemTags[id].begin(), itemTags[id].end(), tag) != itemTags[id].end(); };
+	auto checkQueries = [&]() {
+		checkQuery(Query(default_namespace).Where("country", CondEq, "US"), [&](int id) { return itemCountries[id] == "US"; });
+		checkQuery(Query(default_namespace).Where("country", CondSet, {"DE", "FR", "ZZ"}),
+				   [&](int id) { return itemCountries[id] == "DE" || itemCountries[id] == "FR"; });
+		checkQuery(Query(default_namespace).Where("country", CondEq, "ZZ"), [](int) { return false; });
+		checkQuery(Query(default_namespace).Not().Where("country", CondEq, "RU"), [&](int id) { return itemCountries[id] != "RU"; });
+		checkQuery(Query(default_namespace).Where("country", CondEq, "GB").Or().Where(idIdxName, CondLt, 10),
+				   [&](int id) { return itemCountries[id] == "GB" || id < 10; });
+		checkQuery(Query(default_namespace).Where("brand", CondEq, "acme"),
+				   [&](int id) { return itemBrands[id] == "Acme" || itemBrands[id] == "ACME"; });
+		checkQuery(Query(default_namespace).Where("tags", CondSet, {"tag5", "tag6"}),
+				   [&](int id) { return hasTag(id, "tag5") || hasTag(id, "tag6"); });
+		checkQuery(Query(default_namespace).Where("tags", CondEq, "tag2").Where("country", CondEq, "DE"),
+				   [&](int id) { return hasTag(id, "tag2") && itemCountries[id] == "DE"; });
+	};
+	checkQueries();
+
+	// Updated values are interned by dictionary too
+	for (int i = 0; i < kItemsCount; i += 3) upsertItem(i, "XX", "Umbrella", {"tag5"});
+	checkQueries();
+	checkQuery(Query(default_namespace).Where("country", CondEq, "XX").Where("brand", CondEq, "UMBRELLA"),
+			   [](int id) { return id % 3 == 0; });
+}
+
+#ifndef _WIN32
+// Namespace, which storage can be held busy, like by write of large batch
+class BusyStorageNamespace : public reindexer::Namespace {
+public:
+	BusyStorageNamespace(const string &name) : Namespace(name, CacheModeOn) {}
+	std::mutex &StorageMutex() { return storage_mtx_; }
+	// Count of items in storage, which are seen by cursor, since its last seek
+	static size_t StoredItemsCount(reindexer::datastorage::Cursor &cursor) {
+		size_t count = 0;
+		for (; cursor.Valid() && cursor.Key().length() && cursor.Key()[0] == 'I'; cursor.Next()) count++;
+		return count;
+	}
+	reindexer::datastorage::Cursor *StorageCursor() {
+		StorageOpts opts;
+		unique_ptr<reindexer::datastorage::Cursor> cursor(storage_->GetCursor(opts));
+		cursor->Seek("I");
+		return cursor.release();
+	}
+};
+
+TEST(NamespaceStorage, ReadWhileStorageIsWritten) {
+	const string dbPath = reindexer::fs::JoinPath(reindexer::fs::GetTempDir(), "reindex_busy_storage_test");
+	reindexer::fs::RmDirAll(dbPath);
+	auto upsert = [](reindexer::Namespace &ns, int id) {
+		Item item = ns.NewItem();
+		ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+		Error err = item.FromJSON("{\"id\":" + std::to_string(id) + ",\"data\":\"value_" + std::to_string(id) + "\"}");
+		ASSERT_TRUE(err.ok()) << err.what();
+		ns.Upsert(item);
+	};
+	auto selectCount = [](reindexer::Namespace &ns) {
+		Query q("busy_ns");
+		reindexer::SelectCtx ctx(q, nullptr);
+		reindexer::QueryResults qr;
+		ns.Select(qr, ctx);
+		return qr.Count();
+	};
+
+	{
+		BusyStorageNamespace ns("busy_ns");
+		ns.EnableStorage(dbPath, StorageOpts().Enabled().CreateIfMissing(), reindexer::datastorage::StorageType::Native);
+		ns.AddIndex({"id", "hash", "int", IndexOpts().PK()});
+		for (int id = 0; id < 100; ++id) upsert(ns, id);
+		ns.FlushStorage();
+		// Cursor of native storage sees records, which were written before its seek
+		unique_ptr<reindexer::datastorage::Cursor> cursor(ns.StorageCursor());
+
+		// Flush waits for storage, and writes and reads of namespace are not blocked by it
+		std::unique_lock<std::mutex> storageLock(ns.StorageMutex());
+		std::atomic<bool> flushed{false};
+		std::thread flusher([&]() {
+			ns.FlushStorage();
+			flushed = true;
+		});
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		for (int id = 100; id < 200; ++id) upsert(ns, id);
+		ASSERT_EQ(selectCount(ns), 200u);
+		ASSERT_FALSE(flushed);
+		storageLock.unlock();
+		flusher.join();
+		ASSERT_EQ(BusyStorageNamespace::StoredItemsCount(*cursor), 100u);
+		cursor.reset(ns.StorageCursor());
+		ASSERT_EQ(BusyStorageNamespace::StoredItemsCount(*cursor), 200u);
+		cursor.reset();
+		ns.CloseStorage();
+	}
+
+	// All items are written to storage in order
+	reindexer::Namespace ns("busy_ns", CacheModeOn);
+	ns.EnableStorage(dbPath, StorageOpts().Enabled(), reindexer::datastorage::StorageType::Native);
+	ns.LoadFromStorage();
+	ASSERT_EQ(selectCount(ns), 200u);
+	reindexer::fs::RmDirAll(dbPath);
+}
+#endif
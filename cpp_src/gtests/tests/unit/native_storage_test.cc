@@ -0,0 +1,284 @@
+#ifndef _WIN32
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "core/storage/nativestorage.h"
+#include "tools/fsops.h"
+
+using std::map;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+using reindexer::Error;
+using reindexer::datastorage::Cursor;
+using reindexer::datastorage::NativeStorage;
+using reindexer::datastorage::UpdatesCollection;
+namespace fs = reindexer::fs;
+
+static const string kNativeStoragePath = fs::JoinPath(fs::GetTempDir(), "reindex/native_storage_test");
+static const size_t kNativeTestSegmentSize = 16 << 10;
+
+static StorageOpts nativeOpts() { return StorageOpts().Enabled().CreateIfMissing().WriteBufferSize(kNativeTestSegmentSize); }
+
+static void checkNativeStorage(NativeStorage& storage, const map<string, string>& expected) {
+	StorageOpts opts;
+	unique_ptr<Cursor> cursor(storage.GetCursor(opts));
+	auto it = expected.begin();
+	for (cursor->SeekToFirst(); cursor->Valid(); cursor->Next(), ++it) {
+		ASSERT_TRUE(it != expected.end()) << "Unexpected key " << cursor->Key().ToString();
+		ASSERT_EQ(cursor->Key().ToString(), it->first);
+		ASSERT_EQ(cursor->Value().ToString(), it->second);
+	}
+	ASSERT_TRUE(it == expected.end());
+
+	for (auto& kv : expected) {
+		string value;
+		Error err = storage.Read(opts, kv.first, value);
+		ASSERT_TRUE(err.ok()) << err.what();
+		ASSERT_EQ(value, kv.second);
+	}
+}
+
+static size_t nativeSegmentsCount(const string& path) {
+	vector<fs::DirEntry> entries;
+	fs::ReadDir(path, entries);
+	size_t count = 0;
+	for (auto& entry : entries) count += !entry.isDir;
+	return count;
+}
+
+TEST(NativeStorage, WriteAndReopen) {
+	fs::RmDirAll(kNativeStoragePath);
+	map<string, string> expected;
+	{
+		NativeStorage storage;
+		Error err = storage.Open(kNativeStoragePath, nativeOpts());
+		ASSERT_TRUE(err.ok()) << err.what();
+
+		StorageOpts opts;
+		unique_ptr<UpdatesCollection> batch(storage.GetUpdatesCollection());
+		for (int i = 0; i < 1000; i++) {
+			string key = "key_" + std::to_string(i), value = string(i % 100, 'a') + std::to_string(i);
+			batch->Put(key, value);
+			expected[key] = value;
+		}
+		err = storage.Write(opts, *batch);
+		ASSERT_TRUE(err.ok()) << err.what();
+
+		// Overwrites and deletes of keys
+		for (int i = 0; i < 1000; i += 3) {
+			string key = "key_" + std::to_string(i);
+			err = storage.Write(opts, key, "updated_" + key);
+			ASSERT_TRUE(err.ok()) << err.what();
+			expected[key] = "updated_" + key;
+		}
+		for (int i = 1; i < 1000; i += 5) {
+			string key = "key_" + std::to_string(i);
+			err = storage.Delete(opts, key);
+			ASSERT_TRUE(err.ok()) << err.what();
+			expected.erase(key);
+		}
+		string value;
+		err = storage.Read(opts, "key_1", value);
+		ASSERT_EQ(err.code(), errNotFound);
+
+		checkNativeStorage(storage, expected);
+		ASSERT_GT(nativeSegmentsCount(kNativeStoragePath), 1);
+		err = storage.Flush();
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+
+	NativeStorage storage;
+	Error err = storage.Open(kNativeStoragePath, nativeOpts());
+	ASSERT_TRUE(err.ok()) << err.what();
+	checkNativeStorage(storage, expected);
+}
+
+TEST(NativeStorage, Compaction) {
+	fs::RmDirAll(kNativeStoragePath);
+	map<string, string> expected;
+	NativeStorage storage;
+	Error err = storage.Open(kNativeStoragePath, nativeOpts());
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	// Keys are overwritten many times, so only the last segment keeps live records
+	StorageOpts opts;
+	for (int round = 0; round < 20; round++) {
+		for (int i = 0; i < 100; i++) {
+			string key = "key_" + std::to_string(i), value = string(100, 'a' + round) + std::to_string(i);
+			err = storage.Write(opts, key, value);
+			ASSERT_TRUE(err.ok()) << err.what();
+			expected[key] = value;
+		}
+	}
+	err = storage.Delete(opts, "key_0");
+	ASSERT_TRUE(err.ok()) << err.what();
+	expected.erase("key_0");
+
+	size_t segmentsCount = nativeSegmentsCount(kNativeStoragePath);
+	ASSERT_GT(storage.Compact(), 0);
+	ASSERT_LT(nativeSegmentsCount(kNativeStoragePath), segmentsCount);
+	checkNativeStorage(storage, expected);
+
+	NativeStorage reopened;
+	err = reopened.Open(kNativeStoragePath, nativeOpts());
+	ASSERT_TRUE(err.ok()) << err.what();
+	checkNativeStorage(reopened, expected);
+}
+
+TEST(NativeStorage, ReadPrefix) {
+	fs::RmDirAll(kNativeStoragePath);
+	NativeStorage storage;
+	Error err = storage.Open(kNativeStoragePath, nativeOpts());
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	map<string, string> expected;
+	StorageOpts opts;
+	for (int round = 0; round < 5; round++) {
+		for (int i = 0; i < 200; i++) {
+			string key = (i % 2 ? "I" : "W") + std::to_string(i), value = string(50, 'a' + round) + std::to_string(i);
+			err = storage.Write(opts, key, value);
+			ASSERT_TRUE(err.ok()) << err.what();
+			if (key[0] == 'I') expected[key] = value;
+		}
+	}
+	for (int i = 1; i < 200; i += 10) {
+		string key = "I" + std::to_string(i);
+		err = storage.Delete(opts, key);
+		ASSERT_TRUE(err.ok()) << err.what();
+		expected.erase(key);
+	}
+	ASSERT_GT(nativeSegmentsCount(kNativeStoragePath), 1);
+
+	// Only the last records of keys with prefix are read, in order of writes
+	vector<string> keys;
+	map<string, string> read;
+	err = storage.ReadPrefix(opts, "I", [&](const reindexer::string_view& key, const reindexer::string_view& value) {
+		keys.push_back(key.ToString());
+		read[key.ToString()] = value.ToString();
+		return true;
+	});
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(keys.size(), expected.size());
+	ASSERT_EQ(read, expected);
+	ASSERT_EQ(keys.front(), "I3");
+	ASSERT_EQ(keys.back(), "I199");
+
+	// Reading is stopped by visitor
+	size_t count = 0;
+	err = storage.ReadPrefix(opts, "I", [&](const reindexer::string_view&, const reindexer::string_view&) { return ++count < 10; });
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(count, 10);
+	fs::RmDirAll(kNativeStoragePath);
+}
+
+TEST(NativeStorage, Cursor) {
+	fs::RmDirAll(kNativeStoragePath);
+	NativeStorage storage;
+	Error err = storage.Open(kNativeStoragePath, nativeOpts());
+	ASSERT_TRUE(err.ok()) << err.what();
+	StorageOpts opts;
+	for (int i = 0; i < 10; i++) {
+		err = storage.Write(opts, "key_" + std::to_string(9 - i), "value_" + std::to_string(9 - i));
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+
+	unique_ptr<Cursor> cursor(storage.GetCursor(opts));
+	cursor->Seek("key_5");
+	ASSERT_TRUE(cursor->Valid());
+	ASSERT_EQ(cursor->Key().ToString(), "key_5");
+	cursor->Prev();
+	ASSERT_EQ(cursor->Key().ToString(), "key_4");
+	cursor->Prev();
+	ASSERT_EQ(cursor->Key().ToString(), "key_3");
+	cursor->Next();
+	ASSERT_EQ(cursor->Key().ToString(), "key_4");
+	ASSERT_EQ(cursor->Value().ToString(), "value_4");
+
+	// Cursor keeps records, which were taken by seek: writes after seek are seen only after the next seek
+	err = storage.Write(opts, "key_5", "updated");
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = storage.Write(opts, "key_55", "inserted");
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = storage.Delete(opts, "key_6");
+	ASSERT_TRUE(err.ok()) << err.what();
+	cursor->Next();
+	ASSERT_EQ(cursor->Key().ToString(), "key_5");
+	ASSERT_EQ(cursor->Value().ToString(), "value_5");
+	cursor->Next();
+	ASSERT_EQ(cursor->Key().ToString(), "key_6");
+	ASSERT_EQ(cursor->Value().ToString(), "value_6");
+
+	cursor->Seek("key_5");
+	ASSERT_EQ(cursor->Value().ToString(), "updated");
+	cursor->Next();
+	ASSERT_EQ(cursor->Key().ToString(), "key_55");
+	cursor->Next();
+	ASSERT_EQ(cursor->Key().ToString(), "key_7");
+
+	cursor->SeekToLast();
+	ASSERT_EQ(cursor->Key().ToString(), "key_9");
+	cursor->Next();
+	ASSERT_FALSE(cursor->Valid());
+	cursor->SeekToFirst();
+	ASSERT_EQ(cursor->Key().ToString(), "key_0");
+	cursor->Prev();
+	ASSERT_FALSE(cursor->Valid());
+	fs::RmDirAll(kNativeStoragePath);
+}
+
+TEST(NativeStorage, TornRecord) {
+	fs::RmDirAll(kNativeStoragePath);
+	map<string, string> expected;
+	string segmentPath;
+	{
+		NativeStorage storage;
+		Error err = storage.Open(kNativeStoragePath, nativeOpts());
+		ASSERT_TRUE(err.ok()) << err.what();
+		StorageOpts opts;
+		for (int i = 0; i < 10; i++) {
+			string key = "key_" + std::to_string(i);
+			err = storage.Write(opts, key, "value_" + key);
+			ASSERT_TRUE(err.ok()) << err.what();
+			if (i < 9) expected[key] = "value_" + key;
+		}
+		ASSERT_EQ(nativeSegmentsCount(kNativeStoragePath), 1);
+	}
+
+	// Tail of the last record is lost
+	vector<fs::DirEntry> entries;
+	fs::ReadDir(kNativeStoragePath, entries);
+	ASSERT_EQ(entries.size(), 1);
+	string data;
+	segmentPath = fs::JoinPath(kNativeStoragePath, entries[0].name);
+	ASSERT_GT(fs::ReadFile(segmentPath, data), 0);
+	size_t end = data.find("value_key_9");
+	ASSERT_NE(end, string::npos);
+	ASSERT_EQ(truncate(segmentPath.c_str(), end + 3), 0);
+
+	{
+		NativeStorage storage;
+		Error err = storage.Open(kNativeStoragePath, nativeOpts());
+		ASSERT_TRUE(err.ok()) << err.what();
+		checkNativeStorage(storage, expected);
+
+		// New records are appended to the next segment
+		StorageOpts opts;
+		err = storage.Write(opts, "key_9", "value_new");
+		ASSERT_TRUE(err.ok()) << err.what();
+		expected["key_9"] = "value_new";
+		checkNativeStorage(storage, expected);
+	}
+
+	NativeStorage storage;
+	Error err = storage.Open(kNativeStoragePath, nativeOpts());
+	ASSERT_TRUE(err.ok()) << err.what();
+	checkNativeStorage(storage, expected);
+	fs::RmDirAll(kNativeStoragePath);
+}
+
+#endif  // _WIN32
@@ -0,0 +1,181 @@
+#include <chrono>
+#include <map>
+
+#include "replicator/replicator.h"
+#include "rpcserver_api.h"
+
+using std::map;
+using std::shared_ptr;
+using std::string;
+using reindexer::Error;
+using reindexer::Item;
+using reindexer::Query;
+using reindexer::QueryResults;
+using reindexer::Reindexer;
+using reindexer::Replicator;
+using reindexer::NamespaceDef;
+using reindexer_server::AuthContext;
+using reindexer_server::DBManager;
+namespace fs = reindexer::fs;
+
+static const string kReplicatorTestPath = fs::JoinPath(fs::GetTempDir(), "reindex/replicator_test");
+static const string kReplicatorTestAddr = "127.0.0.1:26534";
+static const string kReplicatorTestDB = "repl_db";
+
+// Leader database is served by RPC server, follower database replicates it
+class ReplicatorApi : public RPCServerApi {
+protected:
+	ReplicatorApi() : RPCServerApi(kReplicatorTestPath, kReplicatorTestAddr, kReplicatorTestDB) {}
+
+	void SetUp() override {
+		RPCServerApi::SetUp();
+		if (HasFatalFailure()) return;
+		leader_ = db_;
+
+		fs::MkDirAll(fs::JoinPath(kReplicatorTestPath, "follower"));
+		followerMgr_.reset(new DBManager(fs::JoinPath(kReplicatorTestPath, "follower"), true));
+		Error err = followerMgr_->Init();
+		ASSERT_TRUE(err.ok()) << err.what();
+		err = followerMgr_->OpenReplica(kReplicatorTestDB, follower_);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+
+	void addNamespace(const string &nsName) {
+		Error err = leader_->AddNamespace(NamespaceDef(nsName, StorageOpts().Enabled().CreateIfMissing())
+											  .AddIndex("id", "hash", "int", IndexOpts().PK())
+											  .AddIndex("value", "tree", "string"));
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+
+	void upsertItems(const string &nsName, int from, int to, const string &prefix) {
+		for (int i = from; i < to; i++) {
+			Item item = leader_->NewItem(nsName);
+			ASSERT_TRUE(item.Status().ok()) << item.Status().what();
+			Error err = item.FromJSON("{\"id\":" + std::to_string(i) + ",\"value\":\"" + prefix + std::to_string(i) + "\"}");
+			ASSERT_TRUE(err.ok()) << err.what();
+			err = leader_->Upsert(nsName, item);
+			ASSERT_TRUE(err.ok()) << err.what();
+		}
+	}
+
+	static map<int, string> readItems(Reindexer &db, const string &nsName) {
+		map<int, string> items;
+		QueryResults qr;
+		if (!db.Select(Query(nsName), qr).ok()) return items;
+		for (auto it : qr) {
+			Item item = it.GetItem();
+			items[item["id"].As<int>()] = item["value"].As<string>();
+		}
+		return items;
+	}
+
+	static bool hasNamespace(Reindexer &db, const string &nsName) {
+		vector<NamespaceDef> defs;
+		db.EnumNamespaces(defs, false);
+		for (auto &def : defs) {
+			if (def.name == nsName) return true;
+		}
+		return false;
+	}
+
+	// Waits, while follower catches up with leader namespace
+	bool waitSynced(const string &nsName) {
+		for (int i = 0; i < 1000; i++) {
+			if (readItems(*follower_, nsName) == readItems(*leader_, nsName) && !readItems(*leader_, nsName).empty()) {
+				QueryResults qr;
+				Error err = follower_->Select(Query(reindexer::kReplicationStatsNamespace).Where("namespace", CondEq, nsName), qr);
+				if (err.ok() && qr.Count() == 1 && qr.begin().GetItem()["lag"].As<int64_t>() == 0) return true;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		}
+		return false;
+	}
+
+	bool waitDropped(const string &nsName) {
+		for (int i = 0; i < 1000; i++) {
+			if (!hasNamespace(*follower_, nsName)) return true;
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		}
+		return false;
+	}
+
+	Item replicationStats(const string &nsName) {
+		QueryResults qr;
+		Error err = follower_->Select(Query(reindexer::kReplicationStatsNamespace).Where("namespace", CondEq, nsName), qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		EXPECT_EQ(qr.Count(), 1);
+		return qr.begin().GetItem();
+	}
+
+	std::unique_ptr<DBManager> followerMgr_;
+	shared_ptr<Reindexer> leader_, follower_;
+};
+
+TEST_F(ReplicatorApi, FollowLeader) {
+	addNamespace("items");
+	addNamespace("dropped");
+	addNamespace("closed");
+	upsertItems("items", 0, 100, "v");
+	upsertItems("dropped", 0, 10, "d");
+	upsertItems("closed", 0, 10, "c");
+
+	// Bootstrap: namespaces are copied from leader
+	std::unique_ptr<Replicator> replicator(new Replicator(follower_, dsn()));
+	Error err = replicator->Start();
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_TRUE(waitSynced("items"));
+	ASSERT_TRUE(waitSynced("dropped"));
+	ASSERT_TRUE(waitSynced("closed"));
+
+	Item stats = replicationStats("items");
+	int64_t lastLSN = stats["last_lsn"].As<int64_t>();
+	ASSERT_GE(lastLSN, 0);
+	ASSERT_EQ(stats["leader_lsn"].As<int64_t>(), lastLSN);
+	ASSERT_EQ(stats["syncs_count"].As<int64_t>(), 1);
+	ASSERT_TRUE(stats["copied"].As<bool>());
+	string json = stats.GetJSON().ToString();
+	ASSERT_NE(json.find("\"state\":\"synced\""), string::npos) << json;
+
+	// Changes are applied by WAL after restart of follower, without copying of namespace
+	replicator->Stop();
+	replicator.reset();
+	upsertItems("items", 50, 150, "u");
+	for (int i = 0; i < 20; i++) {
+		QueryResults qr;
+		err = leader_->Delete(Query("items").Where("id", CondEq, i), qr);
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+	ASSERT_NE(readItems(*follower_, "items"), readItems(*leader_, "items"));
+
+	replicator.reset(new Replicator(follower_, dsn()));
+	err = replicator->Start();
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_TRUE(waitSynced("items"));
+	stats = replicationStats("items");
+	ASSERT_GT(stats["last_lsn"].As<int64_t>(), lastLSN);
+	ASSERT_EQ(stats["leader_lsn"].As<int64_t>(), stats["last_lsn"].As<int64_t>());
+	ASSERT_EQ(stats["syncs_count"].As<int64_t>(), 1);
+
+	// Namespace, which is dropped on leader, is dropped on follower. Closed namespace is kept
+	err = leader_->CloseNamespace("closed");
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = leader_->DropNamespace("dropped");
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_TRUE(waitDropped("dropped"));
+	upsertItems("items", 150, 160, "n");
+	ASSERT_TRUE(waitSynced("items"));
+	ASSERT_TRUE(hasNamespace(*follower_, "closed"));
+	ASSERT_EQ(readItems(*follower_, "closed").size(), 10);
+
+	// Users can only read replica
+	AuthContext auth;
+	err = followerMgr_->OpenDatabase(kReplicatorTestDB, auth, false);
+	ASSERT_TRUE(err.ok()) << err.what();
+	shared_ptr<Reindexer> db;
+	err = auth.GetDB(reindexer_server::kRoleDataRead, &db);
+	ASSERT_TRUE(err.ok()) << err.what();
+	err = auth.GetDB(reindexer_server::kRoleDataWrite, &db);
+	ASSERT_EQ(err.code(), errForbidden);
+
+	replicator->Stop();
+}
@@ -0,0 +1,117 @@
+#include "client/reindexer.h"
+#include "net/cproto/clientconnection.h"
+#include "rpcserver_api.h"
+
+using std::string;
+using std::vector;
+using reindexer::Error;
+using reindexer::Query;
+using reindexer::QueryResults;
+using reindexer::NamespaceDef;
+using reindexer::WrSerializer;
+namespace fs = reindexer::fs;
+namespace ev = reindexer::net::ev;
+namespace cproto = reindexer::net::cproto;
+
+static const string kRPCServerTestPath = fs::JoinPath(fs::GetTempDir(), "reindex/rpcserver_test");
+static const string kRPCServerTestAddr = "127.0.0.1:26535";
+static const string kRPCServerTestDB = "rpc_db";
+
+class RPCServerTest : public RPCServerApi {
+protected:
+	RPCServerTest() : RPCServerApi(kRPCServerTestPath, kRPCServerTestAddr, kRPCServerTestDB) {}
+
+	void SetUp() override {
+		RPCServerApi::SetUp();
+		if (HasFatalFailure()) return;
+		Error err = db_->AddNamespace(NamespaceDef("items", StorageOpts().Enabled().CreateIfMissing())
+										  .AddIndex("id", "hash", "int", IndexOpts().PK())
+										  .AddIndex("year", "tree", "int"));
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+
+	// Sends batch of JSON items by raw connection, which bypasses checks of client
+	Error modifyItems(const string &nsName, const vector<string> &items, int mode) {
+		WrSerializer ser;
+		ser.PutVarUint(items.size());
+		for (auto &json : items) {
+			ser.PutVString(json);
+			ser.PutVarUint(0);
+			ser.PutVString("");
+		}
+		string pack = ser.Slice().ToString();
+
+		httpparser::UrlParser uri;
+		EXPECT_TRUE(uri.parse(dsn()));
+		ev::dynamic_loop loop;
+		ev::async stop;
+		bool terminate = false;
+		stop.set(loop);
+		stop.set([&terminate](ev::async &a) {
+			terminate = true;
+			a.loop.break_loop();
+		});
+		stop.start();
+		std::unique_ptr<cproto::ClientConnection> conn(new cproto::ClientConnection(loop, &uri));
+		std::thread loopThread([&]() {
+			while (!terminate) loop.run();
+			conn.reset();
+		});
+		conn->Connect();
+		Error err = conn->Call(cproto::kCmdModifyItems, nsName, int(FormatJson), pack, mode).Status();
+		stop.send();
+		loopThread.join();
+		return err;
+	}
+
+	size_t count(const string &nsName) {
+		QueryResults qr;
+		Error err = db_->Select(Query(nsName), qr);
+		EXPECT_TRUE(err.ok()) << err.what();
+		return qr.Count();
+	}
+};
+
+TEST_F(RPCServerTest, ModifyItemsIsAtomic) {
+	reindexer::client::Reindexer client;
+	Error err = client.Connect(dsn());
+	ASSERT_TRUE(err.ok()) << err.what();
+
+	// Batch with invalid item is rejected as whole
+	vector<reindexer::client::Item> items;
+	for (int i = 0; i < 10; i++) {
+		items.emplace_back(client.NewItem("items"));
+		ASSERT_TRUE(items.back().Status().ok()) << items.back().Status().what();
+		err = items.back().FromJSON("{\"id\":" + std::to_string(i) + ",\"year\":" + std::to_string(2000 + i) + "}");
+		ASSERT_TRUE(err.ok()) << err.what();
+	}
+	items[5].SetPrecepts({"year=unknown()"});
+	err = client.Upsert("items", items);
+	ASSERT_FALSE(err.ok());
+	ASSERT_NE(err.what().find("Item 5"), string::npos) << err.what();
+	ASSERT_EQ(count("items"), 0);
+
+	items[5].SetPrecepts({});
+	err = client.Upsert("items", items);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(count("items"), 10);
+}
+
+TEST_F(RPCServerTest, ModifyItemsValidatesMode) {
+	vector<string> items = {"{\"id\":1,\"year\":2001}", "{\"id\":2,\"year\":2002}"};
+	Error err = modifyItems("items", items, 10);
+	ASSERT_EQ(err.code(), errParams) << err.what();
+	ASSERT_EQ(count("items"), 0);
+
+	// Item, which can't be parsed, is reported by its position in batch
+	items.push_back("{\"id\":3,\"year\":");
+	err = modifyItems("items", items, ModeUpsert);
+	ASSERT_FALSE(err.ok());
+	ASSERT_NE(err.what().find("Item 2"), string::npos) << err.what();
+	ASSERT_EQ(count("items"), 0);
+
+	items.pop_back();
+	err = modifyItems("items", items, ModeInsert);
+	ASSERT_TRUE(err.ok()) << err.what();
+	ASSERT_EQ(count("items"), 2);
+}
@@ -1,4 +1,6 @@
 #include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
 #include <vector>
 
 #include "core/query/query.h"
@@ -14,6 +16,7 @@ using reindexer::QueryCache;
 using reindexer::QueryCacheKey;
 using reindexer::QueryCacheVal;
 using reindexer::EqQueryCacheKey;
+using reindexer::HashQueryCacheKey;
 
 TEST(LruCache, SimpleTest) {
 	const int nsCount = 10;
@@ -50,3 +53,79 @@ TEST(LruCache, SimpleTest) {
 		}
 	}
 }
+
+TEST(LruCache, ConcurrentEviction) {
+	const int queriesCount = 2000;
+	const int threadsCount = 8;
+	const int iterCount = 20000;
+	// Cache is much smaller, than size of all the entries, so entries are evicted all the time
+	const size_t cacheSizeLimit = 128 * 1024;
+
+	reindexer::LRUCache<QueryCacheKey, QueryCacheVal, HashQueryCacheKey, EqQueryCacheKey> cache(cacheSizeLimit, 1);
+
+	vector<Query> qs;
+	for (int i = 0; i < queriesCount; i++) qs.emplace_back(Query("namespace" + std::to_string(i)));
+
+	// Hits of frequently and rarely requested queries
+	std::atomic<int> hotHits{0}, coldHits{0};
+	vector<std::thread> threads;
+	for (int t = 0; t < threadsCount; t++) {
+		threads.emplace_back([&, t]() {
+			for (int i = 0; i < iterCount; i++) {
+				// First queries are requested much more often, than the others
+				bool hot = i % 4;
+				int idx = hot ? (i * 7 + t) % 32 : (i * 7919 + t) % queriesCount;
+				auto cached = cache.Get({qs[idx]});
+				// Cache raises hit count limit, when entries are evicted too fast
+				if (!cached.key) continue;
+				if (cached.val.total_count >= 0) {
+					ASSERT_EQ(cached.val.total_count, idx);
+					(hot ? hotHits : coldHits)++;
+				} else {
+					cache.Put({qs[idx]}, QueryCacheVal{size_t(idx)});
+				}
+			}
+		});
+	}
+	for (auto& thr : threads) thr.join();
+
+	auto stat = cache.GetMemStat();
+	ASSERT_LE(stat.totalSize, cacheSizeLimit);
+	ASSERT_GT(stat.itemsCount, 0);
+	ASSERT_LT(stat.itemsCount, queriesCount);
+
+	// Frequently requested entries survive eviction, so they are returned much more often, than the others.
+	// Entries are returned only after hit count limit, which depends on timings of threads, so only ratio of hits is checked
+	const int hotRequests = threadsCount * iterCount * 3 / 4, coldRequests = threadsCount * iterCount / 4;
+	ASSERT_GT(double(hotHits) / hotRequests, 4 * double(coldHits) / coldRequests) << hotHits << " " << coldHits;
+
+	cache.Invalidate();
+	ASSERT_TRUE(cache.Empty());
+	ASSERT_EQ(cache.GetMemStat().totalSize, 0);
+}
+
+TEST(LruCache, LargeEntry) {
+	const size_t cacheSizeLimit = 64 * 1024;
+	reindexer::LRUCache<QueryCacheKey, QueryCacheVal, HashQueryCacheKey, EqQueryCacheKey> cache(cacheSizeLimit, 1);
+
+	for (int i = 0; i < 100; i++) {
+		Query q("namespace" + std::to_string(i));
+		cache.Get({q});
+		cache.Put({q}, QueryCacheVal{size_t(i)});
+	}
+
+	// Entry is much larger, than part of the limit per shard, but it is fit to the whole cache
+	reindexer::VariantArray keys;
+	for (int i = 0; i < 2000; i++) keys.push_back(reindexer::Variant(i));
+	Query large = Query("namespace").Where("id", CondSet, keys);
+	QueryCacheKey largeKey(large);
+	ASSERT_GT(largeKey.Size(), cacheSizeLimit / reindexer::kCacheShardsCount);
+	ASSERT_LT(largeKey.Size(), cacheSizeLimit / 2);
+
+	cache.Get(largeKey);
+	cache.Put(largeKey, QueryCacheVal{size_t(1000)});
+	auto cached = cache.Get(largeKey);
+	ASSERT_TRUE(cached.key != nullptr);
+	ASSERT_EQ(cached.val.total_count, 1000);
+	ASSERT_LE(cache.GetMemStat().totalSize, cacheSizeLimit);
+}
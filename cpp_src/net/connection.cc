@@ -82,10 +82,15 @@ void Connection<Mutex>::callback(ev::io & /*watcher*/, int revents) {
 		write_cb();
 	}
 
-	int nevents = ev::READ | (wrBuf_.size() ? ev::WRITE : 0);
+	// Socket is not read, while read buffer is full
+	int nevents = (rdBuf_.available() ? ev::READ : 0) | (wrBuf_.size() ? ev::WRITE : 0);
 
 	if (curEvents_ != nevents && sock_.valid()) {
-		(curEvents_) ? io_.set(nevents) : io_.start(sock_.fd(), nevents);
+		if (!nevents) {
+			io_.stop();
+		} else {
+			(curEvents_) ? io_.set(nevents) : io_.start(sock_.fd(), nevents);
+		}
 		curEvents_ = nevents;
 	}
 }
@@ -122,7 +127,7 @@ void Connection<Mutex>::write_cb() {
 // Receive message from client socket
 template <typename Mutex>
 void Connection<Mutex>::read_cb() {
-	while (!closeConn_) {
+	while (!closeConn_ && rdBuf_.available()) {
 		auto it = rdBuf_.head();
 		ssize_t nread = sock_.recv(it.data(), it.size());
 		int err = sock_.last_error();
@@ -145,7 +150,8 @@ void Connection<Mutex>::timeout_cb(ev::periodic & /*watcher*/, int /*time*/) {
 }
 template <typename Mutex>
 void Connection<Mutex>::async_cb(ev::async &) {
-	callback(io_, ev::WRITE);
+	onAsync();
+	if (sock_.valid()) callback(io_, ev::WRITE);
 }
 
 template class Connection<std::mutex>;
@@ -26,6 +26,8 @@ public:
 protected:
 	virtual void onRead() = 0;
 	virtual void onClose() = 0;
+	// Called by loop, when async watcher is signaled
+	virtual void onAsync() {}
 
 	// Generic callback
 	void callback(ev::io &watcher, int revents);
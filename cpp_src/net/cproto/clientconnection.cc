@@ -2,18 +2,21 @@
 
 #include "clientconnection.h"
 #include <errno.h>
+#include <algorithm>
 #include "tools/serializer.h"
 
 namespace reindexer {
 namespace net {
 namespace cproto {
 
-ClientConnection::ClientConnection(ev::dynamic_loop &loop, const httpparser::UrlParser *uri)
+ClientConnection::ClientConnection(ev::dynamic_loop &loop, const httpparser::UrlParser *uri, int requestsWindow)
 	: ConnectionMT(-1, loop), state_(ConnInit), uri_(uri) {
 	connect_async_.set<ClientConnection, &ClientConnection::connect_async_cb>(this);
 	connect_async_.set(loop);
 	connect_async_.start();
 	waiters_.resize(1024);
+	// Requests, which are sent by completions over window, and write buffer must fit to ring of waiters
+	requestsWindow_ = std::max(1, std::min(requestsWindow, int(waiters_.size()) / 2));
 }
 
 void ClientConnection::Connect() {
@@ -43,6 +46,7 @@ void ClientConnection::connectInternal() {
 	mtx_.lock();
 	state_ = ConnConnecting;
 	lastError_ = errOK;
+	loopThreadID_ = std::this_thread::get_id();
 	mtx_.unlock();
 
 	auto completion = [this](const RPCAnswer &ans) {
@@ -78,6 +82,8 @@ void ClientConnection::onClose() {
 	state_ = ConnFailed;
 	auto waiters = std::move(waiters_);
 	waiters_.resize(1024);
+	pending_ = 0;
+	windowCond_.notify_all();
 	mtx_.unlock();
 
 	for (auto w : waiters)
@@ -142,6 +148,7 @@ void ClientConnection::onRead() {
 			}
 			cmpl = waiter->cmpl;
 			waiter->cmpl = nullptr;
+			if (pending_-- == requestsWindow_) windowCond_.notify_all();
 		} else {
 			fprintf(stderr, "Unexpected RPC answer seq=%d cmd=%d", int(hdr.cmd), int(hdr.seq));
 		}
@@ -187,6 +194,10 @@ void ClientConnection::callRPC(CmdCode cmd, uint32_t seq, const Args &args) {
 
 void ClientConnection::call(Completion cmpl, CmdCode cmd, const Args &args) {
 	std::unique_lock<std::mutex> lck(mtx_);
+	// Loop thread can't wait, because it reads answers
+	if (std::this_thread::get_id() != loopThreadID_) {
+		windowCond_.wait(lck, [this]() { return pending_ < requestsWindow_ || state_ == ConnFailed; });
+	}
 	if (state_ == ConnFailed) {
 		lck.unlock();
 		cmpl(RPCAnswer(lastError_));
@@ -206,6 +217,7 @@ void ClientConnection::call(Completion cmpl, CmdCode cmd, const Args &args) {
 
 	callRPC(cmd, seq, args);
 	waiters_[seq % waiters_.size()] = RPCWaiter(cmd, seq, cmpl);
+	pending_++;
 	if (state_ == ConnConnected) async_.send();
 }
 
@@ -2,6 +2,7 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <thread>
 #include <vector>
 #include "args.h"
 #include "cproto.h"
@@ -32,7 +33,13 @@ protected:
 
 class ClientConnection : public ConnectionMT {
 public:
-	ClientConnection(ev::dynamic_loop &loop, const httpparser::UrlParser *uri);
+	/// @param loop - loop of connection
+	/// @param uri - uri of server
+	/// @param requestsWindow - max count of requests, which are sent and are not answered yet.
+	/// Callers of new requests wait for answers of previous ones. Requests, which are sent by completions, are not limited
+	ClientConnection(ev::dynamic_loop &loop, const httpparser::UrlParser *uri, int requestsWindow = kDefaultRequestsWindow);
+
+	static const int kDefaultRequestsWindow = 256;
 
 	typedef std::function<void(const RPCAnswer &ans)> Completion;
 
@@ -58,7 +65,7 @@ public:
 			},
 			cmd, args, argss...);
 		std::unique_lock<std::mutex> lck(mtx_);
-		if (!ret.IsSet()) cond.wait(lck);
+		cond.wait(lck, [&ret]() { return ret.IsSet(); });
 		return ret;
 	}
 
@@ -103,6 +110,11 @@ protected:
 
 	State state_;
 	vector<RPCWaiter> waiters_;
+	// Count of requests, which are waiting for answers
+	int pending_ = 0;
+	int requestsWindow_;
+	std::condition_variable windowCond_;
+	std::thread::id loopThreadID_;
 	std::condition_variable connectCond_;
 	uint32_t seq_;
 	std::mutex mtx_;
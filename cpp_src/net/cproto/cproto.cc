@@ -21,6 +21,7 @@ std::unordered_map<int, const char *> kRPCCodes = {
 	{kCmdCommit, "Commit"},
 	{kCmdModifyItem, "ModifyItem"},
 	{kCmdDeleteQuery, "DeleteQuery"},
+	{kCmdModifyItems, "ModifyItems"},
 	{kCmdSelect, "Select"},
 	{kCmdSelectSQL, "SelectSQL"},
 	{kCmdFetchResults, "FetchResults"},
@@ -30,6 +31,8 @@ std::unordered_map<int, const char *> kRPCCodes = {
 	{kCmdEnumMeta, "EnumMeta"},
 	{kCmdSubscribeUpdates, "SubscribeUpdates"},
 	{kCmdUpdates, "Updates"},
+	{kCmdGetWAL, "GetWAL"},
+	{kCmdGetSnapshot, "GetSnapshot"},
 };
 
 const char *CmdName(CmdCode cmd) {
@@ -22,6 +22,7 @@ enum CmdCode {
 	kCmdCommit = 32,
 	kCmdModifyItem = 33,
 	kCmdDeleteQuery = 34,
+	kCmdModifyItems = 35,
 
 	kCmdSelect = 48,
 	kCmdSelectSQL = 49,
@@ -34,6 +35,8 @@ enum CmdCode {
 
 	kCmdSubscribeUpdates = 90,
 	kCmdUpdates = 91,
+	kCmdGetWAL = 92,
+	kCmdGetSnapshot = 93,
 
 	kCmdCodeMax = 128
 };
@@ -2,6 +2,7 @@
 
 #include <climits>
 #include <functional>
+#include <initializer_list>
 #include <memory>
 #include <string>
 #include <vector>
@@ -9,6 +10,7 @@
 #include "core/keyvalue/p_string.h"
 #include "cproto.h"
 #include "estl/string_view.h"
+#include "executor.h"
 #include "net/stat.h"
 #include "tools/errors.h"
 
@@ -56,7 +58,7 @@ class Dispatcher {
 	friend class ServerConnection;
 
 public:
-	Dispatcher() : handlers_(kCmdCodeMax, {nullptr, nullptr}) {}
+	Dispatcher() : handlers_(kCmdCodeMax, {nullptr, nullptr}), asyncCmds_(kCmdCodeMax, false) {}
 
 	/// Add handler for command.
 	/// @param cmd - Command code
@@ -98,8 +100,18 @@ public:
 		onClose_ = [=](Context &ctx, const Error &err) { (static_cast<K *>(object)->*func)(ctx, err); };
 	}
 
+	/// Set pool of workers for heavy commands. Commands are executed by workers out of loops of connections,
+	/// and responses are written by loops asynchronously
+	/// @param executor - pool of workers, or nullptr to execute all the commands in loops
+	/// @param cmds - commands to execute by workers
+	void SetExecutor(Executor *executor, std::initializer_list<CmdCode> cmds) {
+		executor_ = executor;
+		for (auto cmd : cmds) asyncCmds_[cmd] = true;
+	}
+
 protected:
 	Error handle(Context &ctx);
+	bool isAsync(CmdCode cmd) const { return executor_ && cmd < kCmdCodeMax && asyncCmds_[cmd]; }
 
 	template <class K>
 	static Error func_wrapper(void *obj, Error (K::*func)(Context &ctx), Context &ctx) {
@@ -145,6 +157,8 @@ protected:
 
 	std::vector<Handler> handlers_;
 	std::vector<Handler> middlewares_;
+	Executor *executor_ = nullptr;
+	std::vector<bool> asyncCmds_;
 
 	std::function<void(Context &ctx, const Error &err, const Args &args)> logger_;
 	std::function<void(Context &ctx, const Error &err)> onClose_;
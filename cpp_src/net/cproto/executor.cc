@@ -0,0 +1,66 @@
+#include "executor.h"
+
+namespace reindexer {
+namespace net {
+namespace cproto {
+
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+
+Executor::Executor(int threads) : counters_(kCmdCodeMax) {
+	threads_.reserve(threads);
+	for (int i = 0; i < threads; i++) threads_.emplace_back([this]() { workerThread(); });
+}
+
+Executor::~Executor() {
+	{
+		std::lock_guard<std::mutex> lck(mtx_);
+		terminate_ = true;
+		cond_.notify_all();
+	}
+	for (auto &thr : threads_) thr.join();
+}
+
+void Executor::Post(CmdCode cmd, std::function<void()> task) {
+	counters_[cmd].queued++;
+	std::lock_guard<std::mutex> lck(mtx_);
+	tasks_.push_back({cmd, clock::now(), std::move(task)});
+	cond_.notify_one();
+}
+
+void Executor::workerThread() {
+	for (;;) {
+		Task task;
+		{
+			std::unique_lock<std::mutex> lck(mtx_);
+			cond_.wait(lck, [this]() { return terminate_ || !tasks_.empty(); });
+			// Connections wait for their calls, so queue is drained before exit
+			if (tasks_.empty()) return;
+			task = std::move(tasks_.front());
+			tasks_.pop_front();
+		}
+		auto &counters = counters_[task.cmd];
+		counters.queued--;
+		auto startedAt = clock::now();
+		task.func();
+		auto finishedAt = clock::now();
+		counters.queueTimeUs += duration_cast<microseconds>(startedAt - task.queuedAt).count();
+		counters.execTimeUs += duration_cast<microseconds>(finishedAt - startedAt).count();
+		counters.calls++;
+	}
+}
+
+std::vector<Executor::CmdStat> Executor::GetStat() const {
+	std::vector<CmdStat> ret;
+	for (int cmd = 0; cmd < kCmdCodeMax; cmd++) {
+		auto &counters = counters_[cmd];
+		size_t calls = counters.calls, queued = counters.queued;
+		if (!calls && !queued) continue;
+		ret.push_back({CmdCode(cmd), queued, calls, calls ? counters.queueTimeUs / calls : 0, calls ? counters.execTimeUs / calls : 0});
+	}
+	return ret;
+}
+
+}  // namespace cproto
+}  // namespace net
+}  // namespace reindexer
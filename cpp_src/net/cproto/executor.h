@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "cproto.h"
+
+namespace reindexer {
+namespace net {
+namespace cproto {
+
+/// Pool of workers, which execute heavy RPC commands out of event loops of connections.
+class Executor {
+public:
+	/// Statistics of command
+	struct CmdStat {
+		CmdCode cmd;
+		/// Amount of queued and not started calls
+		size_t queueDepth;
+		/// Amount of finished calls
+		size_t calls;
+		/// Average time of waiting in queue in microseconds
+		size_t avgQueueTimeUs;
+		/// Average time of execution in microseconds
+		size_t avgExecTimeUs;
+	};
+
+	/// @param threads - count of workers
+	Executor(int threads);
+	~Executor();
+	Executor(const Executor &) = delete;
+	Executor &operator=(const Executor &) = delete;
+
+	/// Adds task to queue. Task must not throw
+	/// @param cmd - command, which is executed by task
+	/// @param task - task
+	void Post(CmdCode cmd, std::function<void()> task);
+	/// @return statistics of commands, which were executed by workers
+	std::vector<CmdStat> GetStat() const;
+	int Threads() const { return int(threads_.size()); }
+
+protected:
+	typedef std::chrono::steady_clock clock;
+	struct Task {
+		CmdCode cmd;
+		clock::time_point queuedAt;
+		std::function<void()> func;
+	};
+	struct Counters {
+		std::atomic<size_t> queued{0};
+		std::atomic<size_t> calls{0};
+		std::atomic<size_t> queueTimeUs{0};
+		std::atomic<size_t> execTimeUs{0};
+	};
+
+	void workerThread();
+
+	std::vector<std::thread> threads_;
+	std::deque<Task> tasks_;
+	std::vector<Counters> counters_;
+	std::mutex mtx_;
+	std::condition_variable cond_;
+	bool terminate_ = false;
+};
+
+}  // namespace cproto
+}  // namespace net
+}  // namespace reindexer
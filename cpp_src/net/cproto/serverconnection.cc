@@ -13,12 +13,20 @@ const auto kCProtoTimeoutSec = 300.;
 ServerConnection::ServerConnection(int fd, ev::dynamic_loop &loop, Dispatcher &dispatcher)
 	: net::ConnectionST(fd, loop), dispatcher_(dispatcher) {
 	timeout_.start(kCProtoTimeoutSec);
+	if (dispatcher_.executor_) async_.start();
 	callback(io_, ev::READ);
 }
 
+ServerConnection::~ServerConnection() {
+	// Worker may still use connection
+	std::unique_lock<std::mutex> lck(asyncMtx_);
+	asyncCond_.wait(lck, [this]() { return !asyncCall_ || asyncDone_; });
+}
+
 bool ServerConnection::Restart(int fd) {
 	restart(fd);
 	respSent_ = false;
+	if (dispatcher_.executor_) async_.start();
 	callback(io_, ev::READ);
 	timeout_.start(kCProtoTimeoutSec);
 	return true;
@@ -26,16 +34,34 @@ bool ServerConnection::Restart(int fd) {
 
 void ServerConnection::Attach(ev::dynamic_loop &loop) {
 	if (!attached_) {
+		std::lock_guard<std::mutex> lck(asyncMtx_);
 		attach(loop);
+		if (dispatcher_.executor_) {
+			async_.start();
+			// Call could be finished, while connection was detached
+			if (asyncDone_) async_.send();
+		}
 		timeout_.start(kCProtoTimeoutSec);
 	}
 }
 
 void ServerConnection::Detach() {
-	if (attached_) detach();
+	if (attached_) {
+		std::lock_guard<std::mutex> lck(asyncMtx_);
+		detach();
+	}
 }
 
 void ServerConnection::onClose() {
+	if (asyncCall_) {
+		// Connection is closed, when worker finishes call. Watcher was stopped by closeConn(), but it is still needed to catch finish
+		async_.start();
+		return;
+	}
+	closeRPC();
+}
+
+void ServerConnection::closeRPC() {
 	if (dispatcher_.onClose_) {
 		Stat stat;
 		Context ctx;
@@ -56,10 +82,58 @@ void ServerConnection::handleRPC(Context &ctx) {
 	}
 }
 
+void ServerConnection::postRPC(Context &ctx, size_t len) {
+	asyncCall_ = true;
+	asyncCallLen_ = len;
+	asyncCtx_ = ctx;
+	dispatcher_.executor_->Post(ctx.call->cmd, [this]() { handleAsyncRPC(); });
+}
+
+void ServerConnection::handleAsyncRPC() {
+	bool drop = false;
+	try {
+		handleRPC(asyncCtx_);
+	} catch (const Error &err) {
+		fprintf(stderr, "drop connect, reason: %s\n", err.what().c_str());
+		responceRPC(asyncCtx_, err, Args());
+		drop = true;
+	}
+
+	std::lock_guard<std::mutex> lck(asyncMtx_);
+	asyncDone_ = true;
+	asyncDrop_ = drop;
+	async_.send();
+	asyncCond_.notify_all();
+}
+
+void ServerConnection::onAsync() {
+	{
+		std::lock_guard<std::mutex> lck(asyncMtx_);
+		if (!asyncDone_) return;
+		asyncDone_ = false;
+		if (sock_.valid()) wrBuf_.write(std::move(asyncResp_));
+		asyncResp_ = chunk();
+		if (asyncDrop_) closeConn_ = true;
+	}
+
+	asyncCall_ = false;
+	respSent_ = false;
+	rdBuf_.erase(asyncCallLen_);
+
+	if (!sock_.valid()) {
+		async_.stop();
+		closeRPC();
+		return;
+	}
+	timeout_.start(kCProtoTimeoutSec);
+	// Read calls, which were received during execution of this one
+	onRead();
+}
+
 void ServerConnection::onRead() {
 	CProtoHeader hdr;
 
-	while (!closeConn_) {
+	while (!closeConn_ && !asyncCall_) {
 		Context ctx;
 		ctx.call = nullptr;
 		ctx.writer = this;
@@ -105,6 +179,10 @@ void ServerConnection::onRead() {
 			ctx.call->seq = hdr.seq;
 			Serializer ser(it.data(), hdr.len);
 			ctx.call->args.Unpack(ser);
+			if (dispatcher_.isAsync(ctx.call->cmd)) {
+				postRPC(ctx, hdr.len);
+				return;
+			}
 			handleRPC(ctx);
 		} catch (const Error &err) {
 			// Execption occurs on unrecoverble error. Send responce, and drop connection
@@ -125,7 +203,8 @@ void ServerConnection::responceRPC(Context &ctx, const Error &status, const Args
 		return;
 	}
 
-	WrSerializer ser(wrBuf_.get_chunk());
+	// Response of worker is passed to loop, and is not written to buffer directly
+	WrSerializer ser(asyncCall_ ? chunk() : wrBuf_.get_chunk());
 
 	CProtoHeader hdr;
 	hdr.len = 0;
@@ -144,7 +223,11 @@ void ServerConnection::responceRPC(Context &ctx, const Error &status, const Args
 	ser.PutVString(status.what());
 	args.Pack(ser);
 	reinterpret_cast<CProtoHeader *>(ser.Buf())->len = ser.Len() - sizeof(hdr);
-	wrBuf_.write(ser.DetachChunk());
+	if (asyncCall_) {
+		asyncResp_ = ser.DetachChunk();
+	} else {
+		wrBuf_.write(ser.DetachChunk());
+	}
 
 	respSent_ = true;
 	// if (canWrite_) {
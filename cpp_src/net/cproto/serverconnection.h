@@ -1,6 +1,8 @@
 #pragma once
 
 #include <string.h>
+#include <condition_variable>
+#include <mutex>
 #include "dispatcher.h"
 #include "net/connection.h"
 #include "net/iserverconnection.h"
@@ -14,13 +16,14 @@ using reindexer::h_vector;
 class ServerConnection : public ConnectionST, public IServerConnection, public Writer {
 public:
 	ServerConnection(int fd, ev::dynamic_loop &loop, Dispatcher &dispatcher);
+	~ServerConnection();
 
 	// IServerConnection interface implementation
 	static ConnectionFactory NewFactory(Dispatcher &dispatcher) {
 		return [&dispatcher](ev::dynamic_loop &loop, int fd) { return new ServerConnection(fd, loop, dispatcher); };
 	};
 
-	bool IsFinished() override final { return !sock_.valid(); }
+	bool IsFinished() override final { return !sock_.valid() && !asyncCall_; }
 	bool Restart(int fd) override final;
 	void Detach() override final;
 	void Attach(ev::dynamic_loop &loop) override final;
@@ -33,11 +36,29 @@ public:
 protected:
 	void onRead() override;
 	void onClose() override;
+	void onAsync() override;
 	void handleRPC(Context &ctx);
 	void responceRPC(Context &ctx, const Error &error, const Args &args);
+	// Passes call to executor. Next calls are not read, until response is written
+	void postRPC(Context &ctx, size_t len);
+	// Executed by worker of executor
+	void handleAsyncRPC();
+	void closeRPC();
 
 	bool respSent_ = false;
 
+	// Call is executed by worker. Call data is kept in read buffer, until call is finished
+	bool asyncCall_ = false;
+	size_t asyncCallLen_ = 0;
+	Context asyncCtx_;
+	// Guards completion of call and async watcher, which is used by worker
+	std::mutex asyncMtx_;
+	std::condition_variable asyncCond_;
+	bool asyncDone_ = false;
+	// Call failed with unrecoverable error, and connection must be dropped
+	bool asyncDrop_ = false;
+	chunk asyncResp_;
+
 	Dispatcher &dispatcher_;
 	ClientData::Ptr clientData_;
 	// keep here to prevent allocs
@@ -515,6 +515,7 @@ void dynamic_loop::stop(async *watcher) {
 	if (it == asyncs_.end()) {
 		return;
 	}
+	if (it - asyncs_.begin() <= asyncPos_) asyncPos_--;
 	asyncs_.erase(it);
 }
 
@@ -534,12 +535,13 @@ void dynamic_loop::io_callback(int fd, int events) {
 }
 
 void dynamic_loop::async_callback() {
-	for (auto async : asyncs_) {
-		if (async->sent_) {
-			async->callback();
-			async->sent_ = false;
-		}
+	// Watchers may be stopped by callbacks, so position in list is corrected by stop()
+	for (asyncPos_ = 0; asyncPos_ < int(asyncs_.size()); asyncPos_++) {
+		auto async = asyncs_[asyncPos_];
+		// Flag is reset before callback, so send() from another thread during callback is not lost
+		if (async->sent_.exchange(false)) async->callback();
 	}
+	asyncPos_ = -1;
 }
 
 bool gEnableBusyLoop = false;
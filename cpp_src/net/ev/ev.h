@@ -161,6 +161,8 @@ protected:
 	std::vector<fd_handler> fds_;
 	std::vector<timer *> timers_;
 	std::vector<async *> asyncs_;
+	// Position of async_callback() in list of asyncs
+	int asyncPos_ = -1;
 	std::vector<sig *> sigs_;
 	bool break_ = false;
 #ifdef HAVE_EPOLL_LOOP
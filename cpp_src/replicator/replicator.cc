@@ -0,0 +1,296 @@
+#include "replicator.h"
+#include <algorithm>
+#include <chrono>
+#include "core/cjson/jsonbuilder.h"
+#include "core/transaction.h"
+#include "tools/logger.h"
+#include "tools/serializer.h"
+
+namespace reindexer {
+
+const char *kReplicationStatsNamespace = "#replicationstats";
+
+// Maximum amount of records in chunk of WAL
+const int kReplicationBatchSize = 1000;
+// Approximate size of chunk of snapshot of namespace, which is loaded on copying of namespace
+const int kReplicationSnapshotChunkSize = 16 << 20;
+// Maximum amount of chunks of namespace, which are applied in one round, so long tail of one namespace does not starve others
+const int kReplicationChunksPerRound = 16;
+// Interval of polling of leader, when all changes are applied or leader is not available
+const std::chrono::milliseconds kReplicationPollInterval(100);
+
+Replicator::Replicator(shared_ptr<Reindexer> local, const string &leaderDSN)
+	: local_(local), leaderDSN_(leaderDSN), terminate_(false) {}
+
+Replicator::~Replicator() { Stop(); }
+
+Error Replicator::Start() {
+	if (thread_.joinable()) {
+		return Error(errLogic, "Replicator is already started");
+	}
+	auto err = leader_.Connect(leaderDSN_);
+	if (!err.ok()) return err;
+
+	err = local_->AddNamespace(NamespaceDef(kReplicationStatsNamespace, StorageOpts().Enabled().CreateIfMissing())
+								   .AddIndex("namespace", "hash", "string", IndexOpts().PK())
+								   .AddIndex("copied", "-", "bool")
+								   .AddIndex("last_lsn", "-", "int64", IndexOpts().Dense())
+								   .AddIndex("leader_lsn", "-", "int64", IndexOpts().Dense())
+								   .AddIndex("lag", "-", "int64", IndexOpts().Dense())
+								   .AddIndex("syncs_count", "-", "int64", IndexOpts().Dense()));
+	// Namespace is already loaded from storage with database
+	if (!err.ok()) err = local_->OpenNamespace(kReplicationStatsNamespace);
+	if (!err.ok()) return err;
+
+	err = loadStates();
+	if (!err.ok()) return err;
+
+	terminate_ = false;
+	thread_ = std::thread([this]() { run(); });
+	return errOK;
+}
+
+void Replicator::Stop() {
+	if (!thread_.joinable()) return;
+	{
+		std::lock_guard<std::mutex> lck(mtx_);
+		terminate_ = true;
+		cond_.notify_all();
+	}
+	thread_.join();
+}
+
+void Replicator::run() {
+	logPrintf(LogInfo, "Replicator: following leader '%s'", leaderDSN_.c_str());
+	for (;;) {
+		bool applied = syncNamespaces();
+
+		std::unique_lock<std::mutex> lck(mtx_);
+		if (!applied) cond_.wait_for(lck, kReplicationPollInterval, [this]() { return bool(terminate_); });
+		if (terminate_) return;
+	}
+}
+
+Error Replicator::loadStates() {
+	QueryResults qr;
+	auto err = local_->Select(Query(kReplicationStatsNamespace), qr);
+	if (!err.ok()) return err;
+
+	for (auto it : qr) {
+		auto item = it.GetItem();
+		NsState &state = states_[item["namespace"].As<string>()];
+		state.copied = item["copied"].As<bool>();
+		state.lastLSN = item["last_lsn"].As<int64_t>();
+		state.leaderLSN = item["leader_lsn"].As<int64_t>();
+		state.syncsCount = item["syncs_count"].As<int64_t>();
+	}
+	return errOK;
+}
+
+bool Replicator::syncNamespaces() {
+	// Namespaces, which are closed on leader, are enumerated too, so only dropped namespaces are missing from the list
+	vector<NamespaceDef> defs;
+	auto err = leader_.EnumNamespaces(defs, true);
+	if (!err.ok()) {
+		// Leader is polled again and again, while it is not available, so only the first failure is logged
+		if (leaderAvailable_) logPrintf(LogError, "Replicator: leader '%s' is not available: %s", leaderDSN_.c_str(), err.what().c_str());
+		leaderAvailable_ = false;
+		return false;
+	}
+	if (!leaderAvailable_) logPrintf(LogInfo, "Replicator: leader '%s' is available again", leaderDSN_.c_str());
+	leaderAvailable_ = true;
+
+	bool applied = false;
+	for (auto &def : defs) {
+		if (terminate_) return false;
+		if (def.name.empty() || def.name[0] == '#') continue;
+
+		NsState &state = states_[def.name];
+		NsState prevState = state;
+		bool nsApplied = false;
+		err = syncNamespace(def, state, nsApplied);
+		applied = applied || nsApplied;
+		if (!err.ok() && err.what() != state.lastError.what()) {
+			logPrintf(LogError, "Replicator: error sync namespace '%s': %s", def.name.c_str(), err.what().c_str());
+		}
+		state.lastError = err;
+
+		if (state.copied != prevState.copied || state.lastLSN != prevState.lastLSN || state.leaderLSN != prevState.leaderLSN ||
+			state.lastError.what() != prevState.lastError.what()) {
+			saveState(def.name, state);
+		}
+	}
+
+	// Namespaces, which were dropped on leader, are dropped on follower too
+	for (auto it = states_.begin(); it != states_.end();) {
+		auto &nsName = it->first;
+		if (std::find_if(defs.begin(), defs.end(), [&nsName](const NamespaceDef &def) { return def.name == nsName; }) != defs.end()) {
+			++it;
+			continue;
+		}
+		logPrintf(LogInfo, "Replicator: namespace '%s' is dropped on leader", nsName.c_str());
+		local_->DropNamespace(nsName);
+		QueryResults qr;
+		local_->Delete(Query(kReplicationStatsNamespace).Where("namespace", CondEq, nsName), qr);
+		it = states_.erase(it);
+	}
+	return applied;
+}
+
+Error Replicator::syncNamespace(const NamespaceDef &def, NsState &state, bool &applied) {
+	WALChunk chunk;
+	Error err;
+	if (state.copied) {
+		err = leader_.GetWAL(def.name, state.lastLSN, kReplicationBatchSize, chunk);
+		if (err.code() == errOutdatedWAL) {
+			logPrintf(LogWarning, "Replicator: %s. Namespace will be copied", err.what().c_str());
+			state.copied = false;
+		} else if (!err.ok()) {
+			return err;
+		}
+	}
+	if (!state.copied) {
+		applied = true;
+		err = copyNamespace(def, state);
+		if (!err.ok()) return err;
+		err = leader_.GetWAL(def.name, state.lastLSN, kReplicationBatchSize, chunk);
+		if (!err.ok()) return err;
+	}
+
+	for (int i = 0;; i++) {
+		state.leaderLSN = chunk.nsLSN;
+		if (chunk.lastLSN == state.lastLSN) break;
+
+		err = applyChunk(def.name, chunk);
+		if (!err.ok()) return err;
+		applied = true;
+		state.lastLSN = chunk.lastLSN;
+
+		if (state.lastLSN >= state.leaderLSN || i + 1 >= kReplicationChunksPerRound || terminate_) break;
+		err = leader_.GetWAL(def.name, state.lastLSN, kReplicationBatchSize, chunk);
+		if (!err.ok()) return err;
+	}
+	return errOK;
+}
+
+Error Replicator::copyNamespace(const NamespaceDef &def, NsState &state) {
+	logPrintf(LogInfo, "Replicator: copying namespace '%s' from leader", def.name.c_str());
+	state.lastLSN = -1;
+	state.syncsCount++;
+	saveState(def.name, state);
+
+	// Snapshot keeps items, which were not changed after LSN of snapshot, and later changes are applied from WAL after it
+	int64_t lsn = -1;
+	size_t itemsCount = 0;
+	auto err = local_->LoadSnapshot(def.name, [&](int64_t snapshotLSN, int64_t fromID, SnapshotChunk &chunk) {
+		if (terminate_) return Error(errLogic, "Replicator is stopped");
+		auto status = leader_.GetSnapshot(def.name, snapshotLSN, fromID, kReplicationSnapshotChunkSize, chunk);
+		lsn = chunk.lsn;
+		itemsCount += chunk.records.size();
+		return status;
+	});
+	if (!err.ok()) return err;
+
+	vector<string> keys;
+	err = leader_.EnumMeta(def.name, keys);
+	if (!err.ok()) return err;
+	for (auto &key : keys) {
+		string data;
+		err = leader_.GetMeta(def.name, key, data);
+		if (!err.ok()) return err;
+		err = local_->PutMeta(def.name, key, data);
+		if (!err.ok()) return err;
+	}
+
+	logPrintf(LogInfo, "Replicator: namespace '%s' is copied, %d items, LSN %lld", def.name.c_str(), int(itemsCount),
+			  static_cast<long long>(lsn));
+	state.copied = true;
+	state.lastLSN = lsn;
+	return errOK;
+}
+
+Error Replicator::applyChunk(const string &nsName, const WALChunk &chunk) {
+	Transaction tx = local_->NewTransaction(nsName);
+	auto commit = [&]() {
+		if (tx.IsEmpty()) return Error();
+		auto err = local_->CommitTransaction(tx);
+		tx = local_->NewTransaction(nsName);
+		return err;
+	};
+
+	for (auto &rec : chunk.records) {
+		Error err;
+		switch (rec.type) {
+			case kWALOpModifyItem: {
+				Item item = local_->NewItem(nsName);
+				err = item.Status().ok() ? item.FromJSON(rec.data) : item.Status();
+				if (err.ok()) tx.Modify(std::move(item), rec.mode == ModeDelete ? ModeDelete : ModeUpsert);
+				break;
+			}
+			case kWALOpModifyIndex:
+			case kWALOpDropIndex:
+				// Items of transaction are built by the current indexes, so they are applied before change of indexes
+				err = commit();
+				if (err.ok()) err = applyIndexRecord(nsName, rec);
+				break;
+			case kWALPutMeta:
+				err = local_->PutMeta(nsName, rec.data, rec.value);
+				break;
+			default:
+				break;
+		}
+		if (!err.ok()) return err;
+	}
+	return commit();
+}
+
+Error Replicator::applyIndexRecord(const string &nsName, const WALRecord &rec) {
+	// Namespace may be copied after change of index, so change may be already applied
+	if (rec.type == kWALOpDropIndex) {
+		auto err = local_->DropIndex(nsName, rec.data);
+		if (!err.ok()) {
+			logPrintf(LogWarning, "Replicator: skipping drop of index of namespace '%s': %s", nsName.c_str(), err.what().c_str());
+		}
+		return errOK;
+	}
+
+	IndexDef indexDef;
+	string json = rec.data;
+	auto err = indexDef.FromJSON(&json[0]);
+	if (!err.ok()) return err;
+	if (rec.mode == ModeInsert) err = local_->AddIndex(nsName, indexDef);
+	if (rec.mode != ModeInsert || !err.ok()) err = local_->UpdateIndex(nsName, indexDef);
+	return err;
+}
+
+void Replicator::saveState(const string &nsName, const NsState &state) {
+	WrSerializer ser;
+	{
+		JsonBuilder builder(ser);
+		builder.Put("namespace", nsName);
+		builder.Put("copied", state.copied);
+		builder.Put("last_lsn", state.lastLSN);
+		builder.Put("leader_lsn", state.leaderLSN);
+		builder.Put("lag", state.copied ? std::max(state.leaderLSN - state.lastLSN, int64_t(0)) : state.leaderLSN + 1);
+		builder.Put("syncs_count", state.syncsCount);
+		const char *stateName = "synced";
+		if (!state.lastError.ok()) {
+			stateName = "error";
+		} else if (!state.copied) {
+			stateName = "copying";
+		} else if (state.lastLSN < state.leaderLSN) {
+			stateName = "syncing";
+		}
+		builder.Put("state", stateName);
+		builder.Put("last_error", state.lastError.what());
+		auto now = std::chrono::system_clock::now().time_since_epoch();
+		builder.Put("updated_unix_nano", int64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count()));
+	}
+
+	Item item = local_->NewItem(kReplicationStatsNamespace);
+	auto err = item.Status().ok() ? item.FromJSON(ser.Slice()) : item.Status();
+	if (err.ok()) err = local_->Upsert(kReplicationStatsNamespace, item);
+	if (!err.ok()) logPrintf(LogError, "Replicator: can't save state of namespace '%s': %s", nsName.c_str(), err.what().c_str());
+}
+
+}  // namespace reindexer
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include "client/reindexer.h"
+#include "core/reindexer.h"
+
+namespace reindexer {
+
+using std::string;
+using std::shared_ptr;
+using std::unordered_map;
+
+extern const char *kReplicationStatsNamespace;
+
+/// Follower of leader database. Namespaces of leader are copied to local database, and then are kept in sync by tail of WAL of leader,
+/// which is polled and applied by batches. Namespace is copied again, if WAL of leader does not keep changes after the applied LSN.<br>
+/// State and lag of replication of each namespace are kept in system namespace #replicationstats of local database.
+class Replicator {
+public:
+	/// @param local - local database, which receives changes
+	/// @param leaderDSN - DSN of leader database, like: `cproto://user@password:127.0.0.1:6534/dbname`
+	Replicator(shared_ptr<Reindexer> local, const string &leaderDSN);
+	~Replicator();
+	Replicator(const Replicator &) = delete;
+	Replicator &operator=(const Replicator &) = delete;
+
+	/// Connect to leader, and start replication thread
+	Error Start();
+	/// Stop replication thread
+	void Stop();
+
+protected:
+	struct NsState {
+		// Namespace is copied from leader, so it can be synced by WAL
+		bool copied = false;
+		// LSN of the last change of leader, which is applied to local namespace
+		int64_t lastLSN = -1;
+		// LSN of the last change of leader namespace
+		int64_t leaderLSN = -1;
+		int64_t syncsCount = 0;
+		Error lastError;
+	};
+
+	void run();
+	Error loadStates();
+	// @return true, if any changes were applied
+	bool syncNamespaces();
+	Error syncNamespace(const NamespaceDef &def, NsState &state, bool &applied);
+	Error copyNamespace(const NamespaceDef &def, NsState &state);
+	Error applyChunk(const string &nsName, const WALChunk &chunk);
+	Error applyIndexRecord(const string &nsName, const WALRecord &rec);
+	void saveState(const string &nsName, const NsState &state);
+
+	shared_ptr<Reindexer> local_;
+	string leaderDSN_;
+	client::Reindexer leader_;
+	unordered_map<string, NsState> states_;
+	bool leaderAvailable_ = true;
+
+	std::thread thread_;
+	std::mutex mtx_;
+	std::condition_variable cond_;
+	std::atomic<bool> terminate_;
+};
+
+}  // namespace reindexer
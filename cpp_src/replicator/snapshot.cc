@@ -0,0 +1,30 @@
+#include "snapshot.h"
+#include "tools/serializer.h"
+
+namespace reindexer {
+
+void SnapshotChunk::Pack(WrSerializer &ser) const {
+	ser.PutVarint(lsn);
+	ser.PutVarint(nextID);
+	ser.PutVString(nsDef);
+	ser.PutVString(tagsMatcher);
+	ser.PutVarUint(records.size());
+	for (auto &rec : records) ser.PutVString(rec);
+}
+
+Error SnapshotChunk::Unpack(string_view data) {
+	try {
+		Serializer ser(data.data(), data.size());
+		lsn = ser.GetVarint();
+		nextID = ser.GetVarint();
+		nsDef = ser.GetVString().ToString();
+		tagsMatcher = ser.GetVString().ToString();
+		records.resize(ser.GetVarUint());
+		for (auto &rec : records) rec = ser.GetVString().ToString();
+	} catch (const Error &err) {
+		return err;
+	}
+	return errOK;
+}
+
+}  // namespace reindexer
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <vector>
+#include "estl/string_view.h"
+#include "tools/errors.h"
+
+namespace reindexer {
+
+using std::string;
+using std::vector;
+
+class WrSerializer;
+
+/// Part of snapshot of namespace. Snapshot is a copy of items of namespace, which were not changed after LSN of snapshot.
+/// Items, which were changed later, are taken from WAL of namespace after LSN of snapshot.
+struct SnapshotChunk {
+	/// LSN of snapshot. It is passed with the next chunks requests
+	int64_t lsn = -1;
+	/// Row, which the next chunk starts from. -1 - it is the last chunk of snapshot
+	int64_t nextID = -1;
+	/// JSON of definition of namespace with indexes. It is sent by the first chunk only
+	string nsDef;
+	/// Serialized tagsmatcher of namespace. Tags are only added to tagsmatcher, so it is valid for items of all previous chunks
+	string tagsMatcher;
+	/// Records of items, as they are kept in storage: LSN of item and CJSON of item
+	vector<string> records;
+
+	void Pack(WrSerializer &ser) const;
+	Error Unpack(string_view data);
+};
+
+/// Function, which fetches chunk of snapshot
+/// @param lsn - LSN of snapshot, as returned by the first chunk. -1 - fetch the first chunk of new snapshot
+/// @param fromID - row, which chunk starts from, as returned by nextID of previous chunk
+/// @param chunk - output chunk
+typedef std::function<Error(int64_t lsn, int64_t fromID, SnapshotChunk &chunk)> SnapshotFetcher;
+
+}  // namespace reindexer
@@ -4,6 +4,7 @@
 #include "core/indexdef.h"
 #include "core/item.h"
 #include "estl/shared_mutex.h"
+#include "walrecord.h"
 
 namespace reindexer {
 
@@ -36,14 +37,4 @@ protected:
 	shared_timed_mutex mtx_;
 };
 
-enum {
-	//
-	kWALOpModifyItem = 1,
-	kWALOpNewNamespace = 2,
-	kWALOpModifyIndex = 3,
-	kWALOpDropIndex = 4,
-	kWALOpDropNamespace = 5,
-	kWALPutMeta = 6
-};
-
 }  // namespace reindexer
@@ -0,0 +1,40 @@
+#include "walrecord.h"
+#include "tools/serializer.h"
+
+namespace reindexer {
+
+void WALRecord::Pack(WrSerializer &ser) const {
+	ser.PutVarint(lsn);
+	ser.PutVarUint(type);
+	ser.PutVarUint(mode);
+	ser.PutVString(data);
+	ser.PutVString(value);
+}
+
+void WALChunk::Pack(WrSerializer &ser) const {
+	ser.PutVarint(lastLSN);
+	ser.PutVarint(nsLSN);
+	ser.PutVarUint(records.size());
+	for (auto &rec : records) rec.Pack(ser);
+}
+
+Error WALChunk::Unpack(string_view data) {
+	try {
+		Serializer ser(data.data(), data.size());
+		lastLSN = ser.GetVarint();
+		nsLSN = ser.GetVarint();
+		records.resize(ser.GetVarUint());
+		for (auto &rec : records) {
+			rec.lsn = ser.GetVarint();
+			rec.type = ser.GetVarUint();
+			rec.mode = ser.GetVarUint();
+			rec.data = ser.GetVString().ToString();
+			rec.value = ser.GetVString().ToString();
+		}
+	} catch (const Error &err) {
+		return err;
+	}
+	return errOK;
+}
+
+}  // namespace reindexer
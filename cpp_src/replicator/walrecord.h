@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "estl/string_view.h"
+#include "tools/errors.h"
+
+namespace reindexer {
+
+using std::string;
+using std::vector;
+
+class WrSerializer;
+
+enum {
+	//
+	kWALOpModifyItem = 1,
+	kWALOpNewNamespace = 2,
+	kWALOpModifyIndex = 3,
+	kWALOpDropIndex = 4,
+	kWALOpDropNamespace = 5,
+	kWALPutMeta = 6
+};
+
+/// Record of write-ahead log of namespace
+struct WALRecord {
+	/// LSN of change
+	int64_t lsn = -1;
+	/// Type of record, one of kWALOp*
+	int type = 0;
+	/// Modify mode of item or index: ModeInsert, ModeUpdate, ModeUpsert or ModeDelete
+	int mode = 0;
+	/// JSON of item or index definition, name of dropped index, or key of meta
+	string data;
+	/// Value of meta
+	string value;
+
+	void Pack(WrSerializer &ser) const;
+};
+
+/// Part of tail of write-ahead log of namespace
+struct WALChunk {
+	/// Records of changes. Records of items, which were changed again later, are skipped: the last change carries actual item
+	vector<WALRecord> records;
+	/// LSN, which the chunk ends at. It is passed as lastLSN to get the next chunk
+	int64_t lastLSN = -1;
+	/// LSN of the last change of namespace
+	int64_t nsLSN = -1;
+
+	void Pack(WrSerializer &ser) const;
+	Error Unpack(string_view data);
+};
+
+}  // namespace reindexer
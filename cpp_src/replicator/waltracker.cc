@@ -0,0 +1,130 @@
+#include "waltracker.h"
+#include <assert.h>
+#include <algorithm>
+#include <memory>
+#include "tools/logger.h"
+#include "tools/serializer.h"
+
+#define kStorageWALPrefix "W"
+
+namespace reindexer {
+
+WALTracker::WALTracker(size_t maxSize) : maxSize_(maxSize) {}
+
+WALTracker::Entry &WALTracker::slot(int64_t lsn) {
+	size_t pos = lsn % maxSize_;
+	// Ring grows on demand, so empty and small namespaces do not reserve memory for the whole WAL
+	if (pos >= ring_.size()) ring_.resize(pos + 1);
+	return ring_[pos];
+}
+
+void WALTracker::Add(int64_t lsn, int type, int mode, IdType id, string &&data) {
+	if (lsn != nextLSN_) Reset(lsn);
+	nextLSN_ = lsn + 1;
+	if (!maxSize_) {
+		firstLSN_ = nextLSN_;
+		return;
+	}
+	if (nextLSN_ - firstLSN_ > int64_t(maxSize_)) firstLSN_ = nextLSN_ - maxSize_;
+
+	Entry &entry = slot(lsn);
+	entry.lsn = lsn;
+	entry.id = id;
+	entry.type = type;
+	entry.mode = mode;
+	entry.data = std::move(data);
+}
+
+void WALTracker::GetStorageRecord(int64_t lsn, WrSerializer &key, WrSerializer &data) const {
+	const Entry *entry = Get(lsn);
+	assert(entry);
+	key << kStorageWALPrefix << std::to_string(lsn % maxSize_);
+	data.PutVarint(entry->lsn);
+	data.PutVarUint(entry->type);
+	data.PutVarUint(entry->mode);
+	data.PutVString(entry->data);
+}
+
+void WALTracker::Load(datastorage::IDataStorage &storage) {
+	StorageOpts opts;
+	opts.FillCache(false);
+
+	// Records are sorted by LSN, so they are read in order of storage
+	vector<Entry> entries;
+	Error status = storage.ReadPrefix(opts, string_view(kStorageWALPrefix), [&](const string_view &, const string_view &data) {
+		try {
+			Serializer ser(data.data(), data.size());
+			Entry entry;
+			entry.lsn = ser.GetVarint();
+			entry.type = ser.GetVarUint();
+			entry.mode = ser.GetVarUint();
+			entry.data = ser.GetVString().ToString();
+			entries.push_back(std::move(entry));
+		} catch (const Error &err) {
+			logPrintf(LogWarning, "Error load WAL record from storage: '%s'", err.what().c_str());
+		}
+		return true;
+	});
+	if (!status.ok()) logPrintf(LogWarning, "Error load WAL from storage: '%s'", status.what().c_str());
+	std::sort(entries.begin(), entries.end(), [](const Entry &lhs, const Entry &rhs) { return lhs.lsn < rhs.lsn; });
+
+	Reset(entries.empty() ? 0 : entries.back().lsn + 1);
+	if (!maxSize_) return;
+
+	// Ring in storage may keep stale records of previous size of WAL, so only records without gaps are taken
+	size_t first = entries.size();
+	while (first > 0 && entries.size() - first < maxSize_ && (first == entries.size() || entries[first - 1].lsn + 1 == entries[first].lsn))
+		first--;
+	if (first == entries.size()) return;
+	firstLSN_ = entries[first].lsn;
+	for (size_t i = first; i < entries.size(); i++) slot(entries[i].lsn) = std::move(entries[i]);
+}
+
+void WALTracker::BindItem(int64_t lsn, IdType id) {
+	if (lsn < firstLSN_ || lsn >= nextLSN_) return;
+	Entry &entry = slot(lsn);
+	if (entry.type == kWALOpModifyItem && entry.mode != ModeDelete) entry.id = id;
+}
+
+void WALTracker::Reset(int64_t nextLSN) {
+	ring_.clear();
+	firstLSN_ = nextLSN_ = nextLSN;
+}
+
+void WALTracker::Resize(size_t maxSize) {
+	if (maxSize == maxSize_) return;
+	vector<Entry> ring;
+	ring.swap(ring_);
+	size_t oldSize = maxSize_;
+	maxSize_ = maxSize;
+	if (!maxSize_) {
+		Reset(nextLSN_);
+		return;
+	}
+
+	int64_t from = std::max(firstLSN_, nextLSN_ - int64_t(maxSize));
+	for (int64_t lsn = from; lsn < nextLSN_; lsn++) slot(lsn) = std::move(ring[lsn % oldSize]);
+	firstLSN_ = from;
+}
+
+const WALTracker::Entry *WALTracker::Get(int64_t lsn) const {
+	if (lsn < firstLSN_ || lsn >= nextLSN_) return nullptr;
+	return &ring_[lsn % maxSize_];
+}
+
+WALRecord WALTracker::ToRecord(const Entry &entry) {
+	WALRecord rec;
+	rec.lsn = entry.lsn;
+	rec.type = entry.type;
+	rec.mode = entry.mode;
+	if (entry.type == kWALPutMeta) {
+		Serializer ser(entry.data.data(), entry.data.size());
+		rec.data = ser.GetVString().ToString();
+		rec.value = ser.GetVString().ToString();
+	} else {
+		rec.data = entry.data;
+	}
+	return rec;
+}
+
+}  // namespace reindexer
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "core/storage/idatastorage.h"
+#include "core/type_consts.h"
+#include "walrecord.h"
+
+namespace reindexer {
+
+const size_t kDefaultWALSize = 100000;
+
+/// Bounded ring of write-ahead log of namespace. Record of lsn is kept in slot lsn % maxSize, and is written to storage by key of slot,
+/// so storage keeps the same bounded ring. Tracker is not thread safe: it is guarded by lock of namespace.
+class WALTracker {
+public:
+	struct Entry {
+		int64_t lsn = -1;
+		// Row of changed item. Item itself is not copied: it is read from namespace, when WAL is read
+		IdType id = -1;
+		uint8_t type = 0;
+		uint8_t mode = 0;
+		// JSON of deleted item or of index definition, name of index, or packed key and value of meta
+		string data;
+	};
+
+	/// @param maxSize - maximum amount of kept records. 0 - WAL is disabled
+	WALTracker(size_t maxSize);
+
+	/// Adds record of change. If lsn does not follow the last record, previous records are dropped
+	void Add(int64_t lsn, int type, int mode, IdType id, string &&data = string());
+	/// Serializes record to write it to storage
+	/// @param lsn - lsn of kept record
+	/// @param key - storage key of record
+	/// @param data - serialized record
+	void GetStorageRecord(int64_t lsn, WrSerializer &key, WrSerializer &data) const;
+	/// Loads records from storage. Only contiguous tail of records is kept. Records of items are not bound to rows yet
+	void Load(datastorage::IDataStorage &storage);
+	/// Binds record of item change to row after load
+	/// @param lsn - lsn of loaded item
+	/// @param id - row of loaded item
+	void BindItem(int64_t lsn, IdType id);
+	/// Drops all records
+	/// @param nextLSN - lsn of the next added record
+	void Reset(int64_t nextLSN);
+	/// Changes maximum amount of kept records. The newest records are kept
+	void Resize(size_t maxSize);
+
+	/// @return record of lsn, or nullptr, if record is not kept
+	const Entry *Get(int64_t lsn) const;
+	/// @return lsn of the oldest kept record
+	int64_t FirstLSN() const { return firstLSN_; }
+	/// @return lsn of the next added record
+	int64_t NextLSN() const { return nextLSN_; }
+	size_t MaxSize() const { return maxSize_; }
+
+	/// Converts kept record of deleted item, index or meta to replicated record
+	static WALRecord ToRecord(const Entry &entry);
+
+protected:
+	Entry &slot(int64_t lsn);
+
+	vector<Entry> ring_;
+	size_t maxSize_;
+	int64_t firstLSN_ = 0;
+	int64_t nextLSN_ = 0;
+};
+
+}  // namespace reindexer
@@ -1,5 +1,6 @@
 #include "config.h"
 
+#include <thread>
 #include "args/args.hpp"
 #include "tools/fsops.h"
 #include "yaml/yaml.h"
@@ -10,13 +11,19 @@ void ServerConfig::Reset() {
 	args_.clear();
 	WebRoot.clear();
 	StorageEngine = "leveldb";
+	StorageCompression.clear();
+	StorageMaxOpenFiles = 0;
+	StorageBlockCacheSize = 0;
+	StorageWriteBufferSize = 0;
 	HTTPAddr = "0.0.0.0:9088";
 	RPCAddr = "0.0.0.0:6534";
+	RPCThreads = std::thread::hardware_concurrency();
 	LogLevel = "info";
 	ServerLog = "stdout";
 	CoreLog = "stdout";
 	HttpLog = "stdout";
 	RpcLog = "stdout";
+	ReplicationLeader.clear();
 #ifndef _WIN32
 	StoragePath = "/tmp/reindex";
 	UserName.clear();
@@ -71,10 +78,16 @@ Error ServerConfig::ParseCmd(int argc, char *argv[]) {
 
 	args::Group dbGroup(parser, "Database options");
 	args::ValueFlag<string> storageF(dbGroup, "PATH", "path to 'reindexer' storage", {'s', "db"}, StoragePath, args::Options::Single);
+	args::ValueFlag<string> engineF(dbGroup, "NAME", "Storage engine of new databases (leveldb, rocksdb, native)", {"engine"},
+									StorageEngine, args::Options::Single);
+	args::ValueFlag<string> leaderF(dbGroup, "DSN", "DSN of leader database to replicate, like cproto://127.0.0.1:6534/dbname",
+									{"leader"}, ReplicationLeader, args::Options::Single);
 
 	args::Group netGroup(parser, "Network options");
 	args::ValueFlag<string> httpAddrF(netGroup, "PORT", "http listen host:port", {'p', "httpaddr"}, HTTPAddr, args::Options::Single);
 	args::ValueFlag<string> rpcAddrF(netGroup, "RPORT", "RPC listen host:port", {'r', "rpcaddr"}, RPCAddr, args::Options::Single);
+	args::ValueFlag<int> rpcThreadsF(netGroup, "N", "Count of RPC workers for selects and modifications (0 - disabled)", {"rpcthreads"},
+									 RPCThreads, args::Options::Single);
 	args::ValueFlag<string> webRootF(netGroup, "PATH", "web root", {'w', "webroot"}, WebRoot, args::Options::Single);
 
 	args::Group logGroup(parser, "Logging options");
@@ -111,9 +124,12 @@ Error ServerConfig::ParseCmd(int argc, char *argv[]) {
 	}
 
 	if (storageF) StoragePath = args::get(storageF);
+	if (engineF) StorageEngine = args::get(engineF);
+	if (leaderF) ReplicationLeader = args::get(leaderF);
 	if (logLevelF) LogLevel = args::get(logLevelF);
 	if (httpAddrF) HTTPAddr = args::get(httpAddrF);
 	if (rpcAddrF) RPCAddr = args::get(rpcAddrF);
+	if (rpcThreadsF) RPCThreads = args::get(rpcThreadsF);
 	if (webRootF) WebRoot = args::get(webRootF);
 #ifndef _WIN32
 	if (userF) UserName = args::get(userF);
@@ -136,6 +152,12 @@ Error ServerConfig::ParseCmd(int argc, char *argv[]) {
 reindexer::Error ServerConfig::fromYaml(Yaml::Node &root) {
 	try {
 		StoragePath = root["storage"]["path"].As<std::string>(StoragePath);
+		StorageEngine = root["storage"]["engine"].As<std::string>(StorageEngine);
+		StorageCompression = root["storage"]["compression"].As<std::string>(StorageCompression);
+		StorageMaxOpenFiles = root["storage"]["max_open_files"].As<int>(StorageMaxOpenFiles);
+		StorageBlockCacheSize = root["storage"]["block_cache_size"].As<int64_t>(StorageBlockCacheSize);
+		StorageWriteBufferSize = root["storage"]["write_buffer_size"].As<int64_t>(StorageWriteBufferSize);
+		ReplicationLeader = root["replication"]["leader"].As<std::string>(ReplicationLeader);
 		LogLevel = root["logger"]["loglevel"].As<std::string>(LogLevel);
 		ServerLog = root["logger"]["serverlog"].As<std::string>(ServerLog);
 		CoreLog = root["logger"]["corelog"].As<std::string>(CoreLog);
@@ -143,6 +165,7 @@ reindexer::Error ServerConfig::fromYaml(Yaml::Node &root) {
 		RpcLog = root["logger"]["rpclog"].As<std::string>(RpcLog);
 		HTTPAddr = root["net"]["httpaddr"].As<std::string>(HTTPAddr);
 		RPCAddr = root["net"]["rpcaddr"].As<std::string>(RPCAddr);
+		RPCThreads = root["net"]["rpcthreads"].As<int>(RPCThreads);
 		WebRoot = root["net"]["webroot"].As<std::string>(WebRoot);
 		EnableSecurity = root["net"]["security"].As<bool>(EnableSecurity);
 #ifndef _WIN32
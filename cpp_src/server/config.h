@@ -25,15 +25,25 @@ struct ServerConfig {
 	Error ParseCmd(int argc, char* argv[]);
 
 	string WebRoot;
+	// Storage engine of new databases: leveldb or rocksdb
 	string StorageEngine;
+	// Tunables of storage engine. Empty or 0 - default value of engine
+	string StorageCompression;
+	int StorageMaxOpenFiles;
+	int64_t StorageBlockCacheSize;
+	int64_t StorageWriteBufferSize;
 	string HTTPAddr;
 	string RPCAddr;
+	// Count of workers, which execute heavy RPC commands. 0 - commands are executed by loops of connections
+	int RPCThreads;
 	string LogLevel;
 	string ServerLog;
 	string CoreLog;
 	string HttpLog;
 	string RpcLog;
 	string StoragePath;
+	// DSN of leader database, like cproto://127.0.0.1:6534/dbname. If it is set, server follows leader, and keeps replica of its database
+	string ReplicationLeader;
 #ifndef _WIN32
 	string UserName;
 	string DaemonPidFile;
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <fstream>
 #include <mutex>
 
@@ -10,7 +11,8 @@
 #include "tools/stringstools.h"
 
 namespace reindexer_server {
-DBManager::DBManager(const string &dbpath, bool noSecurity) : dbpath_(dbpath), noSecurity_(noSecurity) {}
+DBManager::DBManager(const string &dbpath, bool noSecurity, const ConnectOpts &connectOpts)
+	: dbpath_(dbpath), noSecurity_(noSecurity), connectOpts_(connectOpts) {}
 
 Error DBManager::Init() {
 	auto status = readUsers();
@@ -71,7 +73,7 @@ Error DBManager::loadOrCreateDatabase(const string &dbName) {
 
 	logPrintf(LogInfo, "Loading database %s", dbName.c_str());
 	auto db = std::make_shared<reindexer::Reindexer>();
-	auto status = db->Connect(storagePath);
+	auto status = db->Connect(storagePath, connectOpts_);
 	if (status.ok()) {
 		dbs_[dbName] = db;
 	}
@@ -79,6 +81,31 @@ Error DBManager::loadOrCreateDatabase(const string &dbName) {
 	return status;
 }
 
+Error DBManager::OpenReplica(const string &dbName, shared_ptr<Reindexer> &db) {
+	if (!validateObjectName(dbName)) {
+		return Error(errParams, "Database name contains invalid character. Only alphas, digits,'_','-, are allowed");
+	}
+
+	std::unique_lock<shared_timed_mutex> lck(mtx_);
+	auto it = dbs_.find(dbName);
+	if (it == dbs_.end()) {
+		auto status = loadOrCreateDatabase(dbName);
+		if (!status.ok()) {
+			return status;
+		}
+		it = dbs_.find(dbName);
+	}
+	replicas_.push_back(dbName);
+	db = it->second;
+	return 0;
+}
+
+bool DBManager::isReplica(const string &dbName) {
+	shared_lock<shared_timed_mutex> lck(mtx_);
+	return std::find_if(replicas_.begin(), replicas_.end(), [&dbName](const string &name) { return iequals(name, dbName); }) !=
+		   replicas_.end();
+}
+
 Error DBManager::DropDatabase(AuthContext &auth) {
 	shared_ptr<Reindexer> db;
 	auto status = auth.GetDB(kRoleOwner, &db);
@@ -108,7 +135,7 @@ vector<string> DBManager::EnumDatabases() {
 
 Error DBManager::Login(const string &dbName, AuthContext &auth) {
 	if (IsNoSecurity()) {
-		auth.role_ = kRoleOwner;
+		auth.role_ = isReplica(dbName) ? kRoleDataRead : kRoleOwner;
 		auth.dbName_ = dbName;
 		return 0;
 	}
@@ -141,6 +168,9 @@ Error DBManager::Login(const string &dbName, AuthContext &auth) {
 		if (dbIt != urec.roles.end() && dbIt->second > auth.role_) {
 			auth.role_ = dbIt->second;
 		}
+		if (auth.role_ > kRoleDataRead && isReplica(dbName)) {
+			auth.role_ = kRoleDataRead;
+		}
 	}
 	auth.dbName_ = dbName;
 	logPrintf(LogInfo, "Authorized user '%s', to db '%s', role=%s\n", auth.login_.c_str(), dbName.c_str(), UserRoleName(auth.role_));
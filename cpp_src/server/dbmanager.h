@@ -87,7 +87,8 @@ public:
 	/// Construct DBManager
 	/// @param dbpath - path to database on file system
 	/// @param noSecurity - if true, then disable all security validations and users authentication
-	DBManager(const string &dbpath, bool noSecurity);
+	/// @param connectOpts - options of databases: engine and tunables of storage
+	DBManager(const string &dbpath, bool noSecurity, const ConnectOpts &connectOpts = ConnectOpts());
 	/// Initialize database:
 	/// Read all found databases to RAM
 	/// Read user's database
@@ -108,6 +109,12 @@ public:
 	/// @param auth - Authorized AuthContext, with valid Reindexer DB object and reasonale role
 	/// @return Error - error object
 	Error DropDatabase(AuthContext &auth);
+	/// Open database, which is replica of leader database. Users can only read data from replica, whatever roles they have,
+	/// because replica is changed by replication only
+	/// @param dbName - database name, Can't be empty
+	/// @param db - returned database
+	/// @return Error - error object
+	Error OpenReplica(const string &dbName, shared_ptr<Reindexer> &db);
 	/// Check if security disabled
 	/// @return bool - true: security checks are disabled; false: security checks are enabled
 	bool IsNoSecurity() { return noSecurity_; }
@@ -118,12 +125,15 @@ public:
 private:
 	Error readUsers();
 	Error loadOrCreateDatabase(const string &name);
+	bool isReplica(const string &dbName);
 
 	unordered_map<string, shared_ptr<Reindexer>, nocase_hash_str, nocase_equal_str> dbs_;
 	unordered_map<string, UserRecord> users_;
+	vector<string> replicas_;
 	string dbpath_;
 	shared_timed_mutex mtx_;
 	bool noSecurity_;
+	ConnectOpts connectOpts_;
 };
 
 }  // namespace reindexer_server
@@ -492,6 +492,20 @@ int HTTPServer::Check(http::Context &ctx) {
 		MallocExtension_GetNumericProperty("tcmalloc.pageheap_unmapped_bytes", &val);
 		builder.Put("pageheap_unmapped", val);
 #endif
+
+		if (rpcExecutor_) {
+			auto rpcWorkers = builder.Object("rpc_workers");
+			rpcWorkers.Put("threads", rpcExecutor_->Threads());
+			auto commands = rpcWorkers.Array("commands");
+			for (auto &stat : rpcExecutor_->GetStat()) {
+				auto cmd = commands.Object();
+				cmd.Put("command", cproto::CmdName(stat.cmd));
+				cmd.Put("queue_depth", stat.queueDepth);
+				cmd.Put("calls", stat.calls);
+				cmd.Put("avg_queue_time_us", stat.avgQueueTimeUs);
+				cmd.Put("avg_exec_time_us", stat.avgExecTimeUs);
+			}
+		}
 	}
 
 	return ctx.JSON(http::StatusOK, ser.DetachChunk());
@@ -601,8 +615,9 @@ int HTTPServer::modifyItem(http::Context &ctx, int mode) {
 
 	char *jsonPtr = &itemJson[0];
 	size_t jsonLeft = itemJson.size();
-	int cnt = 0;
-	while (jsonPtr && *jsonPtr) {
+	// All items of request are applied by single transaction: if any of them is not valid, none is applied
+	reindexer::Transaction tx = db->NewTransaction(nsName);
+	for (int i = 0; jsonPtr && *jsonPtr; i++) {
 		Item item = db->NewItem(nsName);
 		if (!item.Status().ok()) {
 			http::HttpStatus httpStatus(item.Status());
@@ -615,39 +630,31 @@ int HTTPServer::modifyItem(http::Context &ctx, int mode) {
 		jsonLeft -= (jsonPtr - prevPtr);
 
 		if (!status.ok()) {
-			http::HttpStatus httpStatus(status);
+			http::HttpStatus httpStatus(Error(status.code(), "Item %d is not valid: %s", i, status.what().c_str()));
 
 			return jsonStatus(ctx, httpStatus);
 		}
 
-		switch (mode) {
-			case ModeUpsert:
-				status = db->Upsert(nsName, item);
-				break;
-			case ModeDelete:
-				status = db->Delete(nsName, item);
-				break;
-			case ModeInsert:
-				status = db->Insert(nsName, item);
-				break;
-			case ModeUpdate:
-				status = db->Update(nsName, item);
-				break;
-		}
+		tx.Modify(std::move(item), ItemModifyMode(mode));
+	}
 
-		if (!status.ok()) {
-			http::HttpStatus httpStatus(status);
+	auto status = db->CommitTransaction(tx);
+	if (!status.ok()) {
+		http::HttpStatus httpStatus(status);
 
-			return jsonStatus(ctx, httpStatus);
-		}
-		cnt += item.GetID() == -1 ? 0 : 1;
+		return jsonStatus(ctx, httpStatus);
 	}
-	db->Commit(nsName);
+	int cnt = 0;
+	for (auto &step : tx.GetSteps()) cnt += step.item.GetID() == -1 ? 0 : 1;
 
 	WrSerializer ser(ctx.writer->GetChunk());
 	JsonBuilder builder(ser);
 	builder.Put("updated", cnt);
 	builder.Put("success", true);
+	// Status of each item of request: item is not modified, if it is inserted, but exists, or it is updated or deleted, but does not exist
+	auto items = builder.Array("items");
+	for (auto &step : tx.GetSteps()) items.Put(nullptr, step.item.GetID() != -1);
+	items.End();
 	builder.End();
 
 	return ctx.JSON(http::StatusOK, ser.DetachChunk());
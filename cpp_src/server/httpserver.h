@@ -4,6 +4,7 @@
 #include "core/reindexer.h"
 #include "dbmanager.h"
 #include "loggerwrapper.h"
+#include "net/cproto/executor.h"
 #include "net/http/router.h"
 #include "net/listener.h"
 #include "pprof/pprof.h"
@@ -24,6 +25,8 @@ public:
 	~HTTPServer();
 
 	bool Start(const string &addr, ev::dynamic_loop &loop);
+	// Set pool of RPC workers to report its statistics
+	void SetRPCExecutor(const cproto::Executor *executor) { rpcExecutor_ = executor; }
 	void Stop() { listener_->Stop(); }
 
 	int NotFoundHandler(http::Context &ctx);
@@ -74,6 +77,7 @@ protected:
 	bool allocDebug_;
 	bool enablePprof_;
 	std::chrono::system_clock::time_point startTs_;
+	const cproto::Executor *rpcExecutor_ = nullptr;
 
 	static const int kDefaultLimit = INT_MAX;
 	static const int kDefaultOffset = 0;
@@ -8,8 +8,8 @@
 
 namespace reindexer_server {
 
-RPCServer::RPCServer(DBManager &dbMgr, LoggerWrapper logger, bool allocDebug)
-	: dbMgr_(dbMgr), logger_(logger), allocDebug_(allocDebug), startTs_(std::chrono::system_clock::now()) {}
+RPCServer::RPCServer(DBManager &dbMgr, LoggerWrapper logger, bool allocDebug, cproto::Executor *executor)
+	: dbMgr_(dbMgr), executor_(executor), logger_(logger), allocDebug_(allocDebug), startTs_(std::chrono::system_clock::now()) {}
 
 RPCServer::~RPCServer() {}
 
@@ -181,17 +181,8 @@ Error RPCServer::DropIndex(cproto::Context &ctx, p_string ns, p_string index) {
 	return getDB(ctx, kRoleDBAdmin)->DropIndex(ns.toString(), index.toString());
 }
 
-Error RPCServer::ModifyItem(cproto::Context &ctx, p_string nsName, int format, p_string itemData, int mode, p_string perceptsPack,
-							int stateToken, int /*txID*/) {
-	auto db = getDB(ctx, kRoleDataWrite);
-	string ns = nsName.toString();
-	auto item = Item(db->NewItem(ns));
-	bool tmUpdated = false;
+Error RPCServer::fillItem(Item &item, int format, p_string itemData, int mode, p_string perceptsPack, int stateToken) {
 	Error err;
-	if (!item.Status().ok()) {
-		return item.Status();
-	}
-
 	switch (format) {
 		case FormatJson:
 			err = item.Unsafe().FromJSON(itemData, nullptr, mode == ModeDelete);
@@ -210,7 +201,6 @@ Error RPCServer::ModifyItem(cproto::Context &ctx, p_string nsName, int format, p
 	if (!err.ok()) {
 		return err;
 	}
-	tmUpdated = item.IsTagsUpdated();
 
 	if (perceptsPack.length()) {
 		Serializer ser(perceptsPack);
@@ -222,6 +212,26 @@ Error RPCServer::ModifyItem(cproto::Context &ctx, p_string nsName, int format, p
 		}
 		item.SetPrecepts(precepts);
 	}
+	return errOK;
+}
+
+Error RPCServer::ModifyItem(cproto::Context &ctx, p_string nsName, int format, p_string itemData, int mode, p_string perceptsPack,
+							int stateToken, int /*txID*/) {
+	auto db = getDB(ctx, kRoleDataWrite);
+	string ns = nsName.toString();
+	auto item = Item(db->NewItem(ns));
+	bool tmUpdated = false;
+	Error err;
+	if (!item.Status().ok()) {
+		return item.Status();
+	}
+
+	err = fillItem(item, format, itemData, mode, perceptsPack, stateToken);
+	if (!err.ok()) {
+		return err;
+	}
+	tmUpdated = item.IsTagsUpdated();
+
 	switch (mode) {
 		case ModeUpsert:
 			err = db->Upsert(ns, item);
@@ -235,6 +245,8 @@ Error RPCServer::ModifyItem(cproto::Context &ctx, p_string nsName, int format, p
 		case ModeDelete:
 			err = db->Delete(ns, item);
 			break;
+		default:
+			err = Error(errParams, "Unknown modify mode %d", mode);
 	}
 	if (!err.ok()) {
 		return err;
@@ -252,6 +264,53 @@ Error RPCServer::ModifyItem(cproto::Context &ctx, p_string nsName, int format, p
 	return sendResults(ctx, qres, -1, opts);
 }
 
+Error RPCServer::ModifyItems(cproto::Context &ctx, p_string nsName, int format, p_string itemsPack, int mode) {
+	auto db = getDB(ctx, kRoleDataWrite);
+	string ns = nsName.toString();
+	bool tmUpdated = false;
+	if (mode != ModeUpsert && mode != ModeInsert && mode != ModeUpdate && mode != ModeDelete) {
+		return Error(errParams, "Unknown modify mode %d", mode);
+	}
+
+	// Items of batch are applied by single transaction, under one lock of namespace. Transaction checks all items before applying,
+	// so batch with invalid item is rejected as whole, and results of applied batch are returned for each item
+	Transaction tx = db->NewTransaction(ns);
+	Serializer ser(itemsPack);
+	unsigned count = ser.GetVarUint();
+	for (unsigned i = 0; i < count; i++) {
+		p_string itemData = ser.GetPVString();
+		int stateToken = int(ser.GetVarUint());
+		p_string perceptsPack = ser.GetPVString();
+
+		auto item = Item(db->NewItem(ns));
+		if (!item.Status().ok()) {
+			return item.Status();
+		}
+		auto err = fillItem(item, format, itemData, mode, perceptsPack, stateToken);
+		if (!err.ok()) {
+			return Error(err.code(), "Item %d is not valid: %s", int(i), err.what().c_str());
+		}
+		tmUpdated = tmUpdated || item.IsTagsUpdated();
+		tx.Modify(std::move(item), ItemModifyMode(mode));
+	}
+
+	auto err = db->CommitTransaction(tx);
+	if (!err.ok()) {
+		return err;
+	}
+	QueryResults qres;
+	for (auto &step : tx.GetSteps()) qres.AddItem(step.item);
+	int32_t ptVers = -1;
+	ResultFetchOpts opts;
+	if (tmUpdated) {
+		opts = ResultFetchOpts{kResultsWithItemID | kResultsWithPayloadTypes, span<int32_t>(&ptVers, 1), 0, INT_MAX};
+	} else {
+		opts = ResultFetchOpts{kResultsWithItemID, {}, 0, INT_MAX};
+	}
+
+	return sendResults(ctx, qres, -1, opts);
+}
+
 Error RPCServer::DeleteQuery(cproto::Context &ctx, p_string queryBin) {
 	Query query;
 	Serializer ser(queryBin.data(), queryBin.size());
@@ -424,6 +483,34 @@ Error RPCServer::SubscribeUpdates(cproto::Context &ctx, int flag) {
 	return getDB(ctx, kRoleDataRead)->SubscribeUpdates(this, flag);
 }
 
+Error RPCServer::GetWAL(cproto::Context &ctx, p_string ns, int64_t lastLSN, int limit) {
+	WALChunk chunk;
+	auto err = getDB(ctx, kRoleDataRead)->GetWAL(ns.toString(), lastLSN, limit, chunk);
+	if (!err.ok()) {
+		return err;
+	}
+
+	WrSerializer ser;
+	chunk.Pack(ser);
+	auto resSlice = ser.Slice();
+	ctx.Return({cproto::Arg(p_string(&resSlice))});
+	return errOK;
+}
+
+Error RPCServer::GetSnapshot(cproto::Context &ctx, p_string ns, int64_t lsn, int64_t fromID, int maxSize) {
+	SnapshotChunk chunk;
+	auto err = getDB(ctx, kRoleDataRead)->GetSnapshot(ns.toString(), lsn, fromID, maxSize, chunk);
+	if (!err.ok()) {
+		return err;
+	}
+
+	WrSerializer ser;
+	chunk.Pack(ser);
+	auto resSlice = ser.Slice();
+	ctx.Return({cproto::Arg(p_string(&resSlice))});
+	return errOK;
+}
+
 bool RPCServer::Start(const string &addr, ev::dynamic_loop &loop) {
 	dispatcher.Register(cproto::kCmdPing, this, &RPCServer::Ping);
 	dispatcher.Register(cproto::kCmdLogin, this, &RPCServer::Login);
@@ -442,6 +529,7 @@ bool RPCServer::Start(const string &addr, ev::dynamic_loop &loop) {
 
 	dispatcher.Register(cproto::kCmdModifyItem, this, &RPCServer::ModifyItem);
 	dispatcher.Register(cproto::kCmdDeleteQuery, this, &RPCServer::DeleteQuery);
+	dispatcher.Register(cproto::kCmdModifyItems, this, &RPCServer::ModifyItems);
 
 	dispatcher.Register(cproto::kCmdSelect, this, &RPCServer::Select);
 	dispatcher.Register(cproto::kCmdSelectSQL, this, &RPCServer::SelectSQL);
@@ -452,8 +540,14 @@ bool RPCServer::Start(const string &addr, ev::dynamic_loop &loop) {
 	dispatcher.Register(cproto::kCmdPutMeta, this, &RPCServer::PutMeta);
 	dispatcher.Register(cproto::kCmdEnumMeta, this, &RPCServer::EnumMeta);
 	dispatcher.Register(cproto::kCmdSubscribeUpdates, this, &RPCServer::SubscribeUpdates);
+	dispatcher.Register(cproto::kCmdGetWAL, this, &RPCServer::GetWAL);
+	dispatcher.Register(cproto::kCmdGetSnapshot, this, &RPCServer::GetSnapshot);
 	dispatcher.Middleware(this, &RPCServer::CheckAuth);
 	dispatcher.OnClose(this, &RPCServer::OnClose);
+	// Results of selects are fetched in loops, so only first pages of results are built by workers
+	dispatcher.SetExecutor(executor_, {cproto::kCmdSelect, cproto::kCmdSelectSQL, cproto::kCmdDeleteQuery, cproto::kCmdModifyItem,
+									   cproto::kCmdModifyItems, cproto::kCmdCommit, cproto::kCmdGetWAL,
+									   cproto::kCmdGetSnapshot});
 
 	if (logger_) {
 		dispatcher.Logger(this, &RPCServer::Logger);
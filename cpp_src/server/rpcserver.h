@@ -25,7 +25,7 @@ struct RPCClientData : public cproto::ClientData {
 
 class RPCServer : reindexer::IUpdatesObserver {
 public:
-	RPCServer(DBManager &dbMgr, LoggerWrapper logger, bool allocDebug = false);
+	RPCServer(DBManager &dbMgr, LoggerWrapper logger, bool allocDebug = false, cproto::Executor *executor = nullptr);
 	~RPCServer();
 
 	bool Start(const string &addr, ev::dynamic_loop &loop);
@@ -50,6 +50,7 @@ public:
 
 	Error ModifyItem(cproto::Context &ctx, p_string nsName, int format, p_string itemData, int mode, p_string percepsPack, int stateToken,
 					 int txID);
+	Error ModifyItems(cproto::Context &ctx, p_string nsName, int format, p_string itemsPack, int mode);
 	Error DeleteQuery(cproto::Context &ctx, p_string query);
 
 	Error Select(cproto::Context &ctx, p_string query, int flags, int limit, p_string ptVersions);
@@ -61,6 +62,8 @@ public:
 	Error PutMeta(cproto::Context &ctx, p_string ns, p_string key, p_string data);
 	Error EnumMeta(cproto::Context &ctx, p_string ns);
 	Error SubscribeUpdates(cproto::Context &ctx, int subscribe);
+	Error GetWAL(cproto::Context &ctx, p_string ns, int64_t lastLSN, int limit);
+	Error GetSnapshot(cproto::Context &ctx, p_string ns, int64_t lsn, int64_t fromID, int maxSize);
 
 	Error CheckAuth(cproto::Context &ctx);
 	void Logger(cproto::Context &ctx, const Error &err, const cproto::Args &ret);
@@ -74,6 +77,7 @@ public:
 	Error OnPutMeta(const string &nsName, const string &key, const string &data) override;
 
 protected:
+	Error fillItem(Item &item, int format, p_string itemData, int mode, p_string perceptsPack, int stateToken);
 	Error sendResults(cproto::Context &ctx, QueryResults &qr, int reqId, const ResultFetchOpts &opts);
 	Error fetchResults(cproto::Context &ctx, int reqId, const ResultFetchOpts &opts);
 	void freeQueryResults(cproto::Context &ctx, int id);
@@ -83,6 +87,7 @@ protected:
 
 	DBManager &dbMgr_;
 	cproto::Dispatcher dispatcher;
+	cproto::Executor *executor_;
 	std::unique_ptr<Listener> listener_;
 
 	LoggerWrapper logger_;
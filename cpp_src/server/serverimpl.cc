@@ -3,15 +3,18 @@
 #include <vector>
 
 #include "args/args.hpp"
+#include "core/storage/storagefactory.h"
 #include "debug/allocdebug.h"
 #include "debug/backtrace.h"
 #include "httpserver.h"
 #include "loggerwrapper.h"
 #include "reindexer_version.h"
+#include "replicator/replicator.h"
 #include "rpcserver.h"
 #include "serverimpl.h"
 #include "tools/fsops.h"
 #include "tools/stringstools.h"
+#include "urlparser/urlparser.h"
 #include "yaml/yaml.h"
 
 #ifdef _WIN32
@@ -166,6 +169,32 @@ void ServerImpl::Stop() {
 	async_.send();
 }
 
+Error ServerImpl::getConnectOpts(reindexer::ConnectOpts& opts) {
+	reindexer::datastorage::StorageType storageType;
+	auto err = reindexer::datastorage::StorageTypeFromString(config_.StorageEngine, storageType);
+	if (!err.ok()) return err;
+	if (!reindexer::datastorage::StorageFactory::IsSupported(storageType)) {
+		return Error(errParams, "Storage engine '%s' is not supported by this build of reindexer_server", config_.StorageEngine.c_str());
+	}
+
+	StorageCompression compression = kStorageCompressionDefault;
+	if (config_.StorageCompression == "none") {
+		compression = kStorageCompressionNone;
+	} else if (config_.StorageCompression == "snappy") {
+		compression = kStorageCompressionSnappy;
+	} else if (!config_.StorageCompression.empty()) {
+		return Error(errParams, "Unknown storage compression '%s'", config_.StorageCompression.c_str());
+	}
+
+	opts.WithStorageType(storageType)
+		.WithStorageTunables(StorageOpts()
+								 .Compression(compression)
+								 .MaxOpenFiles(config_.StorageMaxOpenFiles)
+								 .BlockCacheSize(config_.StorageBlockCacheSize)
+								 .WriteBufferSize(config_.StorageWriteBufferSize));
+	return errOK;
+}
+
 int ServerImpl::run() {
 	loggerConfigure();
 	if (running_) {
@@ -200,15 +229,41 @@ int ServerImpl::run() {
 
 	initCoreLogger();
 	try {
-		dbMgr_.reset(new DBManager(config_.StoragePath, !config_.EnableSecurity));
+		reindexer::ConnectOpts connectOpts;
+		auto status = getConnectOpts(connectOpts);
+		if (!status.ok()) {
+			logger_.error("Error storage config: {0}", status.what());
+			return EXIT_FAILURE;
+		}
+		dbMgr_.reset(new DBManager(config_.StoragePath, !config_.EnableSecurity, connectOpts));
 
-		auto status = dbMgr_->Init();
+		status = dbMgr_->Init();
 		if (!status.ok()) {
 			logger_.error("Error init database manager: {0}", status.what());
 			return EXIT_FAILURE;
 		}
 		storageLoaded_ = true;
 
+		std::unique_ptr<Replicator> replicator;
+		if (!config_.ReplicationLeader.empty()) {
+			// Replica has the same name, as database of leader
+			httpparser::UrlParser leaderURI;
+			if (!leaderURI.parse(config_.ReplicationLeader) || leaderURI.path().length() <= 1) {
+				logger_.error("Invalid DSN of replication leader '{0}'", config_.ReplicationLeader);
+				return EXIT_FAILURE;
+			}
+			shared_ptr<Reindexer> replicaDB;
+			status = dbMgr_->OpenReplica(leaderURI.path().substr(1), replicaDB);
+			if (status.ok()) {
+				replicator.reset(new Replicator(replicaDB, config_.ReplicationLeader));
+				status = replicator->Start();
+			}
+			if (!status.ok()) {
+				logger_.error("Error start replication: {0}", status.what());
+				return EXIT_FAILURE;
+			}
+		}
+
 		logger_.info("Starting reindexer_server ({0}) on {1} HTTP, {2} RPC, with db '{3}'", REINDEX_VERSION, config_.HTTPAddr,
 					 config_.RPCAddr, config_.StoragePath);
 
@@ -218,15 +273,20 @@ int ServerImpl::run() {
 			config_.WebRoot.clear();
 		}
 #endif
+		// Workers outlive servers, because connections wait for their calls
+		std::unique_ptr<cproto::Executor> rpcExecutor;
+		if (config_.RPCThreads > 0) rpcExecutor.reset(new cproto::Executor(config_.RPCThreads));
+
 		LoggerWrapper httpLogger("http");
 		HTTPServer httpServer(*dbMgr_, config_.WebRoot, httpLogger, config_.DebugAllocs, config_.DebugPprof);
+		httpServer.SetRPCExecutor(rpcExecutor.get());
 		if (!httpServer.Start(config_.HTTPAddr, loop_)) {
 			logger_.error("Can't listen HTTP on '{0}'", config_.HTTPAddr);
 			return EXIT_FAILURE;
 		}
 
 		LoggerWrapper rpcLogger("rpc");
-		RPCServer rpcServer(*dbMgr_, rpcLogger, config_.DebugAllocs);
+		RPCServer rpcServer(*dbMgr_, rpcLogger, config_.DebugAllocs, rpcExecutor.get());
 		if (!rpcServer.Start(config_.RPCAddr, loop_)) {
 			logger_.error("Can't listen RPC on '{0}'", config_.RPCAddr);
 			return EXIT_FAILURE;
@@ -268,6 +328,7 @@ int ServerImpl::run() {
 
 		rpcServer.Stop();
 		httpServer.Stop();
+		if (replicator) replicator->Stop();
 	} catch (const Error &err) {
 		logger_.error("Unhandled exception occuried: {0}", err.what());
 	}
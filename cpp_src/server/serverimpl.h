@@ -39,6 +39,7 @@ public:
 
 protected:
 	int run();
+	Error getConnectOpts(reindexer::ConnectOpts& opts);
 	Error init();
 
 private:
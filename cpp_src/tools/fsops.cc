@@ -41,6 +41,8 @@ int RmDirAll(const string &path) {
 #endif
 }
 
+int Rename(const string &from, const string &to) { return ::rename(from.c_str(), to.c_str()); }
+
 int ReadFile(const string &path, string &content) {
 	FILE *f = fopen(path.c_str(), "r");
 	if (!f) {
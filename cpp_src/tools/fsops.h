@@ -23,6 +23,7 @@ enum FileStatus {
 
 int MkDirAll(const string &path);
 int RmDirAll(const string &path);
+int Rename(const string &from, const string &to);
 int ReadFile(const string &path, string &content);
 int ReadDir(const string &path, vector<DirEntry> &content);
 bool DirectoryExists(const string &directory);
@@ -0,0 +1,83 @@
+#include "tools/workerpool.h"
+#include <atomic>
+#include <exception>
+
+namespace reindexer {
+
+struct WorkerPool::Job {
+	Job(int cnt, const std::function<void(int)> &fn) : count(cnt), f(fn) {}
+
+	const int count;
+	const std::function<void(int)> &f;
+	// Index of next task to execute
+	std::atomic<int> next{0};
+	// Amount of finished tasks
+	int done = 0;
+	std::exception_ptr err;
+	std::mutex mtx;
+	std::condition_variable finished;
+};
+
+WorkerPool::WorkerPool(int threads) {
+	threads_.reserve(threads);
+	for (int i = 0; i < threads; i++) threads_.emplace_back([this]() { workerThread(); });
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		std::lock_guard<std::mutex> lck(mtx_);
+		terminate_ = true;
+		cond_.notify_all();
+	}
+	for (auto &thr : threads_) thr.join();
+}
+
+void WorkerPool::Run(int count, const std::function<void(int)> &f) {
+	if (count <= 0) return;
+	auto job = std::make_shared<Job>(count, f);
+	if (count > 1 && !threads_.empty()) {
+		std::lock_guard<std::mutex> lck(mtx_);
+		jobs_.push_back(job);
+		cond_.notify_all();
+	}
+
+	execute(*job);
+
+	std::unique_lock<std::mutex> lck(job->mtx);
+	job->finished.wait(lck, [&job]() { return job->done == job->count; });
+	if (job->err) std::rethrow_exception(job->err);
+}
+
+void WorkerPool::workerThread() {
+	for (;;) {
+		std::shared_ptr<Job> job;
+		{
+			std::unique_lock<std::mutex> lck(mtx_);
+			cond_.wait(lck, [this]() { return terminate_ || !jobs_.empty(); });
+			if (terminate_) return;
+			job = jobs_.front();
+			// All the tasks of job are taken, so job is not needed in queue anymore
+			if (job->next >= job->count) {
+				jobs_.pop_front();
+				continue;
+			}
+		}
+		execute(*job);
+	}
+}
+
+void WorkerPool::execute(Job &job) {
+	for (int i = job.next++; i < job.count; i = job.next++) {
+		std::exception_ptr err;
+		try {
+			job.f(i);
+		} catch (...) {
+			err = std::current_exception();
+		}
+		std::lock_guard<std::mutex> lck(job.mtx);
+		if (err && !job.err) job.err = err;
+		if (++job.done == job.count) job.finished.notify_all();
+	}
+}
+
+}  // namespace reindexer
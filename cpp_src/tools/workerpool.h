@@ -0,0 +1,43 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace reindexer {
+
+/// Pool of worker threads, shared by several callers.
+/// Caller of Run participates in execution of own tasks, so Run does not wait for free workers, if all of them are busy
+class WorkerPool {
+public:
+	/// @param threads - amount of worker threads in pool.
+	WorkerPool(int threads);
+	~WorkerPool();
+	WorkerPool(const WorkerPool &) = delete;
+	WorkerPool &operator=(const WorkerPool &) = delete;
+
+	/// Calls f(i) for each i in [0,count) by workers of pool and by calling thread.
+	/// Blocks until all calls are done. First exception of f is rethrown to caller
+	/// @param count - amount of tasks.
+	/// @param f - task function.
+	void Run(int count, const std::function<void(int)> &f);
+	/// @return amount of threads, which may execute tasks of single Run, including calling thread
+	int Concurrency() const { return threads_.size() + 1; }
+
+protected:
+	struct Job;
+	void workerThread();
+	static void execute(Job &job);
+
+	std::vector<std::thread> threads_;
+	std::deque<std::shared_ptr<Job>> jobs_;
+	std::mutex mtx_;
+	std::condition_variable cond_;
+	bool terminate_ = false;
+};
+
+}  // namespace reindexer
@@ -76,6 +76,11 @@ type NamespaceMemStat struct {
 		IndexesSize int `json:"indexes_size"`
 		CacheSize   int `json:"cache_size"`
 	}
+	Payloads struct {
+		SlabsCount int64 `json:"slabs_count"`
+		SlabsSize  int64 `json:"slabs_size"`
+		FreeSize   int64 `json:"free_size"`
+	} `json:"payloads"`
 }
 
 type PerfStat struct {
@@ -99,9 +104,11 @@ type QueryPerfStat struct {
 }
 
 type DBConfigItem struct {
-	Type       string                `json:"type"`
-	Profiling  *DBProfilingConfig    `json:"profiling,omitempty"`
-	LogQueries *[]DBLogQueriesConfig `json:"log_queries,omitempty"`
+	Type         string                `json:"type"`
+	Profiling    *DBProfilingConfig    `json:"profiling,omitempty"`
+	LogQueries   *[]DBLogQueriesConfig `json:"log_queries,omitempty"`
+	Optimization *DBOptimizationConfig `json:"optimization,omitempty"`
+	Namespaces   *[]DBNamespacesConfig `json:"namespaces,omitempty"`
 }
 
 type DBProfilingConfig struct {
@@ -111,11 +118,23 @@ type DBProfilingConfig struct {
 	QueriesPerfStats   bool `json:"queriesperfstats"`
 }
 
+type DBOptimizationConfig struct {
+	TimeoutMs               int `json:"timeout_ms"`
+	ParallelSelectThreads   int `json:"parallel_select_threads"`
+	ParallelSelectThreshold int `json:"parallel_select_threshold"`
+}
+
 type DBLogQueriesConfig struct {
 	Namespace string `json:"namespace"`
 	LogLevel  string `json:"log_level"`
 }
 
+type DBNamespacesConfig struct {
+	Namespace     string `json:"namespace"`
+	SortedIdsMode string `json:"sorted_ids_mode"`
+	WALSize       int    `json:"wal_size,omitempty"`
+}
+
 // DescribeNamespaces makes a 'SELECT * FROM #namespaces' query to database.
 // Return NamespaceDescription results, error
 func (db *Reindexer) DescribeNamespaces() ([]*NamespaceDescription, error) {
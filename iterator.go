@@ -16,14 +16,17 @@ type ExplainResults struct {
 	IndexesUs     int    `json:"indexes_us"`
 	PostprocessUS int    `json:"postprocess_us"`
 	LoopUs        int    `json:"loop_us"`
+	LoopThreads   int    `json:"loop_threads"`
 	SortIndex     string `json:"sort_index"`
 	Selectors     []struct {
 		Field       string  `json:"field"`
 		Method      string  `json:"method"`
+		Strategy    string  `json:"strategy,omitempty"`
 		Keys        int     `json:"keys"`
 		Comparators int     `json:"comparators"`
 		Cost        float32 `json:"cost"`
 		Matched     int     `json:"matched"`
+		Estimated   int     `json:"estimated,omitempty"`
 	} `json:"selectors"`
 }
 
@@ -31,6 +31,8 @@ type indexOptions struct {
 	isDense     bool
 	isPk        bool
 	isSparse    bool
+	isBitmap    bool
+	isColumn    bool
 }
 
 func (db *Reindexer) parseIndex(namespace string, st reflect.Type, joined *map[string][]int) (indexDefs []bindings.IndexDef, err error) {
@@ -182,6 +184,10 @@ func parseOpts(idxSettingsBuf *[]string) indexOptions {
 			opts.isDense = true
 		case "sparse":
 			opts.isSparse = true
+		case "bitmap":
+			opts.isBitmap = true
+		case "column":
+			opts.isColumn = true
 		case "appendable":
 			opts.isAppenable = true
 		default:
@@ -316,6 +322,8 @@ func makeIndexDef(index string, jsonPaths []string, indexType, fieldType string,
 		IsPK:        opts.isPk,
 		IsDense:     opts.isDense,
 		IsSparse:    opts.isSparse,
+		IsBitmap:    opts.isBitmap,
+		IsColumn:    opts.isColumn,
 		CollateMode: cm,
 		SortOrder:   sortOrder,
 	}
@@ -254,6 +254,7 @@ func (opts *NamespaceOptions) CacheOn() *NamespaceOptions {
 	return opts
 }
 
+// CacheAggressive enables cache of full results of repeated queries, in addition to cache of total counts
 func (opts *NamespaceOptions) CacheAggressive() *NamespaceOptions {
 	opts.cachedMode = bindings.CacheModeAggressive
 	return opts